@@ -2,7 +2,7 @@
 # Run  qmake CONFIG+=wv2  to enable support for historic Word file formats
 # Run  qmake "CONFIG+=wv2 quazip5"  to enable all features
 
-QT += network xml gui xmlpatterns
+QT += network xml gui xmlpatterns concurrent
 QT -= webkit
 
 wv2 {
@@ -39,14 +39,28 @@ SOURCES += src/main.cpp src/watchdog.cpp \
     src/searchenginespringerlink.cpp \
     src/networkaccessmanager.cpp \
     src/guessing.cpp \
-    src/directorymonitor.cpp
+    src/directorymonitor.cpp \
+    src/ndjsoncollector.cpp \
+    src/statisticsaggregator.cpp \
+    src/latencymetrics.cpp \
+    src/pdfquickparser.cpp \
+    src/popplerworkerpool.cpp \
+    src/adaptivetimeouts.cpp \
+    src/validatoroutputsummary.cpp \
+    src/jpegparser.cpp \
+    src/jp2parser.cpp \
+    src/tiffparser.cpp \
+    src/fileanalyzerarchive.cpp \
+    src/fileanalyzertar.cpp \
+    src/contentsniffer.cpp \
+    src/toolregistry.cpp
 HEADERS += src/searchengineabstract.h \
     src/searchenginebing.h src/downloader.h \
     src/fileanalyzerabstract.h src/searchenginegoogle.h \
     src/fileanalyzerpdf.h src/fileanalyzerjpeg.h \
     src/fileanalyzerjp2.h src/fileanalyzertiff.h \
     src/watchdog.h src/watchable.h \
-    src/logcollector.h src/fromlogfile.h \
+    src/logcollector.h src/logindex.h src/fromlogfile.h \
     src/general.h src/urldownloader.h \
     src/filefinder.h src/jhovewrapper.h \
     src/filesystemscan.h src/filefinderlist.h \
@@ -56,7 +70,22 @@ HEADERS += src/searchengineabstract.h \
     src/searchenginespringerlink.h \
     src/networkaccessmanager.h \
     src/guessing.h \
-    src/directorymonitor.h
+    src/directorymonitor.h \
+    src/ndjsoncollector.h \
+    src/statisticsaggregator.h \
+    src/latencymetrics.h \
+    src/pdfquickparser.h \
+    src/popplerworkerpool.h \
+    src/adaptivetimeouts.h \
+    src/validatoroutputsummary.h \
+    src/jpegparser.h \
+    src/jp2parser.h \
+    src/tiffparser.h \
+    src/fileanalyzerarchive.h \
+    src/fileanalyzertar.h \
+    src/contentsniffer.h \
+    src/toolregistry.h \
+    src/lazyanalyzer.h
 
 wv2 {
     SOURCES += src/wv2/crc32.c src/wv2/handlers.cpp src/wv2/word_helper.cpp \
@@ -115,14 +144,14 @@ quazip5 {
     DEFINES += HAVE_QUAZIP5
 
     SOURCES += src/fileanalyzeropenxml.cpp src/fileanalyzerodf.cpp \
-               src/fileanalyzerzip.cpp
+               src/fileanalyzerzip.cpp src/zipdirectoryindex.cpp
     HEADERS += src/fileanalyzeropenxml.h src/fileanalyzerodf.h \
-               src/fileanalyzerzip.h
+               src/fileanalyzerzip.h src/zipdirectoryindex.h
 }
 
 unix {
     CONFIG += link_pkgconfig
-    PKGCONFIG += poppler-qt5
+    PKGCONFIG += poppler-qt5 zlib
 }
 
 include(gitversion.pri)
@@ -0,0 +1,10 @@
+QT -= gui webkit network xml
+WARNINGS += -Wall
+TARGET = LogIndexLookup
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG += c++11
+TEMPLATE = app
+
+SOURCES += src/logindexlookup.cpp
+HEADERS += src/logindex.h
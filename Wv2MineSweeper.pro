@@ -1,17 +1,20 @@
 QT -= gui webkit network xml
+QT += concurrent
 SUBDIRS = wv2
 WARNINGS += -Wall
 TARGET = Wv2MineSweeper
 CONFIG += console
-CONFIG -= app_bundle thread
+CONFIG -= app_bundle
 CONFIG += ordered
 TEMPLATE = app
 DEFINES += HAVE_WV2 HAVE_ICONV_H ICONV_CONST= HAVE_STRING_H HAVE_MATH_H
 
 SOURCES += src/wv2minesweeper.cpp src/fileanalyzercompoundbinary.cpp \
-  src/fileanalyzerabstract.cpp src/general.cpp src/poorlogger.cpp
+  src/fileanalyzerabstract.cpp src/general.cpp src/poorlogger.cpp \
+  src/latencymetrics.cpp src/toolregistry.cpp
 HEADERS += src/fileanalyzercompoundbinary.h src/fileanalyzerabstract.h \
-  src/general.h src/poorlogger.h
+  src/general.h src/poorlogger.h src/latencymetrics.h \
+  src/toolregistry.h
 
 # wv2
 HEADERS += src/wv2/word95_helper.h src/wv2/global.h src/wv2/word_helper.h src/wv2/styles.h \
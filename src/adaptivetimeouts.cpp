@@ -0,0 +1,264 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#include "adaptivetimeouts.h"
+
+#include <cmath>
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QDebug>
+
+const int AdaptiveTimeouts::minimumSamples = 20;
+const int AdaptiveTimeouts::saveInterval = 32;
+
+AdaptiveTimeouts::Model::Model()
+    : count(0.0), yty(0.0)
+{
+    for (int i = 0; i < numFeatures; ++i) {
+        xty[i] = 0.0;
+        for (int j = 0; j < numFeatures; ++j)
+            xtx[i][j] = 0.0;
+    }
+}
+
+void AdaptiveTimeouts::Model::add(const double x[numFeatures], double y, double yy) {
+    count += 1.0;
+    for (int i = 0; i < numFeatures; ++i) {
+        xty[i] += x[i] * y;
+        for (int j = 0; j < numFeatures; ++j)
+            xtx[i][j] += x[i] * x[j];
+    }
+    yty += yy;
+}
+
+bool AdaptiveTimeouts::Model::predict(const double x[numFeatures], double &mean, double &standardDeviation) const {
+    if (count < minimumSamples) return false;
+
+    /// Solve normal equations (XtX + ridge) * beta = Xty by Gaussian elimination.
+    /// The small ridge term keeps the system solvable if e.g. the number
+    /// of pages is unknown for all files and therefore constant.
+    static const double ridge = 1e-3;
+    double a[numFeatures][numFeatures + 1];
+    for (int i = 0; i < numFeatures; ++i) {
+        for (int j = 0; j < numFeatures; ++j)
+            a[i][j] = xtx[i][j] + (i == j && i > 0 ? ridge * count : 0.0);
+        a[i][numFeatures] = xty[i];
+    }
+    for (int col = 0; col < numFeatures; ++col) {
+        int pivot = col;
+        for (int row = col + 1; row < numFeatures; ++row)
+            if (std::fabs(a[row][col]) > std::fabs(a[pivot][col])) pivot = row;
+        if (std::fabs(a[pivot][col]) < 1e-12) return false;
+        if (pivot != col)
+            for (int k = 0; k <= numFeatures; ++k) qSwap(a[col][k], a[pivot][k]);
+        for (int row = 0; row < numFeatures; ++row) {
+            if (row == col) continue;
+            const double factor = a[row][col] / a[col][col];
+            for (int k = col; k <= numFeatures; ++k)
+                a[row][k] -= factor * a[col][k];
+        }
+    }
+    double beta[numFeatures];
+    for (int i = 0; i < numFeatures; ++i)
+        beta[i] = a[i][numFeatures] / a[i][i];
+
+    /// Residual sum of squares from sufficient statistics:
+    /// RSS = yty - 2 beta^T Xty + beta^T XtX beta
+    double rss = yty;
+    mean = 0.0;
+    for (int i = 0; i < numFeatures; ++i) {
+        mean += beta[i] * x[i];
+        rss -= 2.0 * beta[i] * xty[i];
+        for (int j = 0; j < numFeatures; ++j)
+            rss += beta[i] * xtx[i][j] * beta[j];
+    }
+    /// Do not trust a model that claims to be more precise than about 10%
+    standardDeviation = qMax(0.1, std::sqrt(qMax(0.0, rss) / (count - numFeatures)));
+    return true;
+}
+
+AdaptiveTimeouts::AdaptiveTimeouts(const QString &filename, QObject *parent)
+    : QObject(parent), m_filename(filename), m_zScore(normalQuantile(0.99)), m_minimumMillisec(30000), m_maximumFactor(4.0), m_unsavedSamples(0)
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+    load();
+}
+
+AdaptiveTimeouts::~AdaptiveTimeouts() {
+    save();
+}
+
+void AdaptiveTimeouts::setQuantile(double quantile) {
+    QMutexLocker locker(&m_mutex);
+    m_zScore = normalQuantile(qBound(0.5, quantile, 0.9999));
+}
+
+void AdaptiveTimeouts::setBounds(int minimumMillisec, double maximumFactor) {
+    QMutexLocker locker(&m_mutex);
+    m_minimumMillisec = qMax(1000, minimumMillisec);
+    m_maximumFactor = qMax(1.0, maximumFactor);
+}
+
+int AdaptiveTimeouts::timeLimit(const QString &tool, qint64 fileSize, int numPages, int defaultTimeLimit) {
+    double x[numFeatures];
+    features(fileSize, numPages, x);
+
+    QMutexLocker locker(&m_mutex);
+    const QHash<QString, Model>::ConstIterator it = m_models.constFind(tool);
+    double mean = 0.0, standardDeviation = 0.0;
+    if (it == m_models.constEnd() || !it.value().predict(x, mean, standardDeviation))
+        return defaultTimeLimit;
+
+    const double maximum = defaultTimeLimit * m_maximumFactor;
+    const double limit = std::exp(mean + m_zScore * standardDeviation);
+    return static_cast<int>(qBound(qMin<double>(m_minimumMillisec, maximum), limit, maximum));
+}
+
+void AdaptiveTimeouts::recordRuntime(const QString &tool, qint64 fileSize, int numPages, qint64 milliseconds) {
+    double x[numFeatures];
+    features(fileSize, numPages, x);
+    const double y = std::log(qMax(Q_INT64_C(1), milliseconds));
+
+    QMutexLocker locker(&m_mutex);
+    m_models[tool].add(x, y, y * y);
+    if (++m_unsavedSamples >= saveInterval)
+        saveLocked();
+}
+
+void AdaptiveTimeouts::recordTimeout(const QString &tool, qint64 fileSize, int numPages, qint64 milliseconds) {
+    double x[numFeatures];
+    features(fileSize, numPages, x);
+    const double c = std::log(qMax(Q_INT64_C(1), milliseconds));
+
+    QMutexLocker locker(&m_mutex);
+    Model &model = m_models[tool];
+    double mean = 0.0, standardDeviation = 0.0;
+    if (model.predict(x, mean, standardDeviation)) {
+        /// Moments of the normal distribution truncated from below at c:
+        /// E[y|y>c] = mean + sd * lambda,
+        /// Var[y|y>c] = sd^2 * (1 + alpha * lambda - lambda^2)
+        /// with alpha = (c - mean) / sd and lambda the inverse Mills ratio
+        const double alpha = (c - mean) / standardDeviation;
+        const double lambda = inverseMillsRatio(alpha);
+        const double y = qMax(c, mean + standardDeviation * lambda);
+        const double variance = standardDeviation * standardDeviation * qMax(0.0, 1.0 + alpha * lambda - lambda * lambda);
+        model.add(x, y, y * y + variance);
+    } else
+        model.add(x, c, c * c);
+    if (++m_unsavedSamples >= saveInterval)
+        saveLocked();
+}
+
+void AdaptiveTimeouts::save() {
+    QMutexLocker locker(&m_mutex);
+    saveLocked();
+}
+
+void AdaptiveTimeouts::saveLocked() {
+    QJsonObject toolsObject;
+    for (QHash<QString, Model>::ConstIterator it = m_models.constBegin(); it != m_models.constEnd(); ++it) {
+        const Model &model = it.value();
+        QJsonArray xtxArray, xtyArray;
+        for (int i = 0; i < numFeatures; ++i) {
+            xtyArray.append(model.xty[i]);
+            for (int j = 0; j < numFeatures; ++j)
+                xtxArray.append(model.xtx[i][j]);
+        }
+        QJsonObject modelObject;
+        modelObject.insert(QStringLiteral("count"), model.count);
+        modelObject.insert(QStringLiteral("xtx"), xtxArray);
+        modelObject.insert(QStringLiteral("xty"), xtyArray);
+        modelObject.insert(QStringLiteral("yty"), model.yty);
+        toolsObject.insert(it.key(), modelObject);
+    }
+    QJsonObject rootObject;
+    rootObject.insert(QStringLiteral("tools"), toolsObject);
+
+    QSaveFile modelsFile(m_filename);
+    if (!modelsFile.open(QSaveFile::WriteOnly)) {
+        qWarning() << "Could not write adaptive timeouts file" << m_filename;
+        return;
+    }
+    modelsFile.write(QJsonDocument(rootObject).toJson(QJsonDocument::Indented));
+    if (modelsFile.commit())
+        m_unsavedSamples = 0;
+    else
+        qWarning() << "Could not write adaptive timeouts file" << m_filename;
+}
+
+void AdaptiveTimeouts::load() {
+    QFile modelsFile(m_filename);
+    if (!modelsFile.exists()) return; ///< nothing learned yet
+    if (!modelsFile.open(QFile::ReadOnly)) {
+        qWarning() << "Could not read adaptive timeouts file" << m_filename;
+        return;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(modelsFile.readAll());
+    const QJsonObject toolsObject = document.object().value(QStringLiteral("tools")).toObject();
+    for (QJsonObject::ConstIterator it = toolsObject.constBegin(); it != toolsObject.constEnd(); ++it) {
+        const QJsonObject modelObject = it.value().toObject();
+        const QJsonArray xtxArray = modelObject.value(QStringLiteral("xtx")).toArray();
+        const QJsonArray xtyArray = modelObject.value(QStringLiteral("xty")).toArray();
+        if (xtxArray.count() != numFeatures * numFeatures || xtyArray.count() != numFeatures) {
+            qWarning() << "Ignoring malformed model for" << it.key() << "in adaptive timeouts file" << m_filename;
+            continue;
+        }
+        Model model;
+        model.count = modelObject.value(QStringLiteral("count")).toDouble();
+        model.yty = modelObject.value(QStringLiteral("yty")).toDouble();
+        for (int i = 0; i < numFeatures; ++i) {
+            model.xty[i] = xtyArray.at(i).toDouble();
+            for (int j = 0; j < numFeatures; ++j)
+                model.xtx[i][j] = xtxArray.at(i * numFeatures + j).toDouble();
+        }
+        m_models.insert(it.key(), model);
+    }
+    qDebug() << "Loaded" << m_models.count() << "runtime models from" << m_filename;
+}
+
+void AdaptiveTimeouts::features(qint64 fileSize, int numPages, double x[numFeatures]) {
+    x[0] = 1.0; ///< intercept
+    x[1] = std::log1p(qMax(Q_INT64_C(0), fileSize) / 1024.0);
+    x[2] = std::log1p(static_cast<double>(qMax(0, numPages)));
+}
+
+double AdaptiveTimeouts::normalQuantile(double p) {
+    /// Rational approximation by Abramowitz and Stegun (26.2.23),
+    /// absolute error below 4.5e-4
+    const double t = std::sqrt(-2.0 * std::log(1.0 - p));
+    return t - (2.515517 + 0.802853 * t + 0.010328 * t * t) / (1.0 + 1.432788 * t + 0.189269 * t * t + 0.001308 * t * t * t);
+}
+
+double AdaptiveTimeouts::inverseMillsRatio(double z) {
+    const double upperTail = 0.5 * std::erfc(z / std::sqrt(2.0));
+    /// Far in the tail, use the asymptotic expansion to avoid dividing by zero
+    if (upperTail < 1e-12)
+        return z + 1.0 / z;
+    static const double inverseSqrtTwoPi = 0.3989422804014327;
+    return inverseSqrtTwoPi * std::exp(-0.5 * z * z) / upperTail;
+}
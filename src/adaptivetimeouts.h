@@ -0,0 +1,160 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#ifndef ADAPTIVETIMEOUTS_H
+#define ADAPTIVETIMEOUTS_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+
+/**
+ * Time limits for external tools like veraPDF, adapted to each file.
+ * For each tool, a model is fitted online from observed runtimes:
+ * the logarithm of the runtime is a linear function of the logarithms
+ * of file size and number of pages, plus normally distributed noise.
+ * A file's time limit is the runtime predicted for the configured
+ * quantile (e.g. 99%), bounded by a minimum and by a multiple of the
+ * tool's default time limit. As long as a tool has too few
+ * observations, its default time limit is used.
+ * Models are loaded from and saved to a JSON file, so that they
+ * persist between runs. All methods are thread-safe.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class AdaptiveTimeouts : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param filename JSON file to load models from and save models to
+     */
+    explicit AdaptiveTimeouts(const QString &filename, QObject *parent = nullptr);
+    ~AdaptiveTimeouts();
+
+    /**
+     * @param quantile fraction of runs expected to finish within the time limit, e.g. 0.99
+     */
+    void setQuantile(double quantile);
+
+    /**
+     * @param minimumMillisec time limit never shorter than this
+     * @param maximumFactor time limit never longer than this multiple of the default time limit
+     */
+    void setBounds(int minimumMillisec, double maximumFactor);
+
+    /**
+     * Determine time limit for running a tool on a file.
+     *
+     * @param tool name of tool, e.g. 'verapdf'
+     * @param fileSize size of file in bytes
+     * @param numPages number of pages, 0 if unknown
+     * @param defaultTimeLimit time limit in milliseconds used if no model is available
+     * @return time limit in milliseconds
+     */
+    int timeLimit(const QString &tool, qint64 fileSize, int numPages, int defaultTimeLimit);
+
+    /**
+     * Record a tool's runtime on a file to improve the tool's model.
+     * Runs killed after exceeding their time limit must be recorded
+     * using @see recordTimeout instead.
+     *
+     * @param tool name of tool, e.g. 'verapdf'
+     * @param fileSize size of file in bytes
+     * @param numPages number of pages, 0 if unknown
+     * @param milliseconds observed runtime
+     */
+    void recordRuntime(const QString &tool, qint64 fileSize, int numPages, qint64 milliseconds);
+
+    /**
+     * Record a run killed after exceeding its time limit. Its true
+     * runtime is unknown but longer than the time it was allowed to run,
+     * i.e. it is a censored observation. Such runs are the slowest ones,
+     * so leaving them out would make the model underestimate runtimes
+     * and shorten time limits ever further. Instead, the run is recorded
+     * with the runtime the current model expects given that the run took
+     * longer than the limit, which raises both the predicted runtime and
+     * its spread. Without a model yet, the limit itself is recorded.
+     *
+     * @param tool name of tool, e.g. 'verapdf'
+     * @param fileSize size of file in bytes
+     * @param numPages number of pages, 0 if unknown
+     * @param milliseconds time the run was allowed before being killed
+     */
+    void recordTimeout(const QString &tool, qint64 fileSize, int numPages, qint64 milliseconds);
+
+public slots:
+    /**
+     * Write all models into the JSON file.
+     * The file is replaced atomically.
+     */
+    void save();
+
+private:
+    static const int numFeatures = 3;
+    /// Minimum number of observations before a model is used
+    static const int minimumSamples;
+    /// Save models after this many new observations
+    static const int saveInterval;
+
+    /// Sufficient statistics for least-squares regression
+    struct Model {
+        double count;
+        double xtx[numFeatures][numFeatures];
+        double xty[numFeatures];
+        double yty;
+
+        explicit Model();
+
+        /**
+         * Add an observation.
+         * @param yy contribution to the sum of squares, usually y * y
+         */
+        void add(const double x[numFeatures], double y, double yy);
+
+        /**
+         * Predict mean and standard deviation of the logarithm of the runtime.
+         * @return false if too few observations or regression failed
+         */
+        bool predict(const double x[numFeatures], double &mean, double &standardDeviation) const;
+    };
+
+    static void features(qint64 fileSize, int numPages, double x[numFeatures]);
+    /// Inverse of the standard normal distribution's CDF for 0.5 <= p < 1
+    static double normalQuantile(double p);
+    /// Ratio of the standard normal distribution's density and upper tail probability at z
+    static double inverseMillsRatio(double z);
+
+    void load();
+    void saveLocked();
+
+    const QString m_filename;
+    QMutex m_mutex;
+    QHash<QString, Model> m_models;
+    double m_zScore;
+    int m_minimumMillisec;
+    double m_maximumFactor;
+    int m_unsavedSamples;
+};
+
+#endif // ADAPTIVETIMEOUTS_H
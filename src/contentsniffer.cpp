@@ -0,0 +1,249 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "contentsniffer.h"
+
+#include <QFile>
+#include <QtEndian>
+
+#include <cstring>
+
+#include <zlib.h>
+
+const int ContentSniffer::headerSize = 8192;
+
+/// Signatures are checked in this order, first match wins
+static const struct Signature {
+    int offset;
+    const char *magic;
+    int length;
+    ContentSniffer::FileType fileType;
+} signatures[] = {
+    {0, "%PDF-", 5, ContentSniffer::ftPDF},
+    {0, "\xff\xd8\xff", 3, ContentSniffer::ftJPEG},
+    {0, "\x00\x00\x00\x0cjP  \x0d\x0a\x87\x0a", 12, ContentSniffer::ftJP2}, ///< JP2 signature box
+    {0, "\xff\x4f\xff\x51", 4, ContentSniffer::ftJP2}, ///< raw JPEG 2000 codestream
+    {0, "II*\x00", 4, ContentSniffer::ftTIFF},
+    {0, "MM\x00*", 4, ContentSniffer::ftTIFF},
+    {0, "II+\x00", 4, ContentSniffer::ftTIFF}, ///< BigTIFF
+    {0, "MM\x00+", 4, ContentSniffer::ftTIFF}, ///< BigTIFF
+    {0, "\x89PNG\x0d\x0a\x1a\x0a", 8, ContentSniffer::ftPNG},
+    {0, "PK\x03\x04", 4, ContentSniffer::ftZIP},
+    {0, "\xd0\xcf\x11\xe0\xa1\xb1\x1a\xe1", 8, ContentSniffer::ftCompoundBinary},
+    {0, "\x1f\x8b", 2, ContentSniffer::ftGzip},
+    {0, "\xfd" "7zXZ\x00", 6, ContentSniffer::ftXz},
+    {0, "BZh", 3, ContentSniffer::ftBzip2},
+    {257, "ustar", 5, ContentSniffer::ftTar}
+};
+
+/// PDF readers tolerate garbage in front of the '%PDF-' header within this many bytes
+static const int maxPDFHeaderOffset = 1024;
+
+static bool hasExtension(const QString &filename, const char *const extensions[]) {
+    for (int i = 0; extensions[i] != nullptr; ++i)
+        if (filename.endsWith(QLatin1String(extensions[i]), Qt::CaseInsensitive))
+            return true;
+    return false;
+}
+
+static const char *const compressedTarExtensions[] = {".tar.gz", ".tgz", ".tar.xz", ".txz", ".tar.bz2", ".tbz", ".tbz2", ".tar.lzma", ".tlz", nullptr};
+static const char *const odfExtensions[] = {".odt", ".ods", ".odp", nullptr};
+static const char *const openXMLExtensions[] = {".docx", ".pptx", ".xlsx", nullptr};
+/// Mimetypes matching above office extensions in the same order
+static const char *const officeMimetypes[] = {
+    "application/vnd.oasis.opendocument.text", "application/vnd.oasis.opendocument.spreadsheet", "application/vnd.oasis.opendocument.presentation",
+    "application/vnd.openxmlformats-officedocument.wordprocessingml.document", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet", "application/vnd.openxmlformats-officedocument.presentationml.presentation"
+};
+
+static QString officeMimetypeForFilename(const QString &filename) {
+    for (int i = 0; i < 3; ++i)
+        if (filename.endsWith(QLatin1String(odfExtensions[i]), Qt::CaseInsensitive))
+            return QLatin1String(officeMimetypes[i]);
+        else if (filename.endsWith(QLatin1String(openXMLExtensions[i]), Qt::CaseInsensitive))
+            return QLatin1String(officeMimetypes[3 + i]);
+    return QString();
+}
+
+/// Uncompress the beginning of gzip-compressed data, as far as the data in memory allows
+static QByteArray gunzipHead(const QByteArray &data, int maxSize) {
+    QByteArray result(maxSize, '\0');
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    /// Adding 16 to window bits makes zlib expect a gzip header
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) return QByteArray();
+    stream.next_out = reinterpret_cast<Bytef *>(result.data());
+    stream.avail_out = static_cast<uInt>(maxSize);
+    inflate(&stream, Z_SYNC_FLUSH); ///< data is incomplete, so errors are expected
+    result.resize(maxSize - static_cast<int>(stream.avail_out));
+    inflateEnd(&stream);
+    return result;
+}
+
+ContentSniffer::ContentSniffer(const QString &filename)
+    : m_fileType(ftUnknown), m_compression(ftUnknown)
+{
+    QFile file(filename);
+    if (file.open(QFile::ReadOnly)) {
+        m_header = file.read(headerSize);
+        file.close();
+    }
+    sniff(filename);
+}
+
+ContentSniffer::ContentSniffer(const QByteArray &header, const QString &filename)
+    : m_header(header), m_fileType(ftUnknown), m_compression(ftUnknown)
+{
+    sniff(filename);
+}
+
+ContentSniffer::FileType ContentSniffer::fileType() const {
+    return m_fileType;
+}
+
+ContentSniffer::FileType ContentSniffer::compression() const {
+    return m_compression;
+}
+
+QString ContentSniffer::mimetype() const {
+    return m_mimetype;
+}
+
+const QByteArray &ContentSniffer::header() const {
+    return m_header;
+}
+
+QStringList ContentSniffer::extensions() const {
+    switch (m_fileType) {
+    case ftPDF: return QStringList() << QStringLiteral(".pdf");
+    case ftJPEG: return QStringList() << QStringLiteral(".jpg") << QStringLiteral(".jpeg") << QStringLiteral(".jpe") << QStringLiteral(".jfif");
+    case ftJP2: return QStringList() << QStringLiteral(".jp2") << QStringLiteral(".jpf") << QStringLiteral(".jpx");
+    case ftTIFF: return QStringList() << QStringLiteral(".tif") << QStringLiteral(".tiff");
+    case ftPNG: return QStringList() << QStringLiteral(".png");
+    case ftZIP: return QStringList() << QStringLiteral(".zip");
+    case ftODF: return QStringList() << QStringLiteral(".odt") << QStringLiteral(".ods") << QStringLiteral(".odp");
+    case ftOpenXML: return QStringList() << QStringLiteral(".docx") << QStringLiteral(".pptx") << QStringLiteral(".xlsx");
+    case ftCompoundBinary: return QStringList() << QStringLiteral(".doc") << QStringLiteral(".ppt") << QStringLiteral(".xls");
+    case ftTar: {
+        QStringList result = QStringList() << QStringLiteral(".tar");
+        for (int i = 0; compressedTarExtensions[i] != nullptr; ++i)
+            result << QLatin1String(compressedTarExtensions[i]);
+        return result;
+    }
+    case ftGzip: return QStringList() << QStringLiteral(".gz");
+    case ftXz: return QStringList() << QStringLiteral(".xz");
+    case ftBzip2: return QStringList() << QStringLiteral(".bz2");
+    case ftLzma: return QStringList() << QStringLiteral(".lzma");
+    default: return QStringList();
+    }
+}
+
+void ContentSniffer::sniff(const QString &filename) {
+    for (const Signature &signature : signatures)
+        if (m_header.size() >= signature.offset + signature.length && std::memcmp(m_header.constData() + signature.offset, signature.magic, static_cast<size_t>(signature.length)) == 0) {
+            m_fileType = signature.fileType;
+            break;
+        }
+    if (m_fileType == ftUnknown && m_header.left(maxPDFHeaderOffset).contains("%PDF-"))
+        m_fileType = ftPDF;
+
+    switch (m_fileType) {
+    case ftZIP: {
+        /// OpenDocument files start with an uncompressed member 'mimetype'
+        /// holding the document's mimetype, see ODF 1.2, Part 3, Section 3.3
+        const uchar *localHeader = reinterpret_cast<const uchar *>(m_header.constData());
+        if (m_header.size() >= 38 && m_header.mid(30, 8) == "mimetype" && qFromLittleEndian<quint16>(localHeader + 8) == 0 /** stored */ && qFromLittleEndian<quint16>(localHeader + 26) == 8) {
+            const int offset = 30 + 8 + qFromLittleEndian<quint16>(localHeader + 28);
+            const QByteArray mimetype = m_header.mid(offset, static_cast<int>(qMin<quint32>(qFromLittleEndian<quint32>(localHeader + 18), 256)));
+            if (mimetype.startsWith("application/vnd.oasis.opendocument.")) {
+                m_fileType = ftODF;
+                m_mimetype = QString::fromLatin1(mimetype);
+            }
+        }
+        /// OfficeOpenXML files have a member '[Content_Types].xml' and
+        /// parts in a directory named after the document type,
+        /// both usually found among the first local headers
+        if (m_fileType == ftZIP && m_header.contains("[Content_Types].xml")) {
+            m_fileType = ftOpenXML;
+            if (m_header.contains("word/"))
+                m_mimetype = QStringLiteral("application/vnd.openxmlformats-officedocument.wordprocessingml.document");
+            else if (m_header.contains("ppt/"))
+                m_mimetype = QStringLiteral("application/vnd.openxmlformats-officedocument.presentationml.presentation");
+            else if (m_header.contains("xl/"))
+                m_mimetype = QStringLiteral("application/vnd.openxmlformats-officedocument.spreadsheetml.sheet");
+        }
+        /// Otherwise, trust filename for office documents only
+        if (m_fileType == ftZIP && hasExtension(filename, odfExtensions))
+            m_fileType = ftODF;
+        else if (m_fileType == ftZIP && hasExtension(filename, openXMLExtensions))
+            m_fileType = ftOpenXML;
+        if (m_mimetype.isEmpty() && m_fileType != ftZIP)
+            m_mimetype = officeMimetypeForFilename(filename);
+        break;
+    }
+    case ftGzip: {
+        m_compression = ftGzip;
+        /// Tar headers are small enough to be found in the compressed header
+        const QByteArray uncompressed = gunzipHead(m_header, 512);
+        if ((uncompressed.size() >= 262 && uncompressed.mid(257, 5) == "ustar") || hasExtension(filename, compressedTarExtensions))
+            m_fileType = ftTar;
+        break;
+    }
+    case ftXz:
+    case ftBzip2:
+        m_compression = m_fileType;
+        if (hasExtension(filename, compressedTarExtensions))
+            m_fileType = ftTar;
+        break;
+    case ftUnknown:
+        /// lzma streams lack a reliable magic number
+        if (filename.endsWith(QStringLiteral(".lzma")) || filename.endsWith(QStringLiteral(".tlz"))) {
+            m_compression = ftLzma;
+            m_fileType = hasExtension(filename, compressedTarExtensions) ? ftTar : ftLzma;
+        }
+        break;
+    default:
+        break;
+    }
+
+    if (m_mimetype.isEmpty())
+        switch (m_fileType) {
+        case ftPDF: m_mimetype = QStringLiteral("application/pdf"); break;
+        case ftJPEG: m_mimetype = QStringLiteral("image/jpeg"); break;
+        case ftJP2: m_mimetype = QStringLiteral("image/jp2"); break;
+        case ftTIFF: m_mimetype = QStringLiteral("image/tiff"); break;
+        case ftPNG: m_mimetype = QStringLiteral("image/png"); break;
+        case ftZIP: m_mimetype = QStringLiteral("application/zip"); break;
+        case ftODF: m_mimetype = QStringLiteral("application/vnd.oasis.opendocument.text"); break;
+        case ftOpenXML: m_mimetype = QStringLiteral("application/vnd.openxmlformats-officedocument.wordprocessingml.document"); break;
+        case ftCompoundBinary: m_mimetype = QStringLiteral("application/x-ole-storage"); break;
+        case ftTar: m_mimetype = QStringLiteral("application/x-tar"); break;
+        case ftGzip: m_mimetype = QStringLiteral("application/gzip"); break;
+        case ftXz: m_mimetype = QStringLiteral("application/x-xz"); break;
+        case ftBzip2: m_mimetype = QStringLiteral("application/x-bzip2"); break;
+        case ftLzma: m_mimetype = QStringLiteral("application/x-lzma"); break;
+        default: break;
+        }
+}
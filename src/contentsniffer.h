@@ -0,0 +1,90 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef CONTENTSNIFFER_H
+#define CONTENTSNIFFER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Recognizes a file's type by signatures in its leading bytes,
+ * regardless of the file's name. Names only serve as fallback
+ * where data is inconclusive, e.g. for lzma-compressed files or
+ * ZIP archives not starting with a characteristic member.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class ContentSniffer
+{
+public:
+    enum FileType {ftUnknown = 0, ftPDF, ftJPEG, ftJP2, ftTIFF, ftPNG, ftZIP, ftODF, ftOpenXML, ftCompoundBinary, ftTar, ftGzip, ftXz, ftBzip2, ftLzma};
+
+    /// Number of leading bytes read to recognize a file's type
+    static const int headerSize;
+
+    /**
+     * Read a file's leading bytes once and recognize its type.
+     *
+     * @param filename file to recognize
+     */
+    explicit ContentSniffer(const QString &filename);
+
+    /**
+     * Recognize type of data already in memory.
+     *
+     * @param header leading bytes of data, ideally @see headerSize many
+     * @param filename name of data's origin, used only as fallback
+     */
+    explicit ContentSniffer(const QByteArray &header, const QString &filename = QString());
+
+    /**
+     * Type of a file's content. For compressed files known to
+     * contain a tar archive, this is ftTar, for other compressed
+     * files this is the compression like ftGzip.
+     */
+    FileType fileType() const;
+
+    /// Compression like ftGzip, or ftUnknown for uncompressed data
+    FileType compression() const;
+
+    QString mimetype() const;
+
+    /// Leading bytes as read from file
+    const QByteArray &header() const;
+
+    /**
+     * Filename extensions used for this file type, like '.tif'
+     * and '.tiff', to be matched against file filters.
+     */
+    QStringList extensions() const;
+
+private:
+    QByteArray m_header;
+    FileType m_fileType, m_compression;
+    QString m_mimetype;
+
+    void sniff(const QString &filename);
+};
+
+#endif // CONTENTSNIFFER_H
@@ -30,34 +30,44 @@
 #include <QTextStream>
 #include <QFile>
 #include <QCryptographicHash>
+#include <QTemporaryFile>
+#include <QMutex>
+#include <QMutexLocker>
 
 #include "guessing.h"
 #include "general.h"
+#include "latencymetrics.h"
+#include "toolregistry.h"
 
 FileAnalyzerAbstract::FileAnalyzerAbstract(QObject *parent)
-    : QObject(parent), textExtraction(teNone)
+    : QObject(parent), textExtraction(teNone), textExtractionMaxPages(0), textExtractionMaxCharacters(0), latencyMetrics(nullptr)
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
-
-    const QSet<QString> stringSet = getAspellLanguages();
-    QString allLanguages;
-    for (const QString &lang : stringSet) {
-        if (!allLanguages.isEmpty())
-            allLanguages.append(QStringLiteral(","));
-        allLanguages.append(lang);
-    }
-    // FIXME reporting does not work yet, as signals are not yet set up
-    emit analysisReport(objectName(), QString(QStringLiteral("<initialization source=\"aspell\" type=\"languages\">%1</initialization>\n").arg(allLanguages)));
+    /// Aspell languages are determined only once needed, see guessLanguage
 }
 
 void FileAnalyzerAbstract::setTextExtraction(TextExtraction textExtraction) {
     this->textExtraction = textExtraction;
 }
 
+void FileAnalyzerAbstract::setTextExtractionLimits(int maxPages, int maxCharacters) {
+    textExtractionMaxPages = maxPages;
+    textExtractionMaxCharacters = maxCharacters;
+}
+
 void FileAnalyzerAbstract::setAnalyzeEmbeddedFiles(bool enableEmbeddedFilesAnalysis) {
     this->enableEmbeddedFilesAnalysis = enableEmbeddedFilesAnalysis;
 }
 
+void FileAnalyzerAbstract::setLatencyMetrics(LatencyMetrics *latencyMetrics) {
+    this->latencyMetrics = latencyMetrics;
+}
+
+void FileAnalyzerAbstract::recordLatency(const QString &stage, qint64 nanoseconds) {
+    if (latencyMetrics != nullptr)
+        latencyMetrics->record(objectName(), stage, nanoseconds);
+}
+
 QStringList FileAnalyzerAbstract::runAspell(const QString &text, const QString &dictionary) const
 {
     QStringList wordList;
@@ -101,28 +111,21 @@ QString FileAnalyzerAbstract::guessLanguage(const QString &text) const
 }
 
 void FileAnalyzerAbstract::delayedToolcheck() {
-    QProcess javaprocess(this);
-    const QStringList javaarguments = QStringList() << QStringLiteral("-version");
-    QByteArray javaStandardError;
-    connect(&javaprocess, &QProcess::readyReadStandardError, [&javaprocess, &javaStandardError]() {
-        const QByteArray d(javaprocess.readAllStandardError());
-        javaStandardError.append(d);
-    });
-    javaprocess.start(QStringLiteral("java"), javaarguments, QIODevice::ReadOnly);
-    if (!javaprocess.waitForStarted(10000) || !javaprocess.waitForFinished(10000)) {
-        const QString stderr = QString::fromLocal8Bit(javaStandardError).trimmed();
-        const QString report = QString(QStringLiteral("<toolcheck name=\"java\" status=\"error\" exitcode=\"%1\"><error>%2</error></toolcheck>\n")).arg(javaprocess.exitCode()).arg(DocScan::xmlify(stderr));
+    /// Java gets probed only once per run, no matter how many analyzers ask
+    const ToolRegistry::Tool java = ToolRegistry::instance().probe(QStringLiteral("java"));
+    const QString &stderr = java.output;
+    if (!java.found) {
+        const QString report = QString(QStringLiteral("<toolcheck name=\"java\" status=\"error\" exitcode=\"%1\"><error>%2</error></toolcheck>\n")).arg(java.exitCode).arg(DocScan::xmlify(stderr));
         emit analysisReport(objectName(), report);
     } else {
-        const QString stderr = QString::fromLocal8Bit(javaStandardError).trimmed();
         const int p1 = stderr.indexOf(QStringLiteral("Environment (build"));
         const int p2 = p1 > 5 ? stderr.indexOf(QLatin1Char(')'), p1 + 20) : -1;
         if (p1 > 5 && p2 > p1) {
             const QString versionNumber = stderr.mid(p1 + 19, p2 - p1 - 19);
-            const QString report = QString(QStringLiteral("<toolcheck name=\"java\" status=\"ok\" exitcode=\"%1\" version=\"%2\"><output>%3</output></toolcheck>\n")).arg(javaprocess.exitCode()).arg(versionNumber).arg(DocScan::xmlify(stderr));
+            const QString report = QString(QStringLiteral("<toolcheck name=\"java\" status=\"ok\" exitcode=\"%1\" version=\"%2\"><output>%3</output></toolcheck>\n")).arg(java.exitCode).arg(versionNumber).arg(DocScan::xmlify(stderr));
             emit analysisReport(objectName(), report);
         } else {
-            const QString report = QString(QStringLiteral("<toolcheck name=\"java\" status=\"error\" exitcode=\"%1\"><error>Could not determine version number</error></toolcheck>\n")).arg(javaprocess.exitCode());
+            const QString report = QString(QStringLiteral("<toolcheck name=\"java\" status=\"error\" exitcode=\"%1\"><error>Could not determine version number</error></toolcheck>\n")).arg(java.exitCode);
             emit analysisReport(objectName(), report);
         }
     }
@@ -130,9 +133,15 @@ void FileAnalyzerAbstract::delayedToolcheck() {
 
 QSet<QString> FileAnalyzerAbstract::getAspellLanguages() const
 {
-    if (aspellLanguages.isEmpty()) {
+    /// Run aspell only once, even if it reports no languages or is not installed.
+    /// Analyzers may ask concurrently from different threads
+    static QMutex aspellMutex;
+    static bool aspellProbed = false;
+    QMutexLocker locker(&aspellMutex);
+    if (!aspellProbed) {
+        aspellProbed = true;
         QRegExp language(QStringLiteral("^[a-z]{2}(_[A-Z]{2})?$"));
-        QProcess aspell(qApp);
+        QProcess aspell; ///< no parent, as caller may not run in main thread
         const QStringList args = QStringList() << QStringLiteral("dicts");
         aspell.start(QStringLiteral("/usr/bin/aspell"), args);
         if (aspell.waitForStarted(10000)) {
@@ -207,6 +216,46 @@ QString FileAnalyzerAbstract::dataToTemporaryFile(const QByteArray &data, const
         return QString();
 }
 
+QString FileAnalyzerAbstract::deviceToTemporaryFile(QIODevice &device, const QString &mimetype, qint64 maxSize, bool *sizeExceeded) {
+    static const qint64 chunkSize = 1 << 20;
+
+    if (sizeExceeded != nullptr) *sizeExceeded = false;
+
+    /// File name depends on data's MD5 sum, which is only known once all data is copied
+    QTemporaryFile temporaryFile(QStringLiteral("/tmp/docscan-embeddedfile-XXXXXX"));
+    if (!temporaryFile.open())
+        return QString();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    qint64 totalSize = 0;
+    QByteArray chunk;
+    while (!(chunk = device.read(chunkSize)).isEmpty()) {
+        totalSize += chunk.size();
+        if (maxSize > 0 && totalSize > maxSize) {
+            if (sizeExceeded != nullptr) *sizeExceeded = true;
+            return QString(); ///< temporary file gets removed automatically
+        }
+        hash.addData(chunk);
+        if (temporaryFile.write(chunk) != chunk.size())
+            return QString();
+    }
+
+    const QString temporaryFilename = QStringLiteral("/tmp/docscan-embeddedfile-") + hash.result().toHex() + DocScan::extensionForMimetype(mimetype);
+    QFile::remove(temporaryFilename); ///< identical data may have been written before
+    if (!temporaryFile.rename(temporaryFilename))
+        return QString();
+    temporaryFile.setAutoRemove(false);
+    return temporaryFilename;
+}
+
+QJsonObject FileAnalyzerAbstract::errorRecord(const QString &filename, const QString &message) {
+    QJsonObject record;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("status"), QStringLiteral("error"));
+    if (!message.isEmpty())
+        record.insert(QStringLiteral("message"), message);
+    return record;
+}
+
 QSet<QString> FileAnalyzerAbstract::aspellLanguages;
 
 const QRegExp FileAnalyzerAbstract::microsoftToolRegExp(QStringLiteral("^(Microsoft\\s(.+\\S) [ -][ ]?(\\S.*)$"));
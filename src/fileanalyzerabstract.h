@@ -26,10 +26,13 @@
 #include <QObject>
 #include <QHash>
 #include <QSet>
+#include <QJsonObject>
 
 #include "watchable.h"
 
 class QDate;
+class QIODevice;
+class LatencyMetrics;
 
 /**
  * Common class for file analyzing classes.
@@ -47,14 +50,38 @@ public:
     explicit FileAnalyzerAbstract(QObject *parent = nullptr);
 
     virtual void setTextExtraction(TextExtraction textExtraction);
+
+    /**
+     * Limit how much text gets extracted per document.
+     * Text beyond those limits will neither be counted nor stored.
+     *
+     * @param maxPages extract text only from the first this many pages, 0 for no limit
+     * @param maxCharacters extract at most this many characters, 0 for no limit
+     */
+    virtual void setTextExtractionLimits(int maxPages, int maxCharacters);
     virtual void setAnalyzeEmbeddedFiles(bool enableEmbeddedFilesAnalysis);
 
+    /**
+     * Set object to record durations of analysis stages in.
+     *
+     * @param latencyMetrics metrics object, or nullptr to disable recording
+     */
+    virtual void setLatencyMetrics(LatencyMetrics *latencyMetrics);
+
 signals:
     /**
      * Reporting findings of analysis
      */
     void analysisReport(QString, QString);
 
+    /**
+     * Reporting findings of analysis as a structured record with typed
+     * fields, one record per analyzed file. Complements the XML report
+     * sent via analysisReport and is meant for machine processing,
+     * e.g. to be written as NDJSON.
+     */
+    void analysisRecord(QString, QJsonObject);
+
     void foundEmbeddedFile(QString);
 
 public slots:
@@ -73,7 +100,9 @@ protected:
     static const QRegExp microsoftToolRegExp;
 
     TextExtraction textExtraction;
+    int textExtractionMaxPages, textExtractionMaxCharacters;
     bool enableEmbeddedFilesAnalysis;
+    LatencyMetrics *latencyMetrics;
 
     QString guessLanguage(const QString &text) const;
     QStringList runAspell(const QString &text, const QString &dictionary) const;
@@ -81,6 +110,36 @@ protected:
     QString evaluatePaperSize(int mmw, int mmh) const;
     QString dataToTemporaryFile(const QByteArray &data, const QString &mimetype);
 
+    /**
+     * Like @see dataToTemporaryFile, but copies data from a device
+     * in chunks, so that large files never get loaded into memory.
+     *
+     * @param device open device to read data from
+     * @param mimetype mime type determining the temporary file's extension
+     * @param maxSize maximum number of bytes to copy, 0 for no limit
+     * @param sizeExceeded if not null, set to true if device provided more than maxSize bytes
+     * @return temporary file's name, empty on failure or if size limit got exceeded
+     */
+    QString deviceToTemporaryFile(QIODevice &device, const QString &mimetype, qint64 maxSize = 0, bool *sizeExceeded = nullptr);
+
+    /**
+     * Create a structured record for a file whose analysis failed.
+     *
+     * @param filename name of the file that was to be analyzed
+     * @param message short error message as used in the XML report
+     * @return record to be sent via analysisRecord
+     */
+    static QJsonObject errorRecord(const QString &filename, const QString &message);
+
+    /**
+     * Record the duration of an analysis stage, if latency metrics
+     * have been set for this analyzer.
+     *
+     * @param stage name of stage, e.g. 'poppleropen'
+     * @param nanoseconds duration as measured by a QElapsedTimer
+     */
+    void recordLatency(const QString &stage, qint64 nanoseconds);
+
 protected slots:
     virtual void delayedToolcheck();
 
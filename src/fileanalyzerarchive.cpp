@@ -0,0 +1,68 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "fileanalyzerarchive.h"
+
+/// Archives nested into each other get analyzed by nested calls
+/// within the same thread, no matter which analyzer handles which archive
+static thread_local int nestingDepth = 0;
+
+FileAnalyzerArchive::FileAnalyzerArchive(QObject *parent)
+    : FileAnalyzerAbstract(parent), m_activeArchives(0)
+{
+    /// nothing
+}
+
+bool FileAnalyzerArchive::isAlive()
+{
+    return m_activeArchives > 0;
+}
+
+void FileAnalyzerArchive::setFilters(const QStringList &filters) {
+    m_filters.clear();
+    for (const QString &filter : filters)
+        m_filters.append(QRegExp(filter, Qt::CaseInsensitive, QRegExp::Wildcard));
+}
+
+int FileAnalyzerArchive::enterArchive() {
+    ++m_activeArchives;
+    return ++nestingDepth;
+}
+
+void FileAnalyzerArchive::leaveArchive() {
+    --m_activeArchives;
+    --nestingDepth;
+}
+
+bool FileAnalyzerArchive::filtersMatch(const QString &filename, const QStringList &contentExtensions) const {
+    if (m_filters.isEmpty()) return true;
+
+    const QString baseName = filename.mid(filename.lastIndexOf(QLatin1Char('/')) + 1);
+    for (const QRegExp &filter : m_filters) {
+        if (filter.exactMatch(baseName))
+            return true;
+        for (const QString &extension : contentExtensions)
+            if (filter.exactMatch(QStringLiteral("member") + extension))
+                return true;
+    }
+    return false;
+}
@@ -0,0 +1,78 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef FILEANALYZERARCHIVE_H
+#define FILEANALYZERARCHIVE_H
+
+#include <QList>
+#include <QRegExp>
+
+#include "fileanalyzerabstract.h"
+
+/**
+ * Common base of analyzers for archives like ZIP or tar files,
+ * which hand on their members for analysis.
+ * Archives may be nested into each other in any combination,
+ * e.g. a ZIP file inside a tar file inside a ZIP file, so the
+ * nesting depth is counted across all archive analyzers.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class FileAnalyzerArchive : public FileAnalyzerAbstract
+{
+    Q_OBJECT
+public:
+    explicit FileAnalyzerArchive(QObject *parent = nullptr);
+
+    virtual bool isAlive() override;
+
+    /**
+     * Only members whose names or leading bytes match one of those
+     * filename patterns (e.g. '*.pdf') get extracted for analysis.
+     * With no filters set, all members are extracted.
+     */
+    void setFilters(const QStringList &filters);
+
+protected:
+    /**
+     * To be called when starting to analyze an archive.
+     *
+     * @return number of archives currently being analyzed by any archive analyzer in this thread, including this one
+     */
+    int enterArchive();
+
+    /// To be called when done analyzing an archive
+    void leaveArchive();
+
+    /**
+     * Check if either a member's name or, for a member recognized by its
+     * content, any extension typical for this content matches the filters.
+     */
+    bool filtersMatch(const QString &filename, const QStringList &contentExtensions) const;
+
+private:
+    QList<QRegExp> m_filters;
+    /// Number of archives currently being analyzed by this analyzer
+    int m_activeArchives;
+};
+
+#endif // FILEANALYZERARCHIVE_H
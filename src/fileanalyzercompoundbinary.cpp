@@ -245,6 +245,7 @@ void FileAnalyzerCompoundBinary::analyzeFile(const QString &filename)
 
     if (isRTFfile(filename)) {
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"RTF file disguising as DOC\" status=\"error\" />\n")).arg(filename));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("RTF file disguising as DOC")));
         m_isAlive = false;
         return;
     }
@@ -255,6 +256,7 @@ void FileAnalyzerCompoundBinary::analyzeFile(const QString &filename)
     wvWare::OLEStorage storage(cppFilename);
     if (!storage.open(wvWare::OLEStorage::ReadOnly)) {
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"OLEStorage cannot be opened\" status=\"error\" />\n")).arg(filename));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("OLEStorage cannot be opened")));
         m_isAlive = false;
         return;
     }
@@ -262,6 +264,7 @@ void FileAnalyzerCompoundBinary::analyzeFile(const QString &filename)
     if (document == nullptr || !document->isValid()) {
         if (document != nullptr)  delete document;
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"Not a valid Word document\" status=\"error\" />\n")).arg(filename));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("Not a valid Word document")));
         m_isAlive = false;
         return;
     }
@@ -342,6 +345,17 @@ void FileAnalyzerCompoundBinary::analyzeFile(const QString &filename)
 
     emit analysisReport(objectName(), logText);
 
+    QJsonObject record;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+    record.insert(QStringLiteral("mimetype"), mimetype);
+    record.insert(QStringLiteral("version"), result.versionText);
+    record.insert(QStringLiteral("size"), QFileInfo(filename).size());
+    if (result.pageCount > 0)
+        record.insert(QStringLiteral("numpages"), result.pageCount);
+    record.insert(QStringLiteral("textlength"), result.plainText.length());
+    emit analysisRecord(objectName(), record);
+
     m_isAlive = false;
 }
 
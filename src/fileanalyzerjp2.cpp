@@ -23,25 +23,19 @@
 #include "fileanalyzerjp2.h"
 
 #include <QDebug>
-#include <QRegularExpression>
-#include <QRegularExpressionMatchIterator>
 
 #include "general.h"
-
-static const int oneMinuteInMillisec = 60000;
-static const int twoMinutesInMillisec = oneMinuteInMillisec * 2;
-static const int fourMinutesInMillisec = oneMinuteInMillisec * 4;
-static const int sixMinutesInMillisec = oneMinuteInMillisec * 6;
+#include "jp2parser.h"
 
 FileAnalyzerJP2::FileAnalyzerJP2(QObject *parent)
-    : FileAnalyzerAbstract(parent)
+    : FileAnalyzerAbstract(parent), m_isAlive(false), m_runJhove(false)
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
 }
 
 bool FileAnalyzerJP2::isAlive()
 {
-    return false; // TODO
+    return m_isAlive;
 }
 
 void FileAnalyzerJP2::setupJhove(const QString &shellscript) {
@@ -53,90 +47,72 @@ void FileAnalyzerJP2::setupJhove(const QString &shellscript) {
     }
 }
 
+void FileAnalyzerJP2::setJhoveValidation(bool runJhove) {
+    m_runJhove = runJhove;
+}
+
 void FileAnalyzerJP2::analyzeFile(const QString &filename)
 {
-    // TODO code de-duplication with FileAnalyzerJPEG
-
-    QProcess *jhoveProcess = launchJHove(this, JHoveJPEG2000, filename);
-    QByteArray jhoveStandardOutputData, jhoveStandardErrorData;
-    connect(jhoveProcess, &QProcess::readyReadStandardOutput, [jhoveProcess, &jhoveStandardOutputData]() {
-        const QByteArray d(jhoveProcess->readAllStandardOutput());
-        jhoveStandardOutputData.append(d);
-    });
-    connect(jhoveProcess, &QProcess::readyReadStandardError, [jhoveProcess, &jhoveStandardErrorData]() {
-        const QByteArray d(jhoveProcess->readAllStandardError());
-        jhoveStandardErrorData.append(d);
-    });
-    const bool jhoveStarted = jhoveProcess != nullptr && jhoveProcess->waitForStarted(oneMinuteInMillisec);
-    if (jhoveProcess != nullptr && !jhoveStarted)
-        qWarning() << "Failed to start jhove for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
-
-    // TODO add more tests there while JHove is running
-
-    int jhoveExitCode = INT_MIN;
-    bool jhoveIsJPEG2000 = false;
-    bool jhoveIsWellformedAndValid = false;
-    int jhoveImageWidth = INT_MIN, jhoveImageHeight = INT_MIN, jhoveFilesize = INT_MIN;
-    QString jhoveErrorMessage;
-    QString jhoveStandardOutput;
-    QString jhoveErrorOutput;
-    if (jhoveStarted) {
-        if (!jhoveProcess->waitForFinished(fourMinutesInMillisec))
-            qWarning() << "Waiting for jHove failed or exceeded time limit for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
-        jhoveExitCode = jhoveProcess->exitCode();
-        jhoveStandardOutput = QString::fromUtf8(jhoveStandardOutputData);
-        jhoveErrorOutput = QString::fromUtf8(jhoveStandardErrorData);
-        if (jhoveExitCode == 0 && !jhoveStandardOutput.isEmpty()) {
-            jhoveIsJPEG2000 = jhoveStandardOutput.contains(QStringLiteral(" MIMEtype: image/jp2"));
-            jhoveIsWellformedAndValid = jhoveStandardOutput.contains(QStringLiteral(" Status: Well-Formed and valid"));
-            static const QRegularExpression imageSizeRegExp(QStringLiteral(" (X|Y)Size: ([1-9][0-9]*)"));
-            QRegularExpressionMatchIterator itImageSize = imageSizeRegExp.globalMatch(jhoveStandardOutput);
-            while (itImageSize.hasNext()) {
-                const QRegularExpressionMatch match = itImageSize.next();
-                bool ok = false;
-                if (match.captured(1) == QStringLiteral("X")) {
-                    jhoveImageWidth = match.captured(2).toInt(&ok);
-                    if (!ok) jhoveImageWidth = INT_MIN;
-                } else if (match.captured(1) == QStringLiteral("Y")) {
-                    jhoveImageHeight = match.captured(2).toInt(&ok);
-                    if (!ok) jhoveImageHeight = INT_MIN;
-                }
-            }
-            static const QRegularExpression fileSizeRegExp(QStringLiteral(" Size: ([1-9][0-9]*)"));
-            const QRegularExpressionMatch fileSizeMatch = fileSizeRegExp.match(jhoveStandardOutput);
-            if (fileSizeMatch.hasMatch()) {
-                bool ok = false;
-                jhoveFilesize = fileSizeMatch.captured(1).toInt(&ok);
-                if (!ok) jhoveFilesize = INT_MIN;
-            }
-            static const QRegularExpression errorMessageRegExp(QStringLiteral(" ErrorMessage: (.*?)"));
-            const QRegularExpressionMatch errorMessageMatch = errorMessageRegExp.match(jhoveStandardOutput);
-            if (errorMessageMatch.hasMatch())
-                jhoveErrorMessage = errorMessageMatch.captured(1);
-        } else
-            qWarning() << "Execution of jHove failed for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory() << ": " << jhoveErrorOutput;
+    m_isAlive = true;
+
+    JP2Parser parser(filename);
+    if (!parser.parse()) {
+        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"%2\" status=\"error\" />\n")).arg(DocScan::xmlify(filename), DocScan::xmlify(parser.errorMessage())));
+        emit analysisRecord(objectName(), errorRecord(filename, parser.errorMessage()));
+        m_isAlive = false;
+        return;
     }
 
-    if (!jhoveStarted)
-        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"jhove-not-started\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
-    else {
-        QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename));
-        report.append(QString(QStringLiteral("<jhove exitcode=\"%1\" jpeg2000=\"%2\" wellformedandvalid=\"%3\">\n")).arg(QString::number(jhoveExitCode), jhoveIsJPEG2000 ? QStringLiteral("yes") : QStringLiteral("no"), jhoveIsWellformedAndValid ? QStringLiteral("yes") : QStringLiteral("no")));
-
-        if (jhoveIsJPEG2000 && jhoveImageWidth > INT_MIN && jhoveImageHeight > INT_MIN && jhoveFilesize > INT_MIN) {
-            report.append(QStringLiteral("<meta>\n"));
-            report.append(QString(QStringLiteral("<rect width=\"%1\" height=\"%2\" />\n")).arg(jhoveImageWidth).arg(jhoveImageHeight));
-            report.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(jhoveFilesize));
-            report.append(QStringLiteral("</meta>\n"));
-        }
-
-        if (!jhoveErrorMessage.isEmpty())
-            report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhoveErrorMessage)));
-        if (!jhoveErrorOutput.isEmpty())
-            report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhoveErrorOutput)));
-
-        report.append(QStringLiteral("</jhove>\n"));
-        report.append(QStringLiteral("</fileanalysis>"));
-        emit analysisReport(objectName(), report);
+    QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename));
+    report.append(QString(QStringLiteral("<jpeg2000 wellformed=\"%1\" rawcodestream=\"%2\" brand=\"%3\" components=\"%4\" bitspercomponent=\"%5\" colourspace=\"%6\" iccprofile=\"%7\" xmlboxes=\"%8\" xmp=\"%9\"")).arg(parser.isWellFormed() ? QStringLiteral("yes") : QStringLiteral("no"), parser.isRawCodestream() ? QStringLiteral("yes") : QStringLiteral("no"), DocScan::xmlify(parser.brand().trimmed()), QString::number(parser.numComponents()), QString::number(parser.bitsPerComponent()), QString::number(parser.colourSpace()), parser.hasICCProfile() ? QStringLiteral("yes") : QStringLiteral("no"), QString::number(parser.numXMLBoxes()), parser.hasXMP() ? QStringLiteral("yes") : QStringLiteral("no")));
+    report.append(QString(QStringLiteral(" resolutionlevels=\"%1\" qualitylayers=\"%2\" lossless=\"%3\" progressionorder=\"%4\" />\n")).arg(QString::number(parser.numResolutionLevels()), QString::number(parser.numQualityLayers()), parser.isLossless() ? QStringLiteral("yes") : QStringLiteral("no"), parser.progressionOrder()));
+    report.append(QStringLiteral("<meta>\n"));
+    if (parser.creationDate().isValid())
+        report.append(DocScan::formatDateTime(parser.creationDate(), creationDate));
+    if (parser.modificationDate().isValid())
+        report.append(DocScan::formatDateTime(parser.modificationDate(), modificationDate));
+    report.append(QString(QStringLiteral("<rect width=\"%1\" height=\"%2\" />\n")).arg(parser.width()).arg(parser.height()));
+    if (parser.horizontalResolution() > 0.0 && parser.verticalResolution() > 0.0)
+        report.append(QString(QStringLiteral("<resolution unit=\"pixelspermetre\" horizontal=\"%1\" vertical=\"%2\" />\n")).arg(parser.horizontalResolution()).arg(parser.verticalResolution()));
+    report.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(parser.fileSize()));
+    report.append(QStringLiteral("</meta>\n"));
+
+    QJsonObject record;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+    record.insert(QStringLiteral("mimetype"), QStringLiteral("image/jp2"));
+    record.insert(QStringLiteral("width"), parser.width());
+    record.insert(QStringLiteral("height"), parser.height());
+    record.insert(QStringLiteral("size"), parser.fileSize());
+    if (parser.creationDate().isValid())
+        record.insert(QStringLiteral("creationdate"), parser.creationDate().toString(Qt::ISODate));
+    if (parser.modificationDate().isValid())
+        record.insert(QStringLiteral("modificationdate"), parser.modificationDate().toString(Qt::ISODate));
+    QJsonObject jpeg2000Record;
+    jpeg2000Record.insert(QStringLiteral("wellformed"), parser.isWellFormed());
+    jpeg2000Record.insert(QStringLiteral("rawcodestream"), parser.isRawCodestream());
+    jpeg2000Record.insert(QStringLiteral("brand"), parser.brand().trimmed());
+    jpeg2000Record.insert(QStringLiteral("components"), parser.numComponents());
+    jpeg2000Record.insert(QStringLiteral("bitspercomponent"), parser.bitsPerComponent());
+    jpeg2000Record.insert(QStringLiteral("colourspace"), parser.colourSpace());
+    jpeg2000Record.insert(QStringLiteral("iccprofile"), parser.hasICCProfile());
+    jpeg2000Record.insert(QStringLiteral("xmp"), parser.hasXMP());
+    jpeg2000Record.insert(QStringLiteral("resolutionlevels"), parser.numResolutionLevels());
+    jpeg2000Record.insert(QStringLiteral("qualitylayers"), parser.numQualityLayers());
+    jpeg2000Record.insert(QStringLiteral("lossless"), parser.isLossless());
+    if (parser.horizontalResolution() > 0.0 && parser.verticalResolution() > 0.0) {
+        jpeg2000Record.insert(QStringLiteral("horizontalresolution"), parser.horizontalResolution());
+        jpeg2000Record.insert(QStringLiteral("verticalresolution"), parser.verticalResolution());
     }
+    record.insert(QStringLiteral("jpeg2000"), jpeg2000Record);
+
+    QJsonObject validatorsRecord;
+    if (m_runJhove && reportJHove(this, JHoveJPEG2000, filename, QStringLiteral("image/jp2"), QStringLiteral("jpeg2000"), report, validatorsRecord))
+        record.insert(QStringLiteral("validators"), validatorsRecord);
+
+    report.append(QStringLiteral("</fileanalysis>"));
+    emit analysisReport(objectName(), report);
+    emit analysisRecord(objectName(), record);
+
+    m_isAlive = false;
 }
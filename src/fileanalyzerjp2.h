@@ -43,8 +43,20 @@ public:
 
     void setupJhove(const QString &shellscript);
 
+    /**
+     * JPEG 2000 files are analyzed by a built-in parser.
+     * Additionally, jHove can be run on each file.
+     *
+     * @param runJhove true to run jHove as well, if configured
+     */
+    void setJhoveValidation(bool runJhove);
+
 public slots:
     virtual void analyzeFile(const QString &filename) override;
+
+private:
+    bool m_isAlive;
+    bool m_runJhove;
 };
 
 #endif // FILEANALYZERJP2_H
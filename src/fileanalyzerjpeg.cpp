@@ -23,25 +23,19 @@
 #include "fileanalyzerjpeg.h"
 
 #include <QDebug>
-#include <QRegularExpression>
-#include <QRegularExpressionMatchIterator>
 
 #include "general.h"
-
-static const int oneMinuteInMillisec = 60000;
-static const int twoMinutesInMillisec = oneMinuteInMillisec * 2;
-static const int fourMinutesInMillisec = oneMinuteInMillisec * 4;
-static const int sixMinutesInMillisec = oneMinuteInMillisec * 6;
+#include "jpegparser.h"
 
 FileAnalyzerJPEG::FileAnalyzerJPEG(QObject *parent)
-    : FileAnalyzerAbstract(parent)
+    : FileAnalyzerAbstract(parent), m_isAlive(false), m_runJhove(false)
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
 }
 
 bool FileAnalyzerJPEG::isAlive()
 {
-    return false; // TODO
+    return m_isAlive;
 }
 
 void FileAnalyzerJPEG::setupJhove(const QString &shellscript) {
@@ -53,107 +47,63 @@ void FileAnalyzerJPEG::setupJhove(const QString &shellscript) {
     }
 }
 
+void FileAnalyzerJPEG::setJhoveValidation(bool runJhove) {
+    m_runJhove = runJhove;
+}
+
 void FileAnalyzerJPEG::analyzeFile(const QString &filename)
 {
-    // TODO code de-duplication with FileAnalyzerJP2
-
-    QProcess *jhoveProcess = launchJHove(this, JHoveJPEG, filename);
-    QByteArray jhoveStandardOutputData, jhoveStandardErrorData;
-    connect(jhoveProcess, &QProcess::readyReadStandardOutput, [jhoveProcess, &jhoveStandardOutputData]() {
-        const QByteArray d(jhoveProcess->readAllStandardOutput());
-        jhoveStandardOutputData.append(d);
-    });
-    connect(jhoveProcess, &QProcess::readyReadStandardError, [jhoveProcess, &jhoveStandardErrorData]() {
-        const QByteArray d(jhoveProcess->readAllStandardError());
-        jhoveStandardErrorData.append(d);
-    });
-    const bool jhoveStarted = jhoveProcess != nullptr && jhoveProcess->waitForStarted(oneMinuteInMillisec);
-    if (jhoveProcess != nullptr && !jhoveStarted)
-        qWarning() << "Failed to start jhove for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
-
-    // TODO add more tests there while JHove is running
-
-    int jhoveExitCode = INT_MIN;
-    bool jhoveIsJPEG = false;
-    bool jhoveIsWellformedAndValid = false;
-    int jhoveImageWidth = INT_MIN, jhoveImageHeight = INT_MIN, jhoveFilesize = INT_MIN;
-    QString jhoveErrorMessage;
-    QDate jhoveCreationDate, jhoveModificationDate;
-    QString jhoveStandardOutput;
-    QString jhoveErrorOutput;
-    if (jhoveStarted) {
-        if (!jhoveProcess->waitForFinished(fourMinutesInMillisec))
-            qWarning() << "Waiting for jHove failed or exceeded time limit for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
-        jhoveExitCode = jhoveProcess->exitCode();
-        jhoveStandardOutput = QString::fromUtf8(jhoveStandardOutputData);
-        jhoveErrorOutput = QString::fromUtf8(jhoveStandardErrorData);
-        if (jhoveExitCode == 0 && !jhoveStandardOutput.isEmpty()) {
-            jhoveIsJPEG = jhoveStandardOutput.contains(QStringLiteral(" MIMEtype: image/jpeg"));
-            jhoveIsWellformedAndValid = jhoveStandardOutput.contains(QStringLiteral(" Status: Well-Formed and valid"));
-            static const QRegularExpression imageSizeRegExp(QStringLiteral(" Image(Width|Height): ([1-9][0-9]*)"));
-            QRegularExpressionMatchIterator itImageSize = imageSizeRegExp.globalMatch(jhoveStandardOutput);
-            while (itImageSize.hasNext()) {
-                const QRegularExpressionMatch match = itImageSize.next();
-                bool ok = false;
-                if (match.captured(1) == QStringLiteral("Width")) {
-                    jhoveImageWidth = match.captured(2).toInt(&ok);
-                    if (!ok) jhoveImageWidth = INT_MIN;
-                } else if (match.captured(1) == QStringLiteral("Height")) {
-                    jhoveImageHeight = match.captured(2).toInt(&ok);
-                    if (!ok) jhoveImageHeight = INT_MIN;
-                }
-            }
-            static const QRegularExpression fileSizeRegExp(QStringLiteral(" Size: ([1-9][0-9]*)"));
-            const QRegularExpressionMatch fileSizeMatch = fileSizeRegExp.match(jhoveStandardOutput);
-            if (fileSizeMatch.hasMatch()) {
-                bool ok = false;
-                jhoveFilesize = fileSizeMatch.captured(1).toInt(&ok);
-                if (!ok) jhoveFilesize = INT_MIN;
-            }
-            static const QRegularExpression dateRegExp(QStringLiteral(" xmp:(Create|Modify)Date=\"((19[89]|20[012345])[0-9]-[01][0-9]-[0-3][0-9])"));
-            QRegularExpressionMatchIterator itDate = dateRegExp.globalMatch(jhoveStandardOutput);
-            while (itDate.hasNext()) {
-                const QRegularExpressionMatch match = itDate.next();
-                const QDate date = QDate::fromString(match.captured(2), QStringLiteral("yyyy-MM-dd"));
-                if (date.isValid()) {
-                    if (match.captured(1) == QStringLiteral("Create"))
-                        jhoveCreationDate = date;
-                    else if (match.captured(1) == QStringLiteral("Modify"))
-                        jhoveModificationDate = date;
-                }
-            }
-            static const QRegularExpression errorMessageRegExp(QStringLiteral(" ErrorMessage: (.*?)"));
-            const QRegularExpressionMatch errorMessageMatch = errorMessageRegExp.match(jhoveStandardOutput);
-            if (errorMessageMatch.hasMatch())
-                jhoveErrorMessage = errorMessageMatch.captured(1);
-        } else
-            qWarning() << "Execution of jHove failed for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory() << ": " << jhoveErrorOutput;
+    m_isAlive = true;
+
+    JPEGParser parser(filename);
+    if (!parser.parse()) {
+        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"%2\" status=\"error\" />\n")).arg(DocScan::xmlify(filename), DocScan::xmlify(parser.errorMessage())));
+        emit analysisRecord(objectName(), errorRecord(filename, parser.errorMessage()));
+        m_isAlive = false;
+        return;
     }
 
-    if (!jhoveStarted)
-        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"jhove-not-started\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
-    else {
-        QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename));
-        report.append(QString(QStringLiteral("<jhove exitcode=\"%1\" jpeg=\"%2\" wellformedandvalid=\"%3\">\n")).arg(QString::number(jhoveExitCode), jhoveIsJPEG ? QStringLiteral("yes") : QStringLiteral("no"), jhoveIsWellformedAndValid ? QStringLiteral("yes") : QStringLiteral("no")));
-
-        if (jhoveIsJPEG && jhoveImageWidth > INT_MIN && jhoveImageHeight > INT_MIN && jhoveFilesize > INT_MIN) {
-            report.append(QStringLiteral("<meta>\n"));
-            if (jhoveCreationDate.isValid())
-                report.append(DocScan::formatDate(jhoveCreationDate, creationDate));
-            if (jhoveModificationDate.isValid())
-                report.append(DocScan::formatDate(jhoveModificationDate, modificationDate));
-            report.append(QString(QStringLiteral("<rect width=\"%1\" height=\"%2\" />\n")).arg(jhoveImageWidth).arg(jhoveImageHeight));
-            report.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(jhoveFilesize));
-            report.append(QStringLiteral("</meta>\n"));
-        }
-
-        if (!jhoveErrorMessage.isEmpty())
-            report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhoveErrorMessage)));
-        if (!jhoveErrorOutput.isEmpty())
-            report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhoveErrorOutput)));
-
-        report.append(QStringLiteral("</jhove>\n"));
-        report.append(QStringLiteral("</fileanalysis>"));
-        emit analysisReport(objectName(), report);
-    }
+    QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename));
+    report.append(QString(QStringLiteral("<jpeg wellformed=\"%1\" mode=\"%2\" arithmeticcoding=\"%3\" components=\"%4\" bitspersample=\"%5\" jfif=\"%6\" exif=\"%7\" xmp=\"%8\" />\n")).arg(parser.isWellFormed() ? QStringLiteral("yes") : QStringLiteral("no"), JPEGParser::modeToString(parser.mode()), parser.isArithmeticCoding() ? QStringLiteral("yes") : QStringLiteral("no"), QString::number(parser.numComponents()), QString::number(parser.bitsPerSample()), parser.hasJFIF() ? QStringLiteral("yes") : QStringLiteral("no"), parser.hasExif() ? QStringLiteral("yes") : QStringLiteral("no"), parser.hasXMP() ? QStringLiteral("yes") : QStringLiteral("no")));
+    report.append(QStringLiteral("<meta>\n"));
+    if (parser.creationDate().isValid())
+        report.append(DocScan::formatDateTime(parser.creationDate(), creationDate));
+    if (parser.modificationDate().isValid())
+        report.append(DocScan::formatDateTime(parser.modificationDate(), modificationDate));
+    report.append(QString(QStringLiteral("<rect width=\"%1\" height=\"%2\" />\n")).arg(parser.width()).arg(parser.height()));
+    report.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(parser.fileSize()));
+    report.append(QStringLiteral("</meta>\n"));
+
+    QJsonObject record;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+    record.insert(QStringLiteral("mimetype"), QStringLiteral("image/jpeg"));
+    record.insert(QStringLiteral("width"), parser.width());
+    record.insert(QStringLiteral("height"), parser.height());
+    record.insert(QStringLiteral("size"), parser.fileSize());
+    if (parser.creationDate().isValid())
+        record.insert(QStringLiteral("creationdate"), parser.creationDate().toString(Qt::ISODate));
+    if (parser.modificationDate().isValid())
+        record.insert(QStringLiteral("modificationdate"), parser.modificationDate().toString(Qt::ISODate));
+    QJsonObject jpegRecord;
+    jpegRecord.insert(QStringLiteral("wellformed"), parser.isWellFormed());
+    jpegRecord.insert(QStringLiteral("mode"), JPEGParser::modeToString(parser.mode()));
+    jpegRecord.insert(QStringLiteral("arithmeticcoding"), parser.isArithmeticCoding());
+    jpegRecord.insert(QStringLiteral("components"), parser.numComponents());
+    jpegRecord.insert(QStringLiteral("bitspersample"), parser.bitsPerSample());
+    jpegRecord.insert(QStringLiteral("jfif"), parser.hasJFIF());
+    jpegRecord.insert(QStringLiteral("exif"), parser.hasExif());
+    jpegRecord.insert(QStringLiteral("xmp"), parser.hasXMP());
+    record.insert(QStringLiteral("jpeg"), jpegRecord);
+
+    /// Running jHove is optional, the built-in parser already provided the essentials
+    QJsonObject validatorsRecord;
+    if (m_runJhove && reportJHove(this, JHoveJPEG, filename, QStringLiteral("image/jpeg"), QStringLiteral("jpeg"), report, validatorsRecord))
+        record.insert(QStringLiteral("validators"), validatorsRecord);
+
+    report.append(QStringLiteral("</fileanalysis>"));
+    emit analysisReport(objectName(), report);
+    emit analysisRecord(objectName(), record);
+
+    m_isAlive = false;
 }
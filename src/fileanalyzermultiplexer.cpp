@@ -28,6 +28,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QCryptographicHash>
+#include <QJsonDocument>
 
 #include "general.h"
 
@@ -39,30 +40,24 @@ const QStringList FileAnalyzerMultiplexer::defaultFilters = QStringList()
         ;
 
 FileAnalyzerMultiplexer::FileAnalyzerMultiplexer(const QStringList &filters, QObject *parent)
-    : FileAnalyzerAbstract(parent), m_filters(filters)
+    : FileAnalyzerAbstract(parent),
+#ifdef HAVE_QUAZIP5
+      m_fileAnalyzerODF(this), m_fileAnalyzerOpenXML(this), m_fileAnalyzerZIP(this),
+#endif // HAVE_QUAZIP5
+      m_fileAnalyzerPDF(this),
+#ifdef HAVE_WV2
+      m_fileAnalyzerCompoundBinary(this),
+#endif // HAVE_WV2
+      m_fileAnalyzerJPEG(this), m_fileAnalyzerJP2(this), m_fileAnalyzerTIFF(this), m_fileAnalyzerTar(this),
+      m_filters(filters), m_embeddedFileCache(64 << 20), m_replayingCachedAnalysis(false)
 {
     qsrand(QTime::currentTime().msec());
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+    /// Specialized analyzers get created only once a file of their type shows up
 #ifdef HAVE_QUAZIP5
-    connect(&m_fileAnalyzerOpenXML, &FileAnalyzerOpenXML::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerOpenXML, &FileAnalyzerOpenXML::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
-    connect(&m_fileAnalyzerODF, &FileAnalyzerODF::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerODF, &FileAnalyzerODF::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
-    connect(&m_fileAnalyzerZIP, &FileAnalyzerZIP::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerZIP, &FileAnalyzerZIP::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
+    m_fileAnalyzerZIP.setup(&FileAnalyzerZIP::setFilters, m_filters);
 #endif // HAVE_QUAZIP5
-    connect(&m_fileAnalyzerPDF, &FileAnalyzerPDF::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerPDF, &FileAnalyzerPDF::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
-#ifdef HAVE_WV2
-    connect(&m_fileAnalyzerCompoundBinary, &FileAnalyzerCompoundBinary::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerCompoundBinary, &foundEmbeddedFile::analysisReport, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
-#endif // HAVE_WV2
-    connect(&m_fileAnalyzerJPEG, &FileAnalyzerJPEG::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerJPEG, &FileAnalyzerJPEG::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
-    connect(&m_fileAnalyzerJP2, &FileAnalyzerJP2::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerJP2, &FileAnalyzerJP2::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
-    connect(&m_fileAnalyzerTIFF, &FileAnalyzerTIFF::analysisReport, this, &FileAnalyzerMultiplexer::analysisReport);
-    connect(&m_fileAnalyzerTIFF, &FileAnalyzerTIFF::foundEmbeddedFile, this, &FileAnalyzerMultiplexer::foundEmbeddedFile);
+    m_fileAnalyzerTar.setup(&FileAnalyzerTar::setFilters, m_filters);
 }
 
 bool FileAnalyzerMultiplexer::isAlive()
@@ -78,81 +73,160 @@ bool FileAnalyzerMultiplexer::isAlive()
     result |= m_fileAnalyzerJPEG.isAlive();
     result |= m_fileAnalyzerJP2.isAlive();
     result |= m_fileAnalyzerTIFF.isAlive();
+    result |= m_fileAnalyzerTar.isAlive();
     return result;
 }
 
 void FileAnalyzerMultiplexer::setTextExtraction(TextExtraction textExtraction) {
     FileAnalyzerAbstract::setTextExtraction(textExtraction);
 #ifdef HAVE_QUAZIP5
-    m_fileAnalyzerOpenXML.setTextExtraction(textExtraction);
-    m_fileAnalyzerODF.setTextExtraction(textExtraction);
+    m_fileAnalyzerOpenXML.setup(&FileAnalyzerOpenXML::setTextExtraction, textExtraction);
+    m_fileAnalyzerODF.setup(&FileAnalyzerODF::setTextExtraction, textExtraction);
     // m_fileAnalyzerZIP.setTextExtraction(textExtraction); ///< no point in extracting text from a ZIP archive
 #endif // HAVE_QUAZIP5
-    m_fileAnalyzerPDF.setTextExtraction(textExtraction);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setTextExtraction, textExtraction);
 #ifdef HAVE_WV2
-    m_fileAnalyzerCompoundBinary.setTextExtraction(textExtraction);
+    m_fileAnalyzerCompoundBinary.setup(&FileAnalyzerCompoundBinary::setTextExtraction, textExtraction);
+#endif // HAVE_WV2
+}
+
+void FileAnalyzerMultiplexer::setTextExtractionLimits(int maxPages, int maxCharacters) {
+    FileAnalyzerAbstract::setTextExtractionLimits(maxPages, maxCharacters);
+#ifdef HAVE_QUAZIP5
+    m_fileAnalyzerOpenXML.setup(&FileAnalyzerOpenXML::setTextExtractionLimits, maxPages, maxCharacters);
+    m_fileAnalyzerODF.setup(&FileAnalyzerODF::setTextExtractionLimits, maxPages, maxCharacters);
+#endif // HAVE_QUAZIP5
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setTextExtractionLimits, maxPages, maxCharacters);
+#ifdef HAVE_WV2
+    m_fileAnalyzerCompoundBinary.setup(&FileAnalyzerCompoundBinary::setTextExtractionLimits, maxPages, maxCharacters);
 #endif // HAVE_WV2
 }
 
 void FileAnalyzerMultiplexer::setAnalyzeEmbeddedFiles(bool enableEmbeddedFilesAnalysis) {
     FileAnalyzerAbstract::setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis);
 #ifdef HAVE_QUAZIP5
-    m_fileAnalyzerOpenXML.setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis);
-    m_fileAnalyzerODF.setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis);
+    m_fileAnalyzerOpenXML.setup(&FileAnalyzerOpenXML::setAnalyzeEmbeddedFiles, enableEmbeddedFilesAnalysis);
+    m_fileAnalyzerODF.setup(&FileAnalyzerODF::setAnalyzeEmbeddedFiles, enableEmbeddedFilesAnalysis);
     // m_fileAnalyzerZIP.setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis); ///< no point in disabling following embedded files for ZIP archives
 #endif // HAVE_QUAZIP5
-    m_fileAnalyzerPDF.setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setAnalyzeEmbeddedFiles, enableEmbeddedFilesAnalysis);
 #ifdef HAVE_WV2
-    m_fileAnalyzerCompoundBinary.setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis);
+    m_fileAnalyzerCompoundBinary.setup(&FileAnalyzerCompoundBinary::setAnalyzeEmbeddedFiles, enableEmbeddedFilesAnalysis);
 #endif // HAVE_WV2
 }
 
+void FileAnalyzerMultiplexer::setLatencyMetrics(LatencyMetrics *latencyMetrics) {
+    FileAnalyzerAbstract::setLatencyMetrics(latencyMetrics);
+#ifdef HAVE_QUAZIP5
+    m_fileAnalyzerOpenXML.setup(&FileAnalyzerOpenXML::setLatencyMetrics, latencyMetrics);
+    m_fileAnalyzerODF.setup(&FileAnalyzerODF::setLatencyMetrics, latencyMetrics);
+    m_fileAnalyzerZIP.setup(&FileAnalyzerZIP::setLatencyMetrics, latencyMetrics);
+#endif // HAVE_QUAZIP5
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setLatencyMetrics, latencyMetrics);
+#ifdef HAVE_WV2
+    m_fileAnalyzerCompoundBinary.setup(&FileAnalyzerCompoundBinary::setLatencyMetrics, latencyMetrics);
+#endif // HAVE_WV2
+    m_fileAnalyzerJPEG.setup(&FileAnalyzerJPEG::setLatencyMetrics, latencyMetrics);
+    m_fileAnalyzerJP2.setup(&FileAnalyzerJP2::setLatencyMetrics, latencyMetrics);
+    m_fileAnalyzerTIFF.setup(&FileAnalyzerTIFF::setLatencyMetrics, latencyMetrics);
+    m_fileAnalyzerTar.setup(&FileAnalyzerTar::setLatencyMetrics, latencyMetrics);
+}
+
 void FileAnalyzerMultiplexer::setupJhove(const QString &shellscript)
 {
-    m_fileAnalyzerPDF.setupJhove(shellscript);
-    m_fileAnalyzerJPEG.setupJhove(shellscript);
-    m_fileAnalyzerJP2.setupJhove(shellscript);
-    m_fileAnalyzerTIFF.setupJhove(shellscript);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupJhove, shellscript);
+    m_fileAnalyzerJPEG.setup(&FileAnalyzerJPEG::setupJhove, shellscript);
+    m_fileAnalyzerJP2.setup(&FileAnalyzerJP2::setupJhove, shellscript);
+    m_fileAnalyzerTIFF.setup(&FileAnalyzerTIFF::setupJhove, shellscript);
 }
 
 void FileAnalyzerMultiplexer::setupVeraPDF(const QString &cliTool) {
-    m_fileAnalyzerPDF.setupVeraPDF(cliTool);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupVeraPDF, cliTool);
 }
 
 void FileAnalyzerMultiplexer::setupPdfBoXValidator(const QString &pdfboxValidatorJavaClass) {
-    m_fileAnalyzerPDF.setupPdfBoXValidator(pdfboxValidatorJavaClass);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupPdfBoXValidator, pdfboxValidatorJavaClass);
 }
 
 void FileAnalyzerMultiplexer::setupCallasPdfAPilotCLI(const QString &callasPdfAPilotCLI) {
-    m_fileAnalyzerPDF.setupCallasPdfAPilotCLI(callasPdfAPilotCLI);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupCallasPdfAPilotCLI, callasPdfAPilotCLI);
 }
 
 void FileAnalyzerMultiplexer::setupDPFManager(const QString &dpfmangerJFXjar) {
-    m_fileAnalyzerTIFF.setupDPFManager(dpfmangerJFXjar);
+    m_fileAnalyzerTIFF.setup(&FileAnalyzerTIFF::setupDPFManager, dpfmangerJFXjar);
 }
 
 void FileAnalyzerMultiplexer::setupAdobePreflightReportDirectory(const QString &adobePreflightReportDirectory) {
-    m_fileAnalyzerPDF.setupAdobePreflightReportDirectory(adobePreflightReportDirectory);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupAdobePreflightReportDirectory, adobePreflightReportDirectory);
 }
 
 void FileAnalyzerMultiplexer::setupQoppaJPDFPreflightDirectory(const QString &qoppaJPDFPreflightDirectory) {
-    m_fileAnalyzerPDF.setupQoppaJPDFPreflightDirectory(qoppaJPDFPreflightDirectory);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupQoppaJPDFPreflightDirectory, qoppaJPDFPreflightDirectory);
 }
 
 void FileAnalyzerMultiplexer::setupThreeHeightsValidatorShellCLI(const QString &threeHeightsValidatorShellCLI, const QString &threeHeightsValidatorLicenseKey) {
-    m_fileAnalyzerPDF.setupThreeHeightsValidatorShellCLI(threeHeightsValidatorShellCLI, threeHeightsValidatorLicenseKey);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setupThreeHeightsValidatorShellCLI, threeHeightsValidatorShellCLI, threeHeightsValidatorLicenseKey);
 }
 
 void FileAnalyzerMultiplexer::setPDFAValidationOptions(const bool validateOnlyPDFAfiles, const bool downgradeToPDFA1b, const FileAnalyzerPDF::XMPPDFConformance enforcedValidationLevel) {
-    m_fileAnalyzerPDF.setPDFAValidationOptions(validateOnlyPDFAfiles, downgradeToPDFA1b, enforcedValidationLevel);
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setPDFAValidationOptions, validateOnlyPDFAfiles, downgradeToPDFA1b, enforcedValidationLevel);
+}
+
+void FileAnalyzerMultiplexer::setValidatorPolicy(const FileAnalyzerPDF::ValidatorPolicy validatorPolicy, const int quorum) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setValidatorPolicy, validatorPolicy, quorum);
+}
+
+void FileAnalyzerMultiplexer::setParallelPageThreshold(int numPages) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setParallelPageThreshold, numPages);
+}
+
+void FileAnalyzerMultiplexer::setQuickPDFAnalysis(bool quickAnalysis) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setQuickAnalysis, quickAnalysis);
+}
+
+void FileAnalyzerMultiplexer::setPopplerWorkerPool(PopplerWorkerPool *popplerWorkerPool) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setPopplerWorkerPool, popplerWorkerPool);
+}
+
+void FileAnalyzerMultiplexer::setAdaptiveTimeouts(AdaptiveTimeouts *adaptiveTimeouts) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setAdaptiveTimeouts, adaptiveTimeouts);
+}
+
+void FileAnalyzerMultiplexer::setValidatorOutputSummary(bool summarize, int maxFailures) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setValidatorOutputSummary, summarize, maxFailures);
+}
+
+void FileAnalyzerMultiplexer::setEmbeddedImageLimits(int maxImages, int maxImageSize) {
+    m_fileAnalyzerPDF.setup(&FileAnalyzerPDF::setEmbeddedImageLimits, maxImages, maxImageSize);
+}
+
+void FileAnalyzerMultiplexer::setImageJhoveValidation(bool runJhove) {
+    m_fileAnalyzerJPEG.setup(&FileAnalyzerJPEG::setJhoveValidation, runJhove);
+    m_fileAnalyzerJP2.setup(&FileAnalyzerJP2::setJhoveValidation, runJhove);
+    m_fileAnalyzerTIFF.setup(&FileAnalyzerTIFF::setJhoveValidation, runJhove);
+}
+
+void FileAnalyzerMultiplexer::setEmbeddedFileCacheSize(int maxSize) {
+    m_embeddedFileCache.setMaxCost(qMax(0, maxSize));
+}
+
+void FileAnalyzerMultiplexer::setArchiveLimits(bool listOnly, qint64 maxMemberSize, int maxCompressionRatio, int maxMembers, int maxNestingDepth) {
+#ifdef HAVE_QUAZIP5
+    m_fileAnalyzerZIP.setup(&FileAnalyzerZIP::setLimits, listOnly, maxMemberSize, maxCompressionRatio, maxMembers, maxNestingDepth);
+#else // HAVE_QUAZIP5
+    Q_UNUSED(maxCompressionRatio)
+#endif // HAVE_QUAZIP5
+    /// Tar archives store members uncompressed, so no ratio applies
+    m_fileAnalyzerTar.setup(&FileAnalyzerTar::setLimits, listOnly, maxMemberSize, maxMembers, maxNestingDepth);
 }
 
 void FileAnalyzerMultiplexer::uncompressAnalyzefile(const QString &filename, const QString &extensionWithDot, const QString &uncompressTool)
 {
     /// Default prefix for temporary file is a large random number
     const QString randomPrefix = QString::number(qrand());
-    /// Create QFileInfo object to extract the 'basename'
-    const QFileInfo fi(filename.left(filename.length() - extensionWithDot.length()));
+    /// Create QFileInfo object to extract the 'basename',
+    /// files recognized by content may lack the extension
+    const QFileInfo fi(filename.endsWith(extensionWithDot) ? filename.left(filename.length() - extensionWithDot.length()) : filename);
     /// Build temporary filename
     const QString randomTempFilename = QStringLiteral("/tmp/.docscan-") + randomPrefix + QStringLiteral("-") + fi.fileName();
 
@@ -246,7 +320,9 @@ void FileAnalyzerMultiplexer::uncompressAnalyzefile(const QString &filename, con
     }
 
     const QString logText = QString(QStringLiteral("<uncompress status=\"%1\" tool=\"%2\" time=\"%3\">\n<origin size=\"%8\" md5sum=\"%5\">%4</origin>\n<destination size=\"%9\" md5sum=\"%7\">%6</destination>\n</uncompress>")).arg(success ? QStringLiteral("success") : QStringLiteral("error"), DocScan::xmlify(uncompressTool), QString::number(QDateTime::currentMSecsSinceEpoch() - startTime), DocScan::xmlify(filename), QString::fromUtf8(compressedMd5.result().toHex()), DocScan::xmlify(uncompressedFilename), QString::fromUtf8(uncompressedMd5.result().toHex()), QString::number(inputSize), QString::number(outputSize));
-    m_fileAnalyzerPDF.setAliasName(uncompressedFilename, filename);
+    /// Avoid creating the PDF analyzer just to tell it about a file it will not see
+    if (ContentSniffer(uncompressedFilename).fileType() == ContentSniffer::ftPDF)
+        m_fileAnalyzerPDF.get()->setAliasName(uncompressedFilename, filename);
     emit analysisReport(objectName(), logText);
     analyzeFile(uncompressedFilename);
     QFile::remove(uncompressedFilename); ///< Remove uncompressed file after analysis
@@ -254,78 +330,169 @@ void FileAnalyzerMultiplexer::uncompressAnalyzefile(const QString &filename, con
 
 void FileAnalyzerMultiplexer::analyzeFile(const QString &filename)
 {
-#ifdef HAVE_QUAZIP5
-    static const QRegExp odfExtension(QStringLiteral("[.]od[pst]$"));
-    static const QRegExp openXMLExtension(QStringLiteral("[.]((doc|ppt|xls)x)$"));
-    static const QRegExp zipExtension(QStringLiteral("[.](zip)$"));
-#endif // HAVE_QUAZIP5
-#ifdef HAVE_WV2
-    static const QRegExp compoundBinaryExtension(QStringLiteral("[.](doc|ppt|xls)$"));
-#endif // HAVE_WV2
-    static const QRegExp jpegExtension(QStringLiteral("[.](jpeg|jpg|jpe|jfif)$"));
-    static const QRegExp jpeg2000Extension(QStringLiteral("[.](jp2|jpf|jpx)$"));
-    static const QRegExp tiffExtension(QStringLiteral("[.]tiff?$"));
-
     QFileInfo fi(filename);
     qDebug() << "Analyzing file" << filename << "of size " << ((fi.size() + 511) / 1024) << "KiB";
 
-    if (filename.endsWith(QStringLiteral(".xz"))) {
-        uncompressAnalyzefile(filename, QStringLiteral(".xz"), QStringLiteral("unxz"));
-    } else if (filename.endsWith(QStringLiteral(".gz"))) {
+    /// File type is recognized by content, so that misnamed files
+    /// and embedded files with guessed extensions get analyzed correctly
+    const ContentSniffer sniffer(filename);
+    const ContentSniffer::FileType fileType = sniffer.fileType();
+    if (fileType == ContentSniffer::ftUnknown) {
+        qWarning() << "Unsupported filetype for file" << filename;
+        return;
+    }
+
+    /// Compressed files are checked against filters once uncompressed
+    const bool compressed = fileType == ContentSniffer::ftGzip || fileType == ContentSniffer::ftXz || fileType == ContentSniffer::ftBzip2 || fileType == ContentSniffer::ftLzma;
+    if (!compressed && !filtersMatch(sniffer)) {
+        qDebug() << "Skipping unmatched file type" << sniffer.mimetype() << "of file" << filename;
+        return;
+    }
+
+    switch (fileType) {
+    case ContentSniffer::ftGzip:
         uncompressAnalyzefile(filename, QStringLiteral(".gz"), QStringLiteral("gunzip"));
-    } else if (filename.endsWith(QStringLiteral(".bz2"))) {
+        break;
+    case ContentSniffer::ftXz:
+        uncompressAnalyzefile(filename, QStringLiteral(".xz"), QStringLiteral("unxz"));
+        break;
+    case ContentSniffer::ftBzip2:
         uncompressAnalyzefile(filename, QStringLiteral(".bz2"), QStringLiteral("bunzip2"));
-    } else if (filename.endsWith(QStringLiteral(".lzma"))) {
+        break;
+    case ContentSniffer::ftLzma:
         uncompressAnalyzefile(filename, QStringLiteral(".lzma"), QStringLiteral("unlzma"));
-    } else if (filename.endsWith(QStringLiteral(".pdf"))) {
-        if (m_filters.contains(QStringLiteral("*.pdf")))
-            m_fileAnalyzerPDF.analyzeFile(filename);
-        else
-            qDebug() << "Skipping unmatched extension \".pdf\"";
+        break;
+    case ContentSniffer::ftTar:
+        /// Compressed tar archives get uncompressed while being read
+        m_fileAnalyzerTar.get()->analyzeFile(filename);
+        break;
+    case ContentSniffer::ftPDF:
+        m_fileAnalyzerPDF.get()->analyzeFile(filename);
+        break;
 #ifdef HAVE_QUAZIP5
-    } else if (odfExtension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + odfExtension.cap(0)))
-            m_fileAnalyzerODF.analyzeFile(filename);
-        else
-            qDebug() << "Skipping unmatched extension" << odfExtension.cap(0);
-    } else if (openXMLExtension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + openXMLExtension.cap(0)))
-            m_fileAnalyzerOpenXML.analyzeFile(filename);
-        else
-            qDebug() << "Skipping unmatched extension" << openXMLExtension.cap(0);
-    } else if (zipExtension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + zipExtension.cap(0)))
-            m_fileAnalyzerZIP.analyzeFile(filename);
-        else
-            qDebug() << "Skipping unmatched extension" << zipExtension.cap(0);
+    case ContentSniffer::ftODF:
+        m_fileAnalyzerODF.get()->analyzeFile(filename);
+        break;
+    case ContentSniffer::ftOpenXML:
+        m_fileAnalyzerOpenXML.get()->analyzeFile(filename);
+        break;
+    case ContentSniffer::ftZIP:
+        m_fileAnalyzerZIP.get()->analyzeFile(filename);
+        break;
 #endif // HAVE_QUAZIP5
 #ifdef HAVE_WV2
-    } else if (compoundBinaryExtension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + compoundBinaryExtension.cap(0))) {
-            m_fileAnalyzerCompoundBinary.analyzeFile(filename);
-        } else
-            qDebug() << "Skipping unmatched extension" << compoundBinaryExtension.cap(0);
+    case ContentSniffer::ftCompoundBinary:
+        m_fileAnalyzerCompoundBinary.get()->analyzeFile(filename);
+        break;
 #endif // HAVE_WV2
-    } else if (jpegExtension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + jpegExtension.cap(0))) {
-            m_fileAnalyzerJPEG.analyzeFile(filename);
-        } else
-            qDebug() << "Skipping unmatched extension" << jpegExtension.cap(0);
-    } else if (jpeg2000Extension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + jpeg2000Extension.cap(0))) {
-            m_fileAnalyzerJP2.analyzeFile(filename);
-        } else
-            qDebug() << "Skipping unmatched extension" << jpeg2000Extension.cap(0);
-    } else if (tiffExtension.indexIn(filename) >= 0) {
-        if (m_filters.contains(QChar('*') + tiffExtension.cap(0))) {
-            m_fileAnalyzerTIFF.analyzeFile(filename);
-        } else
-            qDebug() << "Skipping unmatched extension" << tiffExtension.cap(0);
-    } else
-        qWarning() << "Unsupported filetype for file" << filename;
+    case ContentSniffer::ftJPEG:
+        m_fileAnalyzerJPEG.get()->analyzeFile(filename);
+        break;
+    case ContentSniffer::ftJP2:
+        m_fileAnalyzerJP2.get()->analyzeFile(filename);
+        break;
+    case ContentSniffer::ftTIFF:
+        m_fileAnalyzerTIFF.get()->analyzeFile(filename);
+        break;
+    default:
+        qWarning() << "Unsupported filetype" << sniffer.mimetype() << "for file" << filename;
+    }
 }
 
 void FileAnalyzerMultiplexer::analyzeTemporaryFile(const QString &filename) {
+    /// Temporary files as written by FileAnalyzerAbstract::dataToTemporaryFile
+    /// are named after their data's MD5 sum, use it and extension as cache key
+    static const QRegExp md5Filename(QStringLiteral("/docscan-embeddedfile-([0-9a-f]{32}[^/]*)$"));
+    const QString cacheKey = m_embeddedFileCache.maxCost() > 0 && md5Filename.indexIn(filename) >= 0 ? md5Filename.cap(1) : QString();
+    if (cacheKey.isEmpty()) {
+        analyzeFile(filename);
+        QFile(filename).remove();
+        return;
+    }
+
+    QSet<QString> visitedCacheKeys;
+    if (isReplayable(cacheKey, visitedCacheKeys)) {
+        qDebug() << "Using cached analysis results for file" << filename;
+        QFile(filename).remove();
+        /// Analyses of enclosing files refer to this file's cache entry
+        /// rather than collecting the replayed results themselves
+        for (CachedAnalysis *collectedAnalysis : const_cast<const QList<CachedAnalysis *> &>(m_collectedAnalyses))
+            collectedAnalysis->embeddedCacheKeys.append(cacheKey);
+        m_replayingCachedAnalysis = true;
+        replayCachedAnalysis(cacheKey);
+        m_replayingCachedAnalysis = false;
+        return;
+    }
+
+    /// Collect everything reported while analyzing this file,
+    /// including reports on files embedded in this file
+    CachedAnalysis *analysis = new CachedAnalysis();
+    int cost = 0;
+    const QMetaObject::Connection reportConnection = connect(this, &FileAnalyzerAbstract::analysisReport, [this, analysis, &cost](const QString &origin, const QString &text) {
+        if (m_replayingCachedAnalysis) return;
+        analysis->reports.append(qMakePair(origin, text));
+        cost += text.size() * static_cast<int>(sizeof(QChar));
+    });
+    const QMetaObject::Connection recordConnection = connect(this, &FileAnalyzerAbstract::analysisRecord, [this, analysis, &cost](const QString &origin, const QJsonObject &record) {
+        if (m_replayingCachedAnalysis) return;
+        analysis->records.append(qMakePair(origin, record));
+        cost += QJsonDocument(record).toJson(QJsonDocument::Compact).size();
+        if (record.value(QStringLiteral("listonly")).toBool())
+            analysis->listOnly = true;
+    });
+    m_collectedAnalyses.append(analysis);
     analyzeFile(filename);
+    m_collectedAnalyses.removeLast();
+    disconnect(reportConnection);
+    disconnect(recordConnection);
     QFile(filename).remove();
+
+    /// An archive's members may have been only listed because of its
+    /// nesting depth, so results do not apply to the same file elsewhere
+    if (analysis->listOnly || (analysis->reports.isEmpty() && analysis->records.isEmpty() && analysis->embeddedCacheKeys.isEmpty()))
+        delete analysis;
+    else {
+        for (const QString &embeddedCacheKey : const_cast<const QStringList &>(analysis->embeddedCacheKeys))
+            cost += embeddedCacheKey.size() * static_cast<int>(sizeof(QChar));
+        m_embeddedFileCache.insert(cacheKey, analysis, qMax(1, cost)); ///< takes ownership, deletes object if too large
+    }
+}
+
+bool FileAnalyzerMultiplexer::isReplayable(const QString &cacheKey, QSet<QString> &visitedCacheKeys) const {
+    /// Visiting a key twice means entries refer to each other in a cycle
+    if (visitedCacheKeys.contains(cacheKey)) return false;
+    visitedCacheKeys.insert(cacheKey);
+
+    const CachedAnalysis *cachedAnalysis = m_embeddedFileCache.object(cacheKey);
+    if (cachedAnalysis == nullptr) return false;
+    for (const QString &embeddedCacheKey : cachedAnalysis->embeddedCacheKeys)
+        if (!isReplayable(embeddedCacheKey, visitedCacheKeys)) return false;
+    return true;
+}
+
+void FileAnalyzerMultiplexer::replayCachedAnalysis(const QString &cacheKey) {
+    const CachedAnalysis *cachedAnalysis = m_embeddedFileCache.object(cacheKey);
+    if (cachedAnalysis == nullptr) return;
+
+    /// Embedded files got analyzed before the file containing them
+    for (const QString &embeddedCacheKey : cachedAnalysis->embeddedCacheKeys)
+        replayCachedAnalysis(embeddedCacheKey);
+    for (const QPair<QString, QString> &report : cachedAnalysis->reports) {
+        QString text = report.second;
+        const int p = text.startsWith(QStringLiteral("<fileanalysis ")) ? text.indexOf(QLatin1Char('>')) : -1;
+        if (p > 0) text.insert(p + 1, QStringLiteral("\n<cached/>"));
+        emit analysisReport(report.first, text);
+    }
+    for (const QPair<QString, QJsonObject> &record : cachedAnalysis->records) {
+        QJsonObject cachedRecord = record.second;
+        cachedRecord.insert(QStringLiteral("cached"), true);
+        emit analysisRecord(record.first, cachedRecord);
+    }
+}
+
+bool FileAnalyzerMultiplexer::filtersMatch(const ContentSniffer &sniffer) const {
+    for (const QString &extension : sniffer.extensions())
+        if (m_filters.contains(QChar('*') + extension))
+            return true;
+    return false;
 }
@@ -23,7 +23,12 @@
 #ifndef FILEANALYZERMULTIPLEXER_H
 #define FILEANALYZERMULTIPLEXER_H
 
+#include <QCache>
+#include <QSet>
+#include <QJsonObject>
+
 #include "fileanalyzerabstract.h"
+#include "contentsniffer.h"
 #ifdef HAVE_QUAZIP5
 #include "fileanalyzerodf.h"
 #include "fileanalyzeropenxml.h"
@@ -36,6 +41,8 @@
 #include "fileanalyzerjpeg.h"
 #include "fileanalyzerjp2.h"
 #include "fileanalyzertiff.h"
+#include "fileanalyzertar.h"
+#include "lazyanalyzer.h"
 
 /**
  * Automatically redirects a file to be analyzed
@@ -53,7 +60,9 @@ public:
 
     virtual bool isAlive() override;
     virtual void setTextExtraction(TextExtraction textExtraction) override;
+    virtual void setTextExtractionLimits(int maxPages, int maxCharacters) override;
     virtual void setAnalyzeEmbeddedFiles(bool enableEmbeddedFilesAnalysis) override;
+    virtual void setLatencyMetrics(LatencyMetrics *latencyMetrics) override;
 
     void setupJhove(const QString &shellscript);
     void setupVeraPDF(const QString &cliTool);
@@ -65,6 +74,26 @@ public:
     void setupThreeHeightsValidatorShellCLI(const QString &threeHeightsValidatorShellCLI, const QString &threeHeightsValidatorLicenseKey);
 
     void setPDFAValidationOptions(const bool validateOnlyPDFAfiles, const bool downgradeToPDFA1b, const FileAnalyzerPDF::XMPPDFConformance enforcedValidationLevel);
+    void setValidatorPolicy(const FileAnalyzerPDF::ValidatorPolicy validatorPolicy, const int quorum);
+    void setParallelPageThreshold(int numPages);
+    void setQuickPDFAnalysis(bool quickAnalysis);
+    void setPopplerWorkerPool(PopplerWorkerPool *popplerWorkerPool);
+    void setAdaptiveTimeouts(AdaptiveTimeouts *adaptiveTimeouts);
+    void setValidatorOutputSummary(bool summarize, int maxFailures);
+    void setEmbeddedImageLimits(int maxImages, int maxImageSize);
+    void setImageJhoveValidation(bool runJhove);
+
+    /**
+     * Embedded files are written to temporary files named after
+     * their data's MD5 sum. Results of their analysis get cached,
+     * so that repeatedly embedded files are analyzed only once.
+     *
+     * @param maxSize maximum size of cached results in bytes, 0 to disable cache
+     */
+    void setEmbeddedFileCacheSize(int maxSize);
+
+    /// @see FileAnalyzerZIP::setLimits and FileAnalyzerTar::setLimits
+    void setArchiveLimits(bool listOnly, qint64 maxMemberSize, int maxCompressionRatio, int maxMembers, int maxNestingDepth);
 
 public slots:
     virtual void analyzeFile(const QString &filename) override;
@@ -78,21 +107,49 @@ public slots:
     void analyzeTemporaryFile(const QString &filename);
 
 private:
+    /// Specialized analyzers, each created on first file of its type
 #ifdef HAVE_QUAZIP5
-    FileAnalyzerODF m_fileAnalyzerODF;
-    FileAnalyzerOpenXML m_fileAnalyzerOpenXML;
-    FileAnalyzerZIP m_fileAnalyzerZIP;
+    LazyAnalyzer<FileAnalyzerODF> m_fileAnalyzerODF;
+    LazyAnalyzer<FileAnalyzerOpenXML> m_fileAnalyzerOpenXML;
+    LazyAnalyzer<FileAnalyzerZIP> m_fileAnalyzerZIP;
 #endif // HAVE_QUAZIP5
-    FileAnalyzerPDF m_fileAnalyzerPDF;
+    LazyAnalyzer<FileAnalyzerPDF> m_fileAnalyzerPDF;
 #ifdef HAVE_WV2
-    FileAnalyzerCompoundBinary m_fileAnalyzerCompoundBinary;
+    LazyAnalyzer<FileAnalyzerCompoundBinary> m_fileAnalyzerCompoundBinary;
 #endif // HAVE_WV2
-    FileAnalyzerJPEG m_fileAnalyzerJPEG;
-    FileAnalyzerJP2 m_fileAnalyzerJP2;
-    FileAnalyzerTIFF m_fileAnalyzerTIFF;
+    LazyAnalyzer<FileAnalyzerJPEG> m_fileAnalyzerJPEG;
+    LazyAnalyzer<FileAnalyzerJP2> m_fileAnalyzerJP2;
+    LazyAnalyzer<FileAnalyzerTIFF> m_fileAnalyzerTIFF;
+    LazyAnalyzer<FileAnalyzerTar> m_fileAnalyzerTar;
     const QStringList &m_filters;
 
+    /// Reports and records of an embedded file's analysis, to be replayed for identical files
+    struct CachedAnalysis {
+        QList<QPair<QString, QString> > reports;
+        QList<QPair<QString, QJsonObject> > records;
+        /// Files embedded in this file whose results were replayed from the cache
+        QStringList embeddedCacheKeys;
+        /// Some archive's members were only listed, depending on its nesting depth
+        bool listOnly;
+
+        explicit CachedAnalysis()
+            : listOnly(false) {
+            /// nothing
+        }
+    };
+    QCache<QString, CachedAnalysis> m_embeddedFileCache;
+    /// Analyses of embedded files currently being collected, innermost last
+    QList<CachedAnalysis *> m_collectedAnalyses;
+    bool m_replayingCachedAnalysis;
+
+    /// Check if an analysis and those of all files embedded in it are still cached
+    bool isReplayable(const QString &cacheKey, QSet<QString> &visitedCacheKeys) const;
+    void replayCachedAnalysis(const QString &cacheKey);
+
     void uncompressAnalyzefile(const QString &filename, const QString &extension, const QString &uncompressTool);
+
+    /// Check if any extension typical for a file's content is among the filters (e.g. '*.pdf')
+    bool filtersMatch(const ContentSniffer &sniffer) const;
 };
 
 #endif // FILEANALYZERMULTIPLEXER_H
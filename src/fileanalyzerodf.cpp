@@ -28,182 +28,15 @@
 #include <QIODevice>
 #include <QDebug>
 #include <QStringList>
-#include <QXmlDefaultHandler>
-#include <QXmlSimpleReader>
+#include <QXmlStreamReader>
+#include <QMap>
+#include <QTextStream>
 #include <QStack>
 #include <QFileInfo>
 
 #include "watchdog.h"
 #include "general.h"
-
-class FileAnalyzerODF::ODFContentFileHandler: public QXmlDefaultHandler
-{
-private:
-    ResultContainer &result;
-    QStack<QString> m_nodeName;
-    bool m_insideText;
-    int m_pageCount;
-
-public:
-    ODFContentFileHandler(FileAnalyzerODF *, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), result(resultContainer), m_insideText(false), m_pageCount(0) {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        m_nodeName.push(qName);
-        m_insideText |= (qName == QStringLiteral("office:text") || qName == QStringLiteral("office:presentation") || qName == QStringLiteral("office:spreadsheet")) && m_nodeName.count() >= 2 && m_nodeName.at(m_nodeName.count() - 2) == QStringLiteral("office:body");
-        if (qName == QStringLiteral("draw:page") || qName == QStringLiteral("table:table")) ++m_pageCount;
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        m_nodeName.pop();
-        if (qName == QStringLiteral("office:text") || qName == QStringLiteral("office:presentation") ||  qName == QStringLiteral("office:spreadsheet") || qName == QStringLiteral("office:body")) m_insideText = false;
-        if (qName == QStringLiteral("office:document-content") && m_pageCount > 0 && result.pageCountOrigin == 0) {
-            result.pageCountOrigin = pcoOwnCount;
-            result.pageCount = m_pageCount;
-        }
-
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-
-    virtual bool characters(const QString &text) {
-        if (m_insideText) result.plainText += text;
-        return QXmlDefaultHandler::characters(text);
-    }
-};
-
-class FileAnalyzerODF::ODFStylesFileHandler: public QXmlDefaultHandler
-{
-private:
-    ResultContainer &result;
-    QStack<QString> m_nodeName;
-    QString stylepagelayoutname;
-    QMap<QString, QString> stylepagelayoutproperties;
-    QString m_lastStyleName;
-
-public:
-    ODFStylesFileHandler(FileAnalyzerODF *, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), result(resultContainer) {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        m_nodeName.push(qName);
-
-        if (m_nodeName.count() >= 2 && qName == QStringLiteral("style:master-page") && atts.value(QStringLiteral("style:name")) == QStringLiteral("Standard") && m_nodeName.at(m_nodeName.count() - 2) == QStringLiteral("office:master-styles"))
-            stylepagelayoutname = atts.value(QStringLiteral("style:page-layout-name"));
-        else if (qName == QStringLiteral("style:page-layout"))
-            m_lastStyleName = atts.value(QStringLiteral("style:name"));
-        else if (m_nodeName.count() >= 2 && qName == QStringLiteral("style:page-layout-properties") && m_nodeName.at(m_nodeName.count() - 2) == QStringLiteral("style:page-layout")) {
-            stylepagelayoutproperties.insert(m_lastStyleName, atts.value(QStringLiteral("fo:page-width")) + "|" + atts.value(QStringLiteral("fo:page-height")));
-        }
-
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        m_nodeName.pop();
-
-        if (qName == QStringLiteral("office:document-styles")) {
-            /// end of file
-            if (!stylepagelayoutname.isEmpty() && stylepagelayoutproperties.contains(stylepagelayoutname)) {
-                QStringList sizes = stylepagelayoutproperties[stylepagelayoutname].split(QStringLiteral("|"));
-                if (sizes[0].endsWith(QStringLiteral("in"))) {
-                    bool ok = false;
-                    result.paperSizeWidth = sizes[0].leftRef(sizes[0].length() - 2).toDouble(&ok) * 25.4;
-                    result.paperSizeHeight = sizes[1].leftRef(sizes[1].length() - 2).toDouble(&ok) * 25.4;
-                } else if (sizes[0].endsWith(QStringLiteral("cm"))) {
-                    bool ok = false;
-                    result.paperSizeWidth = sizes[0].leftRef(sizes[0].length() - 2).toDouble(&ok) * 10;
-                    result.paperSizeHeight = sizes[1].leftRef(sizes[1].length() - 2).toDouble(&ok) * 10;
-                } else if (sizes[0].endsWith(QStringLiteral("mm"))) {
-                    bool ok = false;
-                    result.paperSizeWidth = sizes[0].leftRef(sizes[0].length() - 2).toDouble(&ok);
-                    result.paperSizeHeight = sizes[1].leftRef(sizes[1].length() - 2).toDouble(&ok);
-                }
-            }
-        }
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-
-    virtual bool characters(const QString &text) {
-        // still unused: QString nodeName = m_nodeName.top().toLower();
-// TODO
-        return QXmlDefaultHandler::characters(text);
-    }
-
-
-};
-
-class FileAnalyzerODF::ODFMetaFileHandler: public QXmlDefaultHandler
-{
-private:
-    FileAnalyzerODF *p;
-    ResultContainer &result;
-    QStack<QString> nodeNameStack;
-
-
-public:
-    ODFMetaFileHandler(FileAnalyzerODF *parent, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), p(parent), result(resultContainer) {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        nodeNameStack.push(qName);
-
-        if (result.pageCountOrigin == 0 && qName == QStringLiteral("meta:document-statistic") && !atts.value(QStringLiteral("meta:page-count")).isEmpty()) {
-            bool ok = false;
-            result.pageCount = atts.value(QStringLiteral("meta:page-count")).toInt(&ok);
-            if (!ok)
-                result.pageCount = 0;
-            else
-                result.pageCountOrigin = pcoDocument;
-        } else if (qName == QStringLiteral("office:document-meta") && !atts.value(QStringLiteral("office:version")).isEmpty()) {
-            result.documentVersionNumbers = atts.value(QStringLiteral("office:version")).split(QStringLiteral("."));
-        }
-
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        nodeNameStack.pop();
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-
-    virtual bool characters(const QString &text) {
-        QString nodeName = nodeNameStack.top().toLower();
-
-        if (nodeName == QStringLiteral("meta:generator")) {
-            QString guess = p->guessTool(text);
-            if (!guess.isEmpty())
-                result.toolGenerator = QString(QStringLiteral("<tool type=\"generator\">\n%1</tool>\n")).arg(guess);
-        } else if (nodeName == QStringLiteral("dc:initial-creator")) {
-            result.authorInitial = QString(QStringLiteral("<author type=\"first\">%1</author>\n")).arg(DocScan::xmlify(text));
-        } else if (nodeName == QStringLiteral("dc:creator")) {
-            result.authorLast = QString(QStringLiteral("<author type=\"last\">%1</author>\n")).arg(DocScan::xmlify(text));
-        } else if (nodeName == QStringLiteral("dc:title")) {
-            result.title = QString(QStringLiteral("<title>%1</title>\n")).arg(DocScan::xmlify(text));
-        } else if (nodeName == QStringLiteral("dc:subject")) {
-            result.subject = QString(QStringLiteral("<subject>%1</subject>\n")).arg(DocScan::xmlify(text));
-        } else if (nodeName == QStringLiteral("dc:language")) {
-            result.language = QString(QStringLiteral("<language origin=\"document\">%1</language>\n")).arg(text);
-        } else {
-            QDate date = QDate::fromString(text.left(10), QStringLiteral("yyyy-MM-dd"));
-            if (nodeName == QStringLiteral("meta:creation-date") && date.isValid()) {
-                result.dateCreation = date;
-            } else if (nodeName == QStringLiteral("dc:date") && date.isValid()) {
-                result.dateModification = date;
-            } else if (nodeName == QStringLiteral("meta:print-date") && date.isValid()) {
-                result.datePrint = date;
-            }
-        }
-
-        return QXmlDefaultHandler::characters(text);
-    }
-};
+#include "zipdirectoryindex.h"
 
 FileAnalyzerODF::FileAnalyzerODF(QObject *parent)
     : FileAnalyzerAbstract(parent), m_isAlive(false)
@@ -222,42 +55,48 @@ void FileAnalyzerODF::analyzeFile(const QString &filename)
     QuaZip zipFile(filename);
 
     if (zipFile.open(QuaZip::mdUnzip)) {
+        /// all parts are looked up in one index of the central directory
+        ZipDirectoryIndex index(zipFile);
         ResultContainer result;
         result.pageCount = 0;
         result.paperSizeWidth = 0;
         result.paperSizeHeight = 0;
         result.pageCountOrigin = (PageCountOrigin)0;
+        result.textLength = 0;
 
         /// evaluate meta.xml file
-        if (zipFile.setCurrentFile(QStringLiteral("meta.xml"), QuaZip::csInsensitive)) {
+        if (index.setCurrentFile(QStringLiteral("meta.xml"))) {
             QuaZipFile metaXML(&zipFile, parent());
             analyzeMetaXML(metaXML, result);
         } else {
             emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-meta\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+            emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-meta")));
             return;
         }
 
         /// evaluate styles.xml file
-        if (zipFile.setCurrentFile(QStringLiteral("styles.xml"), QuaZip::csInsensitive)) {
+        if (index.setCurrentFile(QStringLiteral("styles.xml"))) {
             QuaZipFile stylesXML(&zipFile, parent());
             analyzeStylesXML(stylesXML, result);
         } else {
             emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-styles\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+            emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-styles")));
             return;
         }
 
         /// evaluate content.xml file
-        if (zipFile.setCurrentFile(QStringLiteral("content.xml"), QuaZip::csInsensitive)) {
+        if (index.setCurrentFile(QStringLiteral("content.xml"))) {
             QuaZipFile contentXML(&zipFile, parent());
             text(contentXML, result);
         } else {
             emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-content\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+            emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-content")));
             return;
         }
 
         /// determine mime type
         QString mimetype = QStringLiteral("application/octet-stream");
-        if (zipFile.setCurrentFile(QStringLiteral("mimetype"), QuaZip::csInsensitive)) {
+        if (index.setCurrentFile(QStringLiteral("mimetype"))) {
             QuaZipFile mimetypeFile(&zipFile, parent());
             if (mimetypeFile.open(QIODevice::ReadOnly)) {
                 QTextStream ts(&mimetypeFile);
@@ -301,12 +140,9 @@ void FileAnalyzerODF::analyzeFile(const QString &filename)
             headerText.append(result.subject);
 
         /// evaluate language
+        /// (guessing language using aspell is disabled as being computationally expensive)
         if (!result.language.isEmpty())
             headerText.append(result.language);
-        /* Disabling aspell, computationally expensive
-        if (result.plainText.length() > 1024)
-            headerText.append(QString(QStringLiteral("<language origin=\"aspell\">%1</language>\n")).arg(guessLanguage(result.plainText)));
-         */
 
         /// evaluate paper size
         if (result.paperSizeHeight > 0 && result.paperSizeWidth > 0)
@@ -326,7 +162,7 @@ void FileAnalyzerODF::analyzeFile(const QString &filename)
 
         // TODO fonts
 
-        QString bodyText = QString(QStringLiteral("<body length=\"%1\" />\n")).arg(result.plainText.length());
+        QString bodyText = QString(QStringLiteral("<body length=\"%1\" />\n")).arg(result.textLength);
 
         /// close all tags, merge text
         metaText += QStringLiteral("</meta>\n");
@@ -337,36 +173,180 @@ void FileAnalyzerODF::analyzeFile(const QString &filename)
         logText += QStringLiteral("</fileanalysis>\n");
 
         emit analysisReport(objectName(), logText);
+
+        QJsonObject record;
+        record.insert(QStringLiteral("filename"), filename);
+        record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+        record.insert(QStringLiteral("mimetype"), mimetype);
+        if (result.documentVersionNumbers.count() > 0 && !majorVersion.isEmpty())
+            record.insert(QStringLiteral("version"), majorVersion + QLatin1Char('.') + minorVersion);
+        record.insert(QStringLiteral("size"), fi.size());
+        if (result.pageCount > 0)
+            record.insert(QStringLiteral("numpages"), result.pageCount);
+        record.insert(QStringLiteral("textlength"), result.textLength);
+        emit analysisRecord(objectName(), record);
+
         zipFile.close();
-    } else
+    } else {
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-fileformat\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-fileformat")));
+    }
 
     m_isAlive = false;
 }
 
 void FileAnalyzerODF::analyzeMetaXML(QIODevice &device, ResultContainer &result)
 {
-    ODFMetaFileHandler handler(this, result);
-    QXmlInputSource source(&device);
-    QXmlSimpleReader reader;
-    reader.setContentHandler(&handler);
-    reader.parse(&source);
+    if (!device.open(QIODevice::ReadOnly)) return;
+
+    QXmlStreamReader reader(&device);
+    QStack<QString> nodeNameStack;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            nodeNameStack.push(reader.qualifiedName().toString().toLower());
+            const QXmlStreamAttributes attributes = reader.attributes();
+            if (result.pageCountOrigin == 0 && reader.qualifiedName() == QStringLiteral("meta:document-statistic") && !attributes.value(QStringLiteral("meta:page-count")).isEmpty()) {
+                bool ok = false;
+                result.pageCount = attributes.value(QStringLiteral("meta:page-count")).toInt(&ok);
+                if (!ok)
+                    result.pageCount = 0;
+                else
+                    result.pageCountOrigin = pcoDocument;
+            } else if (reader.qualifiedName() == QStringLiteral("office:document-meta") && !attributes.value(QStringLiteral("office:version")).isEmpty()) {
+                result.documentVersionNumbers = attributes.value(QStringLiteral("office:version")).toString().split(QStringLiteral("."));
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            nodeNameStack.pop();
+            break;
+        case QXmlStreamReader::Characters: {
+            if (nodeNameStack.isEmpty() || reader.isWhitespace()) break;
+            const QString &nodeName = nodeNameStack.top();
+            const QString text = reader.text().toString();
+            if (nodeName == QStringLiteral("meta:generator")) {
+                QString guess = guessTool(text);
+                if (!guess.isEmpty())
+                    result.toolGenerator = QString(QStringLiteral("<tool type=\"generator\">\n%1</tool>\n")).arg(guess);
+            } else if (nodeName == QStringLiteral("dc:initial-creator")) {
+                result.authorInitial = QString(QStringLiteral("<author type=\"first\">%1</author>\n")).arg(DocScan::xmlify(text));
+            } else if (nodeName == QStringLiteral("dc:creator")) {
+                result.authorLast = QString(QStringLiteral("<author type=\"last\">%1</author>\n")).arg(DocScan::xmlify(text));
+            } else if (nodeName == QStringLiteral("dc:title")) {
+                result.title = QString(QStringLiteral("<title>%1</title>\n")).arg(DocScan::xmlify(text));
+            } else if (nodeName == QStringLiteral("dc:subject")) {
+                result.subject = QString(QStringLiteral("<subject>%1</subject>\n")).arg(DocScan::xmlify(text));
+            } else if (nodeName == QStringLiteral("dc:language")) {
+                result.language = QString(QStringLiteral("<language origin=\"document\">%1</language>\n")).arg(text);
+            } else {
+                QDate date = QDate::fromString(text.left(10), QStringLiteral("yyyy-MM-dd"));
+                if (nodeName == QStringLiteral("meta:creation-date") && date.isValid()) {
+                    result.dateCreation = date;
+                } else if (nodeName == QStringLiteral("dc:date") && date.isValid()) {
+                    result.dateModification = date;
+                } else if (nodeName == QStringLiteral("meta:print-date") && date.isValid()) {
+                    result.datePrint = date;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    device.close();
 }
 
 void FileAnalyzerODF::analyzeStylesXML(QIODevice &device, ResultContainer &result)
 {
-    ODFStylesFileHandler handler(this, result);
-    QXmlInputSource source(&device);
-    QXmlSimpleReader reader;
-    reader.setContentHandler(&handler);
-    reader.parse(&source);
+    if (!device.open(QIODevice::ReadOnly)) return;
+
+    QXmlStreamReader reader(&device);
+    QStack<QString> nodeNameStack;
+    QString stylepagelayoutname;
+    QMap<QString, QString> stylepagelayoutproperties;
+    QString lastStyleName;
+    while (!reader.atEnd()) {
+        const QXmlStreamReader::TokenType tokenType = reader.readNext();
+        if (tokenType == QXmlStreamReader::StartElement) {
+            const QString qName = reader.qualifiedName().toString();
+            const QXmlStreamAttributes attributes = reader.attributes();
+            if (!nodeNameStack.isEmpty() && qName == QStringLiteral("style:master-page") && attributes.value(QStringLiteral("style:name")) == QStringLiteral("Standard") && nodeNameStack.top() == QStringLiteral("office:master-styles"))
+                stylepagelayoutname = attributes.value(QStringLiteral("style:page-layout-name")).toString();
+            else if (qName == QStringLiteral("style:page-layout"))
+                lastStyleName = attributes.value(QStringLiteral("style:name")).toString();
+            else if (!nodeNameStack.isEmpty() && qName == QStringLiteral("style:page-layout-properties") && nodeNameStack.top() == QStringLiteral("style:page-layout"))
+                stylepagelayoutproperties.insert(lastStyleName, attributes.value(QStringLiteral("fo:page-width")).toString() + "|" + attributes.value(QStringLiteral("fo:page-height")).toString());
+            nodeNameStack.push(qName);
+        } else if (tokenType == QXmlStreamReader::EndElement) {
+            nodeNameStack.pop();
+            /// Master styles come after page layouts, nothing else of interest follows
+            if (reader.qualifiedName() == QStringLiteral("office:master-styles"))
+                break;
+        }
+    }
+    device.close();
+
+    if (!stylepagelayoutname.isEmpty() && stylepagelayoutproperties.contains(stylepagelayoutname)) {
+        QStringList sizes = stylepagelayoutproperties[stylepagelayoutname].split(QStringLiteral("|"));
+        if (sizes[0].endsWith(QStringLiteral("in"))) {
+            bool ok = false;
+            result.paperSizeWidth = sizes[0].leftRef(sizes[0].length() - 2).toDouble(&ok) * 25.4;
+            result.paperSizeHeight = sizes[1].leftRef(sizes[1].length() - 2).toDouble(&ok) * 25.4;
+        } else if (sizes[0].endsWith(QStringLiteral("cm"))) {
+            bool ok = false;
+            result.paperSizeWidth = sizes[0].leftRef(sizes[0].length() - 2).toDouble(&ok) * 10;
+            result.paperSizeHeight = sizes[1].leftRef(sizes[1].length() - 2).toDouble(&ok) * 10;
+        } else if (sizes[0].endsWith(QStringLiteral("mm"))) {
+            bool ok = false;
+            result.paperSizeWidth = sizes[0].leftRef(sizes[0].length() - 2).toDouble(&ok);
+            result.paperSizeHeight = sizes[1].leftRef(sizes[1].length() - 2).toDouble(&ok);
+        }
+    }
 }
 
 void FileAnalyzerODF::text(QIODevice &device, ResultContainer &result)
 {
-    ODFContentFileHandler handler(this, result);
-    QXmlInputSource source(&device);
-    QXmlSimpleReader reader;
-    reader.setContentHandler(&handler);
-    reader.parse(&source);
+    if (!device.open(QIODevice::ReadOnly)) return;
+
+    /// Content may be huge, so neither text nor element names are kept,
+    /// only nesting depths of the body and its text element
+    QXmlStreamReader reader(&device);
+    int depth = 0, bodyDepth = -1, textDepth = -1;
+    int pageCount = 0;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            ++depth;
+            const QStringRef qName = reader.qualifiedName();
+            if (qName == QStringLiteral("office:body"))
+                bodyDepth = depth;
+            else if (textDepth < 0 && bodyDepth == depth - 1 && (qName == QStringLiteral("office:text") || qName == QStringLiteral("office:presentation") || qName == QStringLiteral("office:spreadsheet")))
+                textDepth = depth;
+            else if (qName == QStringLiteral("draw:page") || qName == QStringLiteral("table:table"))
+                ++pageCount;
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            if (depth == textDepth) textDepth = -1;
+            if (depth == bodyDepth) bodyDepth = -1;
+            --depth;
+            break;
+        case QXmlStreamReader::Characters:
+            /// Counting the length needs no copy of the text
+            if (textDepth >= 0)
+                result.textLength += reader.text().length();
+            break;
+        default:
+            break;
+        }
+    }
+    device.close();
+
+    if (pageCount > 0 && result.pageCountOrigin == 0) {
+        result.pageCountOrigin = pcoOwnCount;
+        result.pageCount = pageCount;
+    }
 }
@@ -57,14 +57,10 @@ private:
         QDate dateCreation, dateModification, datePrint;
         int pageCount;
         PageCountOrigin pageCountOrigin;
-        QString plainText;
+        int textLength;
         int paperSizeWidth, paperSizeHeight;
     } ResultContainer;
 
-    class ODFContentFileHandler;
-    class ODFMetaFileHandler;
-    class ODFStylesFileHandler;
-
     bool m_isAlive;
 
     void analyzeMetaXML(QIODevice &device, ResultContainer &result);
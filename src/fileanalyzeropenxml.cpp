@@ -26,211 +26,23 @@
 #include <quazipfile.h>
 
 #include <QRegExp>
-#include <QTextStream>
-#include <QXmlDefaultHandler>
+#include <QRegularExpression>
+#include <QXmlStreamReader>
 #include <QStack>
+#include <QMap>
 #include <QDebug>
 #include <QFileInfo>
+#include <QBuffer>
+#include <QThreadPool>
+#include <QtConcurrent>
 
-#include "general.h"
-
-class FileAnalyzerOpenXML::OpenXMLDocumentHandler: public QXmlDefaultHandler
-{
-private:
-    ResultContainer &result;
-    QStack<QString> m_nodeName;
-    bool m_insideText;
-    QString c;
-
-public:
-    OpenXMLDocumentHandler(FileAnalyzerOpenXML *, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), result(resultContainer), m_insideText(false) {
-        result.paperSizeWidth = result.paperSizeHeight = 0;
-        result.formatVersion.clear(); // TODO
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        m_nodeName.push(qName);
-        m_insideText |= qName == QStringLiteral("w:t");
-
-        if (result.paperSizeWidth == 0 && qName == QStringLiteral("w:pgSz")) {
-            bool ok = false;
-            int mmw = atts.value(QStringLiteral("w:w")).toInt(&ok) / 56.695238f;
-            if (ok) {
-                result.paperSizeWidth = mmw;
-                int mmh = atts.value(QStringLiteral("w:h")).toInt(&ok) / 56.695238f;
-                if (ok)
-                    result.paperSizeHeight = mmh;
-            }
-        } else if (qName == QStringLiteral("w:lang"))
-            result.languageDocument = atts.value(QStringLiteral("w:eastAsia"));
-
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        m_nodeName.pop();
-        if (qName == QStringLiteral("w:t")) m_insideText = false;
-        if (qName == QStringLiteral("w:p")) result.plainText += QStringLiteral("\n");
-
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-
-    virtual bool characters(const QString &text) {
-        if (m_insideText) result.plainText += text;
-        return QXmlDefaultHandler::characters(text);
-    }
-};
-
-class FileAnalyzerOpenXML::OpenXMLSettingsHandler: public QXmlDefaultHandler
-{
-private:
-    ResultContainer &result;
-    QString m_language;
-
-public:
-    OpenXMLSettingsHandler(FileAnalyzerOpenXML *, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), result(resultContainer) {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        if (qName == QStringLiteral("w:themeFontLang"))
-            m_language = atts.value(QStringLiteral("w:val"));
-
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        if (qName == QStringLiteral("w:document") && !m_language.isEmpty()) {
-            result.languageDocument = m_language;
-        }
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-};
-
-class FileAnalyzerOpenXML::OpenXMLSlideHandler: public QXmlDefaultHandler
-{
-private:
-    ResultContainer &result;
-    QString m_language;
-
-public:
-    OpenXMLSlideHandler(FileAnalyzerOpenXML *, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), result(resultContainer) {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        if (qName == QStringLiteral("a:rPr"))
-            m_language = atts.value(QStringLiteral("lang"));
-
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        if (qName == QStringLiteral("p:sld") && !m_language.isEmpty()) {
-            result.languageDocument = m_language;
-
-        }
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-};
-
-class FileAnalyzerOpenXML::OpenXMLCoreHandler: public QXmlDefaultHandler
-{
-private:
-    ResultContainer &result;
-    QStack<QString> m_nodeName;
-
-public:
-    OpenXMLCoreHandler(FileAnalyzerOpenXML *, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), result(resultContainer)  {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        m_nodeName.push(qName);
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        m_nodeName.pop();
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-
-    virtual bool characters(const QString &text) {
-        if (m_nodeName.top() == QStringLiteral("dc:creator"))
-            result.authorInitial = QString(QStringLiteral("<author type=\"first\">%1</author>\n")).arg(DocScan::xmlify(text));
-        else if (m_nodeName.top() == QStringLiteral("cp:lastModifiedBy"))
-            result.authorLast = QString(QStringLiteral("<author type=\"last\">%1</author>\n")).arg(DocScan::xmlify(text));
-        else if (m_nodeName.top() == QStringLiteral("dcterms:created")) {
-            QDate date = QDate::fromString(text.left(10), QStringLiteral("yyyy-MM-dd"));
-            result.dateCreation = DocScan::formatDate(date, QStringLiteral("creation"));
-        } else if (m_nodeName.top() == QStringLiteral("dcterms:modified")) {
-            QDate date = QDate::fromString(text.left(10), QStringLiteral("yyyy-MM-dd"));
-            result.dateModification = DocScan::formatDate(date, QStringLiteral("modification"));
-        } else if (m_nodeName.top() == QStringLiteral("dc:title"))
-            result.title = QString(QStringLiteral("<title>%1</title>\n")).arg(DocScan::xmlify(text));
-        else if (m_nodeName.top() == QStringLiteral("dc:subject"))
-            result.subject = QString(QStringLiteral("<subject>%1</subject>\n")).arg(DocScan::xmlify(text));
-
-        return QXmlDefaultHandler::characters(text);
-    }
-};
-
-class FileAnalyzerOpenXML::OpenXMLAppHandler: public QXmlDefaultHandler
-{
-private:
-    FileAnalyzerOpenXML *p;
-    ResultContainer &result;
-    QStack<QString> m_nodeName;
-    QString application, appVersion;
-
-public:
-    OpenXMLAppHandler(FileAnalyzerOpenXML *parent, ResultContainer &resultContainer)
-        : QXmlDefaultHandler(), p(parent), result(resultContainer) {
-        // nothing
-    }
-
-    virtual bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName, const QXmlAttributes &atts) {
-        m_nodeName.push(qName);
-        return QXmlDefaultHandler::startElement(namespaceURI, localName, qName, atts);
-    }
-
-    virtual bool endElement(const QString &namespaceURI, const QString &localName, const QString &qName) {
-        m_nodeName.pop();
-
-        if (qName == QStringLiteral("Properties")) {
-            QString toolString = application;
-            if (!toolString.contains(QRegExp(QStringLiteral("\\d\\.\\d"))))
-                toolString.append(" " + appVersion); /// avoid duplicate version numbers
-            QString guess = p->guessTool(toolString);
-            if (!guess.isEmpty())
-                result.toolGenerator = QString(QStringLiteral("<tool type=\"generator\">\n%1</tool>\n")).arg(guess);
-        }
-        return QXmlDefaultHandler::endElement(namespaceURI, localName, qName);
-    }
-
-    virtual bool characters(const QString &text) {
-        if (m_nodeName.top() == QStringLiteral("Application"))
-            application = text;
-        else if (m_nodeName.top() == QStringLiteral("AppVersion"))
-            appVersion = QString(text).replace(QStringLiteral("0000"), QStringLiteral("0"));
-        else if (m_nodeName.top() == QStringLiteral("Characters")) {
-            bool ok = false;
-            result.characterCount = text.toInt(&ok);
-            if (!ok) result.characterCount = 0;
-        } else if (m_nodeName.top() == QStringLiteral("Pages")) {
-            bool ok = false;
-            result.pageCount = text.toInt(&ok);
-            if (!ok) result.pageCount = 0;
-        }
+#include <climits>
 
+#include "general.h"
+#include "zipdirectoryindex.h"
 
-        return QXmlDefaultHandler::characters(text);
-    }
-};
+/// Slides or sheets below this number are processed without additional threads
+static const int minPartsPerRange = 16;
 
 FileAnalyzerOpenXML::FileAnalyzerOpenXML(QObject *parent)
     : FileAnalyzerAbstract(parent), m_isAlive(false)
@@ -254,41 +66,43 @@ void FileAnalyzerOpenXML::analyzeFile(const QString &filename)
     QuaZip zipFile(filename);
 
     if (zipFile.open(QuaZip::mdUnzip)) {
+        /// all parts are looked up in one index of the central directory
+        ZipDirectoryIndex index(zipFile);
 
         /// determine mime type
         QString mimetype = QStringLiteral("application/octet-stream");
-        if (zipFile.setCurrentFile(QStringLiteral("[Content_Types].xml"), QuaZip::csInsensitive)) {
+        if (index.setCurrentFile(QStringLiteral("[Content_Types].xml"))) {
             QuaZipFile contentTypeFile(&zipFile, parent());
             if (contentTypeFile.open(QIODevice::ReadOnly)) {
-                QTextStream ts(&contentTypeFile);
-                QString allText = ts.readAll();
-                QRegExp mainMimeTypeRegExp("ContentType=\"(application/vnd.openxmlformats-officedocument.[^\"]+).main[+]xml\"");
-                if (mainMimeTypeRegExp.indexIn(allText) >= 0)
-                    mimetype = mainMimeTypeRegExp.cap(1);
+                mimetype = mainContentType(contentTypeFile, mimetype);
                 contentTypeFile.close();
             }
         }
 
         if (mimetype == QStringLiteral("application/vnd.openxmlformats-officedocument.wordprocessingml.document")) {
-            if (!processWordFile(zipFile, result)) {
+            if (!processWordFile(zipFile, index, result)) {
                 emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-document\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+                emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-document")));
                 return;
             }
         }
 
-        if (!processCore(zipFile, result)) {
+        if (!processCore(zipFile, index, result)) {
             emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-corefile\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+            emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-corefile")));
             return;
         }
 
-        if (!processApp(zipFile, result)) {
+        if (!processApp(zipFile, index, result)) {
             emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-appfile\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+            emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-appfile")));
             return;
         }
 
-        if (!processSettings(zipFile, result)) {
-            if (!processSlides(zipFile, result)) {
+        if (!processSettings(zipFile, index, result)) {
+            if (!processSlides(zipFile, index, result) && !processSheets(zipFile, index, result)) {
                 emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+                emit analysisRecord(objectName(), errorRecord(filename, QString()));
                 return;
             }
         }
@@ -359,23 +173,35 @@ void FileAnalyzerOpenXML::analyzeFile(const QString &filename)
 
         emit analysisReport(objectName(), logText);
 
+        QJsonObject record;
+        record.insert(QStringLiteral("filename"), filename);
+        record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+        record.insert(QStringLiteral("mimetype"), mimetype);
+        if (!result.formatVersion.isEmpty())
+            record.insert(QStringLiteral("version"), result.formatVersion);
+        record.insert(QStringLiteral("size"), fi.size());
+        if (result.pageCount > 0)
+            record.insert(QStringLiteral("numpages"), result.pageCount);
+        record.insert(QStringLiteral("textlength"), result.characterCount);
+        emit analysisRecord(objectName(), record);
+
         zipFile.close();
-    } else
+    } else {
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-fileformat\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-fileformat")));
+    }
 
     m_isAlive = false;
 }
 
-bool FileAnalyzerOpenXML::processWordFile(QuaZip &zipFile, ResultContainer &result)
+bool FileAnalyzerOpenXML::processWordFile(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result)
 {
-    if (zipFile.setCurrentFile(QStringLiteral("word/document.xml"), QuaZip::csInsensitive)) {
+    if (index.setCurrentFile(QStringLiteral("word/document.xml"))) {
         QuaZipFile documentFile(&zipFile, parent());
         if (documentFile.open(QIODevice::ReadOnly)) {
-            text(documentFile, result);
-            /* Disabling aspell, computationally expensive
-            if (result.plainText.length() > 1024)
-                result.languageAspell = guessLanguage(result.plainText);
-             */
+            /// Language guessing using aspell is disabled as being
+            /// computationally expensive, so the document's text is not collected
+            processDocument(documentFile, result);
             documentFile.close();
             return true;
         }
@@ -384,16 +210,45 @@ bool FileAnalyzerOpenXML::processWordFile(QuaZip &zipFile, ResultContainer &resu
 }
 
 
-bool FileAnalyzerOpenXML::processCore(QuaZip &zipFile, ResultContainer &result)
+bool FileAnalyzerOpenXML::processCore(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result)
 {
-    if (zipFile.setCurrentFile(QStringLiteral("docProps/core.xml"), QuaZip::csInsensitive)) {
+    if (index.setCurrentFile(QStringLiteral("docProps/core.xml"))) {
         QuaZipFile coreFile(&zipFile, parent());
         if (coreFile.open(QIODevice::ReadOnly)) {
-            OpenXMLCoreHandler handler(this, result);
-            QXmlInputSource source(&coreFile);
-            QXmlSimpleReader reader;
-            reader.setContentHandler(&handler);
-            reader.parse(&source);
+            QXmlStreamReader reader(&coreFile);
+            QStack<QString> nodeNameStack;
+            while (!reader.atEnd()) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement:
+                    nodeNameStack.push(reader.qualifiedName().toString());
+                    break;
+                case QXmlStreamReader::EndElement:
+                    nodeNameStack.pop();
+                    break;
+                case QXmlStreamReader::Characters:
+                    if (!nodeNameStack.isEmpty()) {
+                        const QString &nodeName = nodeNameStack.top();
+                        const QString text = reader.text().toString();
+                        if (nodeName == QStringLiteral("dc:creator"))
+                            result.authorInitial = QString(QStringLiteral("<author type=\"first\">%1</author>\n")).arg(DocScan::xmlify(text));
+                        else if (nodeName == QStringLiteral("cp:lastModifiedBy"))
+                            result.authorLast = QString(QStringLiteral("<author type=\"last\">%1</author>\n")).arg(DocScan::xmlify(text));
+                        else if (nodeName == QStringLiteral("dcterms:created")) {
+                            QDate date = QDate::fromString(text.left(10), QStringLiteral("yyyy-MM-dd"));
+                            result.dateCreation = DocScan::formatDate(date, QStringLiteral("creation"));
+                        } else if (nodeName == QStringLiteral("dcterms:modified")) {
+                            QDate date = QDate::fromString(text.left(10), QStringLiteral("yyyy-MM-dd"));
+                            result.dateModification = DocScan::formatDate(date, QStringLiteral("modification"));
+                        } else if (nodeName == QStringLiteral("dc:title"))
+                            result.title = QString(QStringLiteral("<title>%1</title>\n")).arg(DocScan::xmlify(text));
+                        else if (nodeName == QStringLiteral("dc:subject"))
+                            result.subject = QString(QStringLiteral("<subject>%1</subject>\n")).arg(DocScan::xmlify(text));
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
 
             coreFile.close();
             return true;
@@ -402,16 +257,53 @@ bool FileAnalyzerOpenXML::processCore(QuaZip &zipFile, ResultContainer &result)
     return false;
 }
 
-bool FileAnalyzerOpenXML::processApp(QuaZip &zipFile, ResultContainer &result)
+bool FileAnalyzerOpenXML::processApp(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result)
 {
-    if (zipFile.setCurrentFile(QStringLiteral("docProps/app.xml"), QuaZip::csInsensitive)) {
+    if (index.setCurrentFile(QStringLiteral("docProps/app.xml"))) {
         QuaZipFile appFile(&zipFile, parent());
         if (appFile.open(QIODevice::ReadOnly)) {
-            OpenXMLAppHandler handler(this, result);
-            QXmlInputSource source(&appFile);
-            QXmlSimpleReader reader;
-            reader.setContentHandler(&handler);
-            reader.parse(&source);
+            QXmlStreamReader reader(&appFile);
+            QStack<QString> nodeNameStack;
+            QString application, appVersion;
+            while (!reader.atEnd()) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement:
+                    nodeNameStack.push(reader.qualifiedName().toString());
+                    break;
+                case QXmlStreamReader::EndElement:
+                    nodeNameStack.pop();
+                    break;
+                case QXmlStreamReader::Characters:
+                    if (!nodeNameStack.isEmpty()) {
+                        const QString &nodeName = nodeNameStack.top();
+                        if (nodeName == QStringLiteral("Application"))
+                            application = reader.text().toString();
+                        else if (nodeName == QStringLiteral("AppVersion"))
+                            appVersion = reader.text().toString().replace(QStringLiteral("0000"), QStringLiteral("0"));
+                        else if (nodeName == QStringLiteral("Characters")) {
+                            bool ok = false;
+                            result.characterCount = reader.text().toInt(&ok);
+                            if (!ok) result.characterCount = 0;
+                        } else if (nodeName == QStringLiteral("Pages")) {
+                            bool ok = false;
+                            result.pageCount = reader.text().toInt(&ok);
+                            if (!ok) result.pageCount = 0;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            if (!application.isEmpty()) {
+                QString toolString = application;
+                if (!toolString.contains(QRegExp(QStringLiteral("\\d\\.\\d"))))
+                    toolString.append(" " + appVersion); /// avoid duplicate version numbers
+                QString guess = guessTool(toolString);
+                if (!guess.isEmpty())
+                    result.toolGenerator = QString(QStringLiteral("<tool type=\"generator\">\n%1</tool>\n")).arg(guess);
+            }
 
             appFile.close();
             return true;
@@ -420,47 +312,237 @@ bool FileAnalyzerOpenXML::processApp(QuaZip &zipFile, ResultContainer &result)
     return false;
 }
 
-bool FileAnalyzerOpenXML::processSettings(QuaZip &zipFile, ResultContainer &result)
+bool FileAnalyzerOpenXML::processSettings(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result)
 {
-    if (zipFile.setCurrentFile(QStringLiteral("word/settings.xml"), QuaZip::csInsensitive)) {
-        QuaZipFile appFile(&zipFile, parent());
-        if (appFile.open(QIODevice::ReadOnly)) {
-            OpenXMLSettingsHandler handler(this, result);
-            QXmlInputSource source(&appFile);
-            QXmlSimpleReader reader;
-            reader.setContentHandler(&handler);
-            reader.parse(&source);
+    if (index.setCurrentFile(QStringLiteral("word/settings.xml"))) {
+        QuaZipFile settingsFile(&zipFile, parent());
+        if (settingsFile.open(QIODevice::ReadOnly)) {
+            QXmlStreamReader reader(&settingsFile);
+            while (!reader.atEnd()) {
+                if (reader.readNext() == QXmlStreamReader::StartElement && reader.qualifiedName() == QStringLiteral("w:themeFontLang")) {
+                    /// Language set in document itself takes precedence
+                    if (result.languageDocument.isEmpty())
+                        result.languageDocument = reader.attributes().value(QStringLiteral("w:val")).toString();
+                    break; ///< nothing else of interest in this file
+                }
+            }
 
-            appFile.close();
+            settingsFile.close();
             return true;
         }
     }
     return false;
 }
 
-bool FileAnalyzerOpenXML::processSlides(QuaZip &zipFile, ResultContainer &result)
+bool FileAnalyzerOpenXML::processSlides(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result)
 {
-    if (zipFile.setCurrentFile(QStringLiteral("ppt/slides/slide1.xml"), QuaZip::csInsensitive)) {
-        QuaZipFile appFile(&zipFile, parent());
-        if (appFile.open(QIODevice::ReadOnly)) {
-            OpenXMLSlideHandler handler(this, result);
-            QXmlInputSource source(&appFile);
-            QXmlSimpleReader reader;
-            reader.setContentHandler(&handler);
-            reader.parse(&source);
+    static const QRegularExpression slideRegExp(QStringLiteral("^ppt/slides/slide([0-9]+)[.]xml$"), QRegularExpression::CaseInsensitiveOption);
+    return processParts(zipFile, index, slideRegExp, QStringList() << QStringLiteral("a:t"), QStringLiteral("a:rPr"), result);
+}
 
-            appFile.close();
-            return true;
+bool FileAnalyzerOpenXML::processSheets(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result)
+{
+    static const QRegularExpression sheetRegExp(QStringLiteral("^xl/worksheets/sheet([0-9]+)[.]xml$"), QRegularExpression::CaseInsensitiveOption);
+    /// Document properties take precedence over own counts
+    const bool characterCountKnown = result.characterCount > 0;
+    /// Only inline strings count as text in sheets: cells' values ('<v>')
+    /// are numbers or, for strings, indices into the shared strings
+    if (!processParts(zipFile, index, sheetRegExp, QStringList() << QStringLiteral("t"), QString(), result))
+        return false;
+    if (!characterCountKnown)
+        result.characterCount += sharedStringsCharacterCount(zipFile, index);
+    return true;
+}
+
+int FileAnalyzerOpenXML::sharedStringsCharacterCount(QuaZip &zipFile, ZipDirectoryIndex &index)
+{
+    int characterCount = 0;
+    if (index.setCurrentFile(QStringLiteral("xl/sharedStrings.xml"))) {
+        QuaZipFile sharedStringsFile(&zipFile, parent());
+        if (sharedStringsFile.open(QIODevice::ReadOnly)) {
+            /// Each string is stored once, no matter how many cells refer to it
+            QXmlStreamReader reader(&sharedStringsFile);
+            bool inText = false;
+            while (!reader.atEnd()) {
+                switch (reader.readNext()) {
+                case QXmlStreamReader::StartElement:
+                    inText = reader.qualifiedName() == QStringLiteral("t");
+                    break;
+                case QXmlStreamReader::EndElement:
+                    inText = false;
+                    break;
+                case QXmlStreamReader::Characters:
+                    if (inText)
+                        characterCount += reader.text().length();
+                    break;
+                default:
+                    break;
+                }
+            }
+            sharedStringsFile.close();
         }
     }
-    return false;
+    return characterCount;
 }
 
-void FileAnalyzerOpenXML::text(QIODevice &device, ResultContainer &result)
+bool FileAnalyzerOpenXML::processParts(QuaZip &zipFile, ZipDirectoryIndex &index, const QRegularExpression &partNameRegExp, const QStringList &textElements, const QString &languageElement, ResultContainer &result)
 {
-    OpenXMLDocumentHandler handler(this, result);
-    QXmlInputSource source(&device);
-    QXmlSimpleReader reader;
-    reader.setContentHandler(&handler);
-    reader.parse(&source);
+    /// Collect parts like 'slide12.xml' ordered by their number, not their position in archive
+    QMap<int, ZipDirectoryIndex::Entry> numberedParts;
+    for (const ZipDirectoryIndex::Entry &entry : index.entries()) {
+        const QRegularExpressionMatch match = partNameRegExp.match(entry.name);
+        if (match.hasMatch() && !numberedParts.contains(match.captured(1).toInt()))
+            numberedParts.insert(match.captured(1).toInt(), entry);
+    }
+    if (numberedParts.isEmpty()) return false;
+    const QVector<ZipDirectoryIndex::Entry> parts = numberedParts.values().toVector();
+
+    /// Workers share the memory-mapped archive, but each has its own
+    /// unzip handle and inflate stream
+    const QString filename = zipFile.getZipName();
+    QFile archive(filename);
+    const uchar *archiveData = nullptr;
+    const qint64 archiveSize = archive.size();
+    if (archiveSize > 0 && archiveSize <= INT_MAX && archive.open(QFile::ReadOnly))
+        archiveData = archive.map(0, archiveSize);
+
+    const int numRanges = qBound(1, parts.count() / minPartsPerRange, QThreadPool::globalInstance()->maxThreadCount());
+    QList<QFuture<struct PartRangeResult> > futures;
+    for (int r = 1; r < numRanges; ++r) {
+        const int firstPart = parts.count() * r / numRanges;
+        const int lastPart = parts.count() * (r + 1) / numRanges - 1;
+        futures.append(QtConcurrent::run([ = ]() {
+            return analyzePartRange(filename, archiveData, archiveSize, parts, firstPart, lastPart, textElements, languageElement);
+        }));
+    }
+    /// First range is processed in this thread while workers take care of the others
+    QList<struct PartRangeResult> rangeResults;
+    rangeResults.append(analyzePartRange(filename, archiveData, archiveSize, parts, 0, parts.count() / numRanges - 1, textElements, languageElement));
+    for (QFuture<struct PartRangeResult> &future : futures)
+        rangeResults.append(future.result());
+
+    /// Merge results in part order, so that outcome does not depend on scheduling
+    struct PartRangeResult merged;
+    for (const struct PartRangeResult &rangeResult : const_cast<const QList<struct PartRangeResult> &>(rangeResults)) {
+        merged.characterCount += rangeResult.characterCount;
+        merged.numParts += rangeResult.numParts;
+        if (merged.language.isEmpty())
+            merged.language = rangeResult.language;
+    }
+    if (archiveData != nullptr)
+        archive.unmap(const_cast<uchar *>(archiveData));
+    if (merged.numParts == 0) return false;
+
+    /// Document properties take precedence over own counts
+    if (result.characterCount == 0)
+        result.characterCount = merged.characterCount;
+    if (result.pageCount == 0)
+        result.pageCount = merged.numParts;
+    if (!merged.language.isEmpty())
+        result.languageDocument = merged.language;
+    return true;
+}
+
+struct FileAnalyzerOpenXML::PartRangeResult FileAnalyzerOpenXML::analyzePartRange(const QString &filename, const uchar *archiveData, qint64 archiveSize, const QVector<ZipDirectoryIndex::Entry> &parts, int firstPart, int lastPart, const QStringList &textElements, const QString &languageElement)
+{
+    struct PartRangeResult result;
+
+    QBuffer buffer;
+    if (archiveData != nullptr)
+        buffer.setData(QByteArray::fromRawData(reinterpret_cast<const char *>(archiveData), static_cast<int>(archiveSize)));
+    QuaZip zipFile(filename);
+    if (archiveData != nullptr)
+        zipFile.setIoDevice(&buffer);
+    if (!zipFile.open(QuaZip::mdUnzip)) return result;
+
+    for (int i = firstPart; i <= lastPart; ++i) {
+        if (!ZipDirectoryIndex::goToEntry(zipFile, parts[i])) continue;
+        QuaZipFile partFile(&zipFile);
+        if (!partFile.open(QIODevice::ReadOnly)) continue;
+
+        QXmlStreamReader reader(&partFile);
+        int textDepth = 0;
+        while (!reader.atEnd()) {
+            switch (reader.readNext()) {
+            case QXmlStreamReader::StartElement: {
+                const QStringRef qName = reader.qualifiedName();
+                if (textDepth > 0)
+                    ++textDepth;
+                else {
+                    for (const QString &textElement : textElements)
+                        if (qName == textElement) {
+                            textDepth = 1;
+                            break;
+                        }
+                }
+                if (result.language.isEmpty() && !languageElement.isEmpty() && qName == languageElement) {
+                    const QXmlStreamAttributes attributes = reader.attributes();
+                    result.language = attributes.value(QStringLiteral("lang")).toString();
+                }
+                break;
+            }
+            case QXmlStreamReader::EndElement:
+                if (textDepth > 0) --textDepth;
+                break;
+            case QXmlStreamReader::Characters:
+                if (textDepth > 0)
+                    result.characterCount += reader.text().length();
+                break;
+            default:
+                break;
+            }
+        }
+
+        partFile.close();
+        ++result.numParts;
+    }
+
+    zipFile.close();
+    return result;
+}
+
+QString FileAnalyzerOpenXML::mainContentType(QIODevice &device, const QString &defaultMimetype)
+{
+    static const QString prefix = QStringLiteral("application/vnd.openxmlformats-officedocument.");
+    static const QString suffix = QStringLiteral(".main+xml");
+
+    QXmlStreamReader reader(&device);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) continue;
+        const QXmlStreamAttributes attributes = reader.attributes();
+        const QStringRef contentType = attributes.value(QStringLiteral("ContentType"));
+        if (contentType.startsWith(prefix) && contentType.endsWith(suffix))
+            return contentType.left(contentType.length() - suffix.length()).toString();
+    }
+    return defaultMimetype;
+}
+
+void FileAnalyzerOpenXML::processDocument(QIODevice &device, ResultContainer &result)
+{
+    result.paperSizeWidth = result.paperSizeHeight = 0;
+    result.formatVersion.clear(); // TODO
+
+    /// Only attributes are of interest, so character data passes by without being copied
+    QXmlStreamReader reader(&device);
+    while (!reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) continue;
+
+        const QStringRef qName = reader.qualifiedName();
+        if (result.paperSizeWidth == 0 && qName == QStringLiteral("w:pgSz")) {
+            const QXmlStreamAttributes attributes = reader.attributes();
+            bool ok = false;
+            int mmw = attributes.value(QStringLiteral("w:w")).toInt(&ok) / 56.695238f;
+            if (ok) {
+                result.paperSizeWidth = mmw;
+                int mmh = attributes.value(QStringLiteral("w:h")).toInt(&ok) / 56.695238f;
+                if (ok)
+                    result.paperSizeHeight = mmh;
+            }
+        } else if (result.languageDocument.isEmpty() && qName == QStringLiteral("w:lang"))
+            result.languageDocument = reader.attributes().value(QStringLiteral("w:eastAsia")).toString();
+
+        /// Stop as soon as everything is known, no need to scan the remaining body
+        if (result.paperSizeWidth > 0 && !result.languageDocument.isEmpty())
+            break;
+    }
 }
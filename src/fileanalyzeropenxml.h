@@ -24,10 +24,12 @@
 #define FILEANALYZEROPENXML_H
 
 #include <QStringList>
+#include <QVector>
 
 #include "fileanalyzerabstract.h"
+#include "zipdirectoryindex.h"
 
-class QuaZip;
+class QRegularExpression;
 class QIODevice;
 
 /**
@@ -55,25 +57,38 @@ private:
         QString languageAspell, languageDocument;
         QString dateCreation, dateModification;
         int pageCount;
-        QString plainText;
         int characterCount;
         int paperSizeWidth, paperSizeHeight;
     } ResultContainer;
 
-    class OpenXMLDocumentHandler;
-    class OpenXMLCoreHandler;
-    class OpenXMLAppHandler;
-    class OpenXMLSettingsHandler;
-    class OpenXMLSlideHandler;
+    /// Statistics of a range of slides or sheets, computed concurrently
+    struct PartRangeResult {
+        int characterCount;
+        int numParts;
+        QString language;
+
+        explicit PartRangeResult()
+            : characterCount(0), numParts(0) {
+            /// nothing
+        }
+    };
 
     bool m_isAlive;
 
-    bool processWordFile(QuaZip &zipFile, ResultContainer &result);
-    bool processCore(QuaZip &zipFile, ResultContainer &result);
-    bool processApp(QuaZip &zipFile, ResultContainer &result);
-    bool processSettings(QuaZip &zipFile, ResultContainer &result);
-    bool processSlides(QuaZip &zipFile, ResultContainer &result);
-    void text(QIODevice &device, ResultContainer &result);
+    bool processWordFile(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result);
+    bool processCore(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result);
+    bool processApp(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result);
+    bool processSettings(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result);
+    bool processSlides(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result);
+    bool processSheets(QuaZip &zipFile, ZipDirectoryIndex &index, ResultContainer &result);
+    /// Number of characters in 'xl/sharedStrings.xml', strings referred to by sheets' cells
+    int sharedStringsCharacterCount(QuaZip &zipFile, ZipDirectoryIndex &index);
+    bool processParts(QuaZip &zipFile, ZipDirectoryIndex &index, const QRegularExpression &partNameRegExp, const QStringList &textElements, const QString &languageElement, ResultContainer &result);
+    static struct PartRangeResult analyzePartRange(const QString &filename, const uchar *archiveData, qint64 archiveSize, const QVector<ZipDirectoryIndex::Entry> &parts, int firstPart, int lastPart, const QStringList &textElements, const QString &languageElement);
+
+    /// Main document's mime type as listed in '[Content_Types].xml'
+    QString mainContentType(QIODevice &device, const QString &defaultMimetype);
+    void processDocument(QIODevice &device, ResultContainer &result);
 };
 
 #endif // FILEANALYZEROPENXML_H
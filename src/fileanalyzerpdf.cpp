@@ -23,6 +23,7 @@
 #include "fileanalyzerpdf.h"
 
 #include <QFileInfo>
+#include <QBuffer>
 #include <QTemporaryDir>
 #include <QDebug>
 #include <QDateTime>
@@ -33,23 +34,40 @@
 #include <QHash>
 #include <QXmlQuery>
 #include <QRegularExpression>
-#include <QStandardPaths>
+#include <QSet>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#ifdef Q_OS_LINUX
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif // Q_OS_LINUX
 
 #include "watchdog.h"
 #include "guessing.h"
 #include "general.h"
-
-static const int oneMinuteInMillisec = 60000;
+#include "pdfquickparser.h"
+#include "popplerworkerpool.h"
+#include "adaptivetimeouts.h"
+#include "validatoroutputsummary.h"
+#include "toolregistry.h"
+
+static const int oneSecondInMillisec = 1000;
+static const int oneMinuteInMillisec = oneSecondInMillisec * 60;
 static const int twoMinutesInMillisec = oneMinuteInMillisec * 2;
 static const int fourMinutesInMillisec = oneMinuteInMillisec * 4;
-static const int sixMinutesInMillisec = oneMinuteInMillisec * 6;
 static const int tenMinutesInMillisec = oneMinuteInMillisec * 10;
 static const int twentyMinutesInMillisec = oneMinuteInMillisec * 20;
 static const int thirtyMinutesInMillisec = oneMinuteInMillisec * 30;
 static const int sixtyMinutesInMillisec = oneMinuteInMillisec * 60;
+/// Interval in which validators running concurrently are checked for output and termination
+static const int validatorPollIntervalInMillisec = 50;
 
 FileAnalyzerPDF::FileAnalyzerPDF(QObject *parent)
-    : FileAnalyzerAbstract(parent), JHoveWrapper(), m_isAlive(false), m_validateOnlyPDFAfiles(false), m_downgradeToPDFA1b(false), m_enforcedValidationLevel(xmpNone), m_tempDirDowngradeToPDFA1b(QDir::tempPath() + QStringLiteral("/fileanalyzerPDF-downgradeToPDFA1b.d-XXXXXX"))
+    : FileAnalyzerAbstract(parent), JHoveWrapper(), m_isAlive(false), m_validateOnlyPDFAfiles(false), m_downgradeToPDFA1b(false), m_enforcedValidationLevel(xmpNone), m_validatorPolicy(validatorPolicyAll), m_validatorQuorum(2), m_tempDirDowngradeToPDFA1b(QDir::tempPath() + QStringLiteral("/fileanalyzerPDF-downgradeToPDFA1b.d-XXXXXX")), m_parallelPageThreshold(0), m_quickAnalysis(false), m_popplerWorkerPool(nullptr), m_adaptiveTimeouts(nullptr), m_summarizeValidatorOutput(true), m_validatorOutputMaxFailures(20), m_maxEmbeddedImages(256), m_maxEmbeddedImageSize(64 * 1024 * 1024)
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
     m_tempDirDowngradeToPDFA1b.setAutoRemove(true);
@@ -58,46 +76,34 @@ FileAnalyzerPDF::FileAnalyzerPDF(QObject *parent)
 }
 
 void FileAnalyzerPDF::delayedToolcheck() {
+    /// Probe all tools in parallel, results get cached for all analyzers
+    const QHash<QString, ToolRegistry::Tool> tools = ToolRegistry::instance().probe(QStringList() << QStringLiteral("java") << QStringLiteral("exiftool") << QStringLiteral("pdfinfo"));
+
     FileAnalyzerAbstract::delayedToolcheck();
 
-    QProcess exiftoolprocess(this);
-    const QStringList exiftoolarguments = QStringList() << QStringLiteral("-ver");
-    QByteArray exiftoolStandardOutput;
-    connect(&exiftoolprocess, &QProcess::readyReadStandardOutput, [&exiftoolprocess, &exiftoolStandardOutput]() {
-        const QByteArray d(exiftoolprocess.readAllStandardOutput());
-        exiftoolStandardOutput.append(d);
-    });
-    exiftoolprocess.start(QStringLiteral("exiftool"), exiftoolarguments, QIODevice::ReadOnly);
-    if (!exiftoolprocess.waitForStarted(oneMinuteInMillisec) || !exiftoolprocess.waitForFinished(twoMinutesInMillisec)) {
-        const QString report = QString(QStringLiteral("<toolcheck name=\"exiftool\" status=\"error\" exitcode=\"%1\" />\n")).arg(exiftoolprocess.exitCode());
+    const ToolRegistry::Tool exiftool = tools.value(QStringLiteral("exiftool"));
+    if (!exiftool.found) {
+        const QString report = QString(QStringLiteral("<toolcheck name=\"exiftool\" status=\"error\" exitcode=\"%1\" />\n")).arg(exiftool.exitCode);
         emit analysisReport(objectName(), report);
     } else {
-        const QString stdout = QString::fromLocal8Bit(exiftoolStandardOutput).trimmed();
-        const QString report = QString(QStringLiteral("<toolcheck name=\"exiftool\" status=\"ok\" exitcode=\"%1\" version=\"%2\" />\n")).arg(exiftoolprocess.exitCode()).arg(stdout);
+        const QString report = QString(QStringLiteral("<toolcheck name=\"exiftool\" status=\"ok\" exitcode=\"%1\" version=\"%2\" />\n")).arg(exiftool.exitCode).arg(exiftool.output);
         emit analysisReport(objectName(), report);
     }
 
-    QProcess pdfinfoprocess(this);
-    const QStringList pdfinfoarguments = QStringList() << QStringLiteral("-v");
-    QByteArray pdfinfoStandardError;
-    connect(&pdfinfoprocess, &QProcess::readyReadStandardError, [&pdfinfoprocess, &pdfinfoStandardError]() {
-        const QByteArray d(pdfinfoprocess.readAllStandardError());
-        pdfinfoStandardError.append(d);
-    });
-    pdfinfoprocess.start(QStringLiteral("pdfinfo"), pdfinfoarguments, QIODevice::ReadOnly);
-    if (!pdfinfoprocess.waitForStarted(oneMinuteInMillisec) || !pdfinfoprocess.waitForFinished(twoMinutesInMillisec)) {
-        const QString report = QString(QStringLiteral("<toolcheck name=\"pdfinfo\" status=\"error\" exitcode=\"%1\" />\n")).arg(pdfinfoprocess.exitCode());
+    const ToolRegistry::Tool pdfinfo = tools.value(QStringLiteral("pdfinfo"));
+    if (!pdfinfo.found) {
+        const QString report = QString(QStringLiteral("<toolcheck name=\"pdfinfo\" status=\"error\" exitcode=\"%1\" />\n")).arg(pdfinfo.exitCode);
         emit analysisReport(objectName(), report);
     } else {
-        const QString stderr = QString::fromLocal8Bit(pdfinfoStandardError).trimmed();
+        const QString &stderr = pdfinfo.output;
         const int p1 = stderr.indexOf(QStringLiteral(" version "));
         const int p2 = p1 > 5 ? stderr.indexOf(QLatin1Char('\n'), p1 + 9) : -1;
         if (p1 > 5 && p2 > p1) {
             const QString versionNumber = stderr.mid(p1 + 9, p2 - p1 - 9);
-            const QString report = QString(QStringLiteral("<toolcheck name=\"pdfinfo\" status=\"ok\" exitcode=\"%1\" version=\"%2\"><output>%3</output></toolcheck>\n")).arg(pdfinfoprocess.exitCode()).arg(versionNumber).arg(DocScan::xmlify(stderr));
+            const QString report = QString(QStringLiteral("<toolcheck name=\"pdfinfo\" status=\"ok\" exitcode=\"%1\" version=\"%2\"><output>%3</output></toolcheck>\n")).arg(pdfinfo.exitCode).arg(versionNumber).arg(DocScan::xmlify(stderr));
             emit analysisReport(objectName(), report);
         } else {
-            const QString report = QString(QStringLiteral("<toolcheck name=\"pdfinfo\" status=\"error\" exitcode=\"%1\"><error>Could not determine version number</error></toolcheck>\n")).arg(pdfinfoprocess.exitCode());
+            const QString report = QString(QStringLiteral("<toolcheck name=\"pdfinfo\" status=\"error\" exitcode=\"%1\"><error>Could not determine version number</error></toolcheck>\n")).arg(pdfinfo.exitCode);
             emit analysisReport(objectName(), report);
         }
     }
@@ -262,7 +268,50 @@ void FileAnalyzerPDF::setPDFAValidationOptions(const bool validateOnlyPDFAfiles,
     m_enforcedValidationLevel = enforcedValidationLevel;
 }
 
-bool FileAnalyzerPDF::adobePreflightReportAnalysis(const QString &filename, QString &metaText) {
+void FileAnalyzerPDF::setValidatorPolicy(const ValidatorPolicy validatorPolicy, const int quorum) {
+    m_validatorPolicy = validatorPolicy;
+    m_validatorQuorum = qMax(1, quorum);
+}
+
+void FileAnalyzerPDF::setParallelPageThreshold(int numPages) {
+    m_parallelPageThreshold = numPages;
+}
+
+void FileAnalyzerPDF::setQuickAnalysis(bool quickAnalysis) {
+    m_quickAnalysis = quickAnalysis;
+}
+
+void FileAnalyzerPDF::setPopplerWorkerPool(PopplerWorkerPool *popplerWorkerPool) {
+    m_popplerWorkerPool = popplerWorkerPool;
+}
+
+void FileAnalyzerPDF::setAdaptiveTimeouts(AdaptiveTimeouts *adaptiveTimeouts) {
+    m_adaptiveTimeouts = adaptiveTimeouts;
+}
+
+void FileAnalyzerPDF::setValidatorOutputSummary(bool summarize, int maxFailures) {
+    m_summarizeValidatorOutput = summarize;
+    m_validatorOutputMaxFailures = qMax(0, maxFailures);
+}
+
+void FileAnalyzerPDF::setEmbeddedImageLimits(int maxImages, int maxImageSize) {
+    m_maxEmbeddedImages = qMax(0, maxImages);
+    m_maxEmbeddedImageSize = qMax(0, maxImageSize);
+}
+
+int FileAnalyzerPDF::validatorTimeLimit(const QString &validator, qint64 fileSize, int numPages, int defaultTimeLimit) {
+    return m_adaptiveTimeouts != nullptr ? m_adaptiveTimeouts->timeLimit(validator, fileSize, numPages, defaultTimeLimit) : defaultTimeLimit;
+}
+
+void FileAnalyzerPDF::recordValidatorRuntime(const QString &validator, qint64 fileSize, int numPages, qint64 milliseconds, bool exceededTimeLimit) {
+    if (m_adaptiveTimeouts == nullptr) return;
+    if (exceededTimeLimit)
+        m_adaptiveTimeouts->recordTimeout(validator, fileSize, numPages, milliseconds);
+    else
+        m_adaptiveTimeouts->recordRuntime(validator, fileSize, numPages, milliseconds);
+}
+
+bool FileAnalyzerPDF::adobePreflightReportAnalysis(const QString &filename, QString &metaText, QJsonObject &validatorsRecord) {
     if (m_adobePreflightReportDirectory.isEmpty()) return false; ///< no report directory set
     const QDir startDirectory(m_adobePreflightReportDirectory);
     if (!startDirectory.exists()) return false; ///< report directory does not exist
@@ -365,14 +414,22 @@ bool FileAnalyzerPDF::adobePreflightReportAnalysis(const QString &filename, QStr
     const QString flavorIdentifier = flavorPos > 100 ? xmlCode.mid(flavorPos + 22, 2).toLower() : QString();
     if (flavorIdentifier.length() != 2 || (flavorIdentifier[0] != QLatin1Char('1') && flavorIdentifier[0] != QLatin1Char('2') && flavorIdentifier[0] != QLatin1Char('3') && flavorIdentifier[0] != QLatin1Char('4')) || (flavorIdentifier[1] != QLatin1Char('a') && flavorIdentifier[1] != QLatin1Char('b') && flavorIdentifier[1] != QLatin1Char('u')))
         metaText = metaText.append(QString(QStringLiteral("<adobepreflight status=\"error\" errorwarningscount=\"%1\"><reportfile>%2</reportfile>\n<error>Could not determine which PDF/A compliance level was checked for.</error>%3</adobepreflight>\n")).arg(countWarningsErrors)).arg(DocScan::xmlify(reportXMLfile)).arg(detailedReport);
-    else
+    else {
         metaText = metaText.append(QString(QStringLiteral("<adobepreflight status=\"ok\" flavor=\"PDFA%1\" pdfa%1=\"%2\" errorwarningscount=\"%3\"><reportfile>%4</reportfile>%5</adobepreflight>\n")).arg(flavorIdentifier).arg(countWarningsErrors == 0 ? QStringLiteral("yes") : QStringLiteral("no")).arg(countWarningsErrors)).arg(DocScan::xmlify(reportXMLfile)).arg(detailedReport);
+        QJsonObject adobeRecord;
+        adobeRecord.insert(QStringLiteral("pdfa") + flavorIdentifier, countWarningsErrors == 0);
+        adobeRecord.insert(QStringLiteral("errorwarningscount"), countWarningsErrors);
+        validatorsRecord.insert(QStringLiteral("adobepreflight"), adobeRecord);
+    }
 
     return true; ///< no issues? exit with success
 }
 
-bool FileAnalyzerPDF::popplerAnalysis(const QString &filename, QString &logText, QString &metaText) {
+bool FileAnalyzerPDF::popplerAnalysis(const QString &filename, QString &logText, QString &metaText, QJsonObject &record) {
+    QElapsedTimer stageTimer;
+    stageTimer.start();
     Poppler::Document *popplerDocument = Poppler::Document::load(filename);
+    recordLatency(QStringLiteral("poppleropen"), stageTimer.nsecsElapsed());
     const bool popplerWrapperOk = popplerDocument != nullptr;
     if (popplerWrapperOk) {
         QString guess, headerText;
@@ -382,6 +439,10 @@ bool FileAnalyzerPDF::popplerAnalysis(const QString &filename, QString &logText,
         int majorVersion = 0, minorVersion = 0;
         popplerDocument->getPdfVersion(&majorVersion, &minorVersion);
         metaText.append(QString(QStringLiteral("<fileformat>\n<mimetype>application/pdf</mimetype>\n<version major=\"%1\" minor=\"%2\">%1.%2</version>\n<security locked=\"%3\" encrypted=\"%4\" />\n</fileformat>\n")).arg(QString::number(majorVersion), QString::number(minorVersion), popplerDocument->isLocked() ? QStringLiteral("yes") : QStringLiteral("no"), popplerDocument->isEncrypted() ? QStringLiteral("yes") : QStringLiteral("no")));
+        record.insert(QStringLiteral("version"), QString(QStringLiteral("%1.%2")).arg(majorVersion).arg(minorVersion));
+        record.insert(QStringLiteral("numpages"), numPages);
+        record.insert(QStringLiteral("locked"), popplerDocument->isLocked());
+        record.insert(QStringLiteral("encrypted"), popplerDocument->isEncrypted());
 
         if (enableEmbeddedFilesAnalysis) {
             metaText.append(QStringLiteral("<embeddedfiles>\n"));
@@ -408,47 +469,105 @@ bool FileAnalyzerPDF::popplerAnalysis(const QString &filename, QString &logText,
             toolXMLtext.append(QString(QStringLiteral("<tool type=\"producer\">\n%1</tool>\n")).arg(guess));
         if (!toolXMLtext.isEmpty())
             metaText.append(QStringLiteral("<tools>\n")).append(toolXMLtext).append(QStringLiteral("</tools>\n"));
-
-        QHash<QString, struct ExtendedFontInfo> knownFonts;
-        for (int pageNumber = 0; pageNumber < numPages;) {
-            Poppler::FontIterator *fontIterator = popplerDocument->newFontIterator(pageNumber);
-            ++pageNumber;
-            if (fontIterator == nullptr) continue;
-
-            if (fontIterator->hasNext()) {
-                const QList<Poppler::FontInfo> fontList = fontIterator->next();
-                for (const Poppler::FontInfo &fi : fontList) {
-                    const QString fontName = fi.name();
-                    if (knownFonts.contains(fontName)) {
-                        struct ExtendedFontInfo &efi = knownFonts[fontName];
-                        efi.recordOccurrence(pageNumber);
-                    } else {
-                        const struct ExtendedFontInfo efi(fi, pageNumber);
-                        knownFonts[fontName] = efi;
-                    }
+        if (!creator.isEmpty())
+            record.insert(QStringLiteral("creator"), creator);
+        if (!producer.isEmpty())
+            record.insert(QStringLiteral("producer"), producer);
+
+        /// Collect fonts and, if requested, text of all pages
+        const bool extractText = textExtraction > teNone;
+        const int numTextPages = !extractText ? 0 : (textExtractionMaxPages > 0 ? qMin(numPages, textExtractionMaxPages) : numPages);
+        struct TextAccumulator textAccumulator(textExtraction, textExtractionMaxCharacters);
+        textAccumulator.truncated = extractText && numTextPages < numPages;
+        struct PageRangeResult pages;
+        const int numPageRanges = qMin(QThreadPool::globalInstance()->maxThreadCount(), numPages);
+        if (m_parallelPageThreshold > 0 && numPages >= m_parallelPageThreshold && numPageRanges > 1) {
+            /// For large documents, process page ranges concurrently,
+            /// each range on its own Poppler::Document instance
+            stageTimer.restart();
+            const bool lengthOnly = textExtraction == teLength;
+            QList<QFuture<struct PageRangeResult> > futures;
+            for (int r = 0; r < numPageRanges; ++r) {
+                const int firstPage = numPages * r / numPageRanges;
+                const int lastPage = numPages * (r + 1) / numPageRanges - 1;
+                const int lastTextPage = numTextPages - 1, maxTextCharacters = textExtractionMaxCharacters;
+                futures.append(QtConcurrent::run([ = ]() {
+                    return analyzePageRangeInNewDocument(filename, firstPage, lastPage, lastTextPage, maxTextCharacters, lengthOnly);
+                }));
+            }
+            /// Merge results in page order
+            bool acceptsMoreText = true;
+            for (int r = 0; r < numPageRanges; ++r) {
+                struct PageRangeResult rangeResult = futures[r].result();
+                /// Release the future's copy of the result, including any text
+                futures[r] = QFuture<struct PageRangeResult>();
+                if (!rangeResult.ok) {
+                    /// Loading the document in worker failed, so fall back
+                    /// to process this range on the already loaded document
+                    rangeResult = PageRangeResult(textExtractionMaxCharacters, lengthOnly);
+                    analyzePageRange(popplerDocument, numPages * r / numPageRanges, numPages * (r + 1) / numPageRanges - 1, numTextPages - 1, nullptr, rangeResult);
                 }
+                pages.merge(rangeResult);
+                if (lengthOnly && acceptsMoreText)
+                    acceptsMoreText = textAccumulator.addLength(rangeResult.pageTextsLength);
+                else if (lengthOnly && rangeResult.pageTextsLength > 0)
+                    textAccumulator.truncated = true;
+                for (const QString &pageText : const_cast<const QStringList &>(rangeResult.pageTexts))
+                    if (acceptsMoreText)
+                        acceptsMoreText = textAccumulator.addPage(pageText);
+                    else if (!pageText.isEmpty())
+                        textAccumulator.truncated = true;
+                if (rangeResult.textTruncated)
+                    textAccumulator.truncated = true;
             }
-            delete fontIterator; ///< clean memory
+            recordLatency(QStringLiteral("pages-parallel"), stageTimer.nsecsElapsed());
+        } else {
+            analyzePageRange(popplerDocument, 0, numPages - 1, numTextPages - 1, &textAccumulator, pages);
+            recordLatency(QStringLiteral("fonts"), pages.fontsNanoseconds);
+            if (extractText)
+                recordLatency(QStringLiteral("textextraction"), pages.textNanoseconds);
         }
+
+        const QHash<QString, struct ExtendedFontInfo> &knownFonts = pages.knownFonts;
         QString fontXMLtext;
+        QJsonArray fontsRecord;
         for (QHash<QString, struct ExtendedFontInfo>::ConstIterator it = knownFonts.constBegin(); it != knownFonts.constEnd(); ++it) {
             bool oninnerpage = false;
             for (int pageNumber = 4; !oninnerpage && pageNumber < numPages - 4; ++pageNumber)
                 oninnerpage = it.value().pageNumbers.contains(pageNumber);
-            fontXMLtext.append(QString(QStringLiteral("<font firstpage=\"%5\" lastpage=\"%6\" oninnerpage=\"%7\" embedded=\"%2\" subset=\"%3\"%4>\n%1</font>\n")).arg(Guessing::fontToXML(it.value().name, it.value().typeName), it.value().isEmbedded ? QStringLiteral("yes") : QStringLiteral("no"), it.value().isSubset ? QStringLiteral("yes") : QStringLiteral("no"), it.value().fileName.isEmpty() ? QString() : QString(QStringLiteral(" filename=\"%1\"")).arg(it.value().fileName)).arg(it.value().firstPageNumber).arg(it.value().lastPageNumber).arg(oninnerpage ? QStringLiteral("yes") : QStringLiteral("no")));
+            QJsonObject fontRecord;
+            fontRecord.insert(QStringLiteral("name"), it.value().name);
+            fontRecord.insert(QStringLiteral("type"), it.value().typeName);
+            fontRecord.insert(QStringLiteral("embedded"), it.value().isEmbedded);
+            fontRecord.insert(QStringLiteral("subset"), it.value().isSubset);
+            fontRecord.insert(QStringLiteral("firstpage"), it.value().firstPageNumber);
+            fontRecord.insert(QStringLiteral("lastpage"), it.value().lastPageNumber);
+            fontRecord.insert(QStringLiteral("oninnerpage"), oninnerpage);
+            const QString fontGuessXML = Guessing::fontToXML(it.value().name, it.value().typeName);
+            static const QRegularExpression licenseTypeRegExp(QStringLiteral("<license\\b[^>]*\\btype=\"([^\"]+)\""));
+            const QRegularExpressionMatch licenseTypeMatch = licenseTypeRegExp.match(fontGuessXML);
+            if (licenseTypeMatch.hasMatch())
+                fontRecord.insert(QStringLiteral("license"), licenseTypeMatch.captured(1));
+            fontsRecord.append(fontRecord);
+            fontXMLtext.append(QString(QStringLiteral("<font firstpage=\"%5\" lastpage=\"%6\" oninnerpage=\"%7\" embedded=\"%2\" subset=\"%3\"%4>\n%1</font>\n")).arg(fontGuessXML, it.value().isEmbedded ? QStringLiteral("yes") : QStringLiteral("no"), it.value().isSubset ? QStringLiteral("yes") : QStringLiteral("no"), it.value().fileName.isEmpty() ? QString() : QString(QStringLiteral(" filename=\"%1\"")).arg(it.value().fileName)).arg(it.value().firstPageNumber).arg(it.value().lastPageNumber).arg(oninnerpage ? QStringLiteral("yes") : QStringLiteral("no")));
         }
         if (!fontXMLtext.isEmpty())
             /// Wrap multiple <font> tags into one <fonts> tag
             metaText.append(QStringLiteral("<fonts>\n")).append(fontXMLtext).append(QStringLiteral("</fonts>\n"));
+        record.insert(QStringLiteral("fonts"), fontsRecord);
 
         /// format creation date
         QDate date = popplerDocument->date(QStringLiteral("CreationDate")).toUTC().date();
-        if (date.isValid())
+        if (date.isValid()) {
             headerText.append(DocScan::formatDate(date, creationDate));
+            record.insert(QStringLiteral("creationdate"), date.toString(Qt::ISODate));
+        }
         /// format modification date
         date = popplerDocument->date(("ModDate")).toUTC().date();
-        if (date.isValid())
+        if (date.isValid()) {
             headerText.append(DocScan::formatDate(date, modificationDate));
+            record.insert(QStringLiteral("modificationdate"), date.toString(Qt::ISODate));
+        }
 
         /// retrieve author
         const QString author = popplerDocument->info(QStringLiteral("Author")).simplified();
@@ -475,18 +594,23 @@ bool FileAnalyzerPDF::popplerAnalysis(const QString &filename, QString &logText,
 
         QString bodyText = QString(QStringLiteral("<body numpages=\"%1\"")).arg(numPages);
         if (textExtraction > teNone) {
-            QString text;
-            for (int i = 0; i < numPages; ++i)
-                text += popplerDocument->page(i)->text(QRectF());
-            bodyText.append(QString(QStringLiteral(" length=\"%1\"")).arg(text.length()));
+            bodyText.append(QString(QStringLiteral(" length=\"%1\"")).arg(textAccumulator.length));
+            record.insert(QStringLiteral("textlength"), textAccumulator.length);
+            if (textAccumulator.truncated) {
+                /// Text limits were hit, length refers to the extracted part only
+                bodyText.append(QStringLiteral(" truncated=\"yes\""));
+                record.insert(QStringLiteral("texttruncated"), true);
+            }
             if (textExtraction >= teFullText) {
                 bodyText.append(QStringLiteral(">\n"));
                 if (textExtraction >= teAspell) {
-                    const QString language = guessLanguage(text);
+                    const QString language = guessLanguage(textAccumulator.languageSample);
+                    textAccumulator.languageSample.clear(); ///< clean memory
                     if (!language.isEmpty())
                         bodyText.append(QString(QStringLiteral("<language tool=\"aspell\">%1</language>\n")).arg(language));
                 }
-                bodyText.append(QStringLiteral("<text>")).append(DocScan::xmlifyLines(text)).append(QStringLiteral("</text>\n"));
+                bodyText.append(QStringLiteral("<text>")).append(textAccumulator.escapedText).append(QStringLiteral("</text>\n"));
+                textAccumulator.escapedText.clear(); ///< clean memory
                 bodyText.append(QStringLiteral("</body>\n"));
             } else
                 bodyText.append(QStringLiteral(" />\n"));
@@ -517,6 +641,210 @@ bool FileAnalyzerPDF::popplerAnalysis(const QString &filename, QString &logText,
         return false;
 }
 
+void FileAnalyzerPDF::analyzePageRange(Poppler::Document *popplerDocument, int firstPage, int lastPage, int lastTextPage, struct TextAccumulator *textAccumulator, struct PageRangeResult &result) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int pageNumber = firstPage; pageNumber <= lastPage;) {
+        Poppler::FontIterator *fontIterator = popplerDocument->newFontIterator(pageNumber);
+        ++pageNumber;
+        if (fontIterator == nullptr) continue;
+
+        if (fontIterator->hasNext()) {
+            const QList<Poppler::FontInfo> fontList = fontIterator->next();
+            for (const Poppler::FontInfo &fi : fontList) {
+                const QString fontName = fi.name();
+                if (result.knownFonts.contains(fontName)) {
+                    struct ExtendedFontInfo &efi = result.knownFonts[fontName];
+                    efi.recordOccurrence(pageNumber);
+                } else {
+                    const struct ExtendedFontInfo efi(fi, pageNumber);
+                    result.knownFonts[fontName] = efi;
+                }
+            }
+        }
+        delete fontIterator; ///< clean memory
+    }
+    result.fontsNanoseconds += timer.nsecsElapsed();
+
+    if (lastTextPage >= firstPage) {
+        timer.restart();
+        const int lastPageWithText = qMin(lastPage, lastTextPage);
+        for (int i = firstPage; i <= lastPageWithText; ++i) {
+            Poppler::Page *page = popplerDocument->page(i);
+            if (page == nullptr) continue;
+            const QString pageText = page->text(QRectF());
+            delete page; ///< clean memory
+            if (textAccumulator != nullptr) {
+                if (!textAccumulator->addPage(pageText)) {
+                    /// Maximum number of characters reached,
+                    /// remaining pages are not of interest
+                    if (i < lastPageWithText) textAccumulator->truncated = true;
+                    break;
+                }
+            } else {
+                if (!result.lengthOnly)
+                    result.pageTexts.append(pageText);
+                result.pageTextsLength += pageText.length();
+                /// No single range has to provide more text than the document may have
+                if (result.maxTextCharacters > 0 && result.pageTextsLength >= result.maxTextCharacters) {
+                    result.textTruncated = i < lastPageWithText;
+                    break;
+                }
+            }
+        }
+        result.textNanoseconds += timer.nsecsElapsed();
+    }
+}
+
+bool FileAnalyzerPDF::TextAccumulator::addPage(const QString &pageText) {
+    if (maxCharacters > 0 && length >= maxCharacters) {
+        if (!pageText.isEmpty()) truncated = true;
+        return false;
+    }
+
+    const QString text = maxCharacters > 0 && length + pageText.length() > maxCharacters ? pageText.left(maxCharacters - length) : pageText;
+    if (text.length() < pageText.length()) truncated = true;
+    length += text.length();
+    if (textExtraction >= teFullText) {
+        /// Escape page by page, so that the unescaped text never has to be kept
+        const QString escapedPageText = DocScan::xmlifyLines(text);
+        if (!escapedText.isEmpty() && !escapedPageText.isEmpty())
+            escapedText.append(QChar('\n'));
+        escapedText.append(escapedPageText);
+    }
+    if (textExtraction >= teAspell && languageSample.length() < languageSampleLength) {
+        /// Guessing the language does not require the document's full text
+        languageSample.append(text.left(languageSampleLength - languageSample.length()));
+    }
+
+    return maxCharacters <= 0 || length < maxCharacters;
+}
+
+bool FileAnalyzerPDF::TextAccumulator::addLength(int textLength) {
+    if (maxCharacters > 0 && length + textLength > maxCharacters) {
+        length = maxCharacters;
+        truncated = true;
+        return false;
+    }
+    length += textLength;
+    return maxCharacters <= 0 || length < maxCharacters;
+}
+
+struct FileAnalyzerPDF::PageRangeResult FileAnalyzerPDF::analyzePageRangeInNewDocument(const QString &filename, int firstPage, int lastPage, int lastTextPage, int maxTextCharacters, bool lengthOnly) {
+    struct PageRangeResult result(maxTextCharacters, lengthOnly);
+    Poppler::Document *popplerDocument = Poppler::Document::load(filename);
+    if (popplerDocument == nullptr) {
+        result.ok = false;
+        return result;
+    }
+    analyzePageRange(popplerDocument, firstPage, lastPage, lastTextPage, nullptr, result);
+    delete popplerDocument;
+    return result;
+}
+
+bool FileAnalyzerPDF::quickAnalysis(const QString &filename) {
+    const qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+    PDFQuickParser parser(filename);
+    /// Encrypted documents' strings and streams cannot be decrypted here
+    if (!parser.parse() || parser.isEncrypted()) return false;
+    const int numPages = parser.numPages();
+    if (numPages < 0) return false;
+
+    QString logText, metaText, headerText;
+    QJsonObject record;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("mimetype"), QStringLiteral("application/pdf"));
+    record.insert(QStringLiteral("analysis"), QStringLiteral("quick"));
+
+    /// file format including mime type and file format version
+    metaText.append(QString(QStringLiteral("<fileformat>\n<mimetype>application/pdf</mimetype>\n<version major=\"%1\" minor=\"%2\">%1.%2</version>\n<security locked=\"no\" encrypted=\"no\" />\n</fileformat>\n")).arg(QString::number(parser.majorVersion()), QString::number(parser.minorVersion())));
+    record.insert(QStringLiteral("version"), QString(QStringLiteral("%1.%2")).arg(parser.majorVersion()).arg(parser.minorVersion()));
+    record.insert(QStringLiteral("numpages"), numPages);
+    record.insert(QStringLiteral("locked"), false);
+    record.insert(QStringLiteral("encrypted"), false);
+
+    /// XMP metadata as embedded in the document catalog
+    const PDFVersion pdfVersion = pdfVersionAnalysis(filename);
+    const QString xmpData = QString::fromUtf8(parser.metadata()).trimmed();
+    metaText.append(QStringLiteral("<xmp>"));
+    XMPPDFConformance xmpPDFConformance = xmpNone;
+    if (xmpData.isEmpty())
+        metaText.append(QStringLiteral("<warning>No XMP metadata found</warning></xmp>\n"));
+    else
+        xmpPDFConformance = xmpConformanceAnalysis(xmpData, pdfVersion, metaText);
+    if (xmpPDFConformance > xmpNone)
+        record.insert(QStringLiteral("xmppdfconformance"), xmpPDFConformanceToString(xmpPDFConformance));
+
+    /// guess and evaluate editor (a.k.a. creator) and producer
+    QString toolXMLtext, guess;
+    const QString creator = parser.info("Creator");
+    if (!creator.isEmpty())
+        guess = guessTool(creator, parser.info("Title"));
+    if (!guess.isEmpty())
+        toolXMLtext.append(QString(QStringLiteral("<tool type=\"editor\">\n%1</tool>\n")).arg(guess));
+    const QString producer = parser.info("Producer");
+    guess.clear();
+    if (!producer.isEmpty())
+        guess = guessTool(producer, parser.info("Title"));
+    if (!guess.isEmpty())
+        toolXMLtext.append(QString(QStringLiteral("<tool type=\"producer\">\n%1</tool>\n")).arg(guess));
+    if (!toolXMLtext.isEmpty())
+        metaText.append(QStringLiteral("<tools>\n")).append(toolXMLtext).append(QStringLiteral("</tools>\n"));
+    if (!creator.isEmpty())
+        record.insert(QStringLiteral("creator"), creator);
+    if (!producer.isEmpty())
+        record.insert(QStringLiteral("producer"), producer);
+
+    /// format creation and modification date
+    QDate date = parser.date("CreationDate").toUTC().date();
+    if (date.isValid()) {
+        headerText.append(DocScan::formatDate(date, creationDate));
+        record.insert(QStringLiteral("creationdate"), date.toString(Qt::ISODate));
+    }
+    date = parser.date("ModDate").toUTC().date();
+    if (date.isValid()) {
+        headerText.append(DocScan::formatDate(date, modificationDate));
+        record.insert(QStringLiteral("modificationdate"), date.toString(Qt::ISODate));
+    }
+
+    /// retrieve author, title, subject, and keywords
+    const QString author = parser.info("Author").simplified();
+    if (!author.isEmpty())
+        headerText.append(QString(QStringLiteral("<author>%1</author>\n")).arg(DocScan::xmlify(author)));
+    QString title = parser.info("Title").simplified();
+    if (microsoftToolRegExp.indexIn(title) == 0)
+        title = microsoftToolRegExp.cap(3);
+    if (!title.isEmpty())
+        headerText.append(QString(QStringLiteral("<title>%1</title>\n")).arg(DocScan::xmlify(title)));
+    const QString subject = parser.info("Subject").simplified();
+    if (!subject.isEmpty())
+        headerText.append(QString(QStringLiteral("<subject>%1</subject>\n")).arg(DocScan::xmlify(subject)));
+    const QString keywords = parser.info("Keywords").simplified();
+    if (!keywords.isEmpty())
+        headerText.append(QString(QStringLiteral("<keyword>%1</keyword>\n")).arg(DocScan::xmlify(keywords)));
+
+    logText.append(QString(QStringLiteral("<body numpages=\"%1\" />\n")).arg(numPages));
+    if (!headerText.isEmpty())
+        logText.append(QStringLiteral("<header>\n")).append(headerText).append(QStringLiteral("</header>\n"));
+
+    /// file information including size
+    const QFileInfo fi = QFileInfo(filename);
+    metaText.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(fi.size()));
+    logText.append(QStringLiteral("<meta>\n")).append(metaText).append(QStringLiteral("</meta>\n"));
+
+    const qint64 endTime = QDateTime::currentMSecsSinceEpoch();
+    logText.prepend(QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\" time=\"%2\" analysis=\"quick\"%3>\n")).arg(DocScan::xmlify(filename), QString::number(endTime - startTime), parser.wasReconstructed() ? QStringLiteral(" xref=\"reconstructed\"") : QString()));
+    logText.append(QStringLiteral("</fileanalysis>\n"));
+    emit analysisReport(objectName(), logText);
+
+    record.insert(QStringLiteral("size"), fi.size());
+    record.insert(QStringLiteral("time"), endTime - startTime);
+    record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+    emit analysisRecord(objectName(), record);
+
+    return true;
+}
+
 FileAnalyzerPDF::PDFVersion FileAnalyzerPDF::pdfVersionAnalysis(const QString &filename) {
     QFile pdfFile(filename);
     if (pdfFile.open(QFile::ReadOnly)) {
@@ -605,6 +933,10 @@ FileAnalyzerPDF::XMPPDFConformance FileAnalyzerPDF::xmpAnalysis(const QString &f
         return xmpError;
     }
 
+    return xmpConformanceAnalysis(output, pdfVersion, metaText);
+}
+
+FileAnalyzerPDF::XMPPDFConformance FileAnalyzerPDF::xmpConformanceAnalysis(const QString &output, const PDFVersion pdfVersion, QString &metaText) {
     static const QString pdfPartTag(QStringLiteral("<pdfaid:part>"));
     const int pPdfPartTag = output.indexOf(pdfPartTag);
     QChar part;
@@ -692,89 +1024,185 @@ bool FileAnalyzerPDF::pdfVersionMatchesXMPconformance(const FileAnalyzerPDF::PDF
            || (pdfVersion == pdfVersion2dot0 && xmpPDFConformance == xmpPDFA4);
 }
 
+/**
+ * Rewrite PDF/A identification in XMP data to claim PDF/A-1b.
+ *
+ * @param xmpData XMP data to be modified in-place
+ * @param originConformance set to the conformance claimed before, if known
+ * @param errorText set if no supported PDF/A identification was found
+ * @return true if the XMP data was modified
+ */
+static bool downgradeXMPtoPDFA1b(QByteArray &xmpData, FileAnalyzerPDF::XMPPDFConformance &originConformance, QString &errorText) {
+    /// Both element form like <pdfaid:part>2</pdfaid:part> and
+    /// attribute form like pdfaid:part="2" are in use
+    static const QRegularExpression partRegExp(QStringLiteral("(<pdfaid:part>\\s*|pdfaid:part\\s*=\\s*[\"'])(\\d)"));
+    static const QRegularExpression conformanceRegExp(QStringLiteral("(<pdfaid:conformance>\\s*|pdfaid:conformance\\s*=\\s*[\"'])([A-Za-z])"));
+
+    originConformance = FileAnalyzerPDF::xmpNone;
+    QString xmpText = QString::fromUtf8(xmpData);
+    const QRegularExpressionMatch partMatch = partRegExp.match(xmpText);
+    const QRegularExpressionMatch conformanceMatch = conformanceRegExp.match(xmpText);
+    const QChar part = partMatch.hasMatch() ? partMatch.captured(2)[0] : QChar();
+    const QChar conformance = conformanceMatch.hasMatch() ? conformanceMatch.captured(2)[0].toUpper() : QChar();
+    if (part != QLatin1Char('1') && part != QLatin1Char('2')) {
+        errorText = QStringLiteral("Failed to identify XMP PDFaid data structure: either non-existent or for unsupported PDF/A part");
+        return false;
+    }
+
+    bool modified = false;
+    if (part == QLatin1Char('2')) {
+        xmpText[partMatch.capturedStart(2)] = QLatin1Char('1');
+        modified = true;
+        if (conformance == QLatin1Char('A'))
+            originConformance = FileAnalyzerPDF::xmpPDFA2a;
+        else if (conformance == QLatin1Char('B'))
+            originConformance = FileAnalyzerPDF::xmpPDFA2b;
+        else if (conformance == QLatin1Char('U'))
+            originConformance = FileAnalyzerPDF::xmpPDFA2u;
+    } else if (conformance == QLatin1Char('A'))
+        originConformance = FileAnalyzerPDF::xmpPDFA1a;
+    if (conformance == QLatin1Char('A') || conformance == QLatin1Char('U')) {
+        xmpText[conformanceMatch.capturedStart(2)] = QLatin1Char('B');
+        modified = true;
+    }
+
+    if (modified)
+        xmpData = xmpText.toUtf8();
+    return modified;
+}
+
+static PDFQuickParser::Object pdfNumber(qint64 number) {
+    PDFQuickParser::Object result(PDFQuickParser::Object::Number);
+    result.number = static_cast<double>(number);
+    return result;
+}
+
+/**
+ * Append an incremental update to a PDF file, replacing the
+ * XMP metadata stream by an uncompressed stream with new data.
+ * The update's cross-reference data is of the same kind
+ * (table or stream) as the file's newest one.
+ */
+static bool appendXMPUpdate(QFile &pdfFile, PDFQuickParser &parser, const PDFQuickParser::Object &metadataReference, const PDFQuickParser::Object &metadataStream, const QByteArray &xmpData) {
+    QByteArray update("\n");
+    const qint64 metadataOffset = pdfFile.size() + update.size();
+
+    PDFQuickParser::Object metadataDictionary(PDFQuickParser::Object::Dictionary);
+    metadataDictionary.dictionary = metadataStream.dictionary;
+    static const QList<QByteArray> encodingKeys {"Filter", "DecodeParms", "DL", "F", "FFilter", "FDecodeParms"};
+    for (const QByteArray &key : encodingKeys)
+        metadataDictionary.dictionary.remove(key);
+    metadataDictionary.dictionary.insert("Length", pdfNumber(xmpData.size()));
+    update.append(QByteArray::number(metadataReference.objectNumber) + ' ' + QByteArray::number(metadataReference.generationNumber) + " obj\n" + PDFQuickParser::toPdfSyntax(metadataDictionary) + "\nstream\n").append(xmpData).append("\nendstream\nendobj\n");
+    const qint64 xrefOffset = pdfFile.size() + update.size();
+
+    /// Trailer refers to previous cross-reference data and keeps document catalog, info and ID
+    const PDFQuickParser::Object &previousTrailer = parser.trailer();
+    PDFQuickParser::Object trailer(PDFQuickParser::Object::Dictionary);
+    static const QList<QByteArray> trailerKeys {"Root", "Info", "ID"};
+    for (const QByteArray &key : trailerKeys)
+        if (previousTrailer.dictionary.contains(key))
+            trailer.dictionary.insert(key, previousTrailer.value(key));
+    trailer.dictionary.insert("Prev", pdfNumber(parser.startXRef()));
+    const int size = qMax(previousTrailer.value("Size").toInt(0), qMax(metadataReference.objectNumber, parser.highestObjectNumber()) + 1);
+
+    if (parser.hasXRefStream()) {
+        /// New cross-reference stream listing the metadata stream and itself,
+        /// entries made of type (1 byte), offset (4 bytes), generation (2 bytes)
+        const int xrefStreamNumber = size;
+        const auto xrefStreamEntry = [](qint64 offset, int generation) {
+            QByteArray entry(7, '\1');
+            for (int i = 0; i < 4; ++i)
+                entry[4 - i] = static_cast<char>((offset >> (8 * i)) & 0xff);
+            entry[5] = static_cast<char>((generation >> 8) & 0xff);
+            entry[6] = static_cast<char>(generation & 0xff);
+            return entry;
+        };
+        const QByteArray xrefStreamData = xrefStreamEntry(metadataOffset, metadataReference.generationNumber) + xrefStreamEntry(xrefOffset, 0);
+        trailer.dictionary.insert("Type", PDFQuickParser::Object(PDFQuickParser::Object::Name));
+        trailer.dictionary["Type"].data = QByteArrayLiteral("XRef");
+        trailer.dictionary.insert("Size", pdfNumber(size + 1));
+        PDFQuickParser::Object index(PDFQuickParser::Object::Array), widths(PDFQuickParser::Object::Array);
+        index.array << pdfNumber(metadataReference.objectNumber) << pdfNumber(1) << pdfNumber(xrefStreamNumber) << pdfNumber(1);
+        widths.array << pdfNumber(1) << pdfNumber(4) << pdfNumber(2);
+        trailer.dictionary.insert("Index", index);
+        trailer.dictionary.insert("W", widths);
+        trailer.dictionary.insert("Length", pdfNumber(xrefStreamData.size()));
+        update.append(QByteArray::number(xrefStreamNumber) + " 0 obj\n" + PDFQuickParser::toPdfSyntax(trailer) + "\nstream\n").append(xrefStreamData).append("\nendstream\nendobj\n");
+    } else {
+        trailer.dictionary.insert("Size", pdfNumber(size));
+        update.append("xref\n" + QByteArray::number(metadataReference.objectNumber) + " 1\n" + QByteArray::number(metadataOffset).rightJustified(10, '0') + ' ' + QByteArray::number(metadataReference.generationNumber).rightJustified(5, '0') + " n\r\n");
+        update.append("trailer\n" + PDFQuickParser::toPdfSyntax(trailer) + '\n');
+    }
+    update.append("startxref\n" + QByteArray::number(xrefOffset) + "\n%%EOF\n");
+
+    return pdfFile.write(update) == update.size();
+}
+
+/**
+ * Copy a file. On file systems supporting it, the copy shares
+ * its data blocks with the original instead of duplicating them.
+ */
+static bool cloneFile(const QString &source, const QString &destination) {
+    QFile::remove(destination);
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    QFile sourceFile(source), destinationFile(destination);
+    if (sourceFile.open(QFile::ReadOnly) && destinationFile.open(QFile::WriteOnly)) {
+        if (ioctl(destinationFile.handle(), FICLONE, sourceFile.handle()) == 0)
+            return true;
+        destinationFile.remove();
+    }
+#endif // defined(Q_OS_LINUX) && defined(FICLONE)
+    if (!QFile::copy(source, destination)) return false;
+    /// Copy has original's permissions, but must be writable
+    return QFile::setPermissions(destination, QFile::ReadOwner | QFile::WriteOwner);
+}
+
 bool FileAnalyzerPDF::downgradingPDFA(const QString &filename) {
     static const QString docscanConformanceFakerPrefix(QStringLiteral("docscan-conformance-faker"));
     if (m_downgradeToPDFA1b && !filename.contains(docscanConformanceFakerPrefix)) {
-        QFile pdfFile(filename);
-        if (pdfFile.open(QFile::ReadOnly)) {
-            QByteArray pdfData = pdfFile.readAll();
-            pdfFile.close();
-            bool doWrite = false;
-            QString errorText;
-            XMPPDFConformance originConformance = xmpNone;
-            const int pPart1 = pdfData.indexOf("<pdfaid:part>1</pdfaid:part>");
-            if (pPart1 > 0) {
-                const int pConformanceA = pdfData.indexOf("<pdfaid:conformance>A</pdfaid:conformance>", qMax(0, pPart1 - 1024));
-                if (pConformanceA > 0) {
-                    pdfData[pConformanceA + 20] = 'B';
-                    originConformance = xmpPDFA1a;
-                    doWrite = true;
-                }
-            } else {
-                const int pCombined = qMax(pdfData.indexOf(" pdfaid:part=\"1\" pdfaid:conformance=\"A\">"), pdfData.indexOf(" pdfaid:part='1' pdfaid:conformance='A'>"));
-                if (pCombined > 0) {
-                    pdfData[pCombined + 39] = 'B';
-                    originConformance = xmpPDFA1a;
-                    doWrite = true;
-                } else {
-                    const int pPart2 = pdfData.indexOf("<pdfaid:part>2</pdfaid:part>");
-                    if (pPart2 > 0) {
-                        pdfData[pPart2 + 12] = '1';
-                        doWrite = true;
-                        const int pConformanceA = pdfData.indexOf("<pdfaid:conformance>A</pdfaid:conformance>", qMax(0, pPart2 - 1024));
-                        const int pConformanceB = pdfData.indexOf("<pdfaid:conformance>B</pdfaid:conformance>", qMax(0, pPart2 - 1024));
-                        const int pConformanceU = pdfData.indexOf("<pdfaid:conformance>U</pdfaid:conformance>", qMax(0, pPart2 - 1024));
-                        if (pConformanceA > 0) {
-                            pdfData[pConformanceA + 20] = 'B';
-                            originConformance = xmpPDFA2a;
-                        } else if (pConformanceB > 0)
-                            originConformance = xmpPDFA2b;
-                        else if (pConformanceU > 0) {
-                            pdfData[pConformanceU + 20] = 'B';
-                            originConformance = xmpPDFA2u;
-                        }
-                    } else {
-                        const int pCombinedA = qMax(pdfData.indexOf(" pdfaid:part=\"2\" pdfaid:conformance=\"A\">"), pdfData.indexOf(" pdfaid:part='2' pdfaid:conformance='A'>"));
-                        const int pCombinedB = qMax(pdfData.indexOf(" pdfaid:part=\"2\" pdfaid:conformance=\"B\">"), pdfData.indexOf(" pdfaid:part='2' pdfaid:conformance='B'>"));
-                        const int pCombinedU = qMax(pdfData.indexOf(" pdfaid:part=\"2\" pdfaid:conformance=\"U\">"), pdfData.indexOf(" pdfaid:part='2' pdfaid:conformance='U'>"));
-                        if (pCombinedA > 0) {
-                            pdfData[pCombinedA + 14] = '1';
-                            pdfData[pCombinedA + 39] = 'B';
-                            originConformance = xmpPDFA2a;
-                            doWrite = true;
-                        } else if (pCombinedB > 0) {
-                            pdfData[pCombinedA + 14] = '1';
-                            originConformance = xmpPDFA2b;
-                            doWrite = true;
-                        } else if (pCombinedU > 0) {
-                            pdfData[pCombinedA + 14] = '1';
-                            pdfData[pCombinedA + 39] = 'B';
-                            originConformance = xmpPDFA2u;
-                            doWrite = true;
-                        } else {
-                            errorText = QStringLiteral("Failed to identify XMP PDFaid data structure: either non-existent or compressed/encoded by Filters");
-                            qWarning() << errorText;
-                        }
-                    }
-                }
-            }
-            if (doWrite) {
-                QString originalFilename = QFileInfo(m_aliasFilename.isEmpty() ? filename : m_aliasFilename).fileName().remove(QStringLiteral(".xz"));
-                if (!originalFilename.isEmpty() && originalFilename[0] == QLatin1Char('.')) originalFilename = originalFilename.mid(1); ///< remove leading dot
+        /// Only the XMP metadata stream gets read, located via cross-reference data,
+        /// and replaced in a copy of the file by appending an incremental update
+        PDFQuickParser parser(filename);
+        PDFQuickParser::Object metadataReference, metadataStream;
+        QByteArray xmpData;
+        QString errorText;
+        if (!parser.parse() || parser.wasReconstructed())
+            errorText = QStringLiteral("Failed to read cross-reference data, cannot update file incrementally");
+        else if (parser.isEncrypted())
+            errorText = QStringLiteral("Cannot update encrypted file");
+        else {
+            metadataReference = parser.catalog().value("Metadata");
+            metadataStream = parser.resolve(metadataReference);
+            bool ok = false;
+            if (metadataReference.type == PDFQuickParser::Object::Reference && metadataStream.type == PDFQuickParser::Object::Stream)
+                xmpData = parser.streamData(metadataStream, &ok);
+            if (!ok)
+                errorText = QStringLiteral("Failed to locate or decode XMP metadata stream");
+        }
+
+        XMPPDFConformance originConformance = xmpNone;
+        const bool doWrite = errorText.isEmpty() && downgradeXMPtoPDFA1b(xmpData, originConformance, errorText);
+        if (!errorText.isEmpty())
+            qWarning() << errorText << "for file" << filename;
+
+        if (doWrite) {
+            QString originalFilename = QFileInfo(m_aliasFilename.isEmpty() ? filename : m_aliasFilename).fileName().remove(QStringLiteral(".xz"));
+            if (!originalFilename.isEmpty() && originalFilename[0] == QLatin1Char('.')) originalFilename = originalFilename.mid(1); ///< remove leading dot
 #if QT_VERSION >= 0x050900
-                const QString writeToFilename = m_tempDirDowngradeToPDFA1b.filePath(docscanConformanceFakerPrefix + QStringLiteral("-") + originalFilename);
+            const QString writeToFilename = m_tempDirDowngradeToPDFA1b.filePath(docscanConformanceFakerPrefix + QStringLiteral("-") + originalFilename);
 #else // QT_VERSION >= 0x050900
-                const QString writeToFilename = m_tempDirDowngradeToPDFA1b.path() + QLatin1Char('/') + docscanConformanceFakerPrefix + QStringLiteral("-") + originalFilename;
+            const QString writeToFilename = m_tempDirDowngradeToPDFA1b.path() + QLatin1Char('/') + docscanConformanceFakerPrefix + QStringLiteral("-") + originalFilename;
 #endif // QT_VERSION >= 0x050900
-                QFile pdfFile(writeToFilename);
-                if (pdfFile.open(QFile::WriteOnly)) {
+            QFile pdfFile(writeToFilename);
+            if (cloneFile(filename, writeToFilename) && pdfFile.open(QFile::WriteOnly | QFile::Append)) {
+                const bool updateOk = appendXMPUpdate(pdfFile, parser, metadataReference, metadataStream, xmpData);
+                pdfFile.close();
+                if (updateOk) {
                     const QString originConformanceString = xmpPDFConformanceToString(originConformance);
                     const QString logText = QString(QStringLiteral("<downgradepdfa>\n<origin conformance=\"%3\">%1</origin>\n%4<destination conformance=\"PDF/A-1b\">%2</destination>\n</downgradepdfa>")).arg(DocScan::xmlify(filename), DocScan::xmlify(writeToFilename), DocScan::xmlify(originConformanceString), !m_aliasFilename.isEmpty() ? QStringLiteral("<alias>") + DocScan::xmlify(m_aliasFilename) + QStringLiteral("</alias>\n") : QString());
                     emit analysisReport(objectName(), logText);
 
-                    pdfFile.write(pdfData);
-                    pdfFile.close();
-
                     m_toAnalyzeFilename = writeToFilename;
                     m_aliasFilename.clear();
                     analyzeFile(writeToFilename);
@@ -782,44 +1210,112 @@ bool FileAnalyzerPDF::downgradingPDFA(const QString &filename) {
                     pdfFile.remove();
                     return true;
                 }
-            } else if (!errorText.isEmpty()) {
-                const QString logText = QString(QStringLiteral("<downgradepdfa><error>%1</error></downgradepdfa>")).arg(DocScan::xmlify(errorText));
-                emit analysisReport(objectName(), logText);
             }
+            pdfFile.remove();
+            errorText = QStringLiteral("Failed to write updated copy of file");
+        }
+        if (!errorText.isEmpty()) {
+            const QString logText = QString(QStringLiteral("<downgradepdfa><error>%1</error></downgradepdfa>")).arg(DocScan::xmlify(errorText));
+            emit analysisReport(objectName(), logText);
         }
     }
     return false;
 }
 
 void FileAnalyzerPDF::extractImages(QString &metaText, const QString &filename) {
-    static const QString pdfimagesBinary = QStandardPaths::findExecutable(QStringLiteral("pdfimages"));
-    if (pdfimagesBinary.isEmpty()) return; ///< no analysis without 'pdfimages' binary
-
-    QProcess pdfimages(this);
-    pdfimages.setWorkingDirectory(QStringLiteral("/tmp"));
-    const QString prefix = QStringLiteral("docscan-pdf-extractimages-") + QString::number(qHash<QString>(filename, 0));
-    const QStringList arguments = QStringList() << QStringLiteral("-j") << QStringLiteral("-jp2") << QStringLiteral("-ccitt") << QStringLiteral("-p") << QStringLiteral("-q") << filename << prefix;
-    pdfimages.start(pdfimagesBinary, arguments, QIODevice::ReadOnly);
-    if (!pdfimages.waitForStarted(twoMinutesInMillisec) || !pdfimages.waitForFinished(sixMinutesInMillisec))
-        qWarning() << "Failed to start pdfimages for file " << filename << " and " << pdfimages.program() << pdfimages.arguments().join(' ') << " in directory " << pdfimages.workingDirectory();
-
-    QDir dir(pdfimages.workingDirectory());
-    const QStringList f = QStringList() << prefix + QStringLiteral("-*");
-    const QStringList fileList = dir.entryList(f, QDir::Files, QDir::Name);
-    for (const QString &imageFilename : fileList) {
-        const QString absoluteImageFilename = pdfimages.workingDirectory() + QChar('/') + imageFilename;
-        const QString fileExtension = imageFilename.mid(imageFilename.lastIndexOf(QChar('.')));
-        if (blacklistedFileExtensions.contains(fileExtension)) {
-            /// Skip this type of files
-            QFile(absoluteImageFilename).remove();
-            continue;
+    PDFQuickParser parser(filename);
+    if (!parser.parse() || parser.isEncrypted()) return; ///< streams of encrypted documents cannot be decrypted
+
+    /// Walk the page tree to collect the resources of all pages,
+    /// which may be inherited from the pages' ancestors
+    QList<PDFQuickParser::Object> resourcesQueue;
+    QList<QPair<PDFQuickParser::Object, PDFQuickParser::Object> > pageTreeStack; ///< node and inherited resources
+    pageTreeStack.append(qMakePair(parser.catalog().value("Pages"), PDFQuickParser::Object()));
+    QSet<int> visitedObjects;
+    while (!pageTreeStack.isEmpty()) {
+        const QPair<PDFQuickParser::Object, PDFQuickParser::Object> item = pageTreeStack.takeLast();
+        if (item.first.type == PDFQuickParser::Object::Reference) {
+            /// Malformed page trees may contain cycles
+            if (visitedObjects.contains(item.first.objectNumber)) continue;
+            visitedObjects.insert(item.first.objectNumber);
         }
+        const PDFQuickParser::Object node = parser.resolve(item.first);
+        if (node.type != PDFQuickParser::Object::Dictionary) continue;
+        const PDFQuickParser::Object resources = node.value("Resources").isNull() ? item.second : node.value("Resources");
+        const PDFQuickParser::Object kids = parser.resolve(node.value("Kids"));
+        if (kids.type == PDFQuickParser::Object::Array) {
+            for (int i = kids.array.count() - 1; i >= 0; --i) ///< keep pages in order
+                pageTreeStack.append(qMakePair(kids.array[i], resources));
+        } else if (!resources.isNull())
+            resourcesQueue.append(resources);
+    }
 
-        const QString mimetypeAsAttribute = QString(QStringLiteral(" mimetype=\"%1\"")).arg(DocScan::guessMimetype(imageFilename));
+    /// Image XObjects as listed in resources, including those of form XObjects
+    QList<QPair<int, PDFQuickParser::Object> > images; ///< object number and image
+    QSet<int> visitedXObjects;
+    while (!resourcesQueue.isEmpty()) {
+        const PDFQuickParser::Object xobjects = parser.resolve(parser.resolve(resourcesQueue.takeFirst()).value("XObject"));
+        if (xobjects.type != PDFQuickParser::Object::Dictionary) continue;
+        for (const PDFQuickParser::Object &reference : xobjects.dictionary) {
+            /// Images are shared between pages by referring to the same object
+            if (reference.type != PDFQuickParser::Object::Reference || visitedXObjects.contains(reference.objectNumber)) continue;
+            visitedXObjects.insert(reference.objectNumber);
+            const PDFQuickParser::Object xobject = parser.resolve(reference);
+            if (xobject.type != PDFQuickParser::Object::Stream) continue;
+            const PDFQuickParser::Object subtype = parser.resolve(xobject.value("Subtype"));
+            if (subtype.isName("Image"))
+                images.append(qMakePair(reference.objectNumber, xobject));
+            else if (subtype.isName("Form") && !xobject.value("Resources").isNull())
+                resourcesQueue.append(xobject.value("Resources"));
+        }
+    }
+
+    int numExtractedImages = 0, numSkippedImagesCount = 0, numSkippedImagesSize = 0;
+    QSet<QString> temporaryFilenames;
+    for (const QPair<int, PDFQuickParser::Object> &objectNumberAndImage : const_cast<const QList<QPair<int, PDFQuickParser::Object> > &>(images)) {
+        const PDFQuickParser::Object &image = objectNumberAndImage.second;
+
+        /// Only images compressed as JPEG or JPEG 2000 as the only filter
+        /// can be passed on as they are, other images are skipped
+        const PDFQuickParser::Object filter = parser.resolve(image.value("Filter"));
+        const PDFQuickParser::Object singleFilter = filter.type == PDFQuickParser::Object::Array ? (filter.array.count() == 1 ? parser.resolve(filter.array.first()) : PDFQuickParser::Object()) : filter;
+        QString mimetype;
+        if (singleFilter.isName("DCTDecode") || singleFilter.isName("DCT"))
+            mimetype = QStringLiteral("image/jpeg");
+        else if (singleFilter.isName("JPXDecode"))
+            mimetype = QStringLiteral("image/jp2");
+        else
+            continue;
 
-        emit foundEmbeddedFile(absoluteImageFilename);
-        metaText.append(QStringLiteral("<embeddedfile") + mimetypeAsAttribute + QStringLiteral("><temporaryfilename>") + DocScan::xmlify(absoluteImageFilename) + QStringLiteral("</temporaryfilename></embeddedfile>"));
+        if (m_maxEmbeddedImages > 0 && numExtractedImages >= m_maxEmbeddedImages) {
+            ++numSkippedImagesCount;
+            continue;
+        }
+        /// Image data is not copied into memory, but streamed
+        /// from the memory-mapped PDF file into the temporary file
+        bool ok = false;
+        const QByteArray imageData = parser.rawStreamDataView(image, &ok);
+        if (!ok || imageData.isEmpty()) continue;
+        if (m_maxEmbeddedImageSize > 0 && imageData.size() > m_maxEmbeddedImageSize) {
+            ++numSkippedImagesSize;
+            continue;
+        }
+        QBuffer imageDevice;
+        imageDevice.setData(imageData);
+        if (!imageDevice.open(QBuffer::ReadOnly)) continue;
+
+        const QString temporaryFilename = deviceToTemporaryFile(imageDevice, mimetype);
+        /// Identical images stored in different objects share the same temporary file
+        if (temporaryFilename.isEmpty() || temporaryFilenames.contains(temporaryFilename)) continue;
+        temporaryFilenames.insert(temporaryFilename);
+        ++numExtractedImages;
+
+        metaText.append(QString(QStringLiteral("<embeddedfile mimetype=\"%1\" size=\"%2\" object=\"%3\"><temporaryfilename>")).arg(mimetype, QString::number(imageData.size()), QString::number(objectNumberAndImage.first)) + temporaryFilename /** no need for DocScan::xmlify */ + QStringLiteral("</temporaryfilename></embeddedfile>\n"));
+        emit foundEmbeddedFile(temporaryFilename);
     }
+
+    if (numSkippedImagesCount > 0 || numSkippedImagesSize > 0)
+        metaText.append(QString(QStringLiteral("<skippedimages toomany=\"%1\" toolarge=\"%2\" />\n")).arg(numSkippedImagesCount).arg(numSkippedImagesSize));
 }
 
 void FileAnalyzerPDF::extractEmbeddedFiles(QString &metaText, Poppler::Document *popplerDocument) {
@@ -856,17 +1352,93 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
 
     m_isAlive = true;
     const qint64 startTime = QDateTime::currentMSecsSinceEpoch();
+    QElapsedTimer totalTimer, stageTimer;
+    totalTimer.start();
+
+    if (m_quickAnalysis) {
+        stageTimer.start();
+        const bool quickAnalysisOk = quickAnalysis(filename);
+        recordLatency(QStringLiteral("quickparse"), stageTimer.nsecsElapsed());
+        if (quickAnalysisOk) {
+            recordLatency(QStringLiteral("total"), totalTimer.nsecsElapsed());
+            m_isAlive = false;
+            return;
+        }
+        /// Otherwise, e.g. for encrypted files, fall back to the full analysis
+    }
 
     /// External programs should be both CPU and I/O 'nice'
     static const QStringList defaultArgumentsForNice = QStringList() << QStringLiteral("-n") << QStringLiteral("17") << QStringLiteral("ionice") << QStringLiteral("-c") << QStringLiteral("3");
 
     QString logText, metaText;
     metaText.reserve(16 * 1024 * 1024); ///< 16 MiB reserved
+    stageTimer.start();
     const PDFVersion pdfVersion = pdfVersionAnalysis(filename);
+    recordLatency(QStringLiteral("versionsniff"), stageTimer.nsecsElapsed());
+    stageTimer.restart();
     const XMPPDFConformance xmpPDFConformance = xmpAnalysis(filename, pdfVersion, metaText);
+    recordLatency(QStringLiteral("xmp"), stageTimer.nsecsElapsed());
+
+    /// Structured counterpart to the XML report, populated along the way
+    QJsonObject record, validatorsRecord;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("mimetype"), QStringLiteral("application/pdf"));
+    if (xmpPDFConformance > xmpNone)
+        record.insert(QStringLiteral("xmppdfconformance"), xmpPDFConformanceToString(xmpPDFConformance));
 
     /// While external programs run, analyze PDF file using the Poppler library
-    const bool popplerWrapperOk = popplerAnalysis(filename, logText, metaText);
+    stageTimer.restart();
+    bool popplerWrapperOk = false;
+    PopplerWorkerPool::Result popplerWorkerResult;
+    if (m_popplerWorkerPool != nullptr) {
+        /// Let a sandboxed worker process use Poppler, so that
+        /// a pathological file cannot stall or crash this process
+        QJsonObject request;
+        request.insert(QStringLiteral("filename"), filename);
+        request.insert(QStringLiteral("textextraction"), static_cast<int>(textExtraction));
+        request.insert(QStringLiteral("textextractionmaxpages"), textExtractionMaxPages);
+        request.insert(QStringLiteral("textextractionmaxchars"), textExtractionMaxCharacters);
+        request.insert(QStringLiteral("embeddedfiles"), enableEmbeddedFilesAnalysis);
+        request.insert(QStringLiteral("parallelpagethreshold"), m_parallelPageThreshold);
+        popplerWorkerResult = m_popplerWorkerPool->analyze(request);
+    }
+    if (popplerWorkerResult.status == PopplerWorkerPool::Unavailable)
+        /// No worker pool configured or no worker could be started
+        popplerWrapperOk = popplerAnalysis(filename, logText, metaText, record);
+    /// Recorded exactly once, whether Poppler ran in a worker or in this process
+    recordLatency(QStringLiteral("poppler"), stageTimer.nsecsElapsed());
+    switch (popplerWorkerResult.status) {
+    case PopplerWorkerPool::Ok:
+    case PopplerWorkerPool::Failed:
+        popplerWrapperOk = popplerWorkerResult.status == PopplerWorkerPool::Ok;
+        logText.append(popplerWorkerResult.logText);
+        metaText.append(popplerWorkerResult.metaText);
+        for (QJsonObject::ConstIterator it = popplerWorkerResult.record.constBegin(); it != popplerWorkerResult.record.constEnd(); ++it)
+            record.insert(it.key(), it.value());
+        for (const QString &embeddedFile : const_cast<const QStringList &>(popplerWorkerResult.embeddedFiles))
+            emit foundEmbeddedFile(embeddedFile);
+        break;
+    case PopplerWorkerPool::Timeout:
+    case PopplerWorkerPool::Crashed:
+    case PopplerWorkerPool::MemoryLimit: {
+        /// Give up on this file, without running any validators
+        const QString message = popplerWorkerResult.status == PopplerWorkerPool::Timeout ? QString() : (popplerWorkerResult.status == PopplerWorkerPool::MemoryLimit ? QStringLiteral("poppler-memory-limit") : QStringLiteral("poppler-worker-crashed"));
+        const QString status = popplerWorkerResult.status == PopplerWorkerPool::Timeout ? QStringLiteral("timeout") : QStringLiteral("error");
+        const qint64 fileSize = QFileInfo(filename).size();
+        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"%2\"%3 time=\"%4\"><meta><file size=\"%5\" /></meta></fileanalysis>\n")).arg(DocScan::xmlify(filename), status, message.isEmpty() ? QString() : QString(QStringLiteral(" message=\"%1\"")).arg(message), QString::number(QDateTime::currentMSecsSinceEpoch() - startTime)).arg(fileSize));
+        record.insert(QStringLiteral("status"), status);
+        if (!message.isEmpty())
+            record.insert(QStringLiteral("message"), message);
+        record.insert(QStringLiteral("size"), fileSize);
+        emit analysisRecord(objectName(), record);
+        recordLatency(QStringLiteral("total"), totalTimer.nsecsElapsed());
+        m_isAlive = false;
+        return;
+    }
+    case PopplerWorkerPool::Unavailable:
+        /// Already analyzed in this process, see above
+        break;
+    }
 
     /// If configured to do so, downgrade a PDF/A file that follows a PDF/A standard
     /// better than PDF/A-1b down to just PDF/A-1b by changing its metadata.
@@ -875,7 +1447,10 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
     /// unless the downgrading itself fails (e.g. because the metadata could not be
     /// changed).
     if (m_downgradeToPDFA1b && xmpPDFConformance > xmpPDFA1b) {
-        if (downgradingPDFA(filename)) {
+        stageTimer.restart();
+        const bool downgradingOk = downgradingPDFA(filename);
+        recordLatency(QStringLiteral("downgrade"), stageTimer.nsecsElapsed());
+        if (downgradingOk) {
             if (!metaText.isEmpty()) {
                 metaText.squeeze();
                 logText.append(QStringLiteral("<meta>\n")).append(metaText).append(QStringLiteral("</meta>\n"));
@@ -884,6 +1459,9 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
             logText.prepend(QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename)));
             logText.append(QStringLiteral("</fileanalysis>\n"));
             emit analysisReport(objectName(), logText);
+            record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+            record.insert(QStringLiteral("downgradedtopdfa1b"), true);
+            emit analysisRecord(objectName(), record);
 
             return;
         }
@@ -894,108 +1472,62 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
     /// by XMP metadata regarding PDF/A conformance part and level.
     const bool doRunValidators = !m_validateOnlyPDFAfiles || xmpPDFConformance > xmpNone;
 
-    QTemporaryDir veraPDFTemporaryDirectory(QDir::tempPath() + QStringLiteral("/.docscan-verapdf-"));
-    bool veraPDFStartedRun = false;
-    bool veraPDFIsPDFA1B = false, veraPDFIsPDFA1A = false;
-    QByteArray veraPDFStandardOutputData, veraPDFStandardErrorData;
-    QString veraPDFStandardOutput, veraPDFStandardError;
-    QString veraPDFvalidationFlavor;
-    long veraPDFfilesize = 0;
-    int veraPDFExitCode = INT_MIN;
-    QProcess veraPDF(this);
-    veraPDF.setWorkingDirectory(veraPDFTemporaryDirectory.path());
-    connect(&veraPDF, &QProcess::readyReadStandardOutput, [&veraPDF, &veraPDFStandardOutputData]() {
-        const QByteArray d(veraPDF.readAllStandardOutput());
-        veraPDFStandardOutputData.append(d);
-    });
-    connect(&veraPDF, &QProcess::readyReadStandardError, [&veraPDF, &veraPDFStandardErrorData]() {
-        const QByteArray d(veraPDF.readAllStandardError());
-        veraPDFStandardErrorData.append(d);
-    });
-    if (doRunValidators && !m_veraPDFcliTool.isEmpty()) {
-        /// Chooses built-in Validation Profile flavour, e.g. '1b'
-        veraPDFvalidationFlavor = ((xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b ? QStringLiteral("1b") : ((xmpPDFConformance == xmpPDFA1a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1a) ? QStringLiteral("1a") : ((xmpPDFConformance == xmpPDFA2a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2a ? QStringLiteral("2a") : ((xmpPDFConformance == xmpPDFA2b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2b ? QStringLiteral("2b") : ((xmpPDFConformance == xmpPDFA2u && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2u ? QStringLiteral("2u") : QStringLiteral("0")))));
-        const QStringList arguments = QStringList(defaultArgumentsForNice) << m_veraPDFcliTool << QStringLiteral("-x") << QStringLiteral("-f") << veraPDFvalidationFlavor << QStringLiteral("--maxfailures") << QStringLiteral("2048") << QStringLiteral("--verbose") << QStringLiteral("--format") << QStringLiteral("xml") << filename;
-        veraPDF.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
-        veraPDFStartedRun = veraPDF.waitForStarted(twoMinutesInMillisec);
-        if (!veraPDFStartedRun)
-            qWarning() << "Failed to start veraPDF for file " << filename << " and " << veraPDF.program() << veraPDF.arguments().join(' ') << " in directory " << veraPDF.workingDirectory();
-    }
-
-    bool threeHeightsPDFValidatorStartedRun = false;
-    int  threeHeightsPDFValidatorExitCode = INT_MIN;
-    QString threeHeightsPDFValidatorCLValue;
-    QByteArray threeHeightsPDFValidatorStandardOutputData, threeHeightsPDFValidatorStandardErrorData;
-    QString threeHeightsPDFValidatorStandardOutput, threeHeightsPDFValidatorStandardError;
-    QProcess threeHeightsPDFValidatorProcess(this);
-    connect(&threeHeightsPDFValidatorProcess, &QProcess::readyReadStandardOutput, [&threeHeightsPDFValidatorProcess, &threeHeightsPDFValidatorStandardOutputData]() {
-        const QByteArray d(threeHeightsPDFValidatorProcess.readAllStandardOutput());
-        threeHeightsPDFValidatorStandardOutputData.append(d);
-    });
-    connect(&threeHeightsPDFValidatorProcess, &QProcess::readyReadStandardError, [&threeHeightsPDFValidatorProcess, &threeHeightsPDFValidatorStandardErrorData]() {
-        const QByteArray d(threeHeightsPDFValidatorProcess.readAllStandardError());
-        threeHeightsPDFValidatorStandardErrorData.append(d);
-    });
-    if (doRunValidators && !m_threeHeightsValidatorShellCLI.isEmpty() && !m_threeHeightsValidatorLicenseKey.isEmpty()) {
-        threeHeightsPDFValidatorCLValue = (xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b ? QStringLiteral("pdfa-1b") : ((xmpPDFConformance == xmpPDFA1a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1a ? QStringLiteral("pdfa-1a") : ((xmpPDFConformance == xmpPDFA2a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2a ? QStringLiteral("pdfa-2a") : ((xmpPDFConformance == xmpPDFA2b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2b  ? QStringLiteral("pdfa-2b") : ((xmpPDFConformance == xmpPDFA2u && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2u  ? QStringLiteral("pdfa-2u") : QStringLiteral("ccl")))));
-        const QStringList arguments = QStringList() << defaultArgumentsForNice << m_threeHeightsValidatorShellCLI << QStringLiteral("-lk") << m_threeHeightsValidatorLicenseKey << QStringLiteral("-cl") << threeHeightsPDFValidatorCLValue << QStringLiteral("-rd") << QStringLiteral("-rl") << QStringLiteral("3") << QStringLiteral("-v") << filename;
-        threeHeightsPDFValidatorProcess.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
-        threeHeightsPDFValidatorStartedRun = threeHeightsPDFValidatorProcess.waitForStarted(oneMinuteInMillisec);
-        if (!threeHeightsPDFValidatorStartedRun)
-            qWarning() << "Failed to start 3-Heights PDF Validator Shell for file " << filename << " and " << threeHeightsPDFValidatorProcess.program() << threeHeightsPDFValidatorProcess.arguments().join(' ') << " in directory " << threeHeightsPDFValidatorProcess.workingDirectory();
-    }
-
-    bool callasPdfAPilotStartedRun1 = false, callasPdfAPilotStartedRun2 = false;
-    int callasPdfAPilotExitCode = INT_MIN;
-    int callasPdfAPilotCountErrors = -1;
-    int callasPdfAPilotCountWarnings = -1;
-    char callasPdfAPilotPDFA1letter = '\0';
-    QString callasPdfAPilotStandardOutput, callasPdfAPilotStandardError;
-    QByteArray callasPdfAPilotStandardOutputData, callasPdfAPilotStandardErrorData;
-    QProcess callasPdfAPilot(this);
-    connect(&callasPdfAPilot, &QProcess::readyReadStandardOutput, [&callasPdfAPilot, &callasPdfAPilotStandardOutputData]() {
-        const QByteArray d(callasPdfAPilot.readAllStandardOutput());
-        callasPdfAPilotStandardOutputData.append(d);
-    });
-    connect(&callasPdfAPilot, &QProcess::readyReadStandardError, [&callasPdfAPilot, &callasPdfAPilotStandardErrorData]() {
-        const QByteArray d(callasPdfAPilot.readAllStandardError());
-        callasPdfAPilotStandardErrorData.append(d);
-    });
-    if (doRunValidators && !m_callasPdfAPilotCLI.isEmpty()) {
-        const QStringList arguments = QStringList() << defaultArgumentsForNice << m_callasPdfAPilotCLI << QStringLiteral("--quickpdfinfo") << filename;
-        callasPdfAPilot.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
-        callasPdfAPilotStartedRun1 = callasPdfAPilot.waitForStarted(oneMinuteInMillisec);
-        if (!callasPdfAPilotStartedRun1)
-            qWarning() << "Failed to start callas PDF/A Pilot for file " << filename << " and " << callasPdfAPilot.program() << callasPdfAPilot.arguments().join(' ') << " in directory " << callasPdfAPilot.workingDirectory();
-    }
-
-    bool qoppaJPDFPreflightStarted = false;
-    int  qoppaJPDFPreflightExitCode = INT_MIN;
-    QByteArray qoppaJPDFPreflightStandardOutputData, qoppaJPDFPreflightStandardErrorData;
-    QString qoppaJPDFPreflightStandardOutput, qoppaJPDFPreflightStandardError;
-    QString qoppaJPDFPreflightFlavor;
-    QProcess qoppaJPDFPreflightProcess(this);
-    qoppaJPDFPreflightProcess.setWorkingDirectory(m_qoppaJPDFPreflightDirectory);
-    connect(&qoppaJPDFPreflightProcess, &QProcess::readyReadStandardOutput, [&qoppaJPDFPreflightProcess, &qoppaJPDFPreflightStandardOutputData]() {
-        const QByteArray d(qoppaJPDFPreflightProcess.readAllStandardOutput());
-        qoppaJPDFPreflightStandardOutputData.append(d);
-    });
-    connect(&qoppaJPDFPreflightProcess, &QProcess::readyReadStandardError, [&qoppaJPDFPreflightProcess, &qoppaJPDFPreflightStandardErrorData]() {
-        const QByteArray d(qoppaJPDFPreflightProcess.readAllStandardError());
-        qoppaJPDFPreflightStandardErrorData.append(d);
-    });
-    if (doRunValidators && !m_qoppaJPDFPreflightDirectory.isEmpty()) {
-        qoppaJPDFPreflightFlavor = ((xmpPDFConformance == xmpPDFA1a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1a) ?  QStringLiteral("PDFA1a") : (((xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b) ?  QStringLiteral("PDFA1b") : (((xmpPDFConformance == xmpPDFA2a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2a) ?  QStringLiteral("PDFA2a") : (((xmpPDFConformance == xmpPDFA2b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2b) ?  QStringLiteral("PDFA2b") : (((xmpPDFConformance == xmpPDFA3a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA3a) ?  QStringLiteral("PDFA3a") : ((xmpPDFConformance == xmpPDFA3b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA3b) ?  QStringLiteral("PDFA3b") : (((xmpPDFConformance == xmpPDFA2u && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2u) ?  QStringLiteral("PDFA2u") : QStringLiteral("PDFA1b"))))));
-        const QStringList arguments = QStringList() << defaultArgumentsForNice << (m_qoppaJPDFPreflightDirectory + QStringLiteral("/Validate") + qoppaJPDFPreflightFlavor + QStringLiteral(".sh")) << filename;
-        qoppaJPDFPreflightProcess.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
-        qoppaJPDFPreflightStarted = qoppaJPDFPreflightProcess.waitForStarted(oneMinuteInMillisec);
-        if (!qoppaJPDFPreflightStarted)
-            qWarning() << "Failed to start Qoppa jPDFPreflight for file " << filename << " and " << qoppaJPDFPreflightProcess.program() << qoppaJPDFPreflightProcess.arguments().join(' ') << " in directory " << qoppaJPDFPreflightProcess.workingDirectory();
-    }
+    /// File size and number of pages determine validators' time limits,
+    /// which are measured from each validator's start
+    const qint64 fileSize = QFileInfo(filename).size();
+    const int numPages = record.value(QStringLiteral("numpages")).toInt();
+
+    /// Depending on the validator policy, validators are run in stages,
+    /// cheap ones first: jHove and PDFBox, then veraPDF and callas PDF/A Pilot,
+    /// finally 3-Heights and Qoppa. Once the validators run so far have reached
+    /// a decision, validators of later stages are skipped.
+    const bool stagedValidators = doRunValidators && m_validatorPolicy != validatorPolicyAll;
+    int validatorsValidVerdicts = 0, validatorsInvalidVerdicts = 0;
+    bool validatorsDefinitiveFailure = false;
+    QString validatorsSkipReason; ///< empty as long as no validator is to be skipped
+    QStringList validatorsSkipped;
+    const auto validatorPolicyDecision = [&]() -> QString {
+        if (validatorsDefinitiveFailure)
+            return QStringLiteral("failure");
+        switch (m_validatorPolicy) {
+        case validatorPolicyFailFast:
+            return validatorsInvalidVerdicts > 0 ? QStringLiteral("failure") : QString();
+        case validatorPolicyQuorum:
+            return validatorsValidVerdicts >= m_validatorQuorum || validatorsInvalidVerdicts >= m_validatorQuorum ? QStringLiteral("quorum") : QString();
+        default:
+            return QString();
+        }
+    };
+
+    /// Validators run concurrently but are waited for one after another.
+    /// While waiting for one validator, all other running validators get
+    /// serviced as well, so that their output pipes do not fill up and
+    /// their termination is noticed (and its time taken) right away.
+    QVector<QProcess *> validatorProcesses;
+    const auto waitForValidator = [&validatorProcesses](QProcess *process, int timeLimit) {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        while (process->state() != QProcess::NotRunning) {
+            const int remaining = timeLimit - static_cast<int>(waitTimer.elapsed());
+            if (remaining <= 0) return false;
+            for (QProcess *otherProcess : validatorProcesses)
+                if (otherProcess != process && otherProcess->state() == QProcess::Running)
+                    otherProcess->waitForReadyRead(0);
+            process->waitForFinished(qMin(remaining, validatorPollIntervalInMillisec));
+        }
+        return true;
+    };
 
+    QElapsedTimer jhoveTimer;
+    jhoveTimer.start();
     QProcess *jhoveProcess = doRunValidators ? launchJHove(this, JHovePDF, filename) : nullptr;
     QByteArray jhoveStandardOutputData, jhoveStandardErrorData;
+    qint64 jhoveRuntime = -1;
     if (jhoveProcess != nullptr) {
+        validatorProcesses.append(jhoveProcess);
+        connect(jhoveProcess, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&jhoveTimer, &jhoveRuntime]() {
+            jhoveRuntime = jhoveTimer.elapsed();
+        });
         connect(jhoveProcess, &QProcess::readyReadStandardOutput, [jhoveProcess, &jhoveStandardOutputData]() {
             const QByteArray d(jhoveProcess->readAllStandardOutput());
             jhoveStandardOutputData.append(d);
@@ -1006,94 +1538,262 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
         });
     }
     const bool jhoveStarted = jhoveProcess != nullptr && jhoveProcess->waitForStarted(oneMinuteInMillisec);
+    if (jhoveProcess != nullptr)
+        recordLatency(QStringLiteral("jhove-start"), jhoveTimer.nsecsElapsed());
     if (jhoveProcess != nullptr && !jhoveStarted)
         qWarning() << "Failed to start jhove for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
 
+    bool jhoveIsPDF = false;
+    bool jhovePDFWellformed = false, jhovePDFValid = false, jhoveSucceeded = false;
+    QString jhovePDFversion;
+    QString jhovePDFprofile;
+    int jhoveExitCode = INT_MIN;
+    QString jhoveStandardOutput;
+    QString jhoveStandardError;
+
+    bool jhoveFinished = false;
+    const auto waitForJHove = [&]() {
+        if (!doRunValidators || !jhoveStarted || jhoveFinished) return;
+        jhoveFinished = true;
+        const int jhoveTimeLimit = validatorTimeLimit(QStringLiteral("jhove"), fileSize, numPages, sixtyMinutesInMillisec);
+        const bool jhoveTimeExceeded = !waitForValidator(jhoveProcess, qMax(oneSecondInMillisec, jhoveTimeLimit - static_cast<int>(jhoveTimer.elapsed())));
+        recordLatency(QStringLiteral("jhove-run"), jhoveTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("jhove"), fileSize, numPages, jhoveTimeExceeded ? jhoveTimer.elapsed() : jhoveRuntime, jhoveTimeExceeded);
+        if (jhoveTimeExceeded)
+            qWarning() << "Waiting for jHove failed or exceeded time limit (" << (jhoveTimeLimit / 1000) << "s) for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
+        jhoveExitCode = jhoveProcess->exitCode();
+        jhoveStandardOutput = QString::fromUtf8(jhoveStandardOutputData.constData());
+        jhoveStandardError = QString::fromUtf8(jhoveStandardErrorData.constData());
+        if (!jhoveTimeExceeded && jhoveExitCode == 0 && !jhoveStandardOutput.isEmpty()) {
+            jhoveSucceeded = true;
+            jhoveIsPDF = jhoveStandardOutput.contains(QStringLiteral("Format: PDF")) && !jhoveStandardOutput.contains(QStringLiteral("ErrorMessage:"));
+            static const QRegExp pdfStatusRegExp(QStringLiteral("\\bStatus: ([-.0-9a-zA-Z ]+)"));
+            if (pdfStatusRegExp.indexIn(jhoveStandardOutput) >= 0) {
+                jhovePDFWellformed = pdfStatusRegExp.cap(1).startsWith(QStringLiteral("Well-Formed"), Qt::CaseInsensitive);
+                jhovePDFValid = pdfStatusRegExp.cap(1).endsWith(QStringLiteral("and valid"));
+            }
+            static const QRegExp pdfVersionRegExp(QStringLiteral("\\bVersion: ([.0-9]+)"));
+            jhovePDFversion = pdfVersionRegExp.indexIn(jhoveStandardOutput) >= 0 ? pdfVersionRegExp.cap(1) : QString();
+            static const QRegExp pdfProfileRegExp(QStringLiteral("\\bProfile: ([-.,/0-9a-zA-Z ]+)"));
+            jhovePDFprofile = pdfProfileRegExp.indexIn(jhoveStandardOutput) >= 0 ? pdfProfileRegExp.cap(1) : QString();
+        } else {
+            qWarning() << "Execution of jHove failed for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory() << ": " << jhoveStandardError;
+            jhoveStandardOutput.prepend(QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\" />\n")).arg(jhoveExitCode).arg(jhoveTimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(jhoveTimeLimit / 1000));
+        }
+
+        if (jhoveTimeExceeded)
+            jhoveProcess->kill();
+    };
+
     bool pdfboxValidatorStarted = false;
-    bool pdfboxValidatorValidPdf = false;
+    bool pdfboxValidatorValidPdf = false, pdfboxValidatorSucceeded = false;
     int pdfboxValidatorExitCode = INT_MIN;
+    QElapsedTimer pdfboxValidatorTimer;
     QProcess pdfboxValidator(this);
     QByteArray pdfboxValidatorStandardOutputData, pdfboxValidatorStandardErrorData;
     QString pdfboxValidatorStandardOutput, pdfboxValidatorStandardError;
-    connect(&pdfboxValidator, &QProcess::readyReadStandardOutput, [&pdfboxValidator, &pdfboxValidatorStandardOutputData]() {
+    ValidatorOutputSummary pdfboxValidatorSummary(ValidatorOutputSummary::PdfBox, m_validatorOutputMaxFailures);
+    pdfboxValidatorSummary.setWatchedPhrase(QByteArrayLiteral("is a valid PDF/A-1b file"));
+    connect(&pdfboxValidator, &QProcess::readyReadStandardOutput, [this, &pdfboxValidator, &pdfboxValidatorStandardOutputData, &pdfboxValidatorSummary]() {
         const QByteArray d(pdfboxValidator.readAllStandardOutput());
-        pdfboxValidatorStandardOutputData.append(d);
+        pdfboxValidatorSummary.addData(d);
+        if (!m_summarizeValidatorOutput)
+            pdfboxValidatorStandardOutputData.append(d);
     });
     connect(&pdfboxValidator, &QProcess::readyReadStandardError, [&pdfboxValidator, &pdfboxValidatorStandardErrorData]() {
         const QByteArray d(pdfboxValidator.readAllStandardError());
         pdfboxValidatorStandardErrorData.append(d);
     });
+    qint64 pdfboxValidatorRuntime = -1;
+    connect(&pdfboxValidator, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&pdfboxValidatorTimer, &pdfboxValidatorRuntime]() {
+        pdfboxValidatorRuntime = pdfboxValidatorTimer.elapsed();
+    });
     if (doRunValidators && !m_pdfboxValidatorJavaClass.isEmpty()) {
         static const QFileInfo fi(m_pdfboxValidatorJavaClass);
         static const QDir dir = fi.dir();
         static const QStringList jarFiles = dir.entryList(QStringList() << QStringLiteral("*.jar"), QDir::Files, QDir::Name);
         pdfboxValidator.setWorkingDirectory(dir.path());
         const QStringList arguments = QStringList(defaultArgumentsForNice) << QStringLiteral("java") << QStringLiteral("-cp") << QStringLiteral(".:") + jarFiles.join(':') << fi.fileName().remove(QStringLiteral(".class")) << QStringLiteral("--xml") << filename;
+        pdfboxValidatorTimer.start();
         pdfboxValidator.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
         pdfboxValidatorStarted = pdfboxValidator.waitForStarted(oneMinuteInMillisec);
+        recordLatency(QStringLiteral("pdfbox-start"), pdfboxValidatorTimer.nsecsElapsed());
+        if (pdfboxValidatorStarted)
+            validatorProcesses.append(&pdfboxValidator);
         if (!pdfboxValidatorStarted)
             qWarning() << "Failed to start pdfbox Validator for file " << filename << " and " << pdfboxValidator.program() << pdfboxValidator.arguments().join(' ') << " in directory " << pdfboxValidator.workingDirectory() << ": " << QString::fromUtf8(pdfboxValidatorStandardErrorData.constData());
     }
 
-    bool adobePreflightReportAnalysisOk = false;
-    if (doRunValidators) {
-        /// If for the current filename an alias filename was given,
-        /// use the alias filename to locate the Adobe Preflight report.
-        QString relevantPDFfilename = m_toAnalyzeFilename.isEmpty() ? filename : m_toAnalyzeFilename;
-        if (filename == m_toAnalyzeFilename && !m_aliasFilename.isEmpty()) relevantPDFfilename = m_aliasFilename;
+    bool pdfboxValidatorFinished = false;
+    const auto waitForPdfBoxValidator = [&]() {
+        if (!doRunValidators || !pdfboxValidatorStarted || pdfboxValidatorFinished) return;
+        pdfboxValidatorFinished = true;
+        const int pdfboxValidatorTimeLimit = validatorTimeLimit(QStringLiteral("pdfbox"), fileSize, numPages, sixtyMinutesInMillisec);
+        const bool pdfboxValidatorTimeExceeded = !waitForValidator(&pdfboxValidator, qMax(oneSecondInMillisec, pdfboxValidatorTimeLimit - static_cast<int>(pdfboxValidatorTimer.elapsed())));
+        recordLatency(QStringLiteral("pdfbox-run"), pdfboxValidatorTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("pdfbox"), fileSize, numPages, pdfboxValidatorTimeExceeded ? pdfboxValidatorTimer.elapsed() : pdfboxValidatorRuntime, pdfboxValidatorTimeExceeded);
+        if (pdfboxValidatorTimeExceeded)
+            qWarning() << "Waiting for pdfbox Validator failed or exceeded time limit (" << (pdfboxValidatorTimeLimit / 1000) << "s) for file " << filename << " and " << pdfboxValidator.program() << pdfboxValidator.arguments().join(' ') << " in directory " << pdfboxValidator.workingDirectory();
+        pdfboxValidatorExitCode =   pdfboxValidator.exitCode();
+        pdfboxValidatorStandardOutput = m_summarizeValidatorOutput ? pdfboxValidatorSummary.toXml() : QString::fromUtf8(DocScan::removeBinaryGarbage(pdfboxValidatorStandardOutputData).constData()).trimmed();
+        pdfboxValidatorStandardError = QString::fromUtf8(DocScan::removeBinaryGarbage(pdfboxValidatorStandardErrorData).constData()).trimmed();
+        if (!pdfboxValidatorTimeExceeded && pdfboxValidatorExitCode == 0 && !pdfboxValidatorSummary.isEmpty()) {
+            pdfboxValidatorSucceeded = true;
+            pdfboxValidatorValidPdf = pdfboxValidatorSummary.watchedPhraseSeen();
+        } else {
+            qWarning() << "Execution of pdfbox Validator failed for file " << filename << " and " << pdfboxValidator.program() << pdfboxValidator.arguments().join(' ') << " in directory " << pdfboxValidator.workingDirectory() << ": " << pdfboxValidatorStandardError;
+            pdfboxValidatorStandardOutput.prepend(QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\" />\n")).arg(pdfboxValidatorExitCode).arg(pdfboxValidatorTimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(pdfboxValidatorTimeLimit / 1000));
+        }
 
-        adobePreflightReportAnalysisOk = adobePreflightReportAnalysis(relevantPDFfilename, metaText);
-        if (!adobePreflightReportAnalysisOk)
-            metaText.append(QStringLiteral("<adobepreflight status=\"failed\"><error>Failed to find or evaluate Adobe Preflight XML report file</error></adobepreflight>\n"));
-    } else
-        metaText.append(QStringLiteral("<adobepreflight><info>Adobe Preflight not configured to run</info></adobepreflight>\n"));
+        if (pdfboxValidatorTimeExceeded)
+            pdfboxValidator.kill();
+    };
+
+    if (stagedValidators) {
+        waitForJHove();
+        waitForPdfBoxValidator();
+        /// A file jHove does not consider to be well-formed will not pass any other validator
+        if (jhoveSucceeded && !jhovePDFWellformed)
+            validatorsDefinitiveFailure = true;
+        /// PDFBox's verdict is about PDF/A-1b only
+        if (pdfboxValidatorSucceeded && ((xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b))
+            ++(pdfboxValidatorValidPdf ? validatorsValidVerdicts : validatorsInvalidVerdicts);
+        validatorsSkipReason = validatorPolicyDecision();
+        if (!validatorsSkipReason.isEmpty()) {
+            if (!m_veraPDFcliTool.isEmpty()) validatorsSkipped << QStringLiteral("verapdf");
+            if (!m_callasPdfAPilotCLI.isEmpty()) validatorsSkipped << QStringLiteral("callaspdfapilot");
+            if (!m_threeHeightsValidatorShellCLI.isEmpty() && !m_threeHeightsValidatorLicenseKey.isEmpty()) validatorsSkipped << QStringLiteral("threeheightspdfvalidator");
+            if (!m_qoppaJPDFPreflightDirectory.isEmpty()) validatorsSkipped << QStringLiteral("qoppapdfpreflight");
+        }
+    }
+
+    QTemporaryDir veraPDFTemporaryDirectory(QDir::tempPath() + QStringLiteral("/.docscan-verapdf-"));
+    bool veraPDFStartedRun = false;
+    bool veraPDFIsPDFA1B = false, veraPDFIsPDFA1A = false;
+    QByteArray veraPDFStandardOutputData, veraPDFStandardErrorData;
+    QString veraPDFStandardOutput, veraPDFStandardError;
+    QString veraPDFvalidationFlavor;
+    bool veraPDFHasVerdict = false, veraPDFIsCompliant = false;
+    long veraPDFfilesize = 0;
+    int veraPDFExitCode = INT_MIN;
+    QElapsedTimer veraPDFTimer;
+    QProcess veraPDF(this);
+    veraPDF.setWorkingDirectory(veraPDFTemporaryDirectory.path());
+    ValidatorOutputSummary veraPDFSummary(ValidatorOutputSummary::VeraPDF, m_validatorOutputMaxFailures);
+    connect(&veraPDF, &QProcess::readyReadStandardOutput, [this, &veraPDF, &veraPDFStandardOutputData, &veraPDFSummary]() {
+        const QByteArray d(veraPDF.readAllStandardOutput());
+        /// Output is parsed as it arrives, and only kept in full if requested
+        veraPDFSummary.addData(d);
+        if (!m_summarizeValidatorOutput)
+            veraPDFStandardOutputData.append(d);
+    });
+    connect(&veraPDF, &QProcess::readyReadStandardError, [&veraPDF, &veraPDFStandardErrorData]() {
+        const QByteArray d(veraPDF.readAllStandardError());
+        veraPDFStandardErrorData.append(d);
+    });
+    qint64 veraPDFRuntime = -1;
+    connect(&veraPDF, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&veraPDFTimer, &veraPDFRuntime]() {
+        veraPDFRuntime = veraPDFTimer.elapsed();
+    });
+    if (doRunValidators && validatorsSkipReason.isEmpty() && !m_veraPDFcliTool.isEmpty()) {
+        /// Chooses built-in Validation Profile flavour, e.g. '1b'
+        veraPDFvalidationFlavor = ((xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b ? QStringLiteral("1b") : ((xmpPDFConformance == xmpPDFA1a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1a) ? QStringLiteral("1a") : ((xmpPDFConformance == xmpPDFA2a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2a ? QStringLiteral("2a") : ((xmpPDFConformance == xmpPDFA2b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2b ? QStringLiteral("2b") : ((xmpPDFConformance == xmpPDFA2u && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2u ? QStringLiteral("2u") : QStringLiteral("0")))));
+        QStringList arguments = QStringList(defaultArgumentsForNice) << m_veraPDFcliTool << QStringLiteral("-x") << QStringLiteral("-f") << veraPDFvalidationFlavor << QStringLiteral("--maxfailures") << QStringLiteral("2048");
+        /// In summary mode, let veraPDF validate as far as before but not
+        /// print details for more failed checks than would be kept anyway
+        if (m_summarizeValidatorOutput)
+            arguments << QStringLiteral("--maxfailuresdisplayed") << QString::number(qMax(1, m_validatorOutputMaxFailures));
+        else
+            arguments << QStringLiteral("--verbose");
+        arguments << QStringLiteral("--format") << QStringLiteral("xml") << filename;
+        veraPDFTimer.start();
+        veraPDF.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
+        veraPDFStartedRun = veraPDF.waitForStarted(twoMinutesInMillisec);
+        recordLatency(QStringLiteral("verapdf-start"), veraPDFTimer.nsecsElapsed());
+        if (veraPDFStartedRun)
+            validatorProcesses.append(&veraPDF);
+        if (!veraPDFStartedRun)
+            qWarning() << "Failed to start veraPDF for file " << filename << " and " << veraPDF.program() << veraPDF.arguments().join(' ') << " in directory " << veraPDF.workingDirectory();
+    }
 
-    if (doRunValidators && veraPDFStartedRun) {
-        static const int veraPDFtimeLimit = sixtyMinutesInMillisec;
-        const bool veraPDFtimeExceeded = !veraPDF.waitForFinished(veraPDFtimeLimit);
+    bool veraPDFFinished = false;
+    const auto waitForVeraPDF = [&]() {
+        if (!doRunValidators || !veraPDFStartedRun || veraPDFFinished) return;
+        veraPDFFinished = true;
+        const int veraPDFtimeLimit = validatorTimeLimit(QStringLiteral("verapdf"), fileSize, numPages, sixtyMinutesInMillisec);
+        const bool veraPDFtimeExceeded = !waitForValidator(&veraPDF, qMax(oneSecondInMillisec, veraPDFtimeLimit - static_cast<int>(veraPDFTimer.elapsed())));
+        recordLatency(QStringLiteral("verapdf-run"), veraPDFTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("verapdf"), fileSize, numPages, veraPDFtimeExceeded ? veraPDFTimer.elapsed() : veraPDFRuntime, veraPDFtimeExceeded);
         if (veraPDFtimeExceeded)
             qWarning() << "Waiting for veraPDF failed or exceeded time limit (" << (veraPDFtimeLimit / 1000) << "s) for file " << filename << " and " << veraPDF.program() << veraPDF.arguments().join(' ') << " in directory " << veraPDF.workingDirectory();
         veraPDFExitCode = veraPDF.exitCode();
-        veraPDFStandardOutput = DocScan::removeBinaryGarbage(QString::fromUtf8(veraPDFStandardOutputData.constData()).trimmed());
-        /// Sometimes veraPDF does not return complete and valid XML code. veraPDF's bug or DocScan's bug?
-        if ((!veraPDFStandardOutput.contains(QStringLiteral("<rawResults>")) || !veraPDFStandardOutput.contains(QStringLiteral("</rawResults>"))) && (!veraPDFStandardOutput.contains(QStringLiteral("<ns2:cliReport")) || !veraPDFStandardOutput.contains(QStringLiteral("</ns2:cliReport>"))))
-            veraPDFStandardOutput = QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\">No matching opening and closing 'rawResults' or 'ns2:cliReport' tags found in output:\n")).arg(veraPDFExitCode).arg(veraPDFtimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(veraPDFtimeLimit / 1000) + DocScan::xmlifyLines(veraPDFStandardOutput) + QStringLiteral("</error>");
         veraPDFStandardError = QString::fromUtf8(veraPDFStandardErrorData.constData()).trimmed();
-        if (!veraPDFtimeExceeded && veraPDFExitCode == 0 && !veraPDFStandardOutput.isEmpty()) {
-            const QString startOfOutput = veraPDFStandardOutput.left(8192);
-            const int tagStart = startOfOutput.indexOf(QStringLiteral("<validationResult "));
-            const int tagEnd = startOfOutput.indexOf(QStringLiteral(">"), tagStart + 10);
-            const int flavourPos1 = startOfOutput.indexOf(QStringLiteral(" flavour=\""), tagStart + 10);
-            const int isCompliantPos1 = startOfOutput.indexOf(QStringLiteral(" isCompliant=\""), tagStart + 10);
-            if (flavourPos1 > 0 && isCompliantPos1 > 0 && flavourPos1 < tagEnd && isCompliantPos1 < tagEnd) {
-                const int flavourPos2 = startOfOutput.indexOf(QStringLiteral("\""), flavourPos1 + 10);
-                const int isCompliantPos2 = startOfOutput.indexOf(QStringLiteral("\""), isCompliantPos1 + 14);
-                const bool complianceFlag = startOfOutput.mid(isCompliantPos1 + 14, isCompliantPos2 - isCompliantPos1 - 14) == QStringLiteral("true");
-                if (complianceFlag) {
-                    const QString flavor = startOfOutput.mid(flavourPos1 + 10, flavourPos2 - flavourPos1 - 10);
-                    if (flavor == QStringLiteral("PDFA_1_B")) veraPDFIsPDFA1B = true;
-                    else if (flavor == QStringLiteral("PDFA_1_A")) veraPDFIsPDFA1A = true;
-                }
-            }
-            const int p4 = startOfOutput.indexOf(QStringLiteral("item size=\""));
-            if (p4 > 1) {
-                const int p5 = startOfOutput.indexOf(QStringLiteral("\""), p4 + 11);
-                if (p5 > p4) {
-                    bool ok = false;
-                    veraPDFfilesize = startOfOutput.mid(p4 + 11, p5 - p4 - 11).toLong(&ok);
-                    if (!ok) veraPDFfilesize = 0;
+        if (m_summarizeValidatorOutput)
+            veraPDFStandardOutput = veraPDFSummary.toXml();
+        else
+            veraPDFStandardOutput = DocScan::removeBinaryGarbage(QString::fromUtf8(veraPDFStandardOutputData.constData()).trimmed());
+        /// Sometimes veraPDF does not return complete and valid XML code. veraPDF's bug or DocScan's bug?
+        if (!veraPDFSummary.isComplete())
+            veraPDFStandardOutput = QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\">Incomplete or invalid XML output:\n")).arg(veraPDFExitCode).arg(veraPDFtimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(veraPDFtimeLimit / 1000) + (m_summarizeValidatorOutput ? veraPDFStandardOutput : DocScan::xmlifyLines(veraPDFStandardOutput)) + QStringLiteral("</error>");
+        if (!veraPDFtimeExceeded && veraPDFExitCode == 0 && veraPDFSummary.isComplete()) {
+            if (veraPDFSummary.complianceKnown()) {
+                veraPDFHasVerdict = true;
+                veraPDFIsCompliant = veraPDFSummary.isCompliant();
+                if (veraPDFIsCompliant) {
+                    if (veraPDFSummary.flavour() == QStringLiteral("PDFA_1_B")) veraPDFIsPDFA1B = true;
+                    else if (veraPDFSummary.flavour() == QStringLiteral("PDFA_1_A")) veraPDFIsPDFA1A = true;
                 }
             }
+            veraPDFfilesize = veraPDFSummary.fileSize();
         } else
             qWarning() << "Execution of veraPDF failed for file " << filename << " and " << veraPDF.program() << veraPDF.arguments().join(' ') << " in directory " << veraPDF.workingDirectory() << ": " << veraPDFStandardError;
 
         if (veraPDFtimeExceeded)
             veraPDF.kill();
+    };
+
+    bool callasPdfAPilotStartedRun1 = false, callasPdfAPilotStartedRun2 = false;
+    int callasPdfAPilotExitCode = INT_MIN;
+    int callasPdfAPilotCountErrors = -1;
+    int callasPdfAPilotCountWarnings = -1;
+    char callasPdfAPilotPDFA1letter = '\0';
+    QString callasPdfAPilotStandardOutput, callasPdfAPilotStandardError;
+    QByteArray callasPdfAPilotStandardOutputData, callasPdfAPilotStandardErrorData;
+    QElapsedTimer callasPdfAPilotTimer;
+    QProcess callasPdfAPilot(this);
+    connect(&callasPdfAPilot, &QProcess::readyReadStandardOutput, [&callasPdfAPilot, &callasPdfAPilotStandardOutputData]() {
+        const QByteArray d(callasPdfAPilot.readAllStandardOutput());
+        callasPdfAPilotStandardOutputData.append(d);
+    });
+    connect(&callasPdfAPilot, &QProcess::readyReadStandardError, [&callasPdfAPilot, &callasPdfAPilotStandardErrorData]() {
+        const QByteArray d(callasPdfAPilot.readAllStandardError());
+        callasPdfAPilotStandardErrorData.append(d);
+    });
+    /// Runtime of the most recent of PDF/A Pilot's two runs
+    qint64 callasPdfAPilotRuntime = -1;
+    connect(&callasPdfAPilot, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&callasPdfAPilotTimer, &callasPdfAPilotRuntime]() {
+        callasPdfAPilotRuntime = callasPdfAPilotTimer.elapsed();
+    });
+    if (doRunValidators && validatorsSkipReason.isEmpty() && !m_callasPdfAPilotCLI.isEmpty()) {
+        const QStringList arguments = QStringList() << defaultArgumentsForNice << m_callasPdfAPilotCLI << QStringLiteral("--quickpdfinfo") << filename;
+        callasPdfAPilotTimer.start();
+        callasPdfAPilot.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
+        callasPdfAPilotStartedRun1 = callasPdfAPilot.waitForStarted(oneMinuteInMillisec);
+        recordLatency(QStringLiteral("callaspdfapilot1-start"), callasPdfAPilotTimer.nsecsElapsed());
+        if (callasPdfAPilotStartedRun1)
+            validatorProcesses.append(&callasPdfAPilot);
+        if (!callasPdfAPilotStartedRun1)
+            qWarning() << "Failed to start callas PDF/A Pilot for file " << filename << " and " << callasPdfAPilot.program() << callasPdfAPilot.arguments().join(' ') << " in directory " << callasPdfAPilot.workingDirectory();
     }
 
-    if (doRunValidators && callasPdfAPilotStartedRun1) {
-        static const int callasPdfAPilotTimeLimit = twentyMinutesInMillisec;
-        const bool callasPdfAPilotTimeExceeded = !callasPdfAPilot.waitForFinished(callasPdfAPilotTimeLimit);
+    bool callasPdfAPilotFinishedRun1 = false;
+    const auto waitForCallasPdfAPilotRun1 = [&]() {
+        if (!doRunValidators || !callasPdfAPilotStartedRun1 || callasPdfAPilotFinishedRun1) return;
+        callasPdfAPilotFinishedRun1 = true;
+        const int callasPdfAPilotTimeLimit = validatorTimeLimit(QStringLiteral("callaspdfapilot1"), fileSize, numPages, twentyMinutesInMillisec);
+        const bool callasPdfAPilotTimeExceeded = !waitForValidator(&callasPdfAPilot, qMax(oneSecondInMillisec, callasPdfAPilotTimeLimit - static_cast<int>(callasPdfAPilotTimer.elapsed())));
+        recordLatency(QStringLiteral("callaspdfapilot1-run"), callasPdfAPilotTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("callaspdfapilot1"), fileSize, numPages, callasPdfAPilotTimeExceeded ? callasPdfAPilotTimer.elapsed() : callasPdfAPilotRuntime, callasPdfAPilotTimeExceeded);
         if (callasPdfAPilotTimeExceeded)
             qWarning() << "Waiting for callas PDF/A Pilot failed or exceeded time limit (" << (callasPdfAPilotTimeLimit / 1000) << "s) for file " << filename << " and " << callasPdfAPilot.program() << callasPdfAPilot.arguments().join(' ') << " in directory " << callasPdfAPilot.workingDirectory();
         callasPdfAPilotExitCode = callasPdfAPilot.exitCode();
@@ -1109,8 +1809,10 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
                 callasPdfAPilotStandardOutputData.clear(); ///< reset before launching new PDF/A Pilot process
                 callasPdfAPilotStandardErrorData.clear(); ///< reset before launching new PDF/A Pilot process
                 const QStringList arguments = QStringList(defaultArgumentsForNice) << m_callasPdfAPilotCLI << QStringLiteral("-a") << filename;
+                callasPdfAPilotTimer.restart();
                 callasPdfAPilot.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
                 callasPdfAPilotStartedRun2 = callasPdfAPilot.waitForStarted(oneMinuteInMillisec);
+                recordLatency(QStringLiteral("callaspdfapilot2-start"), callasPdfAPilotTimer.nsecsElapsed());
                 if (!callasPdfAPilotStartedRun2)
                     qWarning() << "Failed to start callas PDF/A Pilot for file " << filename << " and " << callasPdfAPilot.program() << callasPdfAPilot.arguments().join(' ') << " in directory " << callasPdfAPilot.workingDirectory();
             }
@@ -1121,83 +1823,16 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
 
         if (callasPdfAPilotTimeExceeded)
             callasPdfAPilot.kill();
-    }
-
-    bool jhoveIsPDF = false;
-    bool jhovePDFWellformed = false, jhovePDFValid = false;
-    QString jhovePDFversion;
-    QString jhovePDFprofile;
-    int jhoveExitCode = INT_MIN;
-    QString jhoveStandardOutput;
-    QString jhoveStandardError;
-    if (doRunValidators && jhoveStarted) {
-        static const int jhoveTimeLimit = sixtyMinutesInMillisec;
-        const bool jhoveTimeExceeded = !jhoveProcess->waitForFinished(jhoveTimeLimit);
-        if (jhoveTimeExceeded)
-            qWarning() << "Waiting for jHove failed or exceeded time limit (" << (jhoveTimeLimit / 1000) << "s) for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
-        jhoveExitCode = jhoveProcess->exitCode();
-        jhoveStandardOutput = QString::fromUtf8(jhoveStandardOutputData.constData());
-        jhoveStandardError = QString::fromUtf8(jhoveStandardErrorData.constData());
-        if (!jhoveTimeExceeded && jhoveExitCode == 0 && !jhoveStandardOutput.isEmpty()) {
-            jhoveIsPDF = jhoveStandardOutput.contains(QStringLiteral("Format: PDF")) && !jhoveStandardOutput.contains(QStringLiteral("ErrorMessage:"));
-            static const QRegExp pdfStatusRegExp(QStringLiteral("\\bStatus: ([-.0-9a-zA-Z ]+)"));
-            if (pdfStatusRegExp.indexIn(jhoveStandardOutput) >= 0) {
-                jhovePDFWellformed = pdfStatusRegExp.cap(1).startsWith(QStringLiteral("Well-Formed"), Qt::CaseInsensitive);
-                jhovePDFValid = pdfStatusRegExp.cap(1).endsWith(QStringLiteral("and valid"));
-            }
-            static const QRegExp pdfVersionRegExp(QStringLiteral("\\bVersion: ([.0-9]+)"));
-            jhovePDFversion = pdfVersionRegExp.indexIn(jhoveStandardOutput) >= 0 ? pdfVersionRegExp.cap(1) : QString();
-            static const QRegExp pdfProfileRegExp(QStringLiteral("\\bProfile: ([-.,/0-9a-zA-Z ]+)"));
-            jhovePDFprofile = pdfProfileRegExp.indexIn(jhoveStandardOutput) >= 0 ? pdfProfileRegExp.cap(1) : QString();
-        } else {
-            qWarning() << "Execution of jHove failed for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory() << ": " << jhoveStandardError;
-            jhoveStandardOutput.prepend(QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\" />\n")).arg(jhoveExitCode).arg(jhoveTimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(jhoveTimeLimit / 1000));
-        }
-
-        if (jhoveTimeExceeded)
-            jhoveProcess->kill();
-    }
-
-    if (doRunValidators && pdfboxValidatorStarted) {
-        static const int pdfboxValidatorTimeLimit = sixtyMinutesInMillisec;
-        const bool pdfboxValidatorTimeExceeded = !pdfboxValidator.waitForFinished(pdfboxValidatorTimeLimit);
-        if (pdfboxValidatorTimeExceeded)
-            qWarning() << "Waiting for pdfbox Validator failed or exceeded time limit (" << (pdfboxValidatorTimeLimit / 1000) << "s) for file " << filename << " and " << pdfboxValidator.program() << pdfboxValidator.arguments().join(' ') << " in directory " << pdfboxValidator.workingDirectory();
-        pdfboxValidatorExitCode =   pdfboxValidator.exitCode();
-        pdfboxValidatorStandardOutput = QString::fromUtf8(DocScan::removeBinaryGarbage(pdfboxValidatorStandardOutputData).constData()).trimmed();
-        pdfboxValidatorStandardError = QString::fromUtf8(DocScan::removeBinaryGarbage(pdfboxValidatorStandardErrorData).constData()).trimmed();
-        if (!pdfboxValidatorTimeExceeded && pdfboxValidatorExitCode == 0 && !pdfboxValidatorStandardOutput.isEmpty())
-            pdfboxValidatorValidPdf = pdfboxValidatorStandardOutput.contains(QStringLiteral("is a valid PDF/A-1b file"));
-        else {
-            qWarning() << "Execution of pdfbox Validator failed for file " << filename << " and " << pdfboxValidator.program() << pdfboxValidator.arguments().join(' ') << " in directory " << pdfboxValidator.workingDirectory() << ": " << pdfboxValidatorStandardError;
-            pdfboxValidatorStandardOutput.prepend(QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\" />\n")).arg(pdfboxValidatorExitCode).arg(pdfboxValidatorTimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(pdfboxValidatorTimeLimit / 1000));
-        }
-
-        if (pdfboxValidatorTimeExceeded)
-            pdfboxValidator.kill();
-    }
-
-    if (doRunValidators && threeHeightsPDFValidatorStartedRun) {
-        static const int threeHeightsPDFValidatorTimeLimit = twentyMinutesInMillisec;
-        const bool threeHeightsPDFValidatorTimeExceeded = !threeHeightsPDFValidatorProcess.waitForFinished(threeHeightsPDFValidatorTimeLimit);
-        if (threeHeightsPDFValidatorTimeExceeded)
-            qWarning() << "Waiting for 3-Heights PDF Validator Shell failed or exceeded time limit (" << (threeHeightsPDFValidatorTimeLimit / 1000) << "s) for file " << filename << " and " << threeHeightsPDFValidatorProcess.program() << threeHeightsPDFValidatorProcess.arguments().join(' ') << " in directory " << threeHeightsPDFValidatorProcess.workingDirectory();
-        threeHeightsPDFValidatorExitCode = threeHeightsPDFValidatorProcess.exitCode();
-        threeHeightsPDFValidatorStandardOutput = QString::fromUtf8(threeHeightsPDFValidatorStandardOutputData.constData()).trimmed();
-        threeHeightsPDFValidatorStandardError = QString::fromUtf8(threeHeightsPDFValidatorStandardErrorData.constData()).trimmed();
-
-        if (threeHeightsPDFValidatorTimeExceeded || (threeHeightsPDFValidatorExitCode != 0 && threeHeightsPDFValidatorExitCode != 4) || threeHeightsPDFValidatorStandardOutput.isEmpty()) {
-            qWarning() << "Execution of 3-Heights PDF Validator Shell failed for file " << filename << " and " << threeHeightsPDFValidatorProcess.program() << threeHeightsPDFValidatorProcess.arguments().join(' ') << " in directory " << threeHeightsPDFValidatorProcess.workingDirectory() << ": " << threeHeightsPDFValidatorStandardError;
-            threeHeightsPDFValidatorStandardOutput.prepend(QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\" />\n")).arg(threeHeightsPDFValidatorExitCode).arg(threeHeightsPDFValidatorTimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(threeHeightsPDFValidatorTimeLimit / 1000));
-        }
-
-        if (threeHeightsPDFValidatorTimeExceeded)
-            threeHeightsPDFValidatorProcess.kill();
-    }
-
-    if (callasPdfAPilotStartedRun2) {
-        static const int callasPdfAPilotTimeLimit = twentyMinutesInMillisec;
-        const bool callasPdfAPilotTimeExceeded = !callasPdfAPilot.waitForFinished(callasPdfAPilotTimeLimit);
+    };
+
+    bool callasPdfAPilotFinishedRun2 = false;
+    const auto waitForCallasPdfAPilotRun2 = [&]() {
+        if (!callasPdfAPilotStartedRun2 || callasPdfAPilotFinishedRun2) return;
+        callasPdfAPilotFinishedRun2 = true;
+        const int callasPdfAPilotTimeLimit = validatorTimeLimit(QStringLiteral("callaspdfapilot2"), fileSize, numPages, twentyMinutesInMillisec);
+        const bool callasPdfAPilotTimeExceeded = !waitForValidator(&callasPdfAPilot, qMax(oneSecondInMillisec, callasPdfAPilotTimeLimit - static_cast<int>(callasPdfAPilotTimer.elapsed())));
+        recordLatency(QStringLiteral("callaspdfapilot2-run"), callasPdfAPilotTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("callaspdfapilot2"), fileSize, numPages, callasPdfAPilotTimeExceeded ? callasPdfAPilotTimer.elapsed() : callasPdfAPilotRuntime, callasPdfAPilotTimeExceeded);
         if (callasPdfAPilotTimeExceeded)
             qWarning() << "Waiting for callas PDF/A Pilot failed or exceeded time limit (" << (callasPdfAPilotTimeLimit / 1000) << "s) for file " << filename << " and " << callasPdfAPilot.program() << callasPdfAPilot.arguments().join(' ') << " in directory " << callasPdfAPilot.workingDirectory();
         callasPdfAPilotExitCode = callasPdfAPilot.exitCode();
@@ -1225,11 +1860,120 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
 
         if (callasPdfAPilotTimeExceeded)
             callasPdfAPilot.kill();
+    };
+
+    if (stagedValidators && validatorsSkipReason.isEmpty()) {
+        waitForVeraPDF();
+        waitForCallasPdfAPilotRun1();
+        waitForCallasPdfAPilotRun2();
+        if (veraPDFHasVerdict)
+            ++(veraPDFIsCompliant ? validatorsValidVerdicts : validatorsInvalidVerdicts);
+        /// Errors are only counted if the file claims to be PDF/A-1a or PDF/A-1b
+        if (callasPdfAPilotCountErrors >= 0)
+            ++(callasPdfAPilotCountErrors == 0 ? validatorsValidVerdicts : validatorsInvalidVerdicts);
+        validatorsSkipReason = validatorPolicyDecision();
+        if (!validatorsSkipReason.isEmpty()) {
+            if (!m_threeHeightsValidatorShellCLI.isEmpty() && !m_threeHeightsValidatorLicenseKey.isEmpty()) validatorsSkipped << QStringLiteral("threeheightspdfvalidator");
+            if (!m_qoppaJPDFPreflightDirectory.isEmpty()) validatorsSkipped << QStringLiteral("qoppapdfpreflight");
+        }
     }
 
-    if (doRunValidators && qoppaJPDFPreflightStarted) {
-        static const int qoppaJPDFPreflightTimeLimit = sixtyMinutesInMillisec;
-        const bool qoppaJPDFPreflightTimeExceeded = !qoppaJPDFPreflightProcess.waitForFinished(qoppaJPDFPreflightTimeLimit);
+    bool threeHeightsPDFValidatorStartedRun = false;
+    int  threeHeightsPDFValidatorExitCode = INT_MIN;
+    QString threeHeightsPDFValidatorCLValue;
+    QByteArray threeHeightsPDFValidatorStandardOutputData, threeHeightsPDFValidatorStandardErrorData;
+    QString threeHeightsPDFValidatorStandardOutput, threeHeightsPDFValidatorStandardError;
+    QElapsedTimer threeHeightsPDFValidatorTimer;
+    QProcess threeHeightsPDFValidatorProcess(this);
+    connect(&threeHeightsPDFValidatorProcess, &QProcess::readyReadStandardOutput, [&threeHeightsPDFValidatorProcess, &threeHeightsPDFValidatorStandardOutputData]() {
+        const QByteArray d(threeHeightsPDFValidatorProcess.readAllStandardOutput());
+        threeHeightsPDFValidatorStandardOutputData.append(d);
+    });
+    connect(&threeHeightsPDFValidatorProcess, &QProcess::readyReadStandardError, [&threeHeightsPDFValidatorProcess, &threeHeightsPDFValidatorStandardErrorData]() {
+        const QByteArray d(threeHeightsPDFValidatorProcess.readAllStandardError());
+        threeHeightsPDFValidatorStandardErrorData.append(d);
+    });
+    qint64 threeHeightsPDFValidatorRuntime = -1;
+    connect(&threeHeightsPDFValidatorProcess, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&threeHeightsPDFValidatorTimer, &threeHeightsPDFValidatorRuntime]() {
+        threeHeightsPDFValidatorRuntime = threeHeightsPDFValidatorTimer.elapsed();
+    });
+    if (doRunValidators && validatorsSkipReason.isEmpty() && !m_threeHeightsValidatorShellCLI.isEmpty() && !m_threeHeightsValidatorLicenseKey.isEmpty()) {
+        threeHeightsPDFValidatorCLValue = (xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b ? QStringLiteral("pdfa-1b") : ((xmpPDFConformance == xmpPDFA1a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1a ? QStringLiteral("pdfa-1a") : ((xmpPDFConformance == xmpPDFA2a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2a ? QStringLiteral("pdfa-2a") : ((xmpPDFConformance == xmpPDFA2b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2b  ? QStringLiteral("pdfa-2b") : ((xmpPDFConformance == xmpPDFA2u && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2u  ? QStringLiteral("pdfa-2u") : QStringLiteral("ccl")))));
+        const QStringList arguments = QStringList() << defaultArgumentsForNice << m_threeHeightsValidatorShellCLI << QStringLiteral("-lk") << m_threeHeightsValidatorLicenseKey << QStringLiteral("-cl") << threeHeightsPDFValidatorCLValue << QStringLiteral("-rd") << QStringLiteral("-rl") << QStringLiteral("3") << QStringLiteral("-v") << filename;
+        threeHeightsPDFValidatorTimer.start();
+        threeHeightsPDFValidatorProcess.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
+        threeHeightsPDFValidatorStartedRun = threeHeightsPDFValidatorProcess.waitForStarted(oneMinuteInMillisec);
+        recordLatency(QStringLiteral("threeheights-start"), threeHeightsPDFValidatorTimer.nsecsElapsed());
+        if (threeHeightsPDFValidatorStartedRun)
+            validatorProcesses.append(&threeHeightsPDFValidatorProcess);
+        if (!threeHeightsPDFValidatorStartedRun)
+            qWarning() << "Failed to start 3-Heights PDF Validator Shell for file " << filename << " and " << threeHeightsPDFValidatorProcess.program() << threeHeightsPDFValidatorProcess.arguments().join(' ') << " in directory " << threeHeightsPDFValidatorProcess.workingDirectory();
+    }
+
+    bool threeHeightsPDFValidatorFinished = false;
+    const auto waitForThreeHeightsPDFValidator = [&]() {
+        if (!doRunValidators || !threeHeightsPDFValidatorStartedRun || threeHeightsPDFValidatorFinished) return;
+        threeHeightsPDFValidatorFinished = true;
+        const int threeHeightsPDFValidatorTimeLimit = validatorTimeLimit(QStringLiteral("threeheights"), fileSize, numPages, twentyMinutesInMillisec);
+        const bool threeHeightsPDFValidatorTimeExceeded = !waitForValidator(&threeHeightsPDFValidatorProcess, qMax(oneSecondInMillisec, threeHeightsPDFValidatorTimeLimit - static_cast<int>(threeHeightsPDFValidatorTimer.elapsed())));
+        recordLatency(QStringLiteral("threeheights-run"), threeHeightsPDFValidatorTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("threeheights"), fileSize, numPages, threeHeightsPDFValidatorTimeExceeded ? threeHeightsPDFValidatorTimer.elapsed() : threeHeightsPDFValidatorRuntime, threeHeightsPDFValidatorTimeExceeded);
+        if (threeHeightsPDFValidatorTimeExceeded)
+            qWarning() << "Waiting for 3-Heights PDF Validator Shell failed or exceeded time limit (" << (threeHeightsPDFValidatorTimeLimit / 1000) << "s) for file " << filename << " and " << threeHeightsPDFValidatorProcess.program() << threeHeightsPDFValidatorProcess.arguments().join(' ') << " in directory " << threeHeightsPDFValidatorProcess.workingDirectory();
+        threeHeightsPDFValidatorExitCode = threeHeightsPDFValidatorProcess.exitCode();
+        threeHeightsPDFValidatorStandardOutput = QString::fromUtf8(threeHeightsPDFValidatorStandardOutputData.constData()).trimmed();
+        threeHeightsPDFValidatorStandardError = QString::fromUtf8(threeHeightsPDFValidatorStandardErrorData.constData()).trimmed();
+
+        if (threeHeightsPDFValidatorTimeExceeded || (threeHeightsPDFValidatorExitCode != 0 && threeHeightsPDFValidatorExitCode != 4) || threeHeightsPDFValidatorStandardOutput.isEmpty()) {
+            qWarning() << "Execution of 3-Heights PDF Validator Shell failed for file " << filename << " and " << threeHeightsPDFValidatorProcess.program() << threeHeightsPDFValidatorProcess.arguments().join(' ') << " in directory " << threeHeightsPDFValidatorProcess.workingDirectory() << ": " << threeHeightsPDFValidatorStandardError;
+            threeHeightsPDFValidatorStandardOutput.prepend(QString(QStringLiteral("<error exitcode=\"%1\" exceededtimelimit=\"%2\" timelimitsec=\"%3\" />\n")).arg(threeHeightsPDFValidatorExitCode).arg(threeHeightsPDFValidatorTimeExceeded ? QStringLiteral("yes") : QStringLiteral("no")).arg(threeHeightsPDFValidatorTimeLimit / 1000));
+        }
+
+        if (threeHeightsPDFValidatorTimeExceeded)
+            threeHeightsPDFValidatorProcess.kill();
+    };
+
+    bool qoppaJPDFPreflightStarted = false;
+    int  qoppaJPDFPreflightExitCode = INT_MIN;
+    QByteArray qoppaJPDFPreflightStandardOutputData, qoppaJPDFPreflightStandardErrorData;
+    QString qoppaJPDFPreflightStandardOutput, qoppaJPDFPreflightStandardError;
+    QString qoppaJPDFPreflightFlavor;
+    QElapsedTimer qoppaJPDFPreflightTimer;
+    QProcess qoppaJPDFPreflightProcess(this);
+    qoppaJPDFPreflightProcess.setWorkingDirectory(m_qoppaJPDFPreflightDirectory);
+    connect(&qoppaJPDFPreflightProcess, &QProcess::readyReadStandardOutput, [&qoppaJPDFPreflightProcess, &qoppaJPDFPreflightStandardOutputData]() {
+        const QByteArray d(qoppaJPDFPreflightProcess.readAllStandardOutput());
+        qoppaJPDFPreflightStandardOutputData.append(d);
+    });
+    connect(&qoppaJPDFPreflightProcess, &QProcess::readyReadStandardError, [&qoppaJPDFPreflightProcess, &qoppaJPDFPreflightStandardErrorData]() {
+        const QByteArray d(qoppaJPDFPreflightProcess.readAllStandardError());
+        qoppaJPDFPreflightStandardErrorData.append(d);
+    });
+    qint64 qoppaJPDFPreflightRuntime = -1;
+    connect(&qoppaJPDFPreflightProcess, static_cast<void(QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished), [&qoppaJPDFPreflightTimer, &qoppaJPDFPreflightRuntime]() {
+        qoppaJPDFPreflightRuntime = qoppaJPDFPreflightTimer.elapsed();
+    });
+    if (doRunValidators && validatorsSkipReason.isEmpty() && !m_qoppaJPDFPreflightDirectory.isEmpty()) {
+        qoppaJPDFPreflightFlavor = ((xmpPDFConformance == xmpPDFA1a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1a) ?  QStringLiteral("PDFA1a") : (((xmpPDFConformance == xmpPDFA1b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA1b) ?  QStringLiteral("PDFA1b") : (((xmpPDFConformance == xmpPDFA2a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2a) ?  QStringLiteral("PDFA2a") : (((xmpPDFConformance == xmpPDFA2b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2b) ?  QStringLiteral("PDFA2b") : (((xmpPDFConformance == xmpPDFA3a && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA3a) ?  QStringLiteral("PDFA3a") : ((xmpPDFConformance == xmpPDFA3b && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA3b) ?  QStringLiteral("PDFA3b") : (((xmpPDFConformance == xmpPDFA2u && m_enforcedValidationLevel == xmpNone) || m_enforcedValidationLevel == xmpPDFA2u) ?  QStringLiteral("PDFA2u") : QStringLiteral("PDFA1b"))))));
+        const QStringList arguments = QStringList() << defaultArgumentsForNice << (m_qoppaJPDFPreflightDirectory + QStringLiteral("/Validate") + qoppaJPDFPreflightFlavor + QStringLiteral(".sh")) << filename;
+        qoppaJPDFPreflightTimer.start();
+        qoppaJPDFPreflightProcess.start(QStringLiteral("/usr/bin/nice"), arguments, QIODevice::ReadOnly);
+        qoppaJPDFPreflightStarted = qoppaJPDFPreflightProcess.waitForStarted(oneMinuteInMillisec);
+        recordLatency(QStringLiteral("qoppa-start"), qoppaJPDFPreflightTimer.nsecsElapsed());
+        if (qoppaJPDFPreflightStarted)
+            validatorProcesses.append(&qoppaJPDFPreflightProcess);
+        if (!qoppaJPDFPreflightStarted)
+            qWarning() << "Failed to start Qoppa jPDFPreflight for file " << filename << " and " << qoppaJPDFPreflightProcess.program() << qoppaJPDFPreflightProcess.arguments().join(' ') << " in directory " << qoppaJPDFPreflightProcess.workingDirectory();
+    }
+
+    bool qoppaJPDFPreflightFinished = false;
+    const auto waitForQoppaJPDFPreflight = [&]() {
+        if (!doRunValidators || !qoppaJPDFPreflightStarted || qoppaJPDFPreflightFinished) return;
+        qoppaJPDFPreflightFinished = true;
+        const int qoppaJPDFPreflightTimeLimit = validatorTimeLimit(QStringLiteral("qoppa"), fileSize, numPages, sixtyMinutesInMillisec);
+        const bool qoppaJPDFPreflightTimeExceeded = !waitForValidator(&qoppaJPDFPreflightProcess, qMax(oneSecondInMillisec, qoppaJPDFPreflightTimeLimit - static_cast<int>(qoppaJPDFPreflightTimer.elapsed())));
+        recordLatency(QStringLiteral("qoppa-run"), qoppaJPDFPreflightTimer.nsecsElapsed());
+        recordValidatorRuntime(QStringLiteral("qoppa"), fileSize, numPages, qoppaJPDFPreflightTimeExceeded ? qoppaJPDFPreflightTimer.elapsed() : qoppaJPDFPreflightRuntime, qoppaJPDFPreflightTimeExceeded);
         if (qoppaJPDFPreflightTimeExceeded)
             qWarning() << "Waiting for Qoppa jPDFPreflight failed or exceeded time limit (" << (qoppaJPDFPreflightTimeLimit / 1000) << "s) for file " << filename << " and " << qoppaJPDFPreflightProcess.program() << qoppaJPDFPreflightProcess.arguments().join(' ') << " in directory " << qoppaJPDFPreflightProcess.workingDirectory();
         qoppaJPDFPreflightExitCode = qoppaJPDFPreflightProcess.exitCode();
@@ -1243,25 +1987,72 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
 
         if (qoppaJPDFPreflightTimeExceeded)
             qoppaJPDFPreflightProcess.kill();
-    }
+    };
+
+    bool adobePreflightReportAnalysisOk = false;
+    if (doRunValidators) {
+        /// If for the current filename an alias filename was given,
+        /// use the alias filename to locate the Adobe Preflight report.
+        QString relevantPDFfilename = m_toAnalyzeFilename.isEmpty() ? filename : m_toAnalyzeFilename;
+        if (filename == m_toAnalyzeFilename && !m_aliasFilename.isEmpty()) relevantPDFfilename = m_aliasFilename;
+
+        stageTimer.restart();
+        adobePreflightReportAnalysisOk = adobePreflightReportAnalysis(relevantPDFfilename, metaText, validatorsRecord);
+        recordLatency(QStringLiteral("adobepreflight"), stageTimer.nsecsElapsed());
+        if (!adobePreflightReportAnalysisOk)
+            metaText.append(QStringLiteral("<adobepreflight status=\"failed\"><error>Failed to find or evaluate Adobe Preflight XML report file</error></adobepreflight>\n"));
+    } else
+        metaText.append(QStringLiteral("<adobepreflight><info>Adobe Preflight not configured to run</info></adobepreflight>\n"));
+
+    waitForVeraPDF();
+    waitForCallasPdfAPilotRun1();
+    waitForJHove();
+    waitForPdfBoxValidator();
+    waitForThreeHeightsPDFValidator();
+    waitForCallasPdfAPilotRun2();
+    waitForQoppaJPDFPreflight();
 
     const qint64 externalProgramsEndTime = QDateTime::currentMSecsSinceEpoch();
+    stageTimer.restart();
 
     if (doRunValidators && qoppaJPDFPreflightExitCode > INT_MIN) {
         const int p1 = qoppaJPDFPreflightStandardOutput.indexOf(QStringLiteral("<qoppapdfpreflight"));
         const int p2 = qoppaJPDFPreflightStandardOutput.indexOf(QStringLiteral("</qoppapdfpreflight>"), p1 + 1);
-        if (p1 >= 0 && p2 > p1)
+        QJsonObject qoppaRecord;
+        qoppaRecord.insert(QStringLiteral("exitcode"), qoppaJPDFPreflightExitCode);
+        qoppaRecord.insert(QStringLiteral("flavor"), qoppaJPDFPreflightFlavor);
+        if (p1 >= 0 && p2 > p1) {
             metaText.append(qoppaJPDFPreflightStandardOutput.mid(p1, p2 - p1 + 20).replace(QStringLiteral("<qoppapdfpreflight "), QString(QStringLiteral("<qoppapdfpreflight exitcode=\"%1\" flavor=\"%2\" ")).arg(qoppaJPDFPreflightExitCode).arg(qoppaJPDFPreflightFlavor)) + QStringLiteral("\n"));
-        else {
+            /// Pick up compliance flags like pdfa1b="yes" from Qoppa's start tag
+            const QString qoppaStartTag = qoppaJPDFPreflightStandardOutput.mid(p1, qoppaJPDFPreflightStandardOutput.indexOf(QLatin1Char('>'), p1) - p1);
+            static const QRegularExpression rePDFAflag(QStringLiteral("\\bpdfa([1-4][abu]?)=\"(yes|no)\""));
+            QRegularExpressionMatchIterator reIter = rePDFAflag.globalMatch(qoppaStartTag);
+            while (reIter.hasNext()) {
+                const QRegularExpressionMatch match = reIter.next();
+                qoppaRecord.insert(QStringLiteral("pdfa") + match.captured(1), match.captured(2) == QStringLiteral("yes"));
+            }
+        } else {
+            qoppaRecord.insert(QStringLiteral("pdfa1b"), false);
             qWarning() << "Missing expected XML output from Qoppa jPDFPreflight for file " << filename << " and " << qoppaJPDFPreflightProcess.program() << qoppaJPDFPreflightProcess.arguments().join(' ') << " in directory " << qoppaJPDFPreflightProcess.workingDirectory() << ": " << qoppaJPDFPreflightStandardError;
             metaText.append(QString(QStringLiteral("<qoppapdfpreflight exitcode=\"%1\" pdfa1b=\"no\" flavor=\"%3\"><error>Missing expected XML output</error><details>%2</details></qoppapdfpreflight>\n")).arg(qoppaJPDFPreflightExitCode).arg(DocScan::xmlify(qoppaJPDFPreflightStandardError), qoppaJPDFPreflightFlavor));
         }
-    } else
+        validatorsRecord.insert(QStringLiteral("qoppapdfpreflight"), qoppaRecord);
+    } else if (validatorsSkipped.contains(QStringLiteral("qoppapdfpreflight")))
+        metaText.append(QString(QStringLiteral("<qoppapdfpreflight><info skipped=\"%1\">Qoppa skipped by validator policy</info></qoppapdfpreflight>\n")).arg(validatorsSkipReason));
+    else
         metaText.append(QStringLiteral("<qoppapdfpreflight><info>Qoppa not configured to run</info></qoppapdfpreflight>\n"));
 
     if (doRunValidators && jhoveExitCode > INT_MIN) {
         /// insert data from jHove
         metaText.append(QString(QStringLiteral("<jhove exitcode=\"%1\" wellformed=\"%2\" valid=\"%3\" pdf=\"%4\"")).arg(QString::number(jhoveExitCode), jhovePDFWellformed ? QStringLiteral("yes") : QStringLiteral("no"), jhovePDFValid ? QStringLiteral("yes") : QStringLiteral("no"), jhoveIsPDF ? QStringLiteral("yes") : QStringLiteral("no")));
+        QJsonObject jhoveRecord;
+        jhoveRecord.insert(QStringLiteral("exitcode"), jhoveExitCode);
+        jhoveRecord.insert(QStringLiteral("wellformed"), jhovePDFWellformed);
+        jhoveRecord.insert(QStringLiteral("valid"), jhovePDFValid);
+        jhoveRecord.insert(QStringLiteral("pdf"), jhoveIsPDF);
+        jhoveRecord.insert(QStringLiteral("pdfa1a"), jhovePDFprofile.contains(QStringLiteral("ISO PDF/A-1, Level A")));
+        jhoveRecord.insert(QStringLiteral("pdfa1b"), jhovePDFprofile.contains(QStringLiteral("ISO PDF/A-1, Level B")));
+        validatorsRecord.insert(QStringLiteral("jhove"), jhoveRecord);
         if (jhovePDFversion.isEmpty() && jhovePDFprofile.isEmpty() && jhoveStandardOutput.isEmpty() && jhoveStandardError.isEmpty())
             metaText.append(QStringLiteral(" />\n"));
         else {
@@ -1288,6 +2079,14 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
         const QString flavor = !veraPDFvalidationFlavor.isEmpty() && veraPDFvalidationFlavor != QStringLiteral("0") ? QString(QStringLiteral(" flavor=\"PDFA%1\"")).arg(veraPDFvalidationFlavor) : QString();
         /// insert XML data from veraPDF
         metaText.append(QString(QStringLiteral("<verapdf exitcode=\"%1\" filesize=\"%2\" pdfa1b=\"%3\" pdfa1a=\"%4\"%5>\n")).arg(QString::number(veraPDFExitCode), QString::number(veraPDFfilesize), veraPDFIsPDFA1B ? QStringLiteral("yes") : QStringLiteral("no"), veraPDFIsPDFA1A ? QStringLiteral("yes") : QStringLiteral("no"), flavor));
+        QJsonObject veraPDFRecord;
+        veraPDFRecord.insert(QStringLiteral("exitcode"), veraPDFExitCode);
+        veraPDFRecord.insert(QStringLiteral("flavor"), veraPDFvalidationFlavor);
+        veraPDFRecord.insert(QStringLiteral("pdfa1b"), veraPDFIsPDFA1B);
+        veraPDFRecord.insert(QStringLiteral("pdfa1a"), veraPDFIsPDFA1A);
+        if (veraPDFSummary.failedRuleCount() > 0)
+            veraPDFRecord.insert(QStringLiteral("failedrules"), veraPDFSummary.rulesToJson());
+        validatorsRecord.insert(QStringLiteral("verapdf"), veraPDFRecord);
         if (!veraPDFStandardOutput.isEmpty()) {
             /// Check for and omit XML header if it exists
             const int p = veraPDFStandardOutput.indexOf(QStringLiteral("?>"));
@@ -1296,7 +2095,9 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
         if (!veraPDFStandardError.isEmpty())
             metaText.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(veraPDFStandardError)));
         metaText.append(QStringLiteral("</verapdf>\n"));
-    } else if (doRunValidators && !m_veraPDFcliTool.isEmpty())
+    } else if (validatorsSkipped.contains(QStringLiteral("verapdf")))
+        metaText.append(QString(QStringLiteral("<verapdf><info skipped=\"%1\">veraPDF skipped by validator policy</info></verapdf>\n")).arg(validatorsSkipReason));
+    else if (doRunValidators && !m_veraPDFcliTool.isEmpty())
         metaText.append(QStringLiteral("<verapdf><error>veraPDF failed to start or was never started</error></verapdf>\n"));
     else
         metaText.append(QStringLiteral("<verapdf><info>veraPDF not configured to run</info></verapdf>\n"));
@@ -1341,13 +2142,28 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
             complianceString += QStringLiteral(" pdf") + QString(it.key()).remove(QLatin1Char('.')) + QStringLiteral("=\"") + (it.value() ? QStringLiteral("yes") : QStringLiteral("no")) + QStringLiteral("\"");
 
         metaText.append(QString(QStringLiteral("<threeheightspdfvalidator exitcode=\"%1\"%2>")).arg(threeHeightsPDFValidatorExitCode).arg(complianceString) + report + QStringLiteral("</threeheightspdfvalidator>\n"));
-    } else
+        QJsonObject threeHeightsRecord;
+        threeHeightsRecord.insert(QStringLiteral("exitcode"), threeHeightsPDFValidatorExitCode);
+        for (QMap<QString, bool>::ConstIterator it = standardCompliances.constBegin(); it != standardCompliances.constEnd(); ++it)
+            threeHeightsRecord.insert(QStringLiteral("pdfa") + it.key(), it.value());
+        validatorsRecord.insert(QStringLiteral("threeheightspdfvalidator"), threeHeightsRecord);
+    } else if (validatorsSkipped.contains(QStringLiteral("threeheightspdfvalidator")))
+        metaText.append(QString(QStringLiteral("<threeheightspdfvalidator><info skipped=\"%1\">3-Heights PDF Validator Shell skipped by validator policy</info></threeheightspdfvalidator>\n")).arg(validatorsSkipReason));
+    else
         metaText.append(QStringLiteral("<threeheightspdfvalidator><info>3-Heights PDF Validator Shell not configured to run</info></threeheightspdfvalidator>\n"));
 
     if (doRunValidators && pdfboxValidatorExitCode > INT_MIN) {
         /// insert result from Apache's PDFBox
         metaText.append(QString(QStringLiteral("<pdfboxvalidator exitcode=\"%1\" pdfa1b=\"%2\">\n")).arg(QString::number(pdfboxValidatorExitCode), pdfboxValidatorValidPdf ? QStringLiteral("yes") : QStringLiteral("no")));
-        if (!pdfboxValidatorStandardOutput.isEmpty()) {
+        QJsonObject pdfboxRecord;
+        pdfboxRecord.insert(QStringLiteral("exitcode"), pdfboxValidatorExitCode);
+        pdfboxRecord.insert(QStringLiteral("pdfa1b"), pdfboxValidatorValidPdf);
+        if (pdfboxValidatorSummary.failedRuleCount() > 0)
+            pdfboxRecord.insert(QStringLiteral("failedrules"), pdfboxValidatorSummary.rulesToJson());
+        validatorsRecord.insert(QStringLiteral("pdfboxvalidator"), pdfboxRecord);
+        if (m_summarizeValidatorOutput)
+            metaText.append(pdfboxValidatorStandardOutput);
+        else if (!pdfboxValidatorStandardOutput.isEmpty()) {
             QTextStream ts(&pdfboxValidatorStandardOutput);
             QString buffer;
             while (!ts.atEnd() && buffer.length() < (8 * 1 << 20)) ///< read max 8MB
@@ -1373,16 +2189,35 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
         const bool isPDFA1a = callasPdfAPilotPDFA1letter == 'a' && callasPdfAPilotCountErrors == 0 && callasPdfAPilotCountWarnings == 0;
         const bool isPDFA1b = callasPdfAPilotPDFA1letter == 'b' && callasPdfAPilotCountErrors == 0 && callasPdfAPilotCountWarnings == 0;
         metaText.append(QString(QStringLiteral("<callaspdfapilot exitcode=\"%1\" pdfa1b=\"%2\" pdfa1a=\"%3\">\n")).arg(QString::number(callasPdfAPilotExitCode), isPDFA1b ? QStringLiteral("yes") : QStringLiteral("no"), isPDFA1a ? QStringLiteral("yes") : QStringLiteral("no")));
+        QJsonObject callasRecord;
+        callasRecord.insert(QStringLiteral("exitcode"), callasPdfAPilotExitCode);
+        callasRecord.insert(QStringLiteral("pdfa1b"), isPDFA1b);
+        callasRecord.insert(QStringLiteral("pdfa1a"), isPDFA1a);
+        validatorsRecord.insert(QStringLiteral("callaspdfapilot"), callasRecord);
         if (!callasPdfAPilotStandardOutput.isEmpty())
             metaText.append(DocScan::xmlifyLines(callasPdfAPilotStandardOutput));
         if (!callasPdfAPilotStandardError.isEmpty())
             metaText.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(callasPdfAPilotStandardError)));
         metaText.append(QStringLiteral("</callaspdfapilot>"));
-    } else if (doRunValidators && !m_callasPdfAPilotCLI.isEmpty())
+    } else if (validatorsSkipped.contains(QStringLiteral("callaspdfapilot")))
+        metaText.append(QString(QStringLiteral("<callaspdfapilot><info skipped=\"%1\">callas PDF/A Pilot skipped by validator policy</info></callaspdfapilot>\n")).arg(validatorsSkipReason));
+    else if (doRunValidators && !m_callasPdfAPilotCLI.isEmpty())
         metaText.append(QStringLiteral("<callaspdfapilot><error>callas PDF/A Pilot failed to start or was never started</error></callaspdfapilot>\n"));
     else
         metaText.append(QStringLiteral("<callaspdfapilot><info>callas PDF/A Pilot not configured to run</info></callaspdfapilot>\n"));
 
+    if (stagedValidators) {
+        const QString policy = m_validatorPolicy == validatorPolicyQuorum ? QString(QStringLiteral("policy=\"quorum\" quorum=\"%1\"")).arg(m_validatorQuorum) : QStringLiteral("policy=\"failfast\"");
+        if (validatorsSkipped.isEmpty())
+            metaText.append(QString(QStringLiteral("<validatorpolicy %1 valid=\"%2\" invalid=\"%3\" />\n")).arg(policy).arg(validatorsValidVerdicts).arg(validatorsInvalidVerdicts));
+        else
+            metaText.append(QString(QStringLiteral("<validatorpolicy %1 valid=\"%2\" invalid=\"%3\" reason=\"%4\" skipped=\"%5\" />\n")).arg(policy).arg(validatorsValidVerdicts).arg(validatorsInvalidVerdicts).arg(validatorsSkipReason, validatorsSkipped.join(QLatin1Char(','))));
+        if (!validatorsSkipped.isEmpty()) {
+            validatorsRecord.insert(QStringLiteral("skipped"), QJsonArray::fromStringList(validatorsSkipped));
+            validatorsRecord.insert(QStringLiteral("skipreason"), validatorsSkipReason);
+        }
+    }
+
     /// file information including size
     const QFileInfo fi = QFileInfo(filename);
     metaText.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(fi.size()));
@@ -1396,14 +2231,28 @@ void FileAnalyzerPDF::analyzeFile(const QString &filename)
     logText.prepend(QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\" time=\"%2\" external_time=\"%3\">\n")).arg(DocScan::xmlify(filename), QString::number(endTime - startTime), QString::number(externalProgramsEndTime - startTime)));
     logText += QStringLiteral("</fileanalysis>\n");
 
-    if (adobePreflightReportAnalysisOk || popplerWrapperOk || jhoveIsPDF || pdfboxValidatorValidPdf)
+    record.insert(QStringLiteral("size"), fi.size());
+    record.insert(QStringLiteral("time"), endTime - startTime);
+    record.insert(QStringLiteral("externaltime"), externalProgramsEndTime - startTime);
+    if (!validatorsRecord.isEmpty())
+        record.insert(QStringLiteral("validators"), validatorsRecord);
+
+    if (adobePreflightReportAnalysisOk || popplerWrapperOk || jhoveIsPDF || pdfboxValidatorValidPdf) {
         /// At least one tool thought the file was ok
         emit analysisReport(objectName(), logText);
-    else
+        record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+    } else {
         /// No tool could handle this file, so give error message
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-fileformat\" status=\"error\" external_time=\"%2\"><meta><file size=\"%3\" /></meta></fileanalysis>\n")).arg(filename, QString::number(externalProgramsEndTime - startTime)).arg(fi.size()));
+        record.insert(QStringLiteral("status"), QStringLiteral("error"));
+        record.insert(QStringLiteral("message"), QStringLiteral("invalid-fileformat"));
+    }
+    emit analysisRecord(objectName(), record);
+    recordLatency(QStringLiteral("report"), stageTimer.nsecsElapsed());
+    recordLatency(QStringLiteral("total"), totalTimer.nsecsElapsed());
 
     m_isAlive = false;
 }
 
+const int FileAnalyzerPDF::TextAccumulator::languageSampleLength = 65536;
 const QStringList FileAnalyzerPDF::blacklistedFileExtensions = QStringList() << QStringLiteral(".pbm") << QStringLiteral(".ppm") << QStringLiteral(".ccitt") << QStringLiteral(".params") << QStringLiteral(".joboptions");
@@ -31,6 +31,9 @@
 #include "fileanalyzerabstract.h"
 #include "jhovewrapper.h"
 
+class PopplerWorkerPool;
+class AdaptiveTimeouts;
+
 /**
  * Analyzing code for Portable Document File documents.
  *
@@ -40,7 +43,10 @@ class FileAnalyzerPDF : public FileAnalyzerAbstract, public JHoveWrapper
 {
     Q_OBJECT
 
+    friend class PopplerWorkerPool;
+
 public:
+    enum ValidatorPolicy {validatorPolicyAll = 0, validatorPolicyFailFast = 1, validatorPolicyQuorum = 2};
     enum XMPPDFConformance {xmpError = -1, xmpNone = 0, xmpPDFA1b = 10, xmpPDFA1a = 11, xmpPDFA2b = 20, xmpPDFA2a = 21, xmpPDFA2u = 22, xmpPDFA3b = 30, xmpPDFA3a = 31, xmpPDFA3u = 32, xmpPDFA4 = 40};
 
     explicit FileAnalyzerPDF(QObject *parent = nullptr);
@@ -67,6 +73,81 @@ public:
 
     void setPDFAValidationOptions(const bool validateOnlyPDFAfiles, const bool downgradeToPDFA1b, const XMPPDFConformance enforcedValidationLevel);
 
+    /**
+     * By default, all configured validators are run concurrently on each file.
+     * With policy 'failfast' or 'quorum', validators are run in stages
+     * with the cheap ones first. No further stage is started once a
+     * validator reported a file to be invalid ('failfast'), or once
+     * the given number of validators agreed on the file being valid
+     * or invalid ('quorum'). In both cases, no further validators are
+     * run on files jHove considers not to be well-formed.
+     * Skipped validators are listed in the report.
+     *
+     * @param validatorPolicy policy when to skip validators
+     * @param quorum number of agreeing validators for policy 'quorum'
+     */
+    void setValidatorPolicy(const ValidatorPolicy validatorPolicy, const int quorum);
+
+    /**
+     * Documents with at least this many pages get their fonts and text
+     * extracted in parallel, with page ranges processed concurrently on
+     * separate Poppler::Document instances.
+     *
+     * @param numPages minimum number of pages for parallel processing, 0 disables it
+     */
+    void setParallelPageThreshold(int numPages);
+
+    /**
+     * In quick analysis mode, only the PDF header, cross-reference data,
+     * the document information dictionary, the page count and the XMP
+     * metadata are read by a built-in parser. Neither Poppler nor any
+     * external validator is run. Files that cannot be handled this way,
+     * such as encrypted or heavily damaged files, get the full analysis.
+     *
+     * @param quickAnalysis true to enable quick analysis mode
+     */
+    void setQuickAnalysis(bool quickAnalysis);
+
+    /**
+     * Let worker processes from this pool perform the Poppler-based
+     * part of the analysis instead of doing it in this process.
+     * Files on which a worker times out get reported with status
+     * 'timeout', files making a worker crash or exceed its memory
+     * limit with status 'error'.
+     *
+     * @param popplerWorkerPool pool to use, or nullptr to use Poppler in this process
+     */
+    void setPopplerWorkerPool(PopplerWorkerPool *popplerWorkerPool);
+
+    /**
+     * Let validators' time limits depend on file size and number of
+     * pages, based on runtimes observed on previous files.
+     *
+     * @param adaptiveTimeouts runtime models to use and update, or nullptr for fixed time limits
+     */
+    void setAdaptiveTimeouts(AdaptiveTimeouts *adaptiveTimeouts);
+
+    /**
+     * Output of veraPDF and PDFBox is parsed while the validators run.
+     * If summarizing, only a summary gets included in the report:
+     * violated rules with their counts and details on the first few
+     * violations. Otherwise, the validators' complete output is included.
+     *
+     * @param summarize true to include summaries only
+     * @param maxFailures number of violations to include details for
+     */
+    void setValidatorOutputSummary(bool summarize, int maxFailures);
+
+    /**
+     * Images embedded in PDF documents as JPEG or JPEG 2000 data get
+     * passed on for analysis if embedded files analysis is enabled.
+     * Limit how many images per document and how large images may be.
+     *
+     * @param maxImages maximum number of images per document, 0 for no limit
+     * @param maxImageSize maximum size of a single image in bytes, 0 for no limit
+     */
+    void setEmbeddedImageLimits(int maxImages, int maxImageSize);
+
 public slots:
     virtual void analyzeFile(const QString &filename) override;
 
@@ -95,11 +176,88 @@ private:
             pageNumbers.insert(pageNumber);
         }
 
+        void merge(const ExtendedFontInfo &other) {
+            if (other.firstPageNumber < firstPageNumber) firstPageNumber = other.firstPageNumber;
+            if (other.lastPageNumber > lastPageNumber) lastPageNumber = other.lastPageNumber;
+            pageNumbers.unite(other.pageNumbers);
+        }
+
         bool isValid() const {
             return lastPageNumber > INT_MIN && firstPageNumber < INT_MAX && firstPageNumber <= lastPageNumber;
         }
     };
 
+    /**
+     * Receives a document's text page by page, keeping only what
+     * is requested by the text extraction mode: the length, the
+     * XML-escaped text, and a beginning of the text for guessing
+     * the language. The page's text itself is not kept.
+     */
+    struct TextAccumulator {
+        TextExtraction textExtraction;
+        int maxCharacters;
+        int length;
+        bool truncated;
+        QString escapedText, languageSample;
+
+        /// Number of characters used for guessing the language
+        static const int languageSampleLength;
+
+        explicit TextAccumulator(TextExtraction _textExtraction, int _maxCharacters)
+            : textExtraction(_textExtraction), maxCharacters(_maxCharacters), length(0), truncated(false) {
+            /// nothing
+        }
+
+        /**
+         * Add the text of the next page, cutting it if the
+         * maximum number of characters is reached.
+         *
+         * @param pageText text of a single page
+         * @return true if more text can be added
+         */
+        bool addPage(const QString &pageText);
+
+        /**
+         * Add the length of text of following pages whose text
+         * itself is of no interest, as for extraction mode teLength.
+         *
+         * @param textLength number of characters
+         * @return true if more text can be added
+         */
+        bool addLength(int textLength);
+    };
+
+    /// Fonts and text as found in a range of pages
+    struct PageRangeResult {
+        bool ok;
+        QHash<QString, struct ExtendedFontInfo> knownFonts;
+        /// Pages' text, only kept if no TextAccumulator is used,
+        /// and no more than maxTextCharacters characters.
+        /// If only the text's length is needed, pages are just counted
+        QStringList pageTexts;
+        bool lengthOnly;
+        int maxTextCharacters, pageTextsLength;
+        bool textTruncated;
+        qint64 fontsNanoseconds, textNanoseconds;
+
+        explicit PageRangeResult(int _maxTextCharacters = 0, bool _lengthOnly = false)
+            : ok(true), lengthOnly(_lengthOnly), maxTextCharacters(_maxTextCharacters), pageTextsLength(0), textTruncated(false), fontsNanoseconds(0), textNanoseconds(0) {
+            /// nothing
+        }
+
+        /// Merge result of a range of pages following this range
+        void merge(const PageRangeResult &other) {
+            for (QHash<QString, struct ExtendedFontInfo>::ConstIterator it = other.knownFonts.constBegin(); it != other.knownFonts.constEnd(); ++it) {
+                if (knownFonts.contains(it.key()))
+                    knownFonts[it.key()].merge(it.value());
+                else
+                    knownFonts.insert(it.key(), it.value());
+            }
+            fontsNanoseconds += other.fontsNanoseconds;
+            textNanoseconds += other.textNanoseconds;
+        }
+    };
+
     bool m_isAlive;
     QString m_veraPDFcliTool;
     QString m_pdfboxValidatorJavaClass;
@@ -110,16 +268,46 @@ private:
     QString m_toAnalyzeFilename, m_aliasFilename;
     bool m_validateOnlyPDFAfiles, m_downgradeToPDFA1b;
     XMPPDFConformance m_enforcedValidationLevel;
+    ValidatorPolicy m_validatorPolicy;
+    int m_validatorQuorum;
     QTemporaryDir m_tempDirDowngradeToPDFA1b;
+    int m_parallelPageThreshold;
+    bool m_quickAnalysis;
+    PopplerWorkerPool *m_popplerWorkerPool;
+    AdaptiveTimeouts *m_adaptiveTimeouts;
+    bool m_summarizeValidatorOutput;
+    int m_validatorOutputMaxFailures;
+    int m_maxEmbeddedImages, m_maxEmbeddedImageSize;
 
     static const QStringList blacklistedFileExtensions;
 
     enum PDFVersion { pdfVersionError = -1, pdfVersion1dot1 = 11, pdfVersion1dot2 = 12, pdfVersion1dot3 = 13, pdfVersion1dot4 = 14, pdfVersion1dot5 = 15, pdfVersion1dot6 = 16, pdfVersion1dot7 = 17, pdfVersion2dot0 = 20, pdfVersion2dot1 = 21, pdfVersion2dot2 = 22};
 
-    bool popplerAnalysis(const QString &filename, QString &logText, QString &metaText);
+    bool popplerAnalysis(const QString &filename, QString &logText, QString &metaText, QJsonObject &record);
+
+    /// Time limit in milliseconds for running a validator on a file
+    int validatorTimeLimit(const QString &validator, qint64 fileSize, int numPages, int defaultTimeLimit);
+    /// Runs killed after exceeding their time limit are recorded as lower bounds of runtimes
+    void recordValidatorRuntime(const QString &validator, qint64 fileSize, int numPages, qint64 milliseconds, bool exceededTimeLimit);
+
+    /**
+     * Analyze file using PDFQuickParser only and report results.
+     *
+     * @param filename PDF file to analyze
+     * @return false if file could not be analyzed this way and nothing was reported
+     */
+    bool quickAnalysis(const QString &filename);
+    /**
+     * Collect fonts of pages firstPage to lastPage and text of pages
+     * firstPage to lastTextPage. Text gets passed to textAccumulator
+     * page by page or, if textAccumulator is nullptr, stored in result.
+     */
+    static void analyzePageRange(Poppler::Document *popplerDocument, int firstPage, int lastPage, int lastTextPage, struct TextAccumulator *textAccumulator, struct PageRangeResult &result);
+    static struct PageRangeResult analyzePageRangeInNewDocument(const QString &filename, int firstPage, int lastPage, int lastTextPage, int maxTextCharacters, bool lengthOnly);
     PDFVersion pdfVersionAnalysis(const QString &filename);
     inline QString pdfVersionToString(const PDFVersion pdfVersion) const;
     XMPPDFConformance xmpAnalysis(const QString &filename, const PDFVersion pdfVersion, QString &metaText);
+    XMPPDFConformance xmpConformanceAnalysis(const QString &output, const PDFVersion pdfVersion, QString &metaText);
     inline QString xmpPDFConformanceToString(const XMPPDFConformance xmpPDFConformance) const;
 
     /**
@@ -133,7 +321,7 @@ private:
     inline bool pdfVersionMatchesXMPconformance(const FileAnalyzerPDF::PDFVersion pdfVersion, const FileAnalyzerPDF::XMPPDFConformance xmpPDFConformance);
 
     bool downgradingPDFA(const QString &filename);
-    bool adobePreflightReportAnalysis(const QString &filename, QString &metaText);
+    bool adobePreflightReportAnalysis(const QString &filename, QString &metaText, QJsonObject &validatorsRecord);
     void extractImages(QString &metaText, const QString &filename);
     void extractEmbeddedFiles(QString &metaText, Poppler::Document *popplerDocument);
 
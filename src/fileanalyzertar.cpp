@@ -0,0 +1,448 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "fileanalyzertar.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QScopedPointer>
+
+#include <zlib.h>
+
+#include <limits>
+
+#include "contentsniffer.h"
+#include "general.h"
+
+/// Tar archives consist of headers and data padded to blocks of this size
+static const qint64 blockSize = 512;
+/// GNU long names and pax extended headers larger than this are considered broken
+static const qint64 maxMetadataSize = 1 << 20;
+/// Members are read into memory as a whole, so never accept larger members
+static const qint64 maxInMemorySize = 1 << 30;
+/// Time to wait for an external uncompression tool to deliver more data
+static const int readTimeout = 60000;
+
+/**
+ * Sequential device inflating gzip-compressed data as read from
+ * another device, so that .tar.gz files can be read without
+ * running an external uncompression tool.
+ */
+class InflateDevice : public QIODevice
+{
+public:
+    explicit InflateDevice(QIODevice *source)
+        : QIODevice(), m_source(source), m_streamEnded(false), m_failed(false) {
+        m_stream.zalloc = Z_NULL;
+        m_stream.zfree = Z_NULL;
+        m_stream.opaque = Z_NULL;
+        m_stream.next_in = Z_NULL;
+        m_stream.avail_in = 0;
+    }
+
+    ~InflateDevice() {
+        close();
+    }
+
+    virtual bool isSequential() const override {
+        return true;
+    }
+
+    virtual bool open(OpenMode mode) override {
+        if ((mode & QIODevice::WriteOnly) != 0) return false;
+        /// Adding 16 to window bits makes zlib expect a gzip header
+        if (inflateInit2(&m_stream, 16 + MAX_WBITS) != Z_OK) return false;
+        return QIODevice::open(mode);
+    }
+
+    virtual void close() override {
+        if (isOpen()) inflateEnd(&m_stream);
+        QIODevice::close();
+    }
+
+    /// Compressed data was corrupt, as opposed to just ending early
+    bool hasFailed() const {
+        return m_failed;
+    }
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize) override {
+        static const qint64 inputChunkSize = 1 << 16;
+
+        m_stream.next_out = reinterpret_cast<Bytef *>(data);
+        m_stream.avail_out = static_cast<uInt>(qMin(maxSize, maxInMemorySize));
+        const uInt initialAvailOut = m_stream.avail_out;
+        while (m_stream.avail_out == initialAvailOut && !m_streamEnded) {
+            if (m_stream.avail_in == 0) {
+                m_input = m_source->read(inputChunkSize);
+                if (m_input.isEmpty()) break; ///< end of compressed data
+                m_stream.next_in = reinterpret_cast<Bytef *>(m_input.data());
+                m_stream.avail_in = static_cast<uInt>(m_input.size());
+            }
+            const int result = inflate(&m_stream, Z_NO_FLUSH);
+            if (result == Z_STREAM_END) {
+                /// Several concatenated gzip members form a single stream
+                if (m_stream.avail_in > 0 || !m_source->atEnd())
+                    inflateReset(&m_stream);
+                else
+                    m_streamEnded = true;
+            } else if (result != Z_OK && result != Z_BUF_ERROR) {
+                setErrorString(QString::fromLatin1(m_stream.msg != Z_NULL ? m_stream.msg : "inflate failed"));
+                m_streamEnded = m_failed = true;
+                if (m_stream.avail_out == initialAvailOut)
+                    return -1;
+            }
+        }
+        return initialAvailOut - m_stream.avail_out;
+    }
+
+    virtual qint64 writeData(const char *, qint64) override {
+        return -1;
+    }
+
+private:
+    QIODevice *m_source;
+    z_stream m_stream;
+    QByteArray m_input;
+    bool m_streamEnded, m_failed;
+};
+
+/// Name of a tar archive's compression as used in reports
+static QString compressionName(ContentSniffer::FileType compression) {
+    switch (compression) {
+    case ContentSniffer::ftGzip: return QStringLiteral("gzip");
+    case ContentSniffer::ftXz: return QStringLiteral("xz");
+    case ContentSniffer::ftBzip2: return QStringLiteral("bzip2");
+    case ContentSniffer::ftLzma: return QStringLiteral("lzma");
+    default: return QStringLiteral("none");
+    }
+}
+
+/// Read exactly that many bytes unless the device's data ends
+static qint64 readFully(QIODevice &device, char *data, qint64 size) {
+    qint64 total = 0;
+    while (total < size) {
+        const qint64 n = device.read(data + total, size - total);
+        if (n < 0) break;
+        /// Only devices like QProcess deliver more data later
+        if (n == 0 && !device.waitForReadyRead(readTimeout)) break;
+        total += n;
+    }
+    return total;
+}
+
+/// Skip data, seeking if possible and reading otherwise
+static bool skipFully(QIODevice &device, qint64 size) {
+    if (size <= 0) return true;
+    if (!device.isSequential())
+        return device.pos() + size <= device.size() && device.seek(device.pos() + size);
+
+    static const qint64 chunkSize = 1 << 16;
+    QByteArray buffer(static_cast<int>(chunkSize), '\0');
+    while (size > 0) {
+        const qint64 n = readFully(device, buffer.data(), qMin(size, chunkSize));
+        if (n <= 0) return false;
+        size -= n;
+    }
+    return true;
+}
+
+/// Parse a header's numeric field, either octal or GNU's base-256 encoding
+static qint64 parseNumber(const char *field, int length) {
+    if ((field[0] & 0x80) != 0) {
+        if ((field[0] & 0x40) != 0) return -1; ///< negative numbers
+        qint64 value = field[0] & 0x3f;
+        for (int i = 1; i < length; ++i) {
+            if (value > (std::numeric_limits<qint64>::max() >> 8)) return -1;
+            value = (value << 8) | static_cast<unsigned char>(field[i]);
+        }
+        return value;
+    }
+
+    int i = 0;
+    while (i < length && field[i] == ' ') ++i;
+    qint64 value = 0;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        if (value > (std::numeric_limits<qint64>::max() >> 3)) return -1;
+        value = (value << 3) | (field[i] - '0');
+    }
+    return value;
+}
+
+/// Text from a header's field, which is not necessarily null-terminated
+static QString headerString(const char *field, int length) {
+    return QString::fromUtf8(field, static_cast<int>(qstrnlen(field, static_cast<uint>(length))));
+}
+
+static bool isZeroBlock(const char *block) {
+    for (int i = 0; i < blockSize; ++i)
+        if (block[i] != '\0') return false;
+    return true;
+}
+
+/// Header checksum is the sum of all header bytes, its own field counted as spaces
+static bool validChecksum(const char *block) {
+    const qint64 expected = parseNumber(block + 148, 8);
+    qint64 sum = 0;
+    for (int i = 0; i < blockSize; ++i)
+        sum += i >= 148 && i < 156 ? ' ' : static_cast<unsigned char>(block[i]);
+    return sum == expected;
+}
+
+/// Pick path and size from a pax extended header's 'length key=value\n' records
+static void parsePaxHeader(const QByteArray &data, QString &path, qint64 &size) {
+    int pos = 0;
+    while (pos < data.size()) {
+        const int space = data.indexOf(' ', pos);
+        if (space < 0) break;
+        bool ok = false;
+        const int length = data.mid(pos, space - pos).toInt(&ok);
+        if (!ok || length <= space - pos + 1 || pos + length > data.size()) break;
+        const QByteArray record = data.mid(space + 1, pos + length - space - 2); ///< without trailing newline
+        const int equals = record.indexOf('=');
+        if (equals > 0) {
+            const QByteArray key = record.left(equals);
+            if (key == "path")
+                path = QString::fromUtf8(record.mid(equals + 1));
+            else if (key == "size") {
+                const qint64 value = record.mid(equals + 1).toLongLong(&ok);
+                if (ok && value >= 0) size = value;
+            }
+        }
+        pos += length;
+    }
+}
+
+FileAnalyzerTar::FileAnalyzerTar(QObject *parent)
+    : FileAnalyzerArchive(parent), m_listOnly(false), m_maxMemberSize(256 << 20), m_maxMembers(10000), m_maxNestingDepth(2)
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+}
+
+void FileAnalyzerTar::setLimits(bool listOnly, qint64 maxMemberSize, int maxMembers, int maxNestingDepth) {
+    m_listOnly = listOnly;
+    m_maxMemberSize = maxMemberSize;
+    m_maxMembers = maxMembers;
+    m_maxNestingDepth = maxNestingDepth;
+}
+
+void FileAnalyzerTar::analyzeFile(const QString &filename)
+{
+    const int nestingDepth = enterArchive();
+
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) {
+        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"failed-to-open\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("failed-to-open")));
+        leaveArchive();
+        return;
+    }
+
+    /// Data gets uncompressed while being read: gzip in-process,
+    /// all other compressions by piping the output of their tools
+    const QString compression = compressionName(ContentSniffer(file.peek(ContentSniffer::headerSize), filename).compression());
+    QIODevice *device = &file;
+    QScopedPointer<InflateDevice> inflateDevice;
+    QProcess uncompressProcess(this);
+    if (compression == QStringLiteral("gzip")) {
+        inflateDevice.reset(new InflateDevice(&file));
+        inflateDevice->open(QIODevice::ReadOnly);
+        device = inflateDevice.data();
+    } else if (compression != QStringLiteral("none")) {
+        file.close();
+        const QString uncompressTool = compression == QStringLiteral("xz") ? QStringLiteral("unxz") : (compression == QStringLiteral("bzip2") ? QStringLiteral("bunzip2") : QStringLiteral("unlzma"));
+        uncompressProcess.start(uncompressTool, QStringList() << QStringLiteral("-c") << filename, QIODevice::ReadOnly);
+        uncompressProcess.waitForStarted();
+        device = &uncompressProcess;
+    }
+
+    /// Archives nested too deeply into other archives are only listed
+    const bool listOnly = m_listOnly || nestingDepth > m_maxNestingDepth;
+    QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\"><embeddedfiles mode=\"%2\" compression=\"%3\">\n")).arg(DocScan::xmlify(filename), listOnly ? QStringLiteral("list") : QStringLiteral("analyze"), compression);
+    int numMembers = 0, numExtracted = 0, numSkipped = 0;
+    bool validArchive = false;
+    QString streamError, longName, paxPath;
+    qint64 paxSize = -1;
+    char block[blockSize];
+    forever {
+        const qint64 headerSize = readFully(*device, block, blockSize);
+        if (headerSize == 0 && validArchive) break; ///< some writers omit end-of-archive blocks
+        if (headerSize != blockSize) {
+            streamError = QStringLiteral("truncated");
+            break;
+        }
+        if (isZeroBlock(block)) break; ///< end of archive
+        if (!validChecksum(block)) {
+            streamError = QStringLiteral("invalid-header");
+            break;
+        }
+        validArchive = true;
+
+        const char type = block[156];
+        qint64 size = parseNumber(block + 124, 12);
+        if (size < 0) {
+            streamError = QStringLiteral("invalid-header");
+            break;
+        }
+
+        if (type == 'L' || type == 'x') {
+            /// GNU long name or pax extended header, both applying to the following member
+            if (size > maxMetadataSize) {
+                streamError = QStringLiteral("invalid-header");
+                break;
+            }
+            QByteArray data(static_cast<int>(size), '\0');
+            if (readFully(*device, data.data(), size) != size || !skipFully(*device, (blockSize - size % blockSize) % blockSize)) {
+                streamError = QStringLiteral("truncated");
+                break;
+            }
+            if (type == 'L')
+                longName = headerString(data.constData(), data.size());
+            else
+                parsePaxHeader(data, paxPath, paxSize);
+            continue;
+        }
+
+        QString name = !paxPath.isEmpty() ? paxPath : longName;
+        if (name.isEmpty()) {
+            name = headerString(block, 100);
+            /// POSIX ustar headers may split long names into prefix and name
+            const QString prefix = qstrncmp(block + 257, "ustar", 6) == 0 ? headerString(block + 345, 155) : QString();
+            if (!prefix.isEmpty())
+                name = prefix + QLatin1Char('/') + name;
+        }
+        if (paxSize >= 0) size = paxSize;
+        longName.clear();
+        paxPath.clear();
+        paxSize = -1;
+        const qint64 padding = (blockSize - size % blockSize) % blockSize;
+
+        if (type != '0' && type != '\0' && type != '7') {
+            /// Directories, links, devices, global pax headers, ...
+            if (!skipFully(*device, size + padding)) {
+                streamError = QStringLiteral("truncated");
+                break;
+            }
+            continue;
+        }
+
+        if (m_maxMembers > 0 && numMembers >= m_maxMembers) {
+            /// Total number of members remains unknown without reading the remaining archive
+            report.append(QStringLiteral("<truncated />\n"));
+            break;
+        }
+        ++numMembers;
+
+        QString mimetype = DocScan::guessMimetype(name);
+        QString temporaryFilename, skipReason, error;
+        qint64 remaining = size;
+        if (listOnly) {
+            /// Headers provide everything to report
+        } else if ((m_maxMemberSize > 0 && size > m_maxMemberSize) || size > maxInMemorySize)
+            skipReason = QStringLiteral("toolarge");
+        else {
+            /// Leading bytes tell a member's type regardless of its name
+            const qint64 headSize = qMin(size, static_cast<qint64>(ContentSniffer::headerSize));
+            QByteArray data(static_cast<int>(headSize), '\0');
+            if (readFully(*device, data.data(), headSize) == headSize) {
+                remaining -= headSize;
+                const ContentSniffer sniffer(data, name);
+                if (sniffer.fileType() != ContentSniffer::ftUnknown)
+                    mimetype = sniffer.mimetype();
+                if (!filtersMatch(name, sniffer.extensions()))
+                    skipReason = QStringLiteral("unmatched");
+                else {
+                    data.resize(static_cast<int>(size));
+                    if (readFully(*device, data.data() + headSize, remaining) == remaining) {
+                        remaining = 0;
+                        temporaryFilename = dataToTemporaryFile(data, mimetype);
+                        if (temporaryFilename.isEmpty())
+                            error = QStringLiteral("failed-to-write");
+                    } else
+                        error = QStringLiteral("truncated");
+                }
+            } else
+                error = QStringLiteral("truncated");
+        }
+
+        if (error == QStringLiteral("truncated") || !skipFully(*device, remaining + padding)) {
+            report.append(QString(QStringLiteral("<error status=\"truncated\">%1</error>\n")).arg(DocScan::xmlify(name)));
+            streamError = QStringLiteral("truncated");
+            break;
+        } else if (!error.isEmpty()) {
+            report.append(QString(QStringLiteral("<error status=\"%2\">%1</error>\n")).arg(DocScan::xmlify(name), error));
+            continue;
+        }
+
+        const QString sizeAsAttribute = QString(QStringLiteral(" size=\"%1\"")).arg(size);
+        const QString mimetypeAsAttribute = QString(QStringLiteral(" mimetype=\"%1\"")).arg(mimetype);
+        const QString skippedAsAttribute = skipReason.isEmpty() ? QString() : QString(QStringLiteral(" skipped=\"%1\"")).arg(skipReason);
+        const QString embeddedFile = QStringLiteral("<embeddedfile") + sizeAsAttribute + mimetypeAsAttribute + skippedAsAttribute + QStringLiteral("><filename>") + DocScan::xmlify(name) + QStringLiteral("</filename>") + (temporaryFilename.isEmpty() ? QString() : QStringLiteral("<temporaryfilename>") + temporaryFilename /** no need for DocScan::xmlify */ + QStringLiteral("</temporaryfilename>")) + QStringLiteral("</embeddedfile>\n");
+        report.append(embeddedFile);
+
+        if (!skipReason.isEmpty())
+            ++numSkipped;
+        else if (!temporaryFilename.isEmpty()) {
+            ++numExtracted;
+            /// Extracted file gets analyzed and removed right away,
+            /// while reading the archive pauses
+            emit foundEmbeddedFile(temporaryFilename);
+        }
+    }
+
+    if (uncompressProcess.state() != QProcess::NotRunning) {
+        /// Reading may stop before the end of the archive's data
+        uncompressProcess.kill();
+        uncompressProcess.waitForFinished();
+    } else if (compression != QStringLiteral("none") && compression != QStringLiteral("gzip") && streamError.isEmpty() && (uncompressProcess.exitStatus() != QProcess::NormalExit || uncompressProcess.exitCode() != 0))
+        streamError = QStringLiteral("uncompression-failed");
+    if (!inflateDevice.isNull() && inflateDevice->hasFailed())
+        streamError = QStringLiteral("uncompression-failed");
+
+    if (validArchive) {
+        if (!streamError.isEmpty())
+            report.append(QString(QStringLiteral("<error status=\"%1\" />\n")).arg(streamError));
+        report.append(QStringLiteral("</embeddedfiles></fileanalysis>\n"));
+        emit analysisReport(objectName(), report);
+
+        QJsonObject record;
+        record.insert(QStringLiteral("filename"), filename);
+        record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+        record.insert(QStringLiteral("mimetype"), QStringLiteral("application/x-tar"));
+        record.insert(QStringLiteral("size"), QFileInfo(filename).size());
+        record.insert(QStringLiteral("compression"), compression);
+        record.insert(QStringLiteral("members"), numMembers);
+        record.insert(QStringLiteral("embeddedfiles"), numExtracted);
+        record.insert(QStringLiteral("skipped"), numSkipped);
+        record.insert(QStringLiteral("listonly"), listOnly);
+        if (!streamError.isEmpty())
+            record.insert(QStringLiteral("error"), streamError);
+        emit analysisRecord(objectName(), record);
+    } else {
+        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-fileformat\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-fileformat")));
+    }
+
+    leaveArchive();
+}
@@ -0,0 +1,63 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef FILEANALYZERTAR_H
+#define FILEANALYZERTAR_H
+
+#include "fileanalyzerarchive.h"
+
+/**
+ * Analyzing code for tar archives, either uncompressed or
+ * compressed with gzip, xz, bzip2, or lzma.
+ * The archive is read in a single sequential pass without
+ * unpacking it to disk first; matching members are read into
+ * memory and handed on for analysis, all other members are
+ * skipped.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class FileAnalyzerTar : public FileAnalyzerArchive
+{
+    Q_OBJECT
+public:
+    explicit FileAnalyzerTar(QObject *parent = nullptr);
+
+    /**
+     * Protect against huge archives.
+     *
+     * @param listOnly only report members as listed in their headers, never extract them
+     * @param maxMemberSize members larger than this many bytes are not extracted, 0 for no limit
+     * @param maxMembers archive members beyond this number are ignored, 0 for no limit
+     * @param maxNestingDepth archives nested deeper into other archives are only listed
+     */
+    void setLimits(bool listOnly, qint64 maxMemberSize, int maxMembers, int maxNestingDepth);
+
+public slots:
+    virtual void analyzeFile(const QString &filename) override;
+
+private:
+    bool m_listOnly;
+    qint64 m_maxMemberSize;
+    int m_maxMembers, m_maxNestingDepth;
+};
+
+#endif // FILEANALYZERTAR_H
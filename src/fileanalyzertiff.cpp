@@ -23,26 +23,29 @@
 #include "fileanalyzertiff.h"
 
 #include <QDebug>
-#include <QRegularExpression>
-#include <QRegularExpressionMatchIterator>
+#include <QDir>
+#include <QJsonArray>
+#include <QRegExp>
 #include <QTemporaryDir>
 
 #include "general.h"
+#include "tiffparser.h"
 
 static const int oneMinuteInMillisec = 60000;
-static const int twoMinutesInMillisec = oneMinuteInMillisec * 2;
 static const int fourMinutesInMillisec = oneMinuteInMillisec * 4;
-static const int sixMinutesInMillisec = oneMinuteInMillisec * 6;
+
+/// Pages listed individually in the report, further pages are only counted
+static const int maxReportedPages = 256;
 
 FileAnalyzerTIFF::FileAnalyzerTIFF(QObject *parent)
-    : FileAnalyzerAbstract(parent)
+    : FileAnalyzerAbstract(parent), m_isAlive(false), m_runJhove(false)
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
 }
 
 bool FileAnalyzerTIFF::isAlive()
 {
-    return false; // TODO
+    return m_isAlive;
 }
 
 void FileAnalyzerTIFF::setupJhove(const QString &shellscript) {
@@ -59,154 +62,149 @@ void FileAnalyzerTIFF::setupDPFManager(const QString &dpfmangerJFXjar_) {
     dpfmangerJFXjar = dpfmangerJFXjar_;
 }
 
+void FileAnalyzerTIFF::setJhoveValidation(bool runJhove) {
+    m_runJhove = runJhove;
+}
+
 void FileAnalyzerTIFF::analyzeFile(const QString &filename)
 {
-    /// External programs should be both CPU and I/O 'nice'
-    static const QStringList defaultArgumentsForNice = QStringList() << QStringLiteral("-n") << QStringLiteral("17") << QStringLiteral("ionice") << QStringLiteral("-c") << QStringLiteral("3");
+    m_isAlive = true;
+
+    TIFFParser parser(filename);
+    if (!parser.parse()) {
+        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"%2\" status=\"error\" />\n")).arg(DocScan::xmlify(filename), DocScan::xmlify(parser.errorMessage())));
+        emit analysisRecord(objectName(), errorRecord(filename, parser.errorMessage()));
+        m_isAlive = false;
+        return;
+    }
+
+    const QList<TIFFParser::Page> &pages = parser.pages();
+    const TIFFParser::Page &firstPage = pages.first();
+
+    QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename));
+    report.append(QString(QStringLiteral("<tiff wellformed=\"%1\" bigtiff=\"%2\" byteorder=\"%3\" pages=\"%4\" xmp=\"%5\">\n")).arg(parser.isWellFormed() ? QStringLiteral("yes") : QStringLiteral("no"), parser.isBigTIFF() ? QStringLiteral("yes") : QStringLiteral("no"), parser.isBigEndian() ? QStringLiteral("bigendian") : QStringLiteral("littleendian"), QString::number(pages.count()), parser.hasXMP() ? QStringLiteral("yes") : QStringLiteral("no")));
+    QJsonArray pagesArray;
+    for (int i = 0; i < pages.count() && i < maxReportedPages; ++i) {
+        const TIFFParser::Page &page = pages[i];
+        report.append(QString(QStringLiteral("<page number=\"%1\" width=\"%2\" height=\"%3\" compression=\"%4\" photometric=\"%5\" bitspersample=\"%6\" samplesperpixel=\"%7\"")).arg(QString::number(i + 1), QString::number(page.width), QString::number(page.height), TIFFParser::compressionToString(page.compression), TIFFParser::photometricInterpretationToString(page.photometricInterpretation), QString::number(page.bitsPerSample), QString::number(page.samplesPerPixel)));
+        if (page.tiled)
+            report.append(QString(QStringLiteral(" tiled=\"yes\" tilewidth=\"%1\" tileheight=\"%2\" tiles=\"%3\" />\n")).arg(page.tileWidth).arg(page.tileHeight).arg(page.numSegments));
+        else
+            report.append(QString(QStringLiteral(" tiled=\"no\" strips=\"%1\" />\n")).arg(page.numSegments));
+
+        QJsonObject pageRecord;
+        pageRecord.insert(QStringLiteral("width"), page.width);
+        pageRecord.insert(QStringLiteral("height"), page.height);
+        pageRecord.insert(QStringLiteral("compression"), TIFFParser::compressionToString(page.compression));
+        pageRecord.insert(QStringLiteral("photometric"), TIFFParser::photometricInterpretationToString(page.photometricInterpretation));
+        pageRecord.insert(QStringLiteral("bitspersample"), page.bitsPerSample);
+        pageRecord.insert(QStringLiteral("samplesperpixel"), page.samplesPerPixel);
+        pageRecord.insert(QStringLiteral("tiled"), page.tiled);
+        if (page.tiled) {
+            pageRecord.insert(QStringLiteral("tilewidth"), page.tileWidth);
+            pageRecord.insert(QStringLiteral("tileheight"), page.tileHeight);
+        }
+        pagesArray.append(pageRecord);
+    }
+    const QStringList structuralErrors = parser.structuralErrors();
+    for (const QString &error : structuralErrors)
+        report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlify(error)));
+    report.append(QStringLiteral("</tiff>\n"));
+
+    report.append(QStringLiteral("<meta>\n"));
+    if (parser.creationDate().isValid())
+        report.append(DocScan::formatDateTime(parser.creationDate(), creationDate));
+    if (parser.modificationDate().isValid())
+        report.append(DocScan::formatDateTime(parser.modificationDate(), modificationDate));
+    report.append(QString(QStringLiteral("<rect width=\"%1\" height=\"%2\" />\n")).arg(firstPage.width).arg(firstPage.height));
+    report.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(parser.fileSize()));
+    report.append(QStringLiteral("</meta>\n"));
+
+    QJsonObject record;
+    record.insert(QStringLiteral("filename"), filename);
+    record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+    record.insert(QStringLiteral("mimetype"), QStringLiteral("image/tiff"));
+    record.insert(QStringLiteral("width"), firstPage.width);
+    record.insert(QStringLiteral("height"), firstPage.height);
+    record.insert(QStringLiteral("size"), parser.fileSize());
+    if (parser.creationDate().isValid())
+        record.insert(QStringLiteral("creationdate"), parser.creationDate().toString(Qt::ISODate));
+    if (parser.modificationDate().isValid())
+        record.insert(QStringLiteral("modificationdate"), parser.modificationDate().toString(Qt::ISODate));
+    QJsonObject tiffRecord;
+    tiffRecord.insert(QStringLiteral("wellformed"), parser.isWellFormed());
+    tiffRecord.insert(QStringLiteral("bigtiff"), parser.isBigTIFF());
+    tiffRecord.insert(QStringLiteral("bigendian"), parser.isBigEndian());
+    tiffRecord.insert(QStringLiteral("numpages"), pages.count());
+    tiffRecord.insert(QStringLiteral("xmp"), parser.hasXMP());
+    tiffRecord.insert(QStringLiteral("pages"), pagesArray);
+    if (!structuralErrors.isEmpty())
+        tiffRecord.insert(QStringLiteral("errors"), QJsonArray::fromStringList(structuralErrors));
+    record.insert(QStringLiteral("tiff"), tiffRecord);
+
+    QJsonObject validatorsRecord;
+
+    if (m_runJhove)
+        reportJHove(this, JHoveTIFF, filename, QStringLiteral("image/tiff"), QStringLiteral("tiff"), report, validatorsRecord);
+
+    /// DPF Manager is run only if configured
+    if (!dpfmangerJFXjar.isEmpty()) {
+        const QString dpfManagerResult = runDPFManager(filename);
+        report.append(dpfManagerResult);
+        validatorsRecord.insert(QStringLiteral("dpfmanager"), QJsonObject{{QStringLiteral("tiff"), dpfManagerResult.contains(QStringLiteral(" tiff=\"yes\""))}, {QStringLiteral("baseline"), dpfManagerResult.contains(QStringLiteral(" baseline=\"yes\""))}, {QStringLiteral("extended"), dpfManagerResult.contains(QStringLiteral(" extended=\"yes\""))}});
+    }
+    if (!validatorsRecord.isEmpty())
+        record.insert(QStringLiteral("validators"), validatorsRecord);
 
-    // TODO code de-duplication with FileAnalyzerJPEG and FileAnalyzerJP2
+    report.append(QStringLiteral("</fileanalysis>"));
+    emit analysisReport(objectName(), report);
+    emit analysisRecord(objectName(), record);
 
-    QProcess *jhoveProcess = launchJHove(this, JHoveTIFF, filename);
-    QByteArray jhoveStandardOutputData, jhoveStandardErrorData;
-    connect(jhoveProcess, &QProcess::readyReadStandardOutput, [jhoveProcess, &jhoveStandardOutputData]() {
-        const QByteArray d(jhoveProcess->readAllStandardOutput());
-        jhoveStandardOutputData.append(d);
-    });
-    connect(jhoveProcess, &QProcess::readyReadStandardError, [jhoveProcess, &jhoveStandardErrorData]() {
-        const QByteArray d(jhoveProcess->readAllStandardError());
-        jhoveStandardErrorData.append(d);
-    });
-    const bool jhoveStarted = jhoveProcess != nullptr && jhoveProcess->waitForStarted(oneMinuteInMillisec);
-    if (jhoveProcess != nullptr && !jhoveStarted)
-        qWarning() << "Failed to start jhove for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
+    m_isAlive = false;
+}
+
+QString FileAnalyzerTIFF::runDPFManager(const QString &filename)
+{
+    /// External programs should be both CPU and I/O 'nice'
+    static const QStringList defaultArgumentsForNice = QStringList() << QStringLiteral("-n") << QStringLiteral("17") << QStringLiteral("ionice") << QStringLiteral("-c") << QStringLiteral("3");
 
     QProcess dpfManagerProcess(this);
-    QByteArray dpfManagerStandardOutputData, dpfManagerStandardErrorData;
+    QByteArray dpfManagerStandardOutputData;
     connect(&dpfManagerProcess, &QProcess::readyReadStandardOutput, [&dpfManagerProcess, &dpfManagerStandardOutputData]() {
         const QByteArray d(dpfManagerProcess.readAllStandardOutput());
         dpfManagerStandardOutputData.append(d);
     });
-    connect(&dpfManagerProcess, &QProcess::readyReadStandardError, [&dpfManagerProcess, &dpfManagerStandardErrorData]() {
-        const QByteArray d(dpfManagerProcess.readAllStandardError());
-        dpfManagerStandardErrorData.append(d);
-    });
     QTemporaryDir dpfManagerTempDir;
     const QStringList dpfManagerArguments = QStringList(defaultArgumentsForNice) << QStringLiteral("java") << QStringLiteral("-Duser.home=") + dpfManagerTempDir.path() + QStringLiteral("/home") << QStringLiteral("-jar") << dpfmangerJFXjar << QStringLiteral("check") << QStringLiteral("-f")  << QStringLiteral("xml") << QStringLiteral("-o") << dpfManagerTempDir.path() + QStringLiteral("/output") << QStringLiteral("-r") << QStringLiteral("0") << filename;
     dpfManagerProcess.setWorkingDirectory(dpfManagerTempDir.path());
     dpfManagerProcess.start(QStringLiteral("/usr/bin/nice"), dpfManagerArguments, QIODevice::ReadOnly);
-    const bool dpfManagerStarted = dpfManagerProcess.waitForStarted(oneMinuteInMillisec);
-
-    int jhoveExitCode = INT_MIN;
-    bool jhoveIsTIFF = false;
-    bool jhoveIsWellformedAndValid = false;
-    int jhoveImageWidth = INT_MIN, jhoveImageHeight = INT_MIN, jhoveFilesize = INT_MIN;
-    QString jhoveErrorMessage;
-    QDate jhoveCreationDate, jhoveModificationDate;
-    QString jhoveStandardOutput;
-    QString jhoveErrorOutput;
-    if (jhoveStarted) {
-        if (!jhoveProcess->waitForFinished(fourMinutesInMillisec))
-            qWarning() << "Waiting for jHove failed or exceeded time limit for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
-        jhoveExitCode = jhoveProcess->exitCode();
-        jhoveStandardOutput = QString::fromUtf8(jhoveStandardOutputData);
-        jhoveErrorOutput = QString::fromUtf8(jhoveStandardErrorData);
-        if (jhoveExitCode == 0 && !jhoveStandardOutput.isEmpty()) {
-            jhoveIsTIFF = jhoveStandardOutput.contains(QStringLiteral(" MIMEtype: image/tiff"));
-            jhoveIsWellformedAndValid = jhoveStandardOutput.contains(QStringLiteral(" Status: Well-Formed and valid"));
-            static const QRegularExpression imageSizeRegExp(QStringLiteral(" Image(Width|Height): ([1-9][0-9]*)"));
-            QRegularExpressionMatchIterator itImageSize = imageSizeRegExp.globalMatch(jhoveStandardOutput);
-            while (itImageSize.hasNext()) {
-                const QRegularExpressionMatch match = itImageSize.next();
-                bool ok = false;
-                if (match.captured(1) == QStringLiteral("Width")) {
-                    jhoveImageWidth = match.captured(2).toInt(&ok);
-                    if (!ok) jhoveImageWidth = INT_MIN;
-                } else if (match.captured(1) == QStringLiteral("Height")) {
-                    jhoveImageHeight = match.captured(2).toInt(&ok);
-                    if (!ok) jhoveImageHeight = INT_MIN;
-                }
-            }
-            static const QRegularExpression fileSizeRegExp(QStringLiteral(" Size: ([1-9][0-9]*)"));
-            const QRegularExpressionMatch fileSizeMatch = fileSizeRegExp.match(jhoveStandardOutput);
-            if (fileSizeMatch.hasMatch()) {
-                bool ok = false;
-                jhoveFilesize = fileSizeMatch.captured(1).toInt(&ok);
-                if (!ok) jhoveFilesize = INT_MIN;
-            }
-            static const QRegularExpression dateRegExp(QStringLiteral(" xmp:(Create|Modify)Date=\"((19[89]|20[012345])[0-9]-[01][0-9]-[0-3][0-9])"));
-            QRegularExpressionMatchIterator itDate = dateRegExp.globalMatch(jhoveStandardOutput);
-            while (itDate.hasNext()) {
-                const QRegularExpressionMatch match = itDate.next();
-                const QDate date = QDate::fromString(match.captured(2), QStringLiteral("yyyy-MM-dd"));
-                if (date.isValid()) {
-                    if (match.captured(1) == QStringLiteral("Create"))
-                        jhoveCreationDate = date;
-                    else if (match.captured(1) == QStringLiteral("Modify"))
-                        jhoveModificationDate = date;
-                }
-            }
-            static const QRegularExpression errorMessageRegExp(QStringLiteral(" ErrorMessage: (.*?)"));
-            const QRegularExpressionMatch errorMessageMatch = errorMessageRegExp.match(jhoveStandardOutput);
-            if (errorMessageMatch.hasMatch())
-                jhoveErrorMessage = errorMessageMatch.captured(1);
-        } else
-            qWarning() << "Execution of jHove failed for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory() << ": " << jhoveErrorOutput;
+    if (!dpfManagerProcess.waitForStarted(oneMinuteInMillisec)) {
+        qWarning() << "Failed to start DPFManager for file " << filename << " and " << dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory();
+        return QString();
     }
 
+    if (!dpfManagerProcess.waitForFinished(fourMinutesInMillisec))
+        qWarning() << "Waiting for DPFManager failed or exceeded time limit for file " << filename << " and " << dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory();
+    const int dpfManagerExitCode = dpfManagerProcess.exitCode();
     QString dpfManagerResult;
-    int dpfManagerExitCode = INT_MIN;
-    QString dpfManagerStandardOutput, dpfManagerErrorOutput;
-    if (dpfManagerStarted) {
-        if (!dpfManagerProcess.waitForFinished(fourMinutesInMillisec))
-            qWarning() << "Waiting for DPFManager failed or exceeded time limit for file " << filename << " and " << dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory();
-        dpfManagerExitCode = dpfManagerProcess.exitCode();
-        dpfManagerStandardOutput = QString::fromUtf8(dpfManagerStandardOutputData);
-        dpfManagerErrorOutput = QString::fromUtf8(dpfManagerStandardErrorData);
-        if (dpfManagerExitCode == 0 && !dpfManagerStandardOutput.isEmpty()) {
-            const QDir outputDir(dpfManagerTempDir.path() + QStringLiteral("/output"), QStringLiteral("1-*.xml"), QDir::Name | QDir::DirsLast | QDir::IgnoreCase, QDir::Files | QDir::NoDotAndDotDot | QDir::Readable);
-            const QStringList fileList = outputDir.entryList(QStringList() << QStringLiteral("1-*.xml"), QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name | QDir::DirsLast | QDir::IgnoreCase);
-            if (fileList.count() == 2) {
-                const QString xmlLogfile = outputDir.path() + QDir::separator() + (fileList.first().contains(QStringLiteral(".mets.")) ? fileList.last() : fileList.first());
-                QFile xmlFile(xmlLogfile);
-                if (xmlFile.open(QFile::ReadOnly)) {
-                    const QString xmlData = QString::fromUtf8(xmlFile.readAll()).remove(QRegExp(QStringLiteral("<\\?xml[^>]*>"))).remove(QRegExp(QStringLiteral("<tiff_structure.*</tiff_structure>")));
-                    const bool isTiff = xmlData.contains(QStringLiteral("<ImageWidth"));
-                    const bool tiffBaselineCore6 = xmlData.contains(QStringLiteral(" TIFF_Baseline_Core_6_0=\"true\""));
-                    const bool tiffBaselineExtended6 = xmlData.contains(QStringLiteral(" TIFF_Baseline_Extended_6_0==\"true\""));
-                    dpfManagerResult = QString(QStringLiteral("<dpfmanager exitcode=\"%1\" tiff=\"%2\" baseline=\"%3\" extended=\"%4\">\n")).arg(dpfManagerExitCode).arg(isTiff ? QStringLiteral("yes") : QStringLiteral("no"), tiffBaselineCore6 ? QStringLiteral("yes") : QStringLiteral("no"), tiffBaselineExtended6 ? QStringLiteral("yes") : QStringLiteral("no")) + xmlData + QStringLiteral("\n</dpfmanager>\n");
-                    xmlFile.close();
-                } else
-                    qWarning() << "Execution of DPFManager failed for file " << filename << " and " <<  dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory() << ": Could not open file " << xmlLogfile;
+    if (dpfManagerExitCode == 0 && !dpfManagerStandardOutputData.isEmpty()) {
+        const QDir outputDir(dpfManagerTempDir.path() + QStringLiteral("/output"), QStringLiteral("1-*.xml"), QDir::Name | QDir::DirsLast | QDir::IgnoreCase, QDir::Files | QDir::NoDotAndDotDot | QDir::Readable);
+        const QStringList fileList = outputDir.entryList(QStringList() << QStringLiteral("1-*.xml"), QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name | QDir::DirsLast | QDir::IgnoreCase);
+        if (fileList.count() == 2) {
+            const QString xmlLogfile = outputDir.path() + QDir::separator() + (fileList.first().contains(QStringLiteral(".mets.")) ? fileList.last() : fileList.first());
+            QFile xmlFile(xmlLogfile);
+            if (xmlFile.open(QFile::ReadOnly)) {
+                const QString xmlData = QString::fromUtf8(xmlFile.readAll()).remove(QRegExp(QStringLiteral("<\\?xml[^>]*>"))).remove(QRegExp(QStringLiteral("<tiff_structure.*</tiff_structure>")));
+                const bool isTiff = xmlData.contains(QStringLiteral("<ImageWidth"));
+                const bool tiffBaselineCore6 = xmlData.contains(QStringLiteral(" TIFF_Baseline_Core_6_0=\"true\""));
+                const bool tiffBaselineExtended6 = xmlData.contains(QStringLiteral(" TIFF_Baseline_Extended_6_0==\"true\""));
+                dpfManagerResult = QString(QStringLiteral("<dpfmanager exitcode=\"%1\" tiff=\"%2\" baseline=\"%3\" extended=\"%4\">\n")).arg(dpfManagerExitCode).arg(isTiff ? QStringLiteral("yes") : QStringLiteral("no"), tiffBaselineCore6 ? QStringLiteral("yes") : QStringLiteral("no"), tiffBaselineExtended6 ? QStringLiteral("yes") : QStringLiteral("no")) + xmlData + QStringLiteral("\n</dpfmanager>\n");
+                xmlFile.close();
             } else
-                qWarning() << "Execution of DPFManager failed for file " << filename << " and " <<  dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory() << ": Expected 2 output XML file, got " << fileList.count();
-        }
+                qWarning() << "Execution of DPFManager failed for file " << filename << " and " <<  dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory() << ": Could not open file " << xmlLogfile;
+        } else
+            qWarning() << "Execution of DPFManager failed for file " << filename << " and " <<  dpfManagerProcess.program() << dpfManagerProcess.arguments().join(' ') << " in directory " << dpfManagerProcess.workingDirectory() << ": Expected 2 output XML file, got " << fileList.count();
     }
 
-    if (!jhoveStarted)
-        emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"jhove-not-started\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
-    else {
-        QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\">\n")).arg(DocScan::xmlify(filename));
-        report.append(QString(QStringLiteral("<jhove exitcode=\"%1\" tiff=\"%2\" wellformedandvalid=\"%3\">\n")).arg(QString::number(jhoveExitCode), jhoveIsTIFF ? QStringLiteral("yes") : QStringLiteral("no"), jhoveIsWellformedAndValid ? QStringLiteral("yes") : QStringLiteral("no")));
-
-        if (jhoveIsTIFF && jhoveImageWidth > INT_MIN && jhoveImageHeight > INT_MIN && jhoveFilesize > INT_MIN) {
-            report.append(QStringLiteral("<meta>\n"));
-            if (jhoveCreationDate.isValid())
-                report.append(DocScan::formatDate(jhoveCreationDate, creationDate));
-            if (jhoveModificationDate.isValid())
-                report.append(DocScan::formatDate(jhoveModificationDate, modificationDate));
-            report.append(QString(QStringLiteral("<rect width=\"%1\" height=\"%2\" />\n")).arg(jhoveImageWidth).arg(jhoveImageHeight));
-            report.append(QString(QStringLiteral("<file size=\"%1\" />\n")).arg(jhoveFilesize));
-            report.append(QStringLiteral("</meta>\n"));
-        }
-
-        if (!jhoveErrorMessage.isEmpty())
-            report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhoveErrorMessage)));
-        if (!jhoveErrorOutput.isEmpty())
-            report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhoveErrorOutput)));
-
-        report.append(QStringLiteral("</jhove>\n"));
-        report.append(dpfManagerResult);
-        report.append(QStringLiteral("</fileanalysis>"));
-        emit analysisReport(objectName(), report);
-    }
+    return dpfManagerResult;
 }
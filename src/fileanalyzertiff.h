@@ -43,12 +43,18 @@ public:
 
     void setupJhove(const QString &shellscript);
     void setupDPFManager(const QString &dpfmangerJFXjar);
+    void setJhoveValidation(bool runJhove);
 
 public slots:
     virtual void analyzeFile(const QString &filename) override;
 
 private:
+    bool m_isAlive;
+    bool m_runJhove;
     QString dpfmangerJFXjar;
+
+    /// Run DPF Manager on file and return its XML report, or an empty string on failure
+    QString runDPFManager(const QString &filename);
 };
 
 #endif // FILEANALYZERTIFF_H
@@ -23,51 +23,125 @@
 #include "fileanalyzerzip.h"
 
 #include <QDebug>
+#include <QFileInfo>
 
 #include <quazip.h>
 #include <quazipfile.h>
 
+#include "contentsniffer.h"
 #include "general.h"
+#include "zipdirectoryindex.h"
+
+/// Members smaller than this are not subject to compression ratio checks
+static const qint64 minSizeForRatioCheck = 1 << 20;
 
 FileAnalyzerZIP::FileAnalyzerZIP(QObject *parent)
-    : FileAnalyzerAbstract(parent), m_isAlive(false)
+    : FileAnalyzerArchive(parent), m_listOnly(false), m_maxMemberSize(256 << 20), m_maxCompressionRatio(100), m_maxMembers(10000), m_maxNestingDepth(2)
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
 }
 
-bool FileAnalyzerZIP::isAlive()
-{
-    return m_isAlive;
+void FileAnalyzerZIP::setLimits(bool listOnly, qint64 maxMemberSize, int maxCompressionRatio, int maxMembers, int maxNestingDepth) {
+    m_listOnly = listOnly;
+    m_maxMemberSize = maxMemberSize;
+    m_maxCompressionRatio = maxCompressionRatio;
+    m_maxMembers = maxMembers;
+    m_maxNestingDepth = maxNestingDepth;
 }
 
 void FileAnalyzerZIP::analyzeFile(const QString &filename)
 {
-    m_isAlive = true;
+    const int nestingDepth = enterArchive();
 
     QuaZip zipFile(filename);
     if (zipFile.open(QuaZip::mdUnzip)) {
-        QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\"><embeddedfiles>\n")).arg(DocScan::xmlify(filename));
-        for (bool more = zipFile.goToFirstFile(); more; more = zipFile.goToNextFile()) {
-            QuaZipFile contentFile(&zipFile, this);
-            const QString filename = contentFile.getFileName().isEmpty() ? contentFile.getActualFileName() : contentFile.getFileName();
-            if (contentFile.open(QIODevice::ReadOnly)) {
-                const QByteArray data = contentFile.readAll();
-                contentFile.close();
-                const QString mimetype = DocScan::guessMimetype(filename);
-                const QString temporaryFilename = dataToTemporaryFile(data, mimetype);
-                emit foundEmbeddedFile(temporaryFilename);
-
-                const QString size = contentFile.csize() >= 0 ? QString(QStringLiteral(" size=\"%1\" compressedsize=\"%2\"")).arg(contentFile.usize()).arg(contentFile.csize()) : QString();
-                const QString mimetypeAsAttribute = QString(QStringLiteral(" mimetype=\"%1\"")).arg(mimetype);
-                const QString embeddedFile = QStringLiteral("<embeddedfile") + size + mimetypeAsAttribute + QStringLiteral("><filename>") + DocScan::xmlify(filename) + QStringLiteral("</filename>") + (temporaryFilename.isEmpty() ? QString() : QStringLiteral("<temporaryfilename>") + temporaryFilename /** no need for DocScan::xmlify */ + QStringLiteral("</temporaryfilename>")) + QStringLiteral("</embeddedfile>\n");
-                report.append(embeddedFile);
+        /// Archives nested too deeply into other archives are only listed
+        const bool listOnly = m_listOnly || nestingDepth > m_maxNestingDepth;
+        QString report = QString(QStringLiteral("<fileanalysis filename=\"%1\" status=\"ok\"><embeddedfiles mode=\"%2\">\n")).arg(DocScan::xmlify(filename), listOnly ? QStringLiteral("list") : QStringLiteral("analyze"));
+        int numMembers = 0, numExtracted = 0, numSkipped = 0;
+        ZipDirectoryIndex index(zipFile);
+        for (const ZipDirectoryIndex::Entry &entry : index.entries()) {
+            if (entry.name.endsWith(QLatin1Char('/'))) continue; ///< directory
+            if (m_maxMembers > 0 && numMembers >= m_maxMembers) {
+                report.append(QString(QStringLiteral("<truncated members=\"%1\" />\n")).arg(index.count()));
+                break;
+            }
+            ++numMembers;
+
+            QString mimetype = DocScan::guessMimetype(entry.name);
+            QString temporaryFilename, skipReason, error;
+            if (listOnly) {
+                /// Central directory provides everything to report
+            } else if (m_maxMemberSize > 0 && entry.uncompressedSize > static_cast<quint64>(m_maxMemberSize))
+                skipReason = QStringLiteral("toolarge");
+            else if (m_maxCompressionRatio > 0 && entry.uncompressedSize >= static_cast<quint64>(minSizeForRatioCheck) && entry.uncompressedSize > entry.compressedSize * m_maxCompressionRatio)
+                skipReason = QStringLiteral("compressionratio");
+            else if (index.setCurrentFile(entry)) {
+                QuaZipFile contentFile(&zipFile, this);
+                if (contentFile.open(QIODevice::ReadOnly)) {
+                    const ContentSniffer sniffer(contentFile.peek(ContentSniffer::headerSize), entry.name);
+                    if (sniffer.fileType() != ContentSniffer::ftUnknown)
+                        mimetype = sniffer.mimetype();
+                    if (!filtersMatch(entry.name, sniffer.extensions()))
+                        skipReason = QStringLiteral("unmatched");
+                    else {
+                        /// Sizes in central directory may be forged,
+                        /// so enforce limits on the actual data as well
+                        qint64 maxSize = m_maxMemberSize;
+                        if (m_maxCompressionRatio > 0) {
+                            const qint64 ratioLimit = qMax(static_cast<qint64>(entry.compressedSize) * m_maxCompressionRatio, minSizeForRatioCheck);
+                            maxSize = maxSize > 0 ? qMin(maxSize, ratioLimit) : ratioLimit;
+                        }
+                        bool sizeExceeded = false;
+                        temporaryFilename = deviceToTemporaryFile(contentFile, mimetype, maxSize, &sizeExceeded);
+                        if (sizeExceeded)
+                            skipReason = QStringLiteral("toolarge");
+                        else if (temporaryFilename.isEmpty())
+                            error = QStringLiteral("failed-to-write");
+                    }
+                    contentFile.close();
+                } else
+                    error = QStringLiteral("failed-to-open");
             } else
-                report.append(QString(QStringLiteral("<error status=\"failed-to-open\">%1</error>")).arg(DocScan::xmlify(filename)));
+                error = QStringLiteral("failed-to-open");
+
+            if (!error.isEmpty()) {
+                report.append(QString(QStringLiteral("<error status=\"%2\">%1</error>\n")).arg(DocScan::xmlify(entry.name), error));
+                continue;
+            }
+
+            const QString size = QString(QStringLiteral(" size=\"%1\" compressedsize=\"%2\"")).arg(entry.uncompressedSize).arg(entry.compressedSize);
+            const QString mimetypeAsAttribute = QString(QStringLiteral(" mimetype=\"%1\"")).arg(mimetype);
+            const QString skippedAsAttribute = skipReason.isEmpty() ? QString() : QString(QStringLiteral(" skipped=\"%1\"")).arg(skipReason);
+            const QString embeddedFile = QStringLiteral("<embeddedfile") + size + mimetypeAsAttribute + skippedAsAttribute + QStringLiteral("><filename>") + DocScan::xmlify(entry.name) + QStringLiteral("</filename>") + (temporaryFilename.isEmpty() ? QString() : QStringLiteral("<temporaryfilename>") + temporaryFilename /** no need for DocScan::xmlify */ + QStringLiteral("</temporaryfilename>")) + QStringLiteral("</embeddedfile>\n");
+            report.append(embeddedFile);
+
+            if (!skipReason.isEmpty())
+                ++numSkipped;
+            else if (!temporaryFilename.isEmpty()) {
+                ++numExtracted;
+                /// Extracted file gets analyzed and removed right away,
+                /// so at most one member per archive occupies disk space
+                emit foundEmbeddedFile(temporaryFilename);
+            }
         }
         report.append(QStringLiteral("</embeddedfiles></fileanalysis>\n"));
         emit analysisReport(objectName(), report);
-    } else
+
+        QJsonObject record;
+        record.insert(QStringLiteral("filename"), filename);
+        record.insert(QStringLiteral("status"), QStringLiteral("ok"));
+        record.insert(QStringLiteral("mimetype"), QStringLiteral("application/zip"));
+        record.insert(QStringLiteral("size"), QFileInfo(filename).size());
+        record.insert(QStringLiteral("members"), numMembers);
+        record.insert(QStringLiteral("embeddedfiles"), numExtracted);
+        record.insert(QStringLiteral("skipped"), numSkipped);
+        record.insert(QStringLiteral("listonly"), listOnly);
+        emit analysisRecord(objectName(), record);
+    } else {
         emit analysisReport(objectName(), QString(QStringLiteral("<fileanalysis filename=\"%1\" message=\"invalid-fileformat\" status=\"error\" />\n")).arg(DocScan::xmlify(filename)));
+        emit analysisRecord(objectName(), errorRecord(filename, QStringLiteral("invalid-fileformat")));
+    }
 
-    m_isAlive = false;
+    leaveArchive();
 }
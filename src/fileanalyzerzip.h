@@ -23,26 +23,37 @@
 #ifndef FILEANALYZERZIP_H
 #define FILEANALYZERZIP_H
 
-#include "fileanalyzerabstract.h"
+#include "fileanalyzerarchive.h"
 
 /**
  * Analyzing code for ZIP archives.
  *
  * @author Thomas Fischer <thomas.fischer@his.se>
  */
-class FileAnalyzerZIP : public FileAnalyzerAbstract
+class FileAnalyzerZIP : public FileAnalyzerArchive
 {
     Q_OBJECT
 public:
     explicit FileAnalyzerZIP(QObject *parent = nullptr);
 
-    virtual bool isAlive() override;
+    /**
+     * Protect against huge archives and zip bombs.
+     *
+     * @param listOnly only report members as listed in central directory, never extract them
+     * @param maxMemberSize members larger than this many bytes when uncompressed are not extracted, 0 for no limit
+     * @param maxCompressionRatio members compressed better than this ratio are not extracted, 0 for no limit
+     * @param maxMembers archive members beyond this number are ignored, 0 for no limit
+     * @param maxNestingDepth archives nested deeper into other archives are only listed
+     */
+    void setLimits(bool listOnly, qint64 maxMemberSize, int maxCompressionRatio, int maxMembers, int maxNestingDepth);
 
 public slots:
     virtual void analyzeFile(const QString &filename) override;
 
 private:
-    bool m_isAlive;
+    bool m_listOnly;
+    qint64 m_maxMemberSize;
+    int m_maxCompressionRatio, m_maxMembers, m_maxNestingDepth;
 };
 
 #endif // FILEANALYZERZIP_H
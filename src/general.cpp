@@ -214,6 +214,10 @@ QString guessMimetype(const QString &filename) {
         return QStringLiteral("image/png");
     else if (fileExtension == QStringLiteral(".tif") || fileExtension == QStringLiteral(".tiff"))
         return QStringLiteral("image/tiff");
+    else if (fileExtension == QStringLiteral(".zip"))
+        return QStringLiteral("application/zip");
+    else if (fileExtension == QStringLiteral(".tar"))
+        return QStringLiteral("application/x-tar");
     else {
         qWarning() << "Cannot guess mimetype for filename " << filename;
         return QString();
@@ -238,10 +242,48 @@ QString extensionForMimetype(const QString &mimetype) {
         return QStringLiteral(".png");
     else if (mimetype == QStringLiteral("image/tiff"))
         return QStringLiteral(".tiff");
+    else if (mimetype == QStringLiteral("application/zip"))
+        return QStringLiteral(".zip");
+    else if (mimetype == QStringLiteral("application/x-tar"))
+        return QStringLiteral(".tar");
+    else if (mimetype == QStringLiteral("application/vnd.oasis.opendocument.text"))
+        return QStringLiteral(".odt");
+    else if (mimetype == QStringLiteral("application/vnd.oasis.opendocument.spreadsheet"))
+        return QStringLiteral(".ods");
+    else if (mimetype == QStringLiteral("application/vnd.oasis.opendocument.presentation"))
+        return QStringLiteral(".odp");
+    else if (mimetype == QStringLiteral("application/vnd.openxmlformats-officedocument.wordprocessingml.document"))
+        return QStringLiteral(".docx");
+    else if (mimetype == QStringLiteral("application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"))
+        return QStringLiteral(".xlsx");
+    else if (mimetype == QStringLiteral("application/vnd.openxmlformats-officedocument.presentationml.presentation"))
+        return QStringLiteral(".pptx");
+    else if (mimetype == QStringLiteral("application/x-ole-storage"))
+        return QStringLiteral(".ole");
+    else if (mimetype == QStringLiteral("application/gzip"))
+        return QStringLiteral(".gz");
+    else if (mimetype == QStringLiteral("application/x-xz"))
+        return QStringLiteral(".xz");
+    else if (mimetype == QStringLiteral("application/x-bzip2"))
+        return QStringLiteral(".bz2");
     else {
         qWarning() << "Don't know file extension for mimetype" << mimetype;
         return QStringLiteral(".data");
     }
 }
 
+void xmpDates(const QByteArray &xmp, QDateTime &creationDate, QDateTime &modificationDate) {
+    static const QRegularExpression dateRegExp(QStringLiteral("xmp:(Create|Modify)Date(?:\\s*=\\s*[\"']|>)([0-9]{4}-[0-9]{2}-[0-9]{2}[0-9T:.+Z-]*)"));
+    QRegularExpressionMatchIterator it = dateRegExp.globalMatch(QString::fromUtf8(xmp));
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        const QDateTime date = QDateTime::fromString(match.captured(2), Qt::ISODate);
+        if (!date.isValid()) continue;
+        if (match.captured(1) == QStringLiteral("Create") && !creationDate.isValid())
+            creationDate = date;
+        else if (match.captured(1) == QStringLiteral("Modify") && !modificationDate.isValid())
+            modificationDate = date;
+    }
+}
+
 } // end of namespace
@@ -25,6 +25,7 @@
 
 #include <QString>
 #include <QDate>
+#include <QDateTime>
 #include <QHash>
 
 namespace DocScan
@@ -96,6 +97,17 @@ QString formatMap(const QString &key, const QHash<QString, QString> &attrs);
 QString guessMimetype(const QString &filename);
 
 QString extensionForMimetype(const QString &mimetype);
+
+/**
+ * Extract creation and modification date (xmp:CreateDate and
+ * xmp:ModifyDate) from XMP metadata, given either as attributes
+ * or as elements. Dates already valid are kept.
+ *
+ * @param xmp XMP metadata
+ * @param creationDate set to creation date if found and not yet valid
+ * @param modificationDate set to modification date if found and not yet valid
+ */
+void xmpDates(const QByteArray &xmp, QDateTime &creationDate, QDateTime &modificationDate);
 }
 
 #endif // GENERAL_H
@@ -92,6 +92,64 @@ QProcess *JHoveWrapper::launchJHove(QObject *parent, const Module module, const
         return nullptr;
 }
 
+JHoveWrapper::JHoveResult JHoveWrapper::runJHove(QObject *parent, const Module module, const QString &filename, const QString &mimetype) {
+    JHoveResult result;
+    QProcess *jhoveProcess = launchJHove(parent, module, filename);
+    if (jhoveProcess == nullptr) return result;
+    result.launched = true;
+
+    QByteArray jhoveStandardOutputData, jhoveStandardErrorData;
+    QObject::connect(jhoveProcess, &QProcess::readyReadStandardOutput, [jhoveProcess, &jhoveStandardOutputData]() {
+        const QByteArray d(jhoveProcess->readAllStandardOutput());
+        jhoveStandardOutputData.append(d);
+    });
+    QObject::connect(jhoveProcess, &QProcess::readyReadStandardError, [jhoveProcess, &jhoveStandardErrorData]() {
+        const QByteArray d(jhoveProcess->readAllStandardError());
+        jhoveStandardErrorData.append(d);
+    });
+    result.started = jhoveProcess->waitForStarted(oneMinuteInMillisec);
+    if (!result.started)
+        qWarning() << "Failed to start jhove for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
+    else {
+        if (!jhoveProcess->waitForFinished(fourMinutesInMillisec))
+            qWarning() << "Waiting for jHove failed or exceeded time limit for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory();
+        result.exitCode = jhoveProcess->exitCode();
+        const QString jhoveStandardOutput = QString::fromUtf8(jhoveStandardOutputData);
+        result.errorOutput = QString::fromUtf8(jhoveStandardErrorData);
+        if (result.exitCode == 0 && !jhoveStandardOutput.isEmpty()) {
+            result.matchesMimetype = jhoveStandardOutput.contains(QStringLiteral(" MIMEtype: ") + mimetype);
+            result.wellformedAndValid = jhoveStandardOutput.contains(QStringLiteral(" Status: Well-Formed and valid"));
+            static const QRegularExpression errorMessageRegExp(QStringLiteral(" ErrorMessage: (.*?)"));
+            const QRegularExpressionMatch errorMessageMatch = errorMessageRegExp.match(jhoveStandardOutput);
+            if (errorMessageMatch.hasMatch())
+                result.errorMessage = errorMessageMatch.captured(1);
+        } else
+            qWarning() << "Execution of jHove failed for file " << filename << " and " << jhoveProcess->program() << jhoveProcess->arguments().join(' ') << " in directory " << jhoveProcess->workingDirectory() << ": " << result.errorOutput;
+    }
+
+    jhoveProcess->deleteLater();
+    return result;
+}
+
+bool JHoveWrapper::reportJHove(QObject *parent, const Module module, const QString &filename, const QString &mimetype, const QString &formatName, QString &report, QJsonObject &validatorsRecord) {
+    const JHoveResult jhove = runJHove(parent, module, filename, mimetype);
+    if (!jhove.launched) return false;
+
+    report.append(QString(QStringLiteral("<jhove exitcode=\"%1\" %2=\"%3\" wellformedandvalid=\"%4\"%5>\n")).arg(QString::number(jhove.exitCode), formatName, jhove.matchesMimetype ? QStringLiteral("yes") : QStringLiteral("no"), jhove.wellformedAndValid ? QStringLiteral("yes") : QStringLiteral("no"), jhove.started ? QString() : QStringLiteral(" message=\"jhove-not-started\"")));
+    if (!jhove.errorMessage.isEmpty())
+        report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhove.errorMessage)));
+    if (!jhove.errorOutput.isEmpty())
+        report.append(QString(QStringLiteral("<error>%1</error>\n")).arg(DocScan::xmlifyLines(jhove.errorOutput)));
+    report.append(QStringLiteral("</jhove>\n"));
+
+    QJsonObject jhoveRecord;
+    jhoveRecord.insert(QStringLiteral("exitcode"), jhove.exitCode);
+    jhoveRecord.insert(formatName, jhove.matchesMimetype);
+    jhoveRecord.insert(QStringLiteral("wellformedandvalid"), jhove.wellformedAndValid);
+    validatorsRecord.insert(QStringLiteral("jhove"), jhoveRecord);
+    return true;
+}
+
 QString JHoveWrapper::hulName(Module module) {
     switch (module) {
     case JHovePDF: return QStringLiteral("PDF-hul");
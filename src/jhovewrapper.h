@@ -24,6 +24,9 @@
 #define JHOVEWRAPPER_H
 
 #include <QProcess>
+#include <QJsonObject>
+
+#include <climits>
 
 /**
  * Wrapping the command line tool 'jhove'.
@@ -34,11 +37,47 @@ class JHoveWrapper
 {
 public:
     enum Module {JHovePDF, JHoveJPEG, JHoveJPEG2000, JHoveTIFF};
+
+    /// Outcome of running jHove on a single file
+    struct JHoveResult {
+        bool launched, started;
+        int exitCode;
+        /// jHove identified the file as being of the expected mimetype
+        bool matchesMimetype;
+        bool wellformedAndValid;
+        QString errorMessage, errorOutput;
+
+        explicit JHoveResult()
+            : launched(false), started(false), exitCode(INT_MIN), matchesMimetype(false), wellformedAndValid(false) {
+            /// nothing
+        }
+    };
+
 protected:
     static QString jhoveShellscript;
 
     QString setupJhove(QObject *parent, const QString &jhoveShellscript);
     QProcess *launchJHove(QObject *parent, const Module module, const QString &filename);
+
+    /**
+     * Run jHove on a file and wait for it to finish.
+     *
+     * @param module jHove module to use
+     * @param filename file to validate
+     * @param mimetype mimetype jHove is expected to report for this file
+     * @return outcome, not launched if jHove is not configured
+     */
+    JHoveResult runJHove(QObject *parent, const Module module, const QString &filename, const QString &mimetype);
+
+    /**
+     * Run jHove on a file, append a '<jhove>' element describing the
+     * outcome to the report and add a 'jhove' object to the validators
+     * record.
+     *
+     * @param formatName name of the attribute telling if jHove identified the expected mimetype, e.g. 'jpeg'
+     * @return true if jHove was launched, false if it is not configured
+     */
+    bool reportJHove(QObject *parent, const Module module, const QString &filename, const QString &mimetype, const QString &formatName, QString &report, QJsonObject &validatorsRecord);
     static QString hulName(Module module);
 };
 
@@ -0,0 +1,321 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#include "jp2parser.h"
+
+#include <QtMath>
+
+#include "general.h"
+
+/// Box types as four-character codes
+static const quint32 boxSignature = 0x6a502020; ///< 'jP  '
+static const quint32 boxFileType = 0x66747970; ///< 'ftyp'
+static const quint32 boxHeader = 0x6a703268; ///< 'jp2h'
+static const quint32 boxImageHeader = 0x69686472; ///< 'ihdr'
+static const quint32 boxColourSpecification = 0x636f6c72; ///< 'colr'
+static const quint32 boxResolution = 0x72657320; ///< 'res '
+static const quint32 boxCaptureResolution = 0x72657363; ///< 'resc'
+static const quint32 boxDisplayResolution = 0x72657364; ///< 'resd'
+static const quint32 boxXML = 0x786d6c20; ///< 'xml '
+static const quint32 boxUUID = 0x75756964; ///< 'uuid'
+static const quint32 boxCodestream = 0x6a703263; ///< 'jp2c'
+
+/// Limits to protect against malformed or malicious files
+static const qint64 maxMetadataBoxSize = 16 << 20; ///< XML and UUID boxes larger than this are not read
+static const qint64 maxCodestreamHeaderSize = 1 << 16; ///< main header is expected within this many bytes
+
+static inline quint64 readBigEndian(const QByteArray &data, int pos, int numBytes) {
+    quint64 result = 0;
+    for (int i = 0; i < numBytes; ++i)
+        result = (result << 8) | static_cast<uchar>(data[pos + i]);
+    return result;
+}
+
+/// Resolution boxes store vertical and horizontal resolution as fraction and exponent, in pixels per metre
+static void parseResolutionBox(const QByteArray &data, double *resolution) {
+    if (data.size() < 10) return;
+    const double verticalDenominator = static_cast<double>(readBigEndian(data, 2, 2)), horizontalDenominator = static_cast<double>(readBigEndian(data, 6, 2));
+    if (verticalDenominator <= 0.0 || horizontalDenominator <= 0.0) return;
+    resolution[0] = readBigEndian(data, 4, 2) / horizontalDenominator * qPow(10.0, static_cast<qint8>(data[9]));
+    resolution[1] = readBigEndian(data, 0, 2) / verticalDenominator * qPow(10.0, static_cast<qint8>(data[8]));
+}
+
+JP2Parser::JP2Parser(const QString &filename)
+    : m_file(filename), m_fileSize(0), m_rawCodestream(false), m_boxesIntact(true), m_hasSignature(false), m_fileTypeSecond(false), m_imageHeaderFirst(false), m_hasCodestream(false), m_headerWidth(0), m_headerHeight(0), m_width(0), m_height(0), m_numComponents(0), m_bitsPerComponent(0), m_colourSpace(0), m_hasICCProfile(false), m_numXMLBoxes(0), m_hasXMP(false), m_numResolutionLevels(0), m_numQualityLayers(0), m_lossless(false)
+{
+    m_captureResolution[0] = m_captureResolution[1] = 0.0;
+    m_displayResolution[0] = m_displayResolution[1] = 0.0;
+}
+
+bool JP2Parser::parse() {
+    if (!m_file.open(QFile::ReadOnly)) {
+        m_errorMessage = QStringLiteral("Could not open file");
+        return false;
+    }
+    m_fileSize = m_file.size();
+
+    const QByteArray start = readData(0, 12);
+    if (start.size() < 4) {
+        m_errorMessage = QStringLiteral("File too small");
+        return false;
+    }
+    if (start.startsWith("\xff\x4f\xff\x51")) {
+        /// No boxes, file starts with start of codestream and image and tile size markers
+        m_rawCodestream = true;
+        parseCodestream(0, m_fileSize);
+    } else {
+        parseBoxes(0, m_fileSize, 0);
+        if (!m_hasSignature) {
+            m_errorMessage = QStringLiteral("No JPEG 2000 signature found");
+            return false;
+        }
+    }
+
+    if (m_width <= 0 || m_height <= 0) {
+        /// Codestream missing or damaged, fall back to image header
+        m_width = m_headerWidth;
+        m_height = m_headerHeight;
+    }
+    if (m_width <= 0 || m_height <= 0) {
+        m_errorMessage = QStringLiteral("No image dimensions found");
+        return false;
+    }
+    return true;
+}
+
+QString JP2Parser::errorMessage() const {
+    return m_errorMessage;
+}
+
+bool JP2Parser::isWellFormed() const {
+    if (m_rawCodestream)
+        return m_hasCodestream;
+    return m_boxesIntact && m_hasSignature && m_fileTypeSecond && m_imageHeaderFirst && m_hasCodestream && m_headerWidth == m_width && m_headerHeight == m_height;
+}
+
+bool JP2Parser::isRawCodestream() const {
+    return m_rawCodestream;
+}
+
+qint64 JP2Parser::fileSize() const {
+    return m_fileSize;
+}
+
+QString JP2Parser::brand() const {
+    return m_brand;
+}
+
+int JP2Parser::width() const {
+    return m_width;
+}
+
+int JP2Parser::height() const {
+    return m_height;
+}
+
+int JP2Parser::numComponents() const {
+    return m_numComponents;
+}
+
+int JP2Parser::bitsPerComponent() const {
+    return m_bitsPerComponent;
+}
+
+int JP2Parser::colourSpace() const {
+    return m_colourSpace;
+}
+
+bool JP2Parser::hasICCProfile() const {
+    return m_hasICCProfile;
+}
+
+double JP2Parser::horizontalResolution() const {
+    return m_captureResolution[0] > 0.0 ? m_captureResolution[0] : m_displayResolution[0];
+}
+
+double JP2Parser::verticalResolution() const {
+    return m_captureResolution[1] > 0.0 ? m_captureResolution[1] : m_displayResolution[1];
+}
+
+int JP2Parser::numXMLBoxes() const {
+    return m_numXMLBoxes;
+}
+
+bool JP2Parser::hasXMP() const {
+    return m_hasXMP;
+}
+
+int JP2Parser::numResolutionLevels() const {
+    return m_numResolutionLevels;
+}
+
+int JP2Parser::numQualityLayers() const {
+    return m_numQualityLayers;
+}
+
+bool JP2Parser::isLossless() const {
+    return m_lossless;
+}
+
+QString JP2Parser::progressionOrder() const {
+    return m_progressionOrder;
+}
+
+QDateTime JP2Parser::creationDate() const {
+    return m_creationDate;
+}
+
+QDateTime JP2Parser::modificationDate() const {
+    return m_modificationDate;
+}
+
+void JP2Parser::parseBoxes(qint64 begin, qint64 end, quint32 superBox) {
+    static const QByteArray xmpUUID("\xbe\x7a\xcf\xcb\x97\xa9\x42\xe8\x9c\x71\x99\x94\x91\xe3\xaf\xac", 16);
+    qint64 pos = begin;
+    for (int index = 0; pos + 8 <= end; ++index) {
+        const QByteArray header = readData(pos, 16);
+        if (header.size() < 8) {
+            m_boxesIntact = false;
+            break;
+        }
+        qint64 length = static_cast<qint64>(readBigEndian(header, 0, 4));
+        const quint32 type = static_cast<quint32>(readBigEndian(header, 4, 4));
+        qint64 headerLength = 8;
+        if (length == 1) {
+            /// Extended length follows box type
+            if (header.size() < 16) {
+                m_boxesIntact = false;
+                break;
+            }
+            length = static_cast<qint64>(readBigEndian(header, 8, 8));
+            headerLength = 16;
+        } else if (length == 0)
+            length = end - pos; ///< box extends to end of file
+        if (length < headerLength || length > end - pos) {
+            m_boxesIntact = false;
+            break;
+        }
+        const qint64 contentOffset = pos + headerLength, contentLength = length - headerLength;
+
+        if (superBox == 0 && index == 0)
+            m_hasSignature = type == boxSignature && contentLength == 4 && readData(contentOffset, 4) == QByteArray("\x0d\x0a\x87\x0a", 4);
+        else if (superBox == 0 && index == 1)
+            m_fileTypeSecond = type == boxFileType;
+
+        if (type == boxFileType && superBox == 0) {
+            m_brand = QString::fromLatin1(readData(contentOffset, 4));
+        } else if (type == boxHeader && superBox == 0) {
+            parseBoxes(contentOffset, contentOffset + contentLength, boxHeader);
+        } else if (type == boxImageHeader && superBox == boxHeader) {
+            m_imageHeaderFirst |= index == 0;
+            const QByteArray data = readData(contentOffset, 14);
+            if (data.size() == 14) {
+                m_headerHeight = static_cast<int>(readBigEndian(data, 0, 4));
+                m_headerWidth = static_cast<int>(readBigEndian(data, 4, 4));
+                m_numComponents = static_cast<int>(readBigEndian(data, 8, 2));
+                /// 255 means bit depth varies between components, given in a separate box
+                const uchar bitsPerComponent = static_cast<uchar>(data[10]);
+                m_bitsPerComponent = bitsPerComponent == 255 ? 0 : (bitsPerComponent & 0x7f) + 1;
+            }
+        } else if (type == boxColourSpecification && superBox == boxHeader) {
+            /// Only the first colour specification is relevant for readers
+            if (m_colourSpace == 0 && !m_hasICCProfile) {
+                const QByteArray data = readData(contentOffset, 7);
+                if (data.size() >= 7 && data[0] == 1)
+                    m_colourSpace = static_cast<int>(readBigEndian(data, 3, 4));
+                else if (data.size() >= 3 && (data[0] == 2 || data[0] == 3))
+                    m_hasICCProfile = true;
+            }
+        } else if (type == boxResolution && superBox == boxHeader) {
+            parseBoxes(contentOffset, contentOffset + contentLength, boxResolution);
+        } else if (type == boxCaptureResolution && superBox == boxResolution) {
+            parseResolutionBox(readData(contentOffset, 10), m_captureResolution);
+        } else if (type == boxDisplayResolution && superBox == boxResolution) {
+            parseResolutionBox(readData(contentOffset, 10), m_displayResolution);
+        } else if (type == boxXML) {
+            ++m_numXMLBoxes;
+            if (contentLength <= maxMetadataBoxSize) {
+                const QByteArray xml = readData(contentOffset, contentLength);
+                if (xml.contains("<x:xmpmeta") || xml.contains("xmlns:xmp=")) {
+                    m_hasXMP = true;
+                    DocScan::xmpDates(xml, m_creationDate, m_modificationDate);
+                }
+            }
+        } else if (type == boxUUID) {
+            if (contentLength >= 16 && readData(contentOffset, 16) == xmpUUID) {
+                m_hasXMP = true;
+                if (contentLength - 16 <= maxMetadataBoxSize)
+                    DocScan::xmpDates(readData(contentOffset + 16, contentLength - 16), m_creationDate, m_modificationDate);
+            }
+        } else if (type == boxCodestream && superBox == 0) {
+            /// Files may contain several codestreams, the first one is the image
+            if (!m_hasCodestream)
+                parseCodestream(contentOffset, contentLength);
+        }
+
+        pos += length;
+    }
+}
+
+void JP2Parser::parseCodestream(qint64 offset, qint64 length) {
+    const QByteArray data = readData(offset, qMin(length, maxCodestreamHeaderSize));
+    if (data.size() < 4 || static_cast<uchar>(data[0]) != 0xff || static_cast<uchar>(data[1]) != 0x4f) return;
+
+    bool hasImageAndTileSize = false;
+    int pos = 2;
+    while (pos + 4 <= data.size() && static_cast<uchar>(data[pos]) == 0xff) {
+        const uchar marker = static_cast<uchar>(data[pos + 1]);
+        if (marker == 0x90 || marker == 0x93) break; ///< start of tile-part or data ends main header
+        const int segmentLength = static_cast<int>(readBigEndian(data, pos + 2, 2));
+        if (segmentLength < 2 || pos + 2 + segmentLength > data.size()) break;
+        const int segment = pos + 4, contentLength = segmentLength - 2;
+
+        if (marker == 0x51 && contentLength >= 37) {
+            /// Image and tile size: capabilities, image and offset dimensions,
+            /// tile dimensions, number of components, then per component bit depth
+            m_width = static_cast<int>(readBigEndian(data, segment + 2, 4) - readBigEndian(data, segment + 10, 4));
+            m_height = static_cast<int>(readBigEndian(data, segment + 6, 4) - readBigEndian(data, segment + 14, 4));
+            m_numComponents = static_cast<int>(readBigEndian(data, segment + 34, 2));
+            m_bitsPerComponent = (static_cast<uchar>(data[segment + 36]) & 0x7f) + 1;
+            hasImageAndTileSize = true;
+        } else if (marker == 0x52 && contentLength >= 10) {
+            /// Coding style default: progression order, quality layers,
+            /// decomposition levels, and wavelet transformation
+            static const char *const progressionOrders[] = {"LRCP", "RLCP", "RPCL", "PCRL", "CPRL"};
+            const uchar progressionOrder = static_cast<uchar>(data[segment + 1]);
+            m_progressionOrder = progressionOrder < 5 ? QString::fromLatin1(progressionOrders[progressionOrder]) : QString();
+            m_numQualityLayers = static_cast<int>(readBigEndian(data, segment + 2, 2));
+            m_numResolutionLevels = static_cast<uchar>(data[segment + 5]) + 1;
+            m_lossless = data[segment + 9] == 1;
+        }
+
+        pos += 2 + segmentLength;
+    }
+
+    m_hasCodestream = hasImageAndTileSize;
+}
+
+QByteArray JP2Parser::readData(qint64 offset, qint64 length) {
+    if (offset < 0 || length <= 0 || !m_file.seek(offset)) return QByteArray();
+    return m_file.read(length);
+}
@@ -0,0 +1,121 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#ifndef JP2PARSER_H
+#define JP2PARSER_H
+
+#include <QFile>
+#include <QString>
+#include <QDateTime>
+
+/**
+ * Lightweight, read-only parser for JPEG 2000 files, both JP2/JPX
+ * files and raw codestreams. Walks through the file's boxes, reading
+ * signature, file type, image header, colour specification, resolution,
+ * XML and UUID boxes, and the main header of the contiguous codestream.
+ * Only box headers and the contents of boxes of interest get read,
+ * image data is neither read nor decoded.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class JP2Parser
+{
+public:
+    explicit JP2Parser(const QString &filename);
+
+    /**
+     * Open the file and read its boxes and codestream main header.
+     *
+     * @return true if file is a JP2/JPX file or a raw codestream and image dimensions are known
+     */
+    bool parse();
+
+    QString errorMessage() const;
+
+    /**
+     * true if the signature and file type boxes come first, the
+     * header box starts with an image header, a codestream exists,
+     * and dimensions match between image header and codestream
+     */
+    bool isWellFormed() const;
+
+    /// true if file is a raw codestream without any boxes
+    bool isRawCodestream() const;
+
+    qint64 fileSize() const;
+    /// Brand as given in file type box, e.g. 'jp2 ' or 'jpx '
+    QString brand() const;
+    int width() const;
+    int height() const;
+    int numComponents() const;
+    /// Bit depth of first component
+    int bitsPerComponent() const;
+    /// Enumerated colour space (e.g. 16 for sRGB, 17 for greyscale), 0 if not given or ICC profile
+    int colourSpace() const;
+    bool hasICCProfile() const;
+    /// Capture resolution or, if not given, default display resolution in pixels per metre, 0 if unknown
+    double horizontalResolution() const;
+    double verticalResolution() const;
+    int numXMLBoxes() const;
+    bool hasXMP() const;
+
+    /// Number of resolution levels (decomposition levels + 1), number of quality layers
+    int numResolutionLevels() const;
+    int numQualityLayers() const;
+    /// true if reversible 5-3 wavelet transform is used
+    bool isLossless() const;
+    /// Progression order like 'LRCP' or 'RPCL', empty if unknown
+    QString progressionOrder() const;
+
+    /// Dates from XMP metadata, if available
+    QDateTime creationDate() const;
+    QDateTime modificationDate() const;
+
+private:
+    QFile m_file;
+    QString m_errorMessage;
+    qint64 m_fileSize;
+    bool m_rawCodestream, m_boxesIntact, m_hasSignature, m_fileTypeSecond, m_imageHeaderFirst, m_hasCodestream;
+    QString m_brand;
+    int m_headerWidth, m_headerHeight;
+    int m_width, m_height, m_numComponents, m_bitsPerComponent, m_colourSpace;
+    bool m_hasICCProfile;
+    double m_captureResolution[2], m_displayResolution[2];
+    int m_numXMLBoxes;
+    bool m_hasXMP;
+    int m_numResolutionLevels, m_numQualityLayers;
+    bool m_lossless;
+    QString m_progressionOrder;
+    QDateTime m_creationDate, m_modificationDate;
+
+    /**
+     * Read the boxes in the given range of the file.
+     *
+     * @param superBox type of the box containing these boxes, 0 for top level
+     */
+    void parseBoxes(qint64 begin, qint64 end, quint32 superBox);
+    void parseCodestream(qint64 offset, qint64 length);
+    QByteArray readData(qint64 offset, qint64 length);
+};
+
+#endif // JP2PARSER_H
@@ -0,0 +1,295 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#include "jpegparser.h"
+
+#include <cstring>
+
+#include "general.h"
+
+/// EXIF tags of interest
+static const quint16 exifTagDateTime = 0x0132;
+static const quint16 exifTagExifIFDPointer = 0x8769;
+static const quint16 exifTagDateTimeOriginal = 0x9003;
+static const quint16 exifTagDateTimeDigitized = 0x9004;
+
+static inline quint32 readUnsigned(const uchar *data, int numBytes, bool bigEndian) {
+    quint32 result = 0;
+    for (int i = 0; i < numBytes; ++i)
+        result |= static_cast<quint32>(data[bigEndian ? i : numBytes - 1 - i]) << (8 * (numBytes - 1 - i));
+    return result;
+}
+
+/**
+ * Locate an entry in an image file directory (IFD) of EXIF data,
+ * which is structured like a TIFF file.
+ *
+ * @return position of the entry's value (inline or at offset), -1 if not found or invalid
+ */
+static int findIFDEntry(const uchar *data, int length, bool bigEndian, quint32 ifdOffset, quint16 tag, quint16 &type, quint32 &count) {
+    /// Offsets come from the file, so compute in 64 bits to rule out wrap-arounds
+    if (ifdOffset < 8 || static_cast<qint64>(ifdOffset) + 2 > length) return -1;
+    const int numEntries = static_cast<int>(readUnsigned(data + ifdOffset, 2, bigEndian));
+    for (int i = 0; i < numEntries; ++i) {
+        const qint64 entryOffset = static_cast<qint64>(ifdOffset) + 2 + 12 * static_cast<qint64>(i);
+        if (entryOffset + 12 > length) return -1;
+        if (readUnsigned(data + entryOffset, 2, bigEndian) != tag) continue;
+        type = static_cast<quint16>(readUnsigned(data + entryOffset + 2, 2, bigEndian));
+        count = readUnsigned(data + entryOffset + 4, 4, bigEndian);
+        /// Types ASCII (2) and LONG (4) are the only ones needed here
+        const qint64 valueSize = type == 2 ? static_cast<qint64>(count) : (type == 4 ? 4 * static_cast<qint64>(count) : 0);
+        if (valueSize <= 4) return static_cast<int>(entryOffset + 8);
+        const qint64 valueOffset = readUnsigned(data + entryOffset + 8, 4, bigEndian);
+        return valueOffset + valueSize <= length ? static_cast<int>(valueOffset) : -1;
+    }
+    return -1;
+}
+
+/// EXIF dates are formatted like '2017:05:14 09:30:45'
+static QDateTime exifDate(const uchar *data, int length, bool bigEndian, quint32 ifdOffset, quint16 tag) {
+    quint16 type = 0;
+    quint32 count = 0;
+    const int pos = findIFDEntry(data, length, bigEndian, ifdOffset, tag, type, count);
+    if (pos < 0 || type != 2 || count < 19) return QDateTime();
+    return QDateTime::fromString(QString::fromLatin1(reinterpret_cast<const char *>(data + pos), 19), QStringLiteral("yyyy:MM:dd HH:mm:ss"));
+}
+
+JPEGParser::JPEGParser(const QString &filename)
+    : m_file(filename), m_fileSize(0), m_width(0), m_height(0), m_numComponents(0), m_bitsPerSample(0), m_mode(UnknownMode), m_arithmeticCoding(false), m_segmentsIntact(true), m_hasFrame(false), m_hasScan(false), m_hasQuantizationTables(false), m_hasHuffmanTables(false), m_hasJFIF(false), m_hasExif(false), m_hasXMP(false), m_hasEndOfImage(false)
+{
+    /// nothing
+}
+
+bool JPEGParser::parse() {
+    if (!m_file.open(QFile::ReadOnly)) {
+        m_errorMessage = QStringLiteral("Could not open file");
+        return false;
+    }
+    m_fileSize = m_file.size();
+    if (m_fileSize < 4 || m_fileSize > INT_MAX) {
+        m_errorMessage = QStringLiteral("File size not supported");
+        return false;
+    }
+    const uchar *data = m_file.map(0, m_fileSize);
+    if (data == nullptr) {
+        m_errorMessage = QStringLiteral("Could not map file into memory");
+        return false;
+    }
+    const int size = static_cast<int>(m_fileSize);
+    if (data[0] != 0xff || data[1] != 0xd8) {
+        m_errorMessage = QStringLiteral("No start of image marker found");
+        return false;
+    }
+
+    static const QByteArray jfifIdentifier("JFIF\0", 5);
+    static const QByteArray exifIdentifier("Exif\0\0", 6);
+    static const QByteArray xmpIdentifier("http://ns.adobe.com/xap/1.0/\0", 29);
+
+    int pos = 2;
+    while (pos < size) {
+        if (data[pos] != 0xff) {
+            /// Garbage between segments, skip to next possible marker
+            m_segmentsIntact = false;
+            ++pos;
+            continue;
+        }
+        while (pos < size && data[pos] == 0xff) ++pos; ///< skip fill bytes
+        if (pos >= size) break;
+        const uchar marker = data[pos++];
+
+        if (marker == 0xd9) {
+            /// End of image
+            m_hasEndOfImage = true;
+            break;
+        } else if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7))
+            continue; ///< markers without segment: TEM and restart markers
+        else if (marker == 0x00 || marker == 0xd8) {
+            m_segmentsIntact = false;
+            continue;
+        }
+
+        if (pos + 2 > size) {
+            m_segmentsIntact = false;
+            break;
+        }
+        const int length = (data[pos] << 8) | data[pos + 1];
+        if (length < 2 || pos + length > size) {
+            m_segmentsIntact = false;
+            break;
+        }
+        const uchar *segment = data + pos + 2;
+        const int segmentLength = length - 2;
+        pos += length;
+
+        if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc) {
+            /// Start of frame; hierarchical files have several frames, the first one tells dimensions
+            if (!m_hasFrame && segmentLength >= 6) {
+                m_hasFrame = true;
+                m_bitsPerSample = segment[0];
+                m_height = (segment[1] << 8) | segment[2];
+                m_width = (segment[3] << 8) | segment[4];
+                m_numComponents = segment[5];
+                m_arithmeticCoding = marker >= 0xc9;
+                switch (marker & 0x07) {
+                case 0: m_mode = Baseline; break;
+                case 1: m_mode = ExtendedSequential; break;
+                case 2: m_mode = Progressive; break;
+                case 3: m_mode = Lossless; break;
+                default: m_mode = Hierarchical;
+                }
+            }
+        } else if (marker == 0xc4)
+            m_hasHuffmanTables = true;
+        else if (marker == 0xdb)
+            m_hasQuantizationTables = true;
+        else if (marker == 0xdc) {
+            /// Define number of lines, used if frame header left height open
+            if (m_height == 0 && segmentLength >= 2)
+                m_height = (segment[0] << 8) | segment[1];
+        } else if (marker == 0xe0) {
+            if (segmentLength >= jfifIdentifier.size() && memcmp(segment, jfifIdentifier.constData(), jfifIdentifier.size()) == 0)
+                m_hasJFIF = true;
+        } else if (marker == 0xe1) {
+            if (segmentLength >= exifIdentifier.size() && memcmp(segment, exifIdentifier.constData(), exifIdentifier.size()) == 0) {
+                m_hasExif = true;
+                parseExif(segment + exifIdentifier.size(), segmentLength - exifIdentifier.size());
+            } else if (segmentLength >= xmpIdentifier.size() && memcmp(segment, xmpIdentifier.constData(), xmpIdentifier.size()) == 0) {
+                m_hasXMP = true;
+                parseXMP(QByteArray::fromRawData(reinterpret_cast<const char *>(segment + xmpIdentifier.size()), segmentLength - xmpIdentifier.size()));
+            }
+        } else if (marker == 0xda) {
+            /// Start of scan, skip entropy-coded data up to the next marker;
+            /// stuffed zero bytes, restart markers, and fill bytes are no markers
+            m_hasScan = true;
+            while (pos + 1 < size && (data[pos] != 0xff || data[pos + 1] == 0x00 || data[pos + 1] == 0xff || (data[pos + 1] >= 0xd0 && data[pos + 1] <= 0xd7)))
+                ++pos;
+            if (pos + 1 >= size) pos = size;
+        }
+    }
+
+    if (!m_hasFrame) {
+        m_errorMessage = QStringLiteral("No frame header found");
+        return false;
+    }
+    return true;
+}
+
+QString JPEGParser::errorMessage() const {
+    return m_errorMessage;
+}
+
+bool JPEGParser::isWellFormed() const {
+    return m_segmentsIntact && m_hasFrame && m_hasScan && m_hasEndOfImage && m_width > 0 && m_height > 0
+           && (m_mode == Lossless || m_hasQuantizationTables) && (m_arithmeticCoding || m_hasHuffmanTables);
+}
+
+qint64 JPEGParser::fileSize() const {
+    return m_fileSize;
+}
+
+int JPEGParser::width() const {
+    return m_width;
+}
+
+int JPEGParser::height() const {
+    return m_height;
+}
+
+int JPEGParser::numComponents() const {
+    return m_numComponents;
+}
+
+int JPEGParser::bitsPerSample() const {
+    return m_bitsPerSample;
+}
+
+JPEGParser::Mode JPEGParser::mode() const {
+    return m_mode;
+}
+
+bool JPEGParser::isArithmeticCoding() const {
+    return m_arithmeticCoding;
+}
+
+bool JPEGParser::hasJFIF() const {
+    return m_hasJFIF;
+}
+
+bool JPEGParser::hasExif() const {
+    return m_hasExif;
+}
+
+bool JPEGParser::hasXMP() const {
+    return m_hasXMP;
+}
+
+bool JPEGParser::hasEndOfImage() const {
+    return m_hasEndOfImage;
+}
+
+QDateTime JPEGParser::creationDate() const {
+    return m_creationDate;
+}
+
+QDateTime JPEGParser::modificationDate() const {
+    return m_modificationDate;
+}
+
+QString JPEGParser::modeToString(Mode mode) {
+    switch (mode) {
+    case Baseline: return QStringLiteral("baseline");
+    case ExtendedSequential: return QStringLiteral("extendedsequential");
+    case Progressive: return QStringLiteral("progressive");
+    case Lossless: return QStringLiteral("lossless");
+    case Hierarchical: return QStringLiteral("hierarchical");
+    default: return QStringLiteral("unknown");
+    }
+}
+
+void JPEGParser::parseExif(const uchar *data, int length) {
+    if (length < 8) return;
+    /// EXIF data is structured like a TIFF file, starting with byte order and magic number
+    const bool bigEndian = data[0] == 'M' && data[1] == 'M';
+    if (!bigEndian && (data[0] != 'I' || data[1] != 'I')) return;
+    if (readUnsigned(data + 2, 2, bigEndian) != 42) return;
+    const quint32 ifd0Offset = readUnsigned(data + 4, 4, bigEndian);
+
+    const QDateTime dateTime = exifDate(data, length, bigEndian, ifd0Offset, exifTagDateTime);
+    if (dateTime.isValid()) m_modificationDate = dateTime;
+
+    quint16 type = 0;
+    quint32 count = 0;
+    const int exifIFDPointerPos = findIFDEntry(data, length, bigEndian, ifd0Offset, exifTagExifIFDPointer, type, count);
+    if (exifIFDPointerPos >= 0 && type == 4) {
+        const quint32 exifIFDOffset = readUnsigned(data + exifIFDPointerPos, 4, bigEndian);
+        QDateTime dateTimeOriginal = exifDate(data, length, bigEndian, exifIFDOffset, exifTagDateTimeOriginal);
+        if (!dateTimeOriginal.isValid())
+            dateTimeOriginal = exifDate(data, length, bigEndian, exifIFDOffset, exifTagDateTimeDigitized);
+        if (dateTimeOriginal.isValid()) m_creationDate = dateTimeOriginal;
+    }
+}
+
+void JPEGParser::parseXMP(const QByteArray &xmp) {
+    /// EXIF dates take precedence
+    DocScan::xmpDates(xmp, m_creationDate, m_modificationDate);
+}
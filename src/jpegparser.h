@@ -0,0 +1,99 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#ifndef JPEGPARSER_H
+#define JPEGPARSER_H
+
+#include <QFile>
+#include <QString>
+#include <QDateTime>
+
+/**
+ * Lightweight, read-only parser for JPEG files.
+ * Walks through the file's marker segments, reading the frame
+ * header, JFIF, EXIF and XMP application segments, and checks
+ * for table definitions and the end of image marker.
+ * Entropy-coded data is skipped, no image data is decoded.
+ * The file is memory-mapped.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class JPEGParser
+{
+public:
+    enum Mode {UnknownMode = 0, Baseline, ExtendedSequential, Progressive, Lossless, Hierarchical};
+
+    explicit JPEGParser(const QString &filename);
+
+    /**
+     * Open the file and walk through its marker segments
+     * up to the end of image marker.
+     *
+     * @return true if file starts with a start of image marker and has a frame header
+     */
+    bool parse();
+
+    QString errorMessage() const;
+
+    /**
+     * true if all marker segments were intact, a frame header, a scan,
+     * the required quantization and Huffman tables, and an end of image
+     * marker were found
+     */
+    bool isWellFormed() const;
+
+    qint64 fileSize() const;
+    int width() const;
+    int height() const;
+    int numComponents() const;
+    int bitsPerSample() const;
+    Mode mode() const;
+    bool isArithmeticCoding() const;
+
+    bool hasJFIF() const;
+    bool hasExif() const;
+    bool hasXMP() const;
+    bool hasEndOfImage() const;
+
+    /// Creation and modification date from EXIF data or, if missing there, from XMP metadata
+    QDateTime creationDate() const;
+    QDateTime modificationDate() const;
+
+    static QString modeToString(Mode mode);
+
+private:
+    QFile m_file;
+    QString m_errorMessage;
+    qint64 m_fileSize;
+    int m_width, m_height, m_numComponents, m_bitsPerSample;
+    Mode m_mode;
+    bool m_arithmeticCoding;
+    bool m_segmentsIntact, m_hasFrame, m_hasScan, m_hasQuantizationTables, m_hasHuffmanTables;
+    bool m_hasJFIF, m_hasExif, m_hasXMP, m_hasEndOfImage;
+    QDateTime m_creationDate, m_modificationDate;
+
+    void parseExif(const uchar *data, int length);
+    void parseXMP(const QByteArray &xmp);
+};
+
+#endif // JPEGPARSER_H
@@ -0,0 +1,108 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "latencymetrics.h"
+
+#include <algorithm>
+
+#include <QSaveFile>
+#include <QTextStream>
+#include <QMutexLocker>
+#include <QDebug>
+
+/// Bucket boundaries in microseconds
+const QVector<qint64> LatencyMetrics::bucketUpperBounds = LatencyMetrics::initBucketUpperBounds();
+
+QVector<qint64> LatencyMetrics::initBucketUpperBounds() {
+    static const int minExponent = 3, maxExponent = 31; ///< 2^3 us = 8 us up to 2^32 us = 71 min
+    static const int subBucketsPerExponent = 4;
+    QVector<qint64> result;
+    result.reserve((maxExponent - minExponent + 1) * subBucketsPerExponent + 1);
+    result.append(Q_INT64_C(1) << minExponent);
+    for (int e = minExponent; e <= maxExponent; ++e) {
+        const qint64 base = Q_INT64_C(1) << e;
+        for (int k = 1; k <= subBucketsPerExponent; ++k)
+            result.append(base + k * (base / subBucketsPerExponent));
+    }
+    return result;
+}
+
+LatencyMetrics::LatencyMetrics(const QString &filename, QObject *parent)
+    : QObject(parent), m_filename(filename)
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+    connect(&m_writeTimer, &QTimer::timeout, this, &LatencyMetrics::writeMetrics);
+}
+
+void LatencyMetrics::setWriteInterval(int seconds) {
+    if (seconds > 0)
+        m_writeTimer.start(seconds * 1000);
+    else
+        m_writeTimer.stop();
+}
+
+void LatencyMetrics::record(const QString &analyzer, const QString &stage, qint64 nanoseconds) {
+    const qint64 microseconds = qMax(Q_INT64_C(0), nanoseconds / 1000);
+    /// Index of first bucket whose upper bound is not less than the duration;
+    /// durations beyond the largest bound only count towards '+Inf'
+    const int bucket = std::lower_bound(bucketUpperBounds.constBegin(), bucketUpperBounds.constEnd(), microseconds) - bucketUpperBounds.constBegin();
+
+    QMutexLocker locker(&m_mutex);
+    Histogram &histogram = m_histograms[qMakePair(analyzer, stage)];
+    if (histogram.counts.isEmpty())
+        histogram.counts.fill(0, bucketUpperBounds.size());
+    if (bucket < histogram.counts.size())
+        ++histogram.counts[bucket];
+    ++histogram.count;
+    histogram.sumMicroseconds += microseconds;
+}
+
+void LatencyMetrics::writeMetrics() {
+    QSaveFile metricsFile(m_filename);
+    if (!metricsFile.open(QSaveFile::WriteOnly)) {
+        qWarning() << "Could not write metrics file" << m_filename;
+        return;
+    }
+
+    QTextStream ts(&metricsFile);
+    ts.setCodec("utf-8");
+    ts << "# HELP docscan_stage_duration_seconds Duration of individual analysis stages" << endl;
+    ts << "# TYPE docscan_stage_duration_seconds histogram" << endl;
+
+    QMutexLocker locker(&m_mutex);
+    for (QMap<QPair<QString, QString>, Histogram>::ConstIterator it = m_histograms.constBegin(); it != m_histograms.constEnd(); ++it) {
+        const QString labels = QString(QStringLiteral("analyzer=\"%1\",stage=\"%2\"")).arg(it.key().first, it.key().second);
+        quint64 cumulativeCount = 0;
+        for (int i = 0; i < bucketUpperBounds.size(); ++i) {
+            cumulativeCount += it.value().counts[i];
+            ts << "docscan_stage_duration_seconds_bucket{" << labels << ",le=\"" << QString::number(bucketUpperBounds[i] / 1000000.0, 'g', 9) << "\"} " << cumulativeCount << '\n';
+        }
+        ts << "docscan_stage_duration_seconds_bucket{" << labels << ",le=\"+Inf\"} " << it.value().count << '\n';
+        ts << "docscan_stage_duration_seconds_sum{" << labels << "} " << QString::number(it.value().sumMicroseconds / 1000000.0, 'f', 6) << '\n';
+        ts << "docscan_stage_duration_seconds_count{" << labels << "} " << it.value().count << '\n';
+    }
+    locker.unlock();
+
+    ts.flush();
+    if (!metricsFile.commit())
+        qWarning() << "Could not write metrics file" << m_filename;
+}
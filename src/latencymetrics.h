@@ -0,0 +1,99 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef LATENCYMETRICS_H
+#define LATENCYMETRICS_H
+
+#include <QObject>
+#include <QMap>
+#include <QPair>
+#include <QVector>
+#include <QMutex>
+#include <QTimer>
+
+/**
+ * Collecting durations of individual analysis stages (e.g. opening
+ * a file with Poppler or running veraPDF) in histograms with
+ * logarithmically spaced buckets (four buckets per power of two,
+ * from 8 microseconds to about one hour).
+ * Histograms are periodically written to a metrics file in
+ * Prometheus' text exposition format, suitable for node_exporter's
+ * textfile collector.
+ * Recording durations is thread-safe.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class LatencyMetrics : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param filename metrics file to (over-)write periodically
+     */
+    explicit LatencyMetrics(const QString &filename, QObject *parent = nullptr);
+
+    /**
+     * Set interval in which the metrics file gets rewritten.
+     *
+     * @param seconds interval in seconds, 0 or less disables periodic writing
+     */
+    void setWriteInterval(int seconds);
+
+    /**
+     * Record the duration of a single stage.
+     *
+     * @param analyzer name of analyzer which performed the stage, e.g. 'fileanalyzerpdf'
+     * @param stage name of stage, e.g. 'poppleropen' or 'verapdf-run'
+     * @param nanoseconds duration of this stage
+     */
+    void record(const QString &analyzer, const QString &stage, qint64 nanoseconds);
+
+public slots:
+    /**
+     * Write all histograms into the metrics file.
+     * The file is replaced atomically, so readers never see partial data.
+     */
+    void writeMetrics();
+
+private:
+    struct Histogram {
+        QVector<quint64> counts;
+        quint64 count;
+        qint64 sumMicroseconds;
+
+        explicit Histogram()
+            : count(0), sumMicroseconds(0) {
+            /// nothing
+        }
+    };
+
+    static const QVector<qint64> bucketUpperBounds;
+    static QVector<qint64> initBucketUpperBounds();
+
+    const QString m_filename;
+    QTimer m_writeTimer;
+    QMutex m_mutex;
+    /// Key is pair of analyzer and stage, QMap keeps output sorted
+    QMap<QPair<QString, QString>, Histogram> m_histograms;
+};
+
+#endif // LATENCYMETRICS_H
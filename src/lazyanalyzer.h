@@ -0,0 +1,93 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef LAZYANALYZER_H
+#define LAZYANALYZER_H
+
+#include <functional>
+
+#include <QList>
+
+#include "fileanalyzerabstract.h"
+
+/**
+ * Holds a file analyzer that gets created only once first used,
+ * so that analyzers for file types never encountered cost nothing.
+ * Settings made before the analyzer exists are recorded and applied
+ * upon its creation. The analyzer's reports, records, and embedded
+ * files are forwarded as the owner's signals.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+template<class T>
+class LazyAnalyzer
+{
+public:
+    explicit LazyAnalyzer(FileAnalyzerAbstract *owner)
+        : m_owner(owner), m_analyzer(nullptr) {
+        /// nothing
+    }
+
+    ~LazyAnalyzer() {
+        delete m_analyzer;
+    }
+
+    /// Analyzer, created and set up on first call
+    T *get() {
+        if (m_analyzer == nullptr) {
+            m_analyzer = new T();
+            QObject::connect(m_analyzer, &FileAnalyzerAbstract::analysisReport, m_owner, &FileAnalyzerAbstract::analysisReport);
+            QObject::connect(m_analyzer, &FileAnalyzerAbstract::analysisRecord, m_owner, &FileAnalyzerAbstract::analysisRecord);
+            QObject::connect(m_analyzer, &FileAnalyzerAbstract::foundEmbeddedFile, m_owner, &FileAnalyzerAbstract::foundEmbeddedFile);
+            for (const std::function<void(T *)> &setupFunction : m_setupFunctions)
+                setupFunction(m_analyzer);
+        }
+        return m_analyzer;
+    }
+
+    /// An analyzer not created yet cannot be busy
+    bool isAlive() const {
+        return m_analyzer != nullptr && m_analyzer->isAlive();
+    }
+
+    /**
+     * Invoke a setter like FileAnalyzerPDF::setupJhove with the given
+     * arguments on the analyzer, right away if it exists already and
+     * otherwise upon its creation.
+     */
+    template<class Setter, class... Args>
+    void setup(Setter setter, Args... args) {
+        const std::function<void(T *)> setupFunction = std::bind(setter, std::placeholders::_1, args...);
+        m_setupFunctions.append(setupFunction);
+        if (m_analyzer != nullptr)
+            setupFunction(m_analyzer);
+    }
+
+private:
+    Q_DISABLE_COPY(LazyAnalyzer)
+
+    FileAnalyzerAbstract *m_owner;
+    T *m_analyzer;
+    QList<std::function<void(T *)> > m_setupFunctions;
+};
+
+#endif // LAZYANALYZER_H
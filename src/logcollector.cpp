@@ -25,16 +25,41 @@
 #include <typeinfo>
 
 #include <QDateTime>
+#include <QFile>
+#include <QDebug>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+
+#include <algorithm>
 
 #include "general.h"
+#include "logindex.h"
 
 LogCollector::LogCollector(QIODevice *output, QObject *parent)
-    : QObject(parent), m_ts(output), m_output(output), m_tagStart(QStringLiteral("<(\\w+)\\b"))
+    : QObject(parent), m_ts(output), m_output(output), m_tagStart(QStringLiteral("<(\\w+)\\b")), m_maxShardSize(0), m_maxShardEntries(0), m_shardIndex(-1), m_shardEntries(0), m_manifest(nullptr), m_writeIndex(false), m_index(nullptr), m_indexKeyAttribute(QStringLiteral("\\b(filename|file|url|md5sum)=\"([^\"]*)\""))
 {
     setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
-    m_ts << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>" << endl << "<log isodate=\"" << QDateTime::currentDateTimeUtc().toString(Qt::ISODate) << "\">" << endl;
+    writeHeader();
+}
 
-    logGitVersion();
+LogCollector::LogCollector(const QString &baseFilename, qint64 maxShardSize, int maxShardEntries, QObject *parent)
+    : QObject(parent), m_output(nullptr), m_tagStart(QStringLiteral("<(\\w+)\\b")), m_maxShardSize(maxShardSize), m_maxShardEntries(maxShardEntries), m_shardIndex(0), m_shardEntries(0), m_writeIndex(false), m_index(nullptr), m_indexKeyAttribute(QStringLiteral("\\b(filename|file|url|md5sum)=\"([^\"]*)\""))
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+
+    /// Split '/tmp/log.xml' into '/tmp/log.' and '.xml',
+    /// so that shard numbers can be inserted in between
+    const QFileInfo fi(baseFilename);
+    const QString suffix = fi.suffix();
+    m_shardFilenamePrefix = suffix.isEmpty() ? baseFilename + QChar('.') : baseFilename.left(baseFilename.length() - suffix.length());
+    m_shardFilenameSuffix = suffix.isEmpty() ? QStringLiteral(".xml") : QChar('.') + suffix;
+
+    m_manifest = new QFile(m_shardFilenamePrefix + QStringLiteral("manifest"), this);
+    if (!m_manifest->open(QFile::WriteOnly))
+        qWarning() << "Could not open manifest file" << m_manifest->fileName();
+
+    openShard();
 }
 
 bool LogCollector::isAlive()
@@ -42,21 +67,67 @@ bool LogCollector::isAlive()
     return false;
 }
 
+void LogCollector::setWriteIndex(bool writeIndex) {
+    m_writeIndex = writeIndex;
+    if (m_writeIndex)
+        openIndex();
+    else
+        closeIndex();
+}
+
 void LogCollector::receiveLog(const QString &origin, const QString &message)
 {
-    if (m_output->isOpen()) {
-        const QString time = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
-        m_ts << "<logitem epoch=\"" << (QDateTime::currentMSecsSinceEpoch() / 1000) << "\" source=\"" << origin << "\" time=\"" << time << "\">" << endl << message << "</logitem>" << endl;
+    if (m_output != nullptr && m_output->isOpen()) {
+        writeLogItem(origin, message);
+
+        if (m_shardIndex >= 0 && ((m_maxShardSize > 0 && m_output->pos() >= m_maxShardSize) || (m_maxShardEntries > 0 && m_shardEntries >= m_maxShardEntries))) {
+            /// Current shard is full, continue with next one
+            closeShard();
+            ++m_shardIndex;
+            openShard();
+        }
     }
 }
 
 void LogCollector::close()
 {
-    if (m_output->isOpen()) {
-        m_ts << "</log>" << endl << "<!-- " << QDateTime::currentDateTimeUtc().toString(Qt::ISODate) << " -->" << endl;
-        m_ts.flush();
+    if (m_shardIndex >= 0) {
+        closeShard();
+        if (m_manifest != nullptr) m_manifest->close();
+        return;
     }
+
+    if (m_output->isOpen())
+        writeFooter();
     m_output->close();
+    closeIndex();
+}
+
+void LogCollector::writeHeader() {
+    m_ts << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>" << endl << "<log isodate=\"" << QDateTime::currentDateTimeUtc().toString(Qt::ISODate) << "\">" << endl;
+
+    logGitVersion();
+}
+
+void LogCollector::writeLogItem(const QString &origin, const QString &message) {
+    qint64 offset = -1;
+    if (m_index != nullptr) {
+        m_ts.flush();
+        offset = m_output->pos();
+    }
+
+    const QString time = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    m_ts << "<logitem epoch=\"" << (QDateTime::currentMSecsSinceEpoch() / 1000) << "\" source=\"" << origin << "\" time=\"" << time << "\">" << endl << message << "</logitem>" << endl;
+    ++m_shardEntries;
+
+    if (offset >= 0)
+        /// 'endl' has flushed the text stream, so the device's position is up-to-date
+        writeIndexEntries(message, offset, m_output->pos() - offset);
+}
+
+void LogCollector::writeFooter() {
+    m_ts << "</log>" << endl << "<!-- " << QDateTime::currentDateTimeUtc().toString(Qt::ISODate) << " -->" << endl;
+    m_ts.flush();
 }
 
 void LogCollector::logGitVersion() {
@@ -65,6 +136,119 @@ void LogCollector::logGitVersion() {
     static const QDateTime gitCommitDate = QDateTime::fromMSecsSinceEpoch(Q_INT64_C(1000) * GIT_COMMIT_DATE);
     if (!gitCommit.isEmpty() && !gitCommitCount.isEmpty()) {
         static const QString message(QString(QStringLiteral("<git commit=\"%1\" commitcount=\"%2\">\n%3</git>\n")).arg(gitCommit, gitCommitCount, DocScan::formatDateTime(gitCommitDate, QStringLiteral("commitdate"))));
-        receiveLog(QStringLiteral("logcollector"), message);
+        /// Write directly, not via receiveLog, as this may happen
+        /// while a new shard is being opened
+        writeLogItem(QStringLiteral("logcollector"), message);
+    }
+}
+
+QString LogCollector::shardFilename(int index) const {
+    return m_shardFilenamePrefix + QString(QStringLiteral("%1")).arg(index, 4, 10, QChar('0')) + m_shardFilenameSuffix;
+}
+
+bool LogCollector::openShard() {
+    QFile *shard = new QFile(shardFilename(m_shardIndex), this);
+    if (!shard->open(QFile::WriteOnly)) {
+        qWarning() << "Could not open log shard" << shard->fileName();
+        delete shard;
+        m_output = nullptr;
+        return false;
+    }
+
+    m_output = shard;
+    m_ts.setDevice(m_output);
+    m_shardEntries = 0;
+    if (m_writeIndex)
+        openIndex();
+    writeHeader();
+    return true;
+}
+
+void LogCollector::closeShard() {
+    if (m_output == nullptr) return;
+
+    const QString filename = static_cast<QFile *>(m_output)->fileName();
+    if (m_output->isOpen()) {
+        writeFooter();
+        m_output->close();
+
+        /// Only completed shards get listed in manifest,
+        /// one line per shard: filename, number of log items, size in bytes
+        if (m_manifest != nullptr && m_manifest->isOpen()) {
+            m_manifest->write(QString(QStringLiteral("%1\t%2\t%3\n")).arg(filename, QString::number(m_shardEntries), QString::number(QFileInfo(filename).size())).toUtf8());
+            m_manifest->flush();
+        }
     }
+
+    closeIndex();
+    m_ts.setDevice(nullptr);
+    m_output->deleteLater();
+    m_output = nullptr;
+}
+
+void LogCollector::openIndex() {
+    if (m_index != nullptr) return;
+
+    QFile *logFile = qobject_cast<QFile *>(m_output);
+    if (logFile == nullptr || !logFile->isOpen()) {
+        qWarning() << "Cannot write index if log is not written into a file";
+        return;
+    }
+
+    m_index = new QFile(logFile->fileName() + QStringLiteral(".index"), this);
+    if (!m_index->open(QFile::WriteOnly)) {
+        qWarning() << "Could not open index file" << m_index->fileName();
+        delete m_index;
+        m_index = nullptr;
+    }
+}
+
+void LogCollector::closeIndex() {
+    if (m_index == nullptr) return;
+
+    m_index->close();
+    const QFile *logFile = qobject_cast<QFile *>(m_output);
+    if (logFile != nullptr)
+        writeSortedIndex(logFile->fileName() + QLatin1String(LogIndex::sortedIndexSuffix));
+    m_indexEntries.clear();
+    delete m_index;
+    m_index = nullptr;
+}
+
+void LogCollector::writeIndexEntries(const QString &message, qint64 offset, qint64 length) {
+    /// Only consider the first XML tag of a log item, e.g.
+    /// <fileanalysis filename="..." status="ok"> or <download url="..." filename="...">
+    const int tagEnd = message.indexOf(QChar('>'));
+    if (tagEnd < 0) return;
+    const QString firstTag = message.left(tagEnd);
+
+    /// One line per key: offset, length, kind of key, key
+    const QString prefix = QString::number(offset) + QChar('\t') + QString::number(length) + QChar('\t');
+    QByteArray lines;
+    for (int p = m_indexKeyAttribute.indexIn(firstTag); p >= 0; p = m_indexKeyAttribute.indexIn(firstTag, p + m_indexKeyAttribute.matchedLength())) {
+        const QString key = DocScan::dexmlify(m_indexKeyAttribute.cap(2));
+        if (key.isEmpty()) continue;
+        lines.append((prefix + m_indexKeyAttribute.cap(1) + QChar('\t') + key + QChar('\n')).toUtf8());
+        m_indexEntries.append(IndexEntry(LogIndex::keyHash(key.toUtf8()), offset, length));
+    }
+    if (!lines.isEmpty())
+        m_index->write(lines);
+}
+
+void LogCollector::writeSortedIndex(const QString &filename) {
+    std::sort(m_indexEntries.begin(), m_indexEntries.end(), [](const IndexEntry & a, const IndexEntry & b) {
+        return a.keyHash < b.keyHash || (a.keyHash == b.keyHash && a.offset < b.offset);
+    });
+
+    QSaveFile sortedIndex(filename);
+    if (sortedIndex.open(QSaveFile::WriteOnly)) {
+        sortedIndex.write(LogIndex::magic);
+        QDataStream stream(&sortedIndex);
+        stream.setByteOrder(QDataStream::BigEndian);
+        for (const IndexEntry &entry : const_cast<const QVector<IndexEntry> &>(m_indexEntries))
+            stream << entry.keyHash << entry.offset << entry.length;
+        if (!sortedIndex.commit())
+            qWarning() << "Could not write sorted index file" << filename;
+    } else
+        qWarning() << "Could not write sorted index file" << filename;
 }
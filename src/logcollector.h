@@ -27,10 +27,12 @@
 #include <QTextStream>
 #include <QRegExp>
 #include <QTextStream>
+#include <QVector>
 
 #include "watchable.h"
 
 class QIODevice;
+class QFile;
 
 /**
  * Collecting log messages from various sources and
@@ -50,8 +52,37 @@ public:
      */
     explicit LogCollector(QIODevice *output, QObject *parent = nullptr);
 
+    /**
+     * Create instance which writes log messages into a sequence of
+     * numbered files ('shards'). For a base filename like '/tmp/log.xml',
+     * shards are named '/tmp/log.0000.xml', '/tmp/log.0001.xml', etc.
+     * Each shard is a well-formed XML document on its own. Once a shard
+     * is complete and closed, it gets listed in a manifest file named
+     * like '/tmp/log.manifest', so other processes may pick it up while
+     * logging continues.
+     *
+     * @param baseFilename filename to derive shards' and manifest's filenames from
+     * @param maxShardSize start a new shard once current shard has reached this many bytes, 0 for no limit
+     * @param maxShardEntries start a new shard once current shard contains this many log items, 0 for no limit
+     */
+    explicit LogCollector(const QString &baseFilename, qint64 maxShardSize, int maxShardEntries, QObject *parent = nullptr);
+
     virtual bool isAlive();
 
+    /**
+     * Enable or disable writing a sidecar index next to each log file
+     * (e.g. '/tmp/log.xml.index'). For every log item that refers to a file,
+     * the index contains one line per filename, URL, or MD5 sum, listing the
+     * log item's byte offset and length in the log file, allowing to read
+     * a single item without parsing the whole log.
+     * Once the log file is complete, the index is additionally written
+     * sorted by key hash (see LogIndex) to allow lookups by binary search.
+     * Has only an effect if log is written into a file.
+     *
+     * @param writeIndex true if index shall be written
+     */
+    void setWriteIndex(bool writeIndex);
+
 public slots:
     /**
      * Receive incomming log messages and store them in the output device
@@ -71,7 +102,46 @@ private:
     QIODevice *m_output;
     QRegExp m_tagStart;
 
+    /// Only used if writing log into shards
+    QString m_shardFilenamePrefix, m_shardFilenameSuffix;
+    qint64 m_maxShardSize;
+    int m_maxShardEntries;
+    int m_shardIndex, m_shardEntries;
+    QFile *m_manifest;
+
+    bool m_writeIndex;
+    QFile *m_index;
+    QRegExp m_indexKeyAttribute;
+
+    /// Entry of the sorted index, see LogIndex
+    struct IndexEntry {
+        quint64 keyHash;
+        qint64 offset, length;
+
+        IndexEntry()
+            : keyHash(0), offset(0), length(0) {
+            /// nothing
+        }
+
+        IndexEntry(quint64 _keyHash, qint64 _offset, qint64 _length)
+            : keyHash(_keyHash), offset(_offset), length(_length) {
+            /// nothing
+        }
+    };
+    QVector<IndexEntry> m_indexEntries;
+
+    void writeHeader();
+    void writeLogItem(const QString &origin, const QString &message);
+    void writeFooter();
     void logGitVersion();
+
+    inline QString shardFilename(int index) const;
+    bool openShard();
+    void closeShard();
+    void openIndex();
+    void closeIndex();
+    void writeIndexEntries(const QString &message, qint64 offset, qint64 length);
+    void writeSortedIndex(const QString &filename);
 };
 
 #endif // LOGCOLLECTOR_H
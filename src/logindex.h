@@ -0,0 +1,59 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef LOGINDEX_H
+#define LOGINDEX_H
+
+#include <QByteArray>
+#include <QCryptographicHash>
+
+/**
+ * Format of the sorted index written next to a log file when logging
+ * finishes (e.g. '/tmp/log.xml.index.sorted'). After a fixed header,
+ * the file consists of fixed-width records (key hash, offset, length;
+ * big-endian 64 bit integers each), sorted by key hash, so that a log
+ * item can be located by binary search in O(log n) seeks instead of
+ * scanning the whole index.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+namespace LogIndex {
+
+/// Appended to the log file's name
+static const char sortedIndexSuffix[] = ".index.sorted";
+/// First bytes of a sorted index file
+static const QByteArray magic("DocScanLogIndex1");
+/// Size of a single record in bytes
+static const int recordSize = 3 * 8;
+
+/// Hash of a key like a filename, URL, or MD5 sum, as stored in records
+inline quint64 keyHash(const QByteArray &key) {
+    const QByteArray md5 = QCryptographicHash::hash(key, QCryptographicHash::Md5);
+    quint64 result = 0;
+    for (int i = 0; i < 8; ++i)
+        result = (result << 8) | static_cast<uchar>(md5[i]);
+    return result;
+}
+
+}
+
+#endif // LOGINDEX_H
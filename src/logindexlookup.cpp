@@ -0,0 +1,167 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+/**
+ * Small command line tool to retrieve single log items from DocScan's
+ * XML log files using the sidecar index written by LogCollector
+ * (configuration option 'logcollector:index').
+ *
+ * Usage:  LogIndexLookup KEY LOGFILE [LOGFILE ...]
+ *
+ * KEY is a filename, URL, or MD5 sum as found in the index. For each
+ * matching index entry, the log item is read directly from the log file
+ * at the recorded offset and printed to standard output.
+ * The sorted index written once a log file is complete is searched by
+ * binary search; for incomplete log files, the plain index is scanned.
+ */
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+#include <QDataStream>
+#include <QSet>
+#include <QDebug>
+
+#include "logindex.h"
+
+/// Read record number 'index' from sorted index
+static bool readRecord(QFile &sortedIndexFile, qint64 index, quint64 &keyHash, qint64 &offset, qint64 &length) {
+    if (!sortedIndexFile.seek(LogIndex::magic.length() + index * LogIndex::recordSize)) return false;
+    QDataStream stream(&sortedIndexFile);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream >> keyHash >> offset >> length;
+    return stream.status() == QDataStream::Ok;
+}
+
+/**
+ * Look up key in sorted index by binary search.
+ *
+ * @return number of log items printed, -1 if sorted index is not available
+ */
+static int lookupSorted(const QString &key, const QString &logFilename, QTextStream &out) {
+    QFile sortedIndexFile(logFilename + QLatin1String(LogIndex::sortedIndexSuffix));
+    if (!sortedIndexFile.open(QFile::ReadOnly)) return -1;
+    if (sortedIndexFile.read(LogIndex::magic.length()) != LogIndex::magic) {
+        qWarning() << "Not a sorted index file:" << sortedIndexFile.fileName();
+        return -1;
+    }
+    QFile logFile(logFilename);
+    if (!logFile.open(QFile::ReadOnly)) {
+        qWarning() << "Cannot open log file" << logFilename;
+        return 0;
+    }
+
+    /// Find first record with key's hash
+    const quint64 hash = LogIndex::keyHash(key.toUtf8());
+    const qint64 numRecords = (sortedIndexFile.size() - LogIndex::magic.length()) / LogIndex::recordSize;
+    qint64 low = 0, high = numRecords;
+    quint64 keyHash = 0;
+    qint64 offset = 0, length = 0;
+    while (low < high) {
+        const qint64 middle = low + (high - low) / 2;
+        if (!readRecord(sortedIndexFile, middle, keyHash, offset, length)) return 0;
+        if (keyHash < hash)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    int count = 0;
+    QSet<qint64> printedOffsets; ///< same log item may be indexed under several keys
+    for (qint64 i = low; i < numRecords && readRecord(sortedIndexFile, i, keyHash, offset, length) && keyHash == hash; ++i) {
+        if (length <= 0 || printedOffsets.contains(offset)) continue;
+        if (!logFile.seek(offset)) {
+            qWarning() << "Cannot seek to offset" << offset << "in log file" << logFilename;
+            continue;
+        }
+        out << QString::fromUtf8(logFile.read(length));
+        printedOffsets.insert(offset);
+        ++count;
+    }
+    return count;
+}
+
+static int lookup(const QString &key, const QString &logFilename, QTextStream &out) {
+    const int sortedCount = lookupSorted(key, logFilename, out);
+    if (sortedCount >= 0) return sortedCount;
+
+    /// No sorted index, e.g. as log file is still being written
+    QFile indexFile(logFilename + QStringLiteral(".index"));
+    if (!indexFile.open(QFile::ReadOnly)) {
+        qWarning() << "Cannot open index file" << indexFile.fileName();
+        return -1;
+    }
+    QFile logFile(logFilename);
+    if (!logFile.open(QFile::ReadOnly)) {
+        qWarning() << "Cannot open log file" << logFilename;
+        return -1;
+    }
+
+    const QByteArray utf8Key = key.toUtf8();
+    int count = 0;
+    qint64 lastOffset = -1;
+    while (!indexFile.atEnd()) {
+        /// Line format: offset, length, kind of key, key; separated by tabs
+        const QByteArray line = indexFile.readLine();
+        const QList<QByteArray> fields = line.left(line.endsWith('\n') ? line.length() - 1 : line.length()).split('\t');
+        if (fields.length() < 4 || fields[3] != utf8Key) continue;
+
+        bool ok = false;
+        const qint64 offset = fields[0].toLongLong(&ok);
+        if (!ok || offset == lastOffset) continue; ///< same log item may be indexed under several keys
+        const qint64 length = fields[1].toLongLong(&ok);
+        if (!ok || length <= 0) continue;
+
+        if (!logFile.seek(offset)) {
+            qWarning() << "Cannot seek to offset" << offset << "in log file" << logFilename;
+            continue;
+        }
+        out << QString::fromUtf8(logFile.read(length));
+        lastOffset = offset;
+        ++count;
+    }
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s KEY LOGFILE [LOGFILE ...]\n", argv[0]);
+        return 1;
+    }
+
+    const QString key = QString::fromUtf8(argv[1]);
+    QTextStream out(stdout);
+    out.setCodec("utf-8");
+    int count = 0;
+    for (int i = 2; i < argc; ++i) {
+        const int c = lookup(key, QString::fromUtf8(argv[i]), out);
+        if (c > 0) count += c;
+    }
+    out.flush();
+
+    return count > 0 ? 0 : 2;
+}
@@ -20,6 +20,8 @@
 
  */
 
+#include <climits>
+
 #include <QCoreApplication>
 #include <QFile>
 #include <QFileInfo>
@@ -41,6 +43,12 @@
 #include "webcrawler.h"
 #include "general.h"
 #include "logcollector.h"
+#include "ndjsoncollector.h"
+#include "statisticsaggregator.h"
+#include "latencymetrics.h"
+#include "popplerworkerpool.h"
+#include "adaptivetimeouts.h"
+#include "toolregistry.h"
 #include "fromlogfile.h"
 #include "filefinderlist.h"
 
@@ -49,10 +57,15 @@ QStringList filter;
 FileFinder *finder;
 Downloader *downloader;
 LogCollector *logCollector;
+qint64 logCollectorMaxShardSize;
+int logCollectorMaxShardEntries;
+bool logCollectorWriteIndex;
+NDJSONCollector *ndjsonCollector;
 FileAnalyzerAbstract *fileAnalyzer;
 static const int defaultNumHits = 25000;
 int numHits, webcrawlermaxvisitedpages;
 QString jhoveShellscript;
+bool imageJhoveValidation;
 QString dpfmangerJFXjar;
 QString veraPDFcliTool;
 QString pdfboxValidatorJavaClass;
@@ -62,8 +75,29 @@ QString qoppaJPDFPreflightDirectory;
 QString threeHeightsValidatorShellCLI, threeHeightsValidatorLicenseKey;
 bool validateOnlyPDFAfiles, downgradeToPDFA1b;
 FileAnalyzerPDF::XMPPDFConformance enforcedValidationLevel;
+FileAnalyzerPDF::ValidatorPolicy validatorPolicy;
+int validatorQuorum;
+bool summarizeValidatorOutput;
+int validatorOutputMaxFailures;
 FileAnalyzerAbstract::TextExtraction textExtraction;
+int textExtractionMaxPages, textExtractionMaxCharacters;
 bool enableEmbeddedFilesAnalysis;
+int embeddedImagesMax, embeddedImageMaxSize;
+int embeddedFileCacheSize;
+bool zipListOnly;
+qint64 zipMaxMemberSize;
+int zipMaxCompressionRatio, zipMaxMembers, zipMaxNestingDepth;
+bool enableStatistics;
+int statisticsInterval;
+QString metricsFilename;
+int metricsInterval;
+int parallelPageThreshold;
+bool quickPDFAnalysis;
+int popplerWorkers, popplerWorkerMemoryLimit, popplerWorkerTimeout;
+QString adaptiveTimeoutsFilename;
+double adaptiveTimeoutsQuantile, adaptiveTimeoutsMaxFactor;
+int adaptiveTimeoutsMinimum;
+QString toolRegistryFilename;
 
 bool evaluateConfigfile(const QString &filename)
 {
@@ -97,12 +131,149 @@ bool evaluateConfigfile(const QString &filename)
                         textExtraction = FileAnalyzerAbstract::teAspell;
                     else
                         qWarning() << "Invalid value for \"textExtraction\":" << value;
+                } else if (key == QStringLiteral("textextraction:maxpages")) {
+                    bool ok = false;
+                    textExtractionMaxPages = value.toInt(&ok);
+                    if (!ok || textExtractionMaxPages < 0) textExtractionMaxPages = 0;
+                    qDebug() << "textextraction:maxpages =" << textExtractionMaxPages;
+                } else if (key == QStringLiteral("textextraction:maxchars")) {
+                    bool ok = false;
+                    textExtractionMaxCharacters = value.toInt(&ok);
+                    if (!ok || textExtractionMaxCharacters < 0) textExtractionMaxCharacters = 0;
+                    qDebug() << "textextraction:maxchars =" << textExtractionMaxCharacters;
                 } else if (key == QStringLiteral("embeddedfilesanalysis")) {
                     enableEmbeddedFilesAnalysis = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
+                } else if (key == QStringLiteral("embeddedfilesanalysis:maximages")) {
+                    bool ok = false;
+                    embeddedImagesMax = value.toInt(&ok);
+                    if (!ok || embeddedImagesMax < 0) embeddedImagesMax = 256;
+                    qDebug() << "embeddedfilesanalysis:maximages =" << embeddedImagesMax;
+                } else if (key == QStringLiteral("embeddedfilesanalysis:maximagesize")) {
+                    bool ok = false;
+                    embeddedImageMaxSize = value.toInt(&ok);
+                    if (!ok || embeddedImageMaxSize < 0) embeddedImageMaxSize = 64 * 1024 * 1024;
+                    qDebug() << "embeddedfilesanalysis:maximagesize =" << embeddedImageMaxSize;
+                } else if (key == QStringLiteral("embeddedfilesanalysis:cachesize")) {
+                    bool ok = false;
+                    embeddedFileCacheSize = value.toInt(&ok);
+                    if (!ok || embeddedFileCacheSize < 0) embeddedFileCacheSize = 64 << 20;
+                    qDebug() << "embeddedfilesanalysis:cachesize =" << embeddedFileCacheSize;
+                } else if (key == QStringLiteral("zip:listonly")) {
+                    zipListOnly = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
+                    qDebug() << "zip:listonly =" << zipListOnly;
+                } else if (key == QStringLiteral("zip:maxmembersize")) {
+                    bool ok = false;
+                    zipMaxMemberSize = value.toLongLong(&ok);
+                    if (!ok || zipMaxMemberSize < 0) zipMaxMemberSize = 256 << 20;
+                    qDebug() << "zip:maxmembersize =" << zipMaxMemberSize;
+                } else if (key == QStringLiteral("zip:maxcompressionratio")) {
+                    bool ok = false;
+                    zipMaxCompressionRatio = value.toInt(&ok);
+                    if (!ok || zipMaxCompressionRatio < 0) zipMaxCompressionRatio = 100;
+                    qDebug() << "zip:maxcompressionratio =" << zipMaxCompressionRatio;
+                } else if (key == QStringLiteral("zip:maxmembers")) {
+                    bool ok = false;
+                    zipMaxMembers = value.toInt(&ok);
+                    if (!ok || zipMaxMembers < 0) zipMaxMembers = 10000;
+                    qDebug() << "zip:maxmembers =" << zipMaxMembers;
+                } else if (key == QStringLiteral("zip:maxdepth")) {
+                    bool ok = false;
+                    zipMaxNestingDepth = value.toInt(&ok);
+                    if (!ok || zipMaxNestingDepth < 0) zipMaxNestingDepth = 2;
+                    qDebug() << "zip:maxdepth =" << zipMaxNestingDepth;
+                } else if (key == QStringLiteral("statistics")) {
+                    enableStatistics = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
+                } else if (key == QStringLiteral("pdf:parallelpagethreshold")) {
+                    bool ok = false;
+                    parallelPageThreshold = value.toInt(&ok);
+                    if (!ok || parallelPageThreshold < 0) parallelPageThreshold = 0;
+                    qDebug() << "pdf:parallelpagethreshold =" << parallelPageThreshold;
+                } else if (key == QStringLiteral("pdf:popplerworkers")) {
+                    bool ok = false;
+                    popplerWorkers = value.toInt(&ok);
+                    if (!ok || popplerWorkers < 0) popplerWorkers = 0;
+                    qDebug() << "pdf:popplerworkers =" << popplerWorkers;
+                } else if (key == QStringLiteral("pdf:popplerworkermemory")) {
+                    bool ok = false;
+                    popplerWorkerMemoryLimit = value.toInt(&ok);
+                    if (!ok || popplerWorkerMemoryLimit < 0) popplerWorkerMemoryLimit = 0;
+                    qDebug() << "pdf:popplerworkermemory =" << popplerWorkerMemoryLimit;
+                } else if (key == QStringLiteral("pdf:popplerworkertimeout")) {
+                    bool ok = false;
+                    popplerWorkerTimeout = value.toInt(&ok);
+                    if (!ok || popplerWorkerTimeout < 1) popplerWorkerTimeout = 300;
+                    qDebug() << "pdf:popplerworkertimeout =" << popplerWorkerTimeout;
+                } else if (key == QStringLiteral("pdfanalysis")) {
+                    if (value.compare(QStringLiteral("quick"), Qt::CaseInsensitive) == 0)
+                        quickPDFAnalysis = true;
+                    else if (value.compare(QStringLiteral("full"), Qt::CaseInsensitive) == 0)
+                        quickPDFAnalysis = false;
+                    else
+                        qWarning() << "Invalid value for \"pdfanalysis\":" << value;
+                } else if (key == QStringLiteral("adaptivetimeouts")) {
+                    adaptiveTimeoutsFilename = value;
+                    qDebug() << "adaptivetimeouts =" << adaptiveTimeoutsFilename;
+                } else if (key == QStringLiteral("toolcheck:cachefile")) {
+                    toolRegistryFilename = value;
+                    qDebug() << "toolcheck:cachefile =" << toolRegistryFilename;
+                } else if (key == QStringLiteral("adaptivetimeouts:quantile")) {
+                    bool ok = false;
+                    adaptiveTimeoutsQuantile = value.toDouble(&ok);
+                    if (!ok || adaptiveTimeoutsQuantile < 0.5 || adaptiveTimeoutsQuantile >= 1.0) adaptiveTimeoutsQuantile = 0.99;
+                    qDebug() << "adaptivetimeouts:quantile =" << adaptiveTimeoutsQuantile;
+                } else if (key == QStringLiteral("adaptivetimeouts:minimum")) {
+                    bool ok = false;
+                    adaptiveTimeoutsMinimum = value.toInt(&ok);
+                    if (!ok || adaptiveTimeoutsMinimum < 1) adaptiveTimeoutsMinimum = 30;
+                    qDebug() << "adaptivetimeouts:minimum =" << adaptiveTimeoutsMinimum;
+                } else if (key == QStringLiteral("adaptivetimeouts:maxfactor")) {
+                    bool ok = false;
+                    adaptiveTimeoutsMaxFactor = value.toDouble(&ok);
+                    if (!ok || adaptiveTimeoutsMaxFactor < 1.0) adaptiveTimeoutsMaxFactor = 4.0;
+                    qDebug() << "adaptivetimeouts:maxfactor =" << adaptiveTimeoutsMaxFactor;
+                } else if (key == QStringLiteral("metricsfile")) {
+                    metricsFilename = value;
+                    qDebug() << "metricsfile =" << metricsFilename;
+                } else if (key == QStringLiteral("metricsfile:interval")) {
+                    bool ok = false;
+                    metricsInterval = value.toInt(&ok);
+                    if (!ok || metricsInterval < 0) metricsInterval = 0;
+                    qDebug() << "metricsfile:interval =" << metricsInterval;
+                } else if (key == QStringLiteral("statistics:interval")) {
+                    bool ok = false;
+                    statisticsInterval = value.toInt(&ok);
+                    if (!ok || statisticsInterval < 0) statisticsInterval = 0;
+                    qDebug() << "statistics:interval =" << statisticsInterval;
                 } else if (key == QStringLiteral("validateonlypdfafiles")) {
                     validateOnlyPDFAfiles = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
                 } else if (key == QStringLiteral("downgradetopdfa1b")) {
                     downgradeToPDFA1b = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
+                } else if (key == QStringLiteral("validatorpolicy")) {
+                    if (value.compare(QStringLiteral("all"), Qt::CaseInsensitive) == 0)
+                        validatorPolicy = FileAnalyzerPDF::validatorPolicyAll;
+                    else if (value.compare(QStringLiteral("failfast"), Qt::CaseInsensitive) == 0)
+                        validatorPolicy = FileAnalyzerPDF::validatorPolicyFailFast;
+                    else if (value.compare(QStringLiteral("quorum"), Qt::CaseInsensitive) == 0)
+                        validatorPolicy = FileAnalyzerPDF::validatorPolicyQuorum;
+                    else
+                        qWarning() << "Invalid value for \"validatorpolicy\":" << value;
+                } else if (key == QStringLiteral("validatorpolicy:quorum")) {
+                    bool ok = false;
+                    validatorQuorum = value.toInt(&ok);
+                    if (!ok || validatorQuorum < 1) validatorQuorum = 2;
+                    qDebug() << "validatorpolicy:quorum =" << validatorQuorum;
+                } else if (key == QStringLiteral("validatoroutput")) {
+                    if (value.compare(QStringLiteral("summary"), Qt::CaseInsensitive) == 0)
+                        summarizeValidatorOutput = true;
+                    else if (value.compare(QStringLiteral("full"), Qt::CaseInsensitive) == 0)
+                        summarizeValidatorOutput = false;
+                    else
+                        qWarning() << "Invalid value for \"validatoroutput\":" << value;
+                } else if (key == QStringLiteral("validatoroutput:maxfailures")) {
+                    bool ok = false;
+                    validatorOutputMaxFailures = value.toInt(&ok);
+                    if (!ok || validatorOutputMaxFailures < 0) validatorOutputMaxFailures = 20;
+                    qDebug() << "validatoroutput:maxfailures =" << validatorOutputMaxFailures;
                 } else if (key == QStringLiteral("pdfapartlevel")) {
                     if (value.compare(QStringLiteral("auto"), Qt::CaseInsensitive) == 0)
                         enforcedValidationLevel = FileAnalyzerPDF::xmpNone;
@@ -135,6 +306,9 @@ bool evaluateConfigfile(const QString &filename)
                     const QFileInfo script(jhoveShellscript);
                     if (jhoveShellscript.isEmpty() || !script.exists() || !script.isExecutable())
                         qCritical() << "Value for jhoveShellscript does not refer to an existing, executable script or program";
+                } else if (key == QStringLiteral("jhove:images")) {
+                    imageJhoveValidation = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
+                    qDebug() << "jhove:images =" << imageJhoveValidation;
                 } else if (key == QStringLiteral("dpfmanagerjar")) {
                     dpfmangerJFXjar = value;
                     qDebug() << "dpfmangerJFXjar =" << dpfmangerJFXjar;
@@ -252,9 +426,38 @@ bool evaluateConfigfile(const QString &filename)
                     /// a FakeDownloader instance will be automatically created and used.
                 } else if (key == QStringLiteral("logcollector") && logCollector == nullptr) {
                     qDebug() << "logcollector =" << value;
-                    QFile *logOutput = new QFile(value);
-                    logOutput->open(QFile::WriteOnly);
-                    logCollector = new LogCollector(logOutput);
+                    if (logCollectorMaxShardSize > 0 || logCollectorMaxShardEntries > 0)
+                        /// Write log into a sequence of well-formed XML files
+                        /// instead of a single, monolithic one
+                        logCollector = new LogCollector(value, logCollectorMaxShardSize, logCollectorMaxShardEntries);
+                    else {
+                        QFile *logOutput = new QFile(value);
+                        logOutput->open(QFile::WriteOnly);
+                        logCollector = new LogCollector(logOutput);
+                    }
+                } else if (key == QStringLiteral("logcollector:maxshardsize")) {
+                    /// Value is given in MiB
+                    bool ok = false;
+                    const qint64 maxShardSizeMiB = value.toLongLong(&ok);
+                    /// Check before shifting, as shifting negative or too large values is undefined
+                    logCollectorMaxShardSize = ok && maxShardSizeMiB > 0 && maxShardSizeMiB <= (LLONG_MAX >> 20) ? maxShardSizeMiB << 20 : 0;
+                    qDebug() << "logcollector:maxshardsize =" << logCollectorMaxShardSize;
+                    if (logCollector != nullptr)
+                        qWarning() << "logcollector:maxshardsize has to be set before logcollector to take effect";
+                } else if (key == QStringLiteral("logcollector:index")) {
+                    logCollectorWriteIndex = value.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0 || value.compare(QStringLiteral("yes"), Qt::CaseInsensitive) == 0;
+                } else if (key == QStringLiteral("logcollector:maxshardentries")) {
+                    bool ok = false;
+                    logCollectorMaxShardEntries = value.toInt(&ok);
+                    if (!ok || logCollectorMaxShardEntries < 0) logCollectorMaxShardEntries = 0;
+                    qDebug() << "logcollector:maxshardentries =" << logCollectorMaxShardEntries;
+                    if (logCollector != nullptr)
+                        qWarning() << "logcollector:maxshardentries has to be set before logcollector to take effect";
+                } else if (key == QStringLiteral("ndjsoncollector") && ndjsonCollector == nullptr) {
+                    qDebug() << "ndjsoncollector =" << value;
+                    QFile *ndjsonOutput = new QFile(value);
+                    ndjsonOutput->open(QFile::WriteOnly);
+                    ndjsonCollector = new NDJSONCollector(ndjsonOutput);
                 } else if (key == QStringLiteral("finder:numhits")) {
                     bool ok = false;
                     numHits = value.toInt(&ok);
@@ -294,6 +497,9 @@ bool evaluateConfigfile(const QString &filename)
                     } else if (value.contains(QStringLiteral("tiff"))) {
                         fileAnalyzer = new FileAnalyzerTIFF();
                         qDebug() << "fileanalyzer = FileAnalyzerTIFF";
+                    } else if (value.contains(QStringLiteral("tar"))) {
+                        fileAnalyzer = new FileAnalyzerTar();
+                        qDebug() << "fileanalyzer = FileAnalyzerTar";
                     } else
                         fileAnalyzer = nullptr;
                 } else {
@@ -341,18 +547,53 @@ int main(int argc, char *argv[])
     qInstallMessageHandler(myMessageOutput);
     QCoreApplication a(argc, argv);
 
+    if (argc == 3 && qstrcmp(argv[1], PopplerWorkerPool::workerArgument) == 0) {
+        /// Running as worker process, started by a PopplerWorkerPool
+        return PopplerWorkerPool::runWorker(QString::fromLatin1(argv[2]).toInt());
+    }
+
     netAccMan = new NetworkAccessManager(&a);
     fileAnalyzer = nullptr;
     logCollector = nullptr;
+    logCollectorMaxShardSize = 0;
+    logCollectorMaxShardEntries = 0;
+    logCollectorWriteIndex = false;
+    ndjsonCollector = nullptr;
     downloader = nullptr;
     finder = nullptr;
     numHits = defaultNumHits;
     webcrawlermaxvisitedpages = 0;
     textExtraction = FileAnalyzerAbstract::teNone;
+    textExtractionMaxPages = 0;
+    textExtractionMaxCharacters = 0;
     enableEmbeddedFilesAnalysis = false;
+    embeddedImagesMax = 256;
+    embeddedImageMaxSize = 64 * 1024 * 1024;
+    embeddedFileCacheSize = 64 << 20;
+    zipListOnly = false;
+    zipMaxMemberSize = 256 << 20;
+    zipMaxCompressionRatio = 100;
+    zipMaxMembers = 10000;
+    zipMaxNestingDepth = 2;
+    enableStatistics = false;
+    statisticsInterval = 0;
+    metricsInterval = 60;
+    parallelPageThreshold = 0;
+    quickPDFAnalysis = false;
+    imageJhoveValidation = false;
+    popplerWorkers = 0;
+    popplerWorkerMemoryLimit = 2048;
+    popplerWorkerTimeout = 300;
+    adaptiveTimeoutsQuantile = 0.99;
+    adaptiveTimeoutsMinimum = 30;
+    adaptiveTimeoutsMaxFactor = 4.0;
     validateOnlyPDFAfiles = true;
     downgradeToPDFA1b = false;
     enforcedValidationLevel = FileAnalyzerPDF::xmpNone;
+    validatorPolicy = FileAnalyzerPDF::validatorPolicyAll;
+    validatorQuorum = 2;
+    summarizeValidatorOutput = true;
+    validatorOutputMaxFailures = 20;
 
     if (argc != 2) {
         fprintf(stderr, "Require single configuration file as parameter\n");
@@ -377,17 +618,44 @@ int main(int argc, char *argv[])
             /// to use a specialized type of file analyzer, still create a multiplexer.
             fileAnalyzerMultiplexer = new FileAnalyzerMultiplexer(FileAnalyzerMultiplexer::defaultFilters, &a);
             QObject::connect(fileAnalyzerMultiplexer, &FileAnalyzerAbstract::analysisReport, logCollector, &LogCollector::receiveLog);
+            if (ndjsonCollector != nullptr)
+                QObject::connect(fileAnalyzerMultiplexer, &FileAnalyzerAbstract::analysisRecord, ndjsonCollector, &NDJSONCollector::receiveRecord);
+        }
+
+        logCollector->setWriteIndex(logCollectorWriteIndex);
+
+        StatisticsAggregator *statisticsAggregator = nullptr;
+        if (enableStatistics) {
+            statisticsAggregator = new StatisticsAggregator(&a);
+            statisticsAggregator->setReportInterval(statisticsInterval);
+            QObject::connect(statisticsAggregator, &StatisticsAggregator::report, logCollector, &LogCollector::receiveLog);
+            if (fileAnalyzer != nullptr)
+                QObject::connect(fileAnalyzer, &FileAnalyzerAbstract::analysisRecord, statisticsAggregator, &StatisticsAggregator::receiveRecord);
+            if (fileAnalyzerMultiplexer != fileAnalyzer)
+                QObject::connect(fileAnalyzerMultiplexer, &FileAnalyzerAbstract::analysisRecord, statisticsAggregator, &StatisticsAggregator::receiveRecord);
+        }
+
+        LatencyMetrics *latencyMetrics = nullptr;
+        if (!metricsFilename.isEmpty()) {
+            latencyMetrics = new LatencyMetrics(metricsFilename, &a);
+            latencyMetrics->setWriteInterval(metricsInterval);
+            if (fileAnalyzer != nullptr)
+                fileAnalyzer->setLatencyMetrics(latencyMetrics);
+            if (fileAnalyzerMultiplexer != fileAnalyzer)
+                fileAnalyzerMultiplexer->setLatencyMetrics(latencyMetrics);
         }
 
         WatchDog watchDog;
         if (fileAnalyzer != nullptr) {
             watchDog.addWatchable(fileAnalyzer);
             fileAnalyzer->setTextExtraction(textExtraction);
+            fileAnalyzer->setTextExtractionLimits(textExtractionMaxPages, textExtractionMaxCharacters);
             fileAnalyzer->setAnalyzeEmbeddedFiles(enableEmbeddedFilesAnalysis);
         }
         if (downloader != nullptr) watchDog.addWatchable(downloader);
         if (finder != nullptr) watchDog.addWatchable(finder);
         watchDog.addWatchable(logCollector);
+        if (ndjsonCollector != nullptr) watchDog.addWatchable(ndjsonCollector);
 
         if (downloader != nullptr && finder != nullptr) QObject::connect(finder, &FileFinder::foundUrl, downloader, &Downloader::download);
         if (downloader != nullptr && fileAnalyzer != nullptr) QObject::connect(downloader, static_cast<void(Downloader::*)(QString)>(&Downloader::downloaded), fileAnalyzer, &FileAnalyzerAbstract::analyzeFile);
@@ -396,10 +664,16 @@ int main(int argc, char *argv[])
         if (fileAnalyzer != nullptr) {
             QObject::connect(fileAnalyzer, &FileAnalyzerAbstract::analysisReport, logCollector, &LogCollector::receiveLog);
             QObject::connect(fileAnalyzer, &FileAnalyzerAbstract::foundEmbeddedFile, fileAnalyzerMultiplexer, &FileAnalyzerMultiplexer::analyzeTemporaryFile);
+            if (ndjsonCollector != nullptr)
+                QObject::connect(fileAnalyzer, &FileAnalyzerAbstract::analysisRecord, ndjsonCollector, &NDJSONCollector::receiveRecord);
         }
         if (finder != nullptr) QObject::connect(finder, &FileFinder::report, logCollector, &LogCollector::receiveLog);
         if (downloader != nullptr) QObject::connect(&watchDog, &WatchDog::firstWarning, downloader, &Downloader::finalReport);
+        /// Final statistics must be logged before the log collector gets closed
+        if (statisticsAggregator != nullptr) QObject::connect(&watchDog, &WatchDog::lastWarning, statisticsAggregator, &StatisticsAggregator::finalReport);
         QObject::connect(&watchDog, &WatchDog::lastWarning, logCollector, &LogCollector::close);
+        if (latencyMetrics != nullptr) QObject::connect(&watchDog, &WatchDog::lastWarning, latencyMetrics, &LatencyMetrics::writeMetrics);
+        if (ndjsonCollector != nullptr) QObject::connect(&watchDog, &WatchDog::lastWarning, ndjsonCollector, &NDJSONCollector::close);
 
         FileAnalyzerPDF *fileAnalyzerPDF = qobject_cast<FileAnalyzerPDF *>(fileAnalyzer);
 
@@ -424,9 +698,19 @@ int main(int argc, char *argv[])
             if (fileAnalyzerMultiplexer != nullptr)
                 fileAnalyzerMultiplexer->setupJhove(jhoveShellscript);
         }
+        FileAnalyzerJPEG *fileAnalyzerJPEG = qobject_cast<FileAnalyzerJPEG *>(fileAnalyzer);
+        if (fileAnalyzerJPEG != nullptr)
+            fileAnalyzerJPEG->setJhoveValidation(imageJhoveValidation);
+        FileAnalyzerJP2 *fileAnalyzerJP2 = qobject_cast<FileAnalyzerJP2 *>(fileAnalyzer);
+        if (fileAnalyzerJP2 != nullptr)
+            fileAnalyzerJP2->setJhoveValidation(imageJhoveValidation);
+        FileAnalyzerTIFF *fileAnalyzerTIFF = qobject_cast<FileAnalyzerTIFF *>(fileAnalyzer);
+        if (fileAnalyzerTIFF != nullptr)
+            fileAnalyzerTIFF->setJhoveValidation(imageJhoveValidation);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setImageJhoveValidation(imageJhoveValidation);
 
         if (!dpfmangerJFXjar.isEmpty()) {
-            FileAnalyzerTIFF *fileAnalyzerTIFF = qobject_cast<FileAnalyzerTIFF *>(fileAnalyzer);
             if (fileAnalyzerTIFF != nullptr)
                 fileAnalyzerTIFF->setupDPFManager(dpfmangerJFXjar);
             if (fileAnalyzerMultiplexer != nullptr)
@@ -479,6 +763,58 @@ int main(int argc, char *argv[])
             fileAnalyzerPDF->setPDFAValidationOptions(validateOnlyPDFAfiles, downgradeToPDFA1b, enforcedValidationLevel);
         if (fileAnalyzerMultiplexer != nullptr)
             fileAnalyzerMultiplexer->setPDFAValidationOptions(validateOnlyPDFAfiles, downgradeToPDFA1b, enforcedValidationLevel);
+        if (fileAnalyzerPDF != nullptr)
+            fileAnalyzerPDF->setValidatorPolicy(validatorPolicy, validatorQuorum);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setValidatorPolicy(validatorPolicy, validatorQuorum);
+        if (fileAnalyzerPDF != nullptr)
+            fileAnalyzerPDF->setValidatorOutputSummary(summarizeValidatorOutput, validatorOutputMaxFailures);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setValidatorOutputSummary(summarizeValidatorOutput, validatorOutputMaxFailures);
+        if (fileAnalyzerPDF != nullptr)
+            fileAnalyzerPDF->setEmbeddedImageLimits(embeddedImagesMax, embeddedImageMaxSize);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setEmbeddedImageLimits(embeddedImagesMax, embeddedImageMaxSize);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setEmbeddedFileCacheSize(embeddedFileCacheSize);
+#ifdef HAVE_QUAZIP5
+        FileAnalyzerZIP *fileAnalyzerZIP = qobject_cast<FileAnalyzerZIP *>(fileAnalyzer);
+        if (fileAnalyzerZIP != nullptr)
+            fileAnalyzerZIP->setLimits(zipListOnly, zipMaxMemberSize, zipMaxCompressionRatio, zipMaxMembers, zipMaxNestingDepth);
+#endif // HAVE_QUAZIP5
+        FileAnalyzerTar *fileAnalyzerTar = qobject_cast<FileAnalyzerTar *>(fileAnalyzer);
+        if (fileAnalyzerTar != nullptr)
+            fileAnalyzerTar->setLimits(zipListOnly, zipMaxMemberSize, zipMaxMembers, zipMaxNestingDepth);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setArchiveLimits(zipListOnly, zipMaxMemberSize, zipMaxCompressionRatio, zipMaxMembers, zipMaxNestingDepth);
+        if (fileAnalyzerPDF != nullptr)
+            fileAnalyzerPDF->setParallelPageThreshold(parallelPageThreshold);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setParallelPageThreshold(parallelPageThreshold);
+        if (fileAnalyzerPDF != nullptr)
+            fileAnalyzerPDF->setQuickAnalysis(quickPDFAnalysis);
+        if (fileAnalyzerMultiplexer != nullptr)
+            fileAnalyzerMultiplexer->setQuickPDFAnalysis(quickPDFAnalysis);
+        if (popplerWorkers > 0) {
+            PopplerWorkerPool *popplerWorkerPool = new PopplerWorkerPool(popplerWorkers, popplerWorkerMemoryLimit, popplerWorkerTimeout, &a);
+            if (fileAnalyzerPDF != nullptr)
+                fileAnalyzerPDF->setPopplerWorkerPool(popplerWorkerPool);
+            if (fileAnalyzerMultiplexer != nullptr)
+                fileAnalyzerMultiplexer->setPopplerWorkerPool(popplerWorkerPool);
+        }
+        if (!toolRegistryFilename.isEmpty())
+            ToolRegistry::instance().setCacheFilename(toolRegistryFilename);
+        if (!adaptiveTimeoutsFilename.isEmpty()) {
+            AdaptiveTimeouts *adaptiveTimeouts = new AdaptiveTimeouts(adaptiveTimeoutsFilename, &a);
+            adaptiveTimeouts->setQuantile(adaptiveTimeoutsQuantile);
+            adaptiveTimeouts->setBounds(adaptiveTimeoutsMinimum * 1000, adaptiveTimeoutsMaxFactor);
+            if (fileAnalyzerPDF != nullptr)
+                fileAnalyzerPDF->setAdaptiveTimeouts(adaptiveTimeouts);
+            if (fileAnalyzerMultiplexer != nullptr)
+                fileAnalyzerMultiplexer->setAdaptiveTimeouts(adaptiveTimeouts);
+            /// Learned models must be saved even if DocScan gets terminated
+            QObject::connect(&watchDog, &WatchDog::lastWarning, adaptiveTimeouts, &AdaptiveTimeouts::save);
+        }
 
         if (finder != nullptr) finder->startSearch(numHits);
 
@@ -492,6 +828,7 @@ int main(int argc, char *argv[])
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("numHits"), intToString(numHits)));
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("webcrawlermaxvisitedpages"), intToString(webcrawlermaxvisitedpages)));
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("jhoveShellscript"), DocScan::xmlify(jhoveShellscript)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("imageJhoveValidation"), boolToString(imageJhoveValidation)));
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("dpfmangerJFXjar"), DocScan::xmlify(dpfmangerJFXjar)));
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("veraPDFcliTool"), DocScan::xmlify(veraPDFcliTool)));
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("pdfboxValidatorJavaClass"), DocScan::xmlify(pdfboxValidatorJavaClass)));
@@ -509,6 +846,16 @@ int main(int argc, char *argv[])
         default: break; ///< empty string
         }
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("enforcedValidationLevel"), enforcedValidationLevelString));
+        QString validatorPolicyString;
+        switch (validatorPolicy) {
+        case FileAnalyzerPDF::validatorPolicyAll: validatorPolicyString = QStringLiteral("all"); break;
+        case FileAnalyzerPDF::validatorPolicyFailFast: validatorPolicyString = QStringLiteral("failfast"); break;
+        case FileAnalyzerPDF::validatorPolicyQuorum: validatorPolicyString = QStringLiteral("quorum"); break;
+        }
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("validatorPolicy"), validatorPolicyString));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("validatorQuorum"), intToString(validatorQuorum)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("validatorOutput"), summarizeValidatorOutput ? QStringLiteral("summary") : QStringLiteral("full")));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("validatorOutputMaxFailures"), intToString(validatorOutputMaxFailures)));
         QString textExtractionString;
         switch (textExtraction) {
         ///  enum TextExtraction {teNone = 0, teLength = 5, teFullText = 10, teAspell = 15};
@@ -519,7 +866,34 @@ int main(int argc, char *argv[])
         default: break; ///< empty string
         }
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("textExtraction"), textExtractionString));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("textExtractionMaxPages"), intToString(textExtractionMaxPages)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("textExtractionMaxCharacters"), intToString(textExtractionMaxCharacters)));
         configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("enableEmbeddedFilesAnalysis"), boolToString(enableEmbeddedFilesAnalysis)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("embeddedImagesMax"), intToString(embeddedImagesMax)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("embeddedImageMaxSize"), intToString(embeddedImageMaxSize)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("embeddedFileCacheSize"), intToString(embeddedFileCacheSize)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("zipListOnly"), boolToString(zipListOnly)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("zipMaxMemberSize"), QString::number(zipMaxMemberSize)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("zipMaxCompressionRatio"), intToString(zipMaxCompressionRatio)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("zipMaxMembers"), intToString(zipMaxMembers)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("zipMaxNestingDepth"), intToString(zipMaxNestingDepth)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("logCollectorMaxShardSize"), QString::number(logCollectorMaxShardSize)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("logCollectorMaxShardEntries"), intToString(logCollectorMaxShardEntries)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("logCollectorWriteIndex"), boolToString(logCollectorWriteIndex)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("parallelPageThreshold"), intToString(parallelPageThreshold)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("pdfAnalysis"), quickPDFAnalysis ? QStringLiteral("quick") : QStringLiteral("full")));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("popplerWorkers"), intToString(popplerWorkers)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("popplerWorkerMemoryLimit"), intToString(popplerWorkerMemoryLimit)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("popplerWorkerTimeout"), intToString(popplerWorkerTimeout)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("adaptiveTimeoutsFilename"), DocScan::xmlify(adaptiveTimeoutsFilename)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("adaptiveTimeoutsQuantile"), QString::number(adaptiveTimeoutsQuantile)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("adaptiveTimeoutsMinimum"), intToString(adaptiveTimeoutsMinimum)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("adaptiveTimeoutsMaxFactor"), QString::number(adaptiveTimeoutsMaxFactor)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("toolRegistryFilename"), DocScan::xmlify(toolRegistryFilename)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("metricsFilename"), DocScan::xmlify(metricsFilename)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("metricsInterval"), intToString(metricsInterval)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("enableStatistics"), boolToString(enableStatistics)));
+        configurationXML.append(QString(keyValueXMLtemplate).arg(QStringLiteral("statisticsInterval"), intToString(statisticsInterval)));
         configurationXML.append(QStringLiteral("</configuration>"));
         logCollector->receiveLog(QStringLiteral("main"), configurationXML);
 
@@ -0,0 +1,56 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "ndjsoncollector.h"
+
+#include <QIODevice>
+#include <QJsonDocument>
+#include <QDateTime>
+
+NDJSONCollector::NDJSONCollector(QIODevice *output, QObject *parent)
+    : QObject(parent), m_output(output)
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+}
+
+bool NDJSONCollector::isAlive()
+{
+    return false;
+}
+
+void NDJSONCollector::receiveRecord(const QString &origin, const QJsonObject &record)
+{
+    if (m_output->isOpen()) {
+        QJsonObject line(record);
+        line.insert(QStringLiteral("source"), origin);
+        line.insert(QStringLiteral("epoch"), QDateTime::currentMSecsSinceEpoch() / 1000);
+        /// Compact JSON does not contain any line breaks,
+        /// so each record occupies exactly one line
+        m_output->write(QJsonDocument(line).toJson(QJsonDocument::Compact));
+        m_output->write("\n", 1);
+    }
+}
+
+void NDJSONCollector::close()
+{
+    m_output->close();
+}
@@ -0,0 +1,74 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef NDJSONCOLLECTOR_H
+#define NDJSONCOLLECTOR_H
+
+#include <QObject>
+#include <QJsonObject>
+
+#include "watchable.h"
+
+class QIODevice;
+
+/**
+ * Collecting structured analysis records from file analyzers and
+ * storing them in an IO device (e.g. file) as newline-delimited
+ * JSON (NDJSON), one record per line.
+ * Runs alongside LogCollector, which keeps receiving the XML reports.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class NDJSONCollector : public QObject, public Watchable
+{
+    Q_OBJECT
+public:
+    /**
+     * Create instance by specifying in which output device records
+     * have to be stored.
+     *
+     * @param output device to write records to
+     */
+    explicit NDJSONCollector(QIODevice *output, QObject *parent = nullptr);
+
+    virtual bool isAlive();
+
+public slots:
+    /**
+     * Receive a structured record and append it as a single line
+     * of JSON to the output device as specified in the constructor.
+     *
+     * @param origin name of the object that created the record
+     * @param record record to store
+     */
+    void receiveRecord(const QString &origin, const QJsonObject &record);
+
+    /**
+     * Flush and close output device once logging is finished at process exit.
+     */
+    void close();
+
+private:
+    QIODevice *m_output;
+};
+
+#endif // NDJSONCOLLECTOR_H
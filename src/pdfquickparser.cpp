@@ -0,0 +1,943 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "pdfquickparser.h"
+
+#include <QtGlobal>
+
+#include <zlib.h>
+
+/// Limits to protect against malformed or malicious files
+static const int maxNestingDepth = 64;
+static const int maxReferenceChain = 32;
+static const int maxDecodedStreamSize = 64 << 20; ///< 64 MiB
+static const int maxPredictorColumns = 1 << 20; ///< far beyond any image width in practice
+static const int maxXRefSections = 4096; ///< incremental updates chained by /Prev
+
+static inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\0';
+}
+
+static inline bool isDelimiter(char c) {
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' || c == '{' || c == '}' || c == '/' || c == '%';
+}
+
+static inline bool isRegular(char c) {
+    return !isWhitespace(c) && !isDelimiter(c);
+}
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+PDFQuickParser::PDFQuickParser(const QString &filename)
+    : m_file(filename), m_majorVersion(0), m_minorVersion(0), m_startXRef(-1), m_reconstructed(false), m_xrefStream(false)
+{
+    /// nothing
+}
+
+bool PDFQuickParser::parse() {
+    if (!m_file.open(QFile::ReadOnly)) {
+        m_errorMessage = QStringLiteral("Could not open file");
+        return false;
+    }
+    const qint64 size = m_file.size();
+    if (size < 16 || size > INT_MAX) {
+        m_errorMessage = QStringLiteral("File size not supported");
+        return false;
+    }
+    const uchar *mappedData = m_file.map(0, size);
+    if (mappedData == nullptr) {
+        m_errorMessage = QStringLiteral("Could not map file into memory");
+        return false;
+    }
+    m_data = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData), static_cast<int>(size));
+
+    if (!readHeader()) {
+        m_errorMessage = QStringLiteral("No PDF header found");
+        return false;
+    }
+
+    /// Follow 'startxref' near the end of the file to the newest cross-reference data
+    bool xrefOk = false;
+    const int startXRefPos = m_data.lastIndexOf("startxref");
+    if (startXRefPos >= 0) {
+        int pos = startXRefPos + 9;
+        if (readInteger(m_data, pos, m_startXRef))
+            xrefOk = readXRef(m_startXRef);
+    }
+    if (!xrefOk || catalog().type != Object::Dictionary) {
+        /// Cross-reference data is missing or damaged, so scan file for objects
+        m_xref.clear();
+        m_objectStreams.clear();
+        m_trailer = Object();
+        if (!reconstructXRef()) {
+            m_errorMessage = QStringLiteral("No cross-reference data or document catalog found");
+            return false;
+        }
+    }
+
+    /// Since PDF 1.4, the catalog may override the version given in the header
+    const Object version = catalog().value("Version");
+    if (version.type == Object::Name && version.data.length() >= 3 && isDigit(version.data[0]) && version.data[1] == '.' && isDigit(version.data[2])) {
+        const int major = version.data[0] - '0', minor = version.data[2] - '0';
+        if (major > m_majorVersion || (major == m_majorVersion && minor > m_minorVersion)) {
+            m_majorVersion = major;
+            m_minorVersion = minor;
+        }
+    }
+
+    return true;
+}
+
+QString PDFQuickParser::errorMessage() const {
+    return m_errorMessage;
+}
+
+int PDFQuickParser::majorVersion() const {
+    return m_majorVersion;
+}
+
+int PDFQuickParser::minorVersion() const {
+    return m_minorVersion;
+}
+
+bool PDFQuickParser::isEncrypted() const {
+    return m_trailer.dictionary.contains("Encrypt");
+}
+
+bool PDFQuickParser::wasReconstructed() const {
+    return m_reconstructed;
+}
+
+bool PDFQuickParser::hasXRefStream() const {
+    return m_xrefStream;
+}
+
+int PDFQuickParser::numPages() {
+    const Object pages = resolve(catalog().value("Pages"));
+    if (pages.type != Object::Dictionary) return -1;
+    const Object count = resolve(pages.value("Count"));
+    return count.type == Object::Number && count.number >= 0 ? count.toInt() : -1;
+}
+
+QString PDFQuickParser::info(const QByteArray &key) {
+    const Object infoDictionary = resolve(m_trailer.value("Info"));
+    if (infoDictionary.type != Object::Dictionary) return QString();
+    const Object value = resolve(infoDictionary.value(key));
+    return value.type == Object::String ? textString(value.data) : QString();
+}
+
+QDateTime PDFQuickParser::date(const QByteArray &key) {
+    const Object infoDictionary = resolve(m_trailer.value("Info"));
+    if (infoDictionary.type != Object::Dictionary) return QDateTime();
+    const Object value = resolve(infoDictionary.value(key));
+    return value.type == Object::String ? dateFromString(value.data) : QDateTime();
+}
+
+QByteArray PDFQuickParser::metadata() {
+    const Object metadataStream = resolve(catalog().value("Metadata"));
+    if (metadataStream.type != Object::Stream) return QByteArray();
+    bool ok = false;
+    const QByteArray data = streamData(metadataStream, &ok);
+    return ok ? data : QByteArray();
+}
+
+const PDFQuickParser::Object &PDFQuickParser::trailer() const {
+    return m_trailer;
+}
+
+PDFQuickParser::Object PDFQuickParser::catalog() {
+    return resolve(m_trailer.value("Root"));
+}
+
+PDFQuickParser::Object PDFQuickParser::object(int objectNumber) {
+    if (m_resolving.contains(objectNumber)) return Object(); ///< circular reference
+
+    const XRefEntry entry = m_xref.value(objectNumber);
+    Object result;
+    m_resolving.insert(objectNumber);
+    if (entry.type == 1 && entry.offset >= 0 && entry.offset < m_data.size()) {
+        int pos = static_cast<int>(entry.offset);
+        if (!parseIndirectObject(pos, objectNumber, result))
+            result = Object();
+    } else if (entry.type == 2)
+        result = objectFromObjectStream(static_cast<int>(entry.offset), objectNumber);
+    m_resolving.remove(objectNumber);
+
+    return result;
+}
+
+PDFQuickParser::Object PDFQuickParser::resolve(const Object &candidate) {
+    Object result = candidate;
+    for (int i = 0; result.type == Object::Reference && i < maxReferenceChain; ++i)
+        result = object(result.objectNumber);
+    return result.type == Object::Reference ? Object() : result;
+}
+
+bool PDFQuickParser::rawStreamRange(const Object &stream, int &start, int &length) {
+    if (stream.type != Object::Stream || stream.streamOffset < 0 || stream.streamOffset > m_data.size()) return false;
+
+    start = static_cast<int>(stream.streamOffset);
+    qint64 statedLength = resolve(stream.value("Length")).toInt(-1);
+    int endPos = static_cast<int>(start + statedLength);
+    if (statedLength < 0 || start + statedLength > m_data.size() || !readKeyword(m_data, endPos, "endstream")) {
+        /// Length is missing or wrong, so search for end of stream instead
+        const int endstreamPos = m_data.indexOf("endstream", start);
+        if (endstreamPos < 0) return false;
+        statedLength = endstreamPos - start;
+        while (statedLength > 0 && (m_data[static_cast<int>(start + statedLength - 1)] == '\n' || m_data[static_cast<int>(start + statedLength - 1)] == '\r'))
+            --statedLength;
+    }
+    length = static_cast<int>(statedLength);
+    return true;
+}
+
+QByteArray PDFQuickParser::rawStreamData(const Object &stream, bool *ok) {
+    if (ok != nullptr) *ok = false;
+    int start = 0, length = 0;
+    if (!rawStreamRange(stream, start, length)) return QByteArray();
+    if (ok != nullptr) *ok = true;
+    return QByteArray(m_data.constData() + start, length);
+}
+
+QByteArray PDFQuickParser::rawStreamDataView(const Object &stream, bool *ok) {
+    if (ok != nullptr) *ok = false;
+    int start = 0, length = 0;
+    if (!rawStreamRange(stream, start, length)) return QByteArray();
+    if (ok != nullptr) *ok = true;
+    return QByteArray::fromRawData(m_data.constData() + start, length);
+}
+
+QByteArray PDFQuickParser::streamData(const Object &stream, bool *ok) {
+    if (ok != nullptr) *ok = false;
+    bool rawDataOk = false;
+    QByteArray data = rawStreamData(stream, &rawDataOk);
+    if (!rawDataOk) return QByteArray();
+
+    /// Filters and their parameters are either given as single objects or as arrays
+    const Object filter = resolve(stream.value("Filter"));
+    const QList<Object> filters = filter.type == Object::Array ? filter.array : (filter.type == Object::Name ? QList<Object>() << filter : QList<Object>());
+    const Object decodeParameters = resolve(stream.value("DecodeParms"));
+    const QList<Object> decodeParametersList = decodeParameters.type == Object::Array ? decodeParameters.array : (decodeParameters.type == Object::Dictionary ? QList<Object>() << decodeParameters : QList<Object>());
+    for (int i = 0; i < filters.count(); ++i) {
+        const Object filterName = resolve(filters[i]);
+        bool decodingOk = false;
+        if (filterName.isName("FlateDecode") || filterName.isName("Fl")) {
+            data = flateDecode(data, decodingOk);
+            if (decodingOk && i < decodeParametersList.count()) {
+                const Object parameters = resolve(decodeParametersList[i]);
+                if (parameters.type == Object::Dictionary)
+                    data = applyPredictor(data, parameters, decodingOk);
+            }
+        } else if (filterName.isName("ASCIIHexDecode") || filterName.isName("AHx")) {
+            QByteArray decoded;
+            decoded.reserve(data.size() / 2);
+            int high = -1;
+            for (int p = 0; p < data.size() && data[p] != '>'; ++p) {
+                const int value = hexValue(data[p]);
+                if (value < 0) continue; ///< skip whitespace
+                if (high < 0)
+                    high = value;
+                else {
+                    decoded.append(static_cast<char>(high * 16 + value));
+                    high = -1;
+                }
+            }
+            if (high >= 0) decoded.append(static_cast<char>(high * 16));
+            data = decoded;
+            decodingOk = true;
+        }
+        /// Any other filter (e.g. image compression) is not supported
+        if (!decodingOk) return QByteArray();
+    }
+
+    if (ok != nullptr) *ok = true;
+    return data;
+}
+
+qint64 PDFQuickParser::startXRef() const {
+    return m_startXRef;
+}
+
+int PDFQuickParser::highestObjectNumber() const {
+    int result = m_trailer.value("Size").toInt() - 1;
+    for (QHash<int, XRefEntry>::ConstIterator it = m_xref.constBegin(); it != m_xref.constEnd(); ++it)
+        if (it.key() > result) result = it.key();
+    return result;
+}
+
+QByteArray PDFQuickParser::toPdfSyntax(const Object &object) {
+    switch (object.type) {
+    case Object::Boolean:
+        return object.boolean ? QByteArrayLiteral("true") : QByteArrayLiteral("false");
+    case Object::Number:
+        if (object.number == static_cast<double>(object.toInt64(-1)))
+            return QByteArray::number(object.toInt64());
+        else
+            return QByteArray::number(object.number, 'f', 6);
+    case Object::String:
+        return '<' + object.data.toHex() + '>';
+    case Object::Name: {
+        QByteArray result("/");
+        for (const char c : object.data) {
+            /// Delimiters, whitespace and non-printable characters must be escaped
+            if (isRegular(c) && c != '#' && c > ' ' && c <= '~')
+                result.append(c);
+            else
+                result.append('#').append(QByteArray(1, c).toHex());
+        }
+        return result;
+    }
+    case Object::Array: {
+        QByteArray result("[");
+        for (const Object &element : object.array)
+            result.append(' ').append(toPdfSyntax(element));
+        return result.append(" ]");
+    }
+    case Object::Dictionary:
+    case Object::Stream: {
+        QByteArray result("<<");
+        for (QMap<QByteArray, Object>::ConstIterator it = object.dictionary.constBegin(); it != object.dictionary.constEnd(); ++it) {
+            Object key(Object::Name);
+            key.data = it.key();
+            result.append(' ').append(toPdfSyntax(key)).append(' ').append(toPdfSyntax(it.value()));
+        }
+        return result.append(" >>");
+    }
+    case Object::Reference:
+        return QByteArray::number(object.objectNumber) + ' ' + QByteArray::number(object.generationNumber) + " R";
+    default:
+        return QByteArrayLiteral("null");
+    }
+}
+
+QString PDFQuickParser::textString(const QByteArray &pdfString) {
+    if (pdfString.size() >= 2 && static_cast<uchar>(pdfString[0]) == 0xfe && static_cast<uchar>(pdfString[1]) == 0xff) {
+        /// UTF-16BE with byte order mark
+        QString result;
+        result.reserve((pdfString.size() - 2) / 2);
+        for (int i = 2; i + 1 < pdfString.size(); i += 2)
+            result.append(QChar(static_cast<ushort>((static_cast<uchar>(pdfString[i]) << 8) | static_cast<uchar>(pdfString[i + 1]))));
+        return result;
+    } else if (pdfString.size() >= 3 && static_cast<uchar>(pdfString[0]) == 0xef && static_cast<uchar>(pdfString[1]) == 0xbb && static_cast<uchar>(pdfString[2]) == 0xbf) {
+        /// UTF-8 with byte order mark as introduced in PDF 2.0
+        return QString::fromUtf8(pdfString.mid(3));
+    }
+
+    /// PDFDocEncoding is mostly identical to ISO 8859-1, except for code points 0x80 to 0xA0
+    static const ushort pdfDocEncoding80toA0[] = {
+        0x2022, 0x2020, 0x2021, 0x2026, 0x2014, 0x2013, 0x0192, 0x2044, 0x2039, 0x203a, 0x2212, 0x2030, 0x201e, 0x201c, 0x201d, 0x2018,
+        0x2019, 0x201a, 0x2122, 0xfb01, 0xfb02, 0x0141, 0x0152, 0x0160, 0x0178, 0x017d, 0x0131, 0x0142, 0x0153, 0x0161, 0x017e, 0xfffd,
+        0x20ac
+    };
+    QString result;
+    result.reserve(pdfString.size());
+    for (const char c : pdfString) {
+        const uchar uc = static_cast<uchar>(c);
+        result.append(uc >= 0x80 && uc <= 0xa0 ? QChar(pdfDocEncoding80toA0[uc - 0x80]) : QChar(uc));
+    }
+    return result;
+}
+
+QDateTime PDFQuickParser::dateFromString(const QByteArray &pdfDate) {
+    QByteArray text = pdfDate.trimmed();
+    if (text.startsWith("D:")) text = text.mid(2);
+    if (text.length() < 4) return QDateTime();
+
+    bool ok = false;
+    const int year = text.left(4).toInt(&ok);
+    if (!ok) return QDateTime();
+    /// Month, day, hour, minute, and second are optional two-digit fields
+    int fields[5] = {1, 1, 0, 0, 0};
+    int pos = 4;
+    for (int i = 0; i < 5 && pos + 1 < text.length() && isDigit(text[pos]) && isDigit(text[pos + 1]); ++i, pos += 2)
+        fields[i] = (text[pos] - '0') * 10 + text[pos + 1] - '0';
+    const QDate date(year, fields[0], fields[1]);
+    const QTime time(fields[2], fields[3], fields[4]);
+    if (!date.isValid() || !time.isValid()) return QDateTime();
+
+    /// Time zone is either 'Z' or an offset like +02'00'
+    int offsetSeconds = 0;
+    if (pos < text.length() && (text[pos] == '+' || text[pos] == '-')) {
+        const int sign = text[pos] == '-' ? -1 : 1;
+        const QByteArray zone = text.mid(pos + 1).replace('\'', QByteArray());
+        const int hours = zone.left(2).toInt();
+        const int minutes = zone.mid(2, 2).toInt();
+        offsetSeconds = sign * (hours * 3600 + minutes * 60);
+    }
+
+    return QDateTime(date, time, Qt::OffsetFromUTC, offsetSeconds);
+}
+
+bool PDFQuickParser::readHeader() {
+    /// Header may be preceded by some garbage
+    const int headerPos = m_data.indexOf("%PDF-");
+    if (headerPos < 0 || headerPos > 1024 || headerPos + 8 > m_data.size()) return false;
+    if (!isDigit(m_data[headerPos + 5]) || m_data[headerPos + 6] != '.' || !isDigit(m_data[headerPos + 7])) return false;
+    m_majorVersion = m_data[headerPos + 5] - '0';
+    m_minorVersion = m_data[headerPos + 7] - '0';
+    return true;
+}
+
+bool PDFQuickParser::readXRef(qint64 offset) {
+    /// Only the newest section must be readable, older cross-reference
+    /// data is optional, so failing to read it is tolerated
+    QSet<qint64> visitedOffsets;
+    for (int section = 0; section < maxXRefSections; ++section) {
+        if (offset < 0 || offset >= m_data.size() || visitedOffsets.contains(offset)) return section > 0;
+        visitedOffsets.insert(offset);
+
+        int pos = static_cast<int>(offset);
+        Object trailerDictionary;
+        if (readKeyword(m_data, pos, "xref")) {
+            /// Classic cross-reference table followed by trailer
+            if (!readXRefTable(pos, trailerDictionary)) return section > 0;
+            /// Hybrid files provide additional entries in a cross-reference stream
+            const Object xrefStreamOffset = trailerDictionary.value("XRefStm");
+            if (xrefStreamOffset.type == Object::Number && xrefStreamOffset.number >= 0 && xrefStreamOffset.number < m_data.size()) {
+                int xrefStreamPos = xrefStreamOffset.toInt();
+                Object xrefStream;
+                if (parseIndirectObject(xrefStreamPos, -1, xrefStream) && xrefStream.type == Object::Stream)
+                    readXRefStream(xrefStream);
+            }
+        } else {
+            /// Cross-reference stream, its dictionary serves as trailer
+            Object xrefStream;
+            if (!parseIndirectObject(pos, -1, xrefStream) || xrefStream.type != Object::Stream || !xrefStream.value("Type").isName("XRef"))
+                return section > 0;
+            if (!readXRefStream(xrefStream)) return section > 0;
+            trailerDictionary = Object(Object::Dictionary);
+            trailerDictionary.dictionary = xrefStream.dictionary;
+        }
+
+        /// The newest trailer is the one to use
+        if (m_trailer.isNull()) {
+            m_trailer = trailerDictionary;
+            m_xrefStream = trailerDictionary.value("Type").isName("XRef");
+        }
+
+        const Object previousOffset = trailerDictionary.value("Prev");
+        if (previousOffset.type != Object::Number) return true;
+        offset = previousOffset.toInt64(-1);
+    }
+
+    /// Sections beyond the limit are ignored
+    return true;
+}
+
+bool PDFQuickParser::readXRefTable(int &pos, Object &trailerDictionary) {
+    forever {
+        if (readKeyword(m_data, pos, "trailer"))
+            return parseObject(m_data, pos, trailerDictionary) && trailerDictionary.type == Object::Dictionary;
+
+        qint64 firstObjectNumber = 0, count = 0;
+        if (!readInteger(m_data, pos, firstObjectNumber) || !readInteger(m_data, pos, count) || firstObjectNumber < 0 || count < 0)
+            return false;
+        for (qint64 i = 0; i < count; ++i) {
+            qint64 offset = 0, generation = 0;
+            if (!readInteger(m_data, pos, offset) || !readInteger(m_data, pos, generation)) return false;
+            skipWhitespace(m_data, pos);
+            if (pos >= m_data.size()) return false;
+            const char type = m_data[pos++];
+            if (type != 'n' && type != 'f') return false;
+            /// Entries found first are the newest ones
+            const int objectNumber = static_cast<int>(firstObjectNumber + i);
+            if (!m_xref.contains(objectNumber))
+                m_xref.insert(objectNumber, XRefEntry(type == 'n' ? 1 : 0, offset));
+        }
+    }
+}
+
+bool PDFQuickParser::readXRefStream(const Object &xrefStream) {
+    const Object widthsArray = xrefStream.value("W");
+    if (widthsArray.type != Object::Array || widthsArray.array.count() < 3) return false;
+    int widths[3];
+    int entrySize = 0;
+    for (int i = 0; i < 3; ++i) {
+        widths[i] = widthsArray.array[i].toInt(-1);
+        if (widths[i] < 0 || widths[i] > 8) return false;
+        entrySize += widths[i];
+    }
+    if (entrySize <= 0) return false;
+
+    bool ok = false;
+    const QByteArray data = streamData(xrefStream, &ok);
+    if (!ok) return false;
+
+    /// Subsections as pairs of first object number and count, default is one subsection for all objects
+    QList<QPair<qint64, qint64> > subsections;
+    const Object index = xrefStream.value("Index");
+    if (index.type == Object::Array && index.array.count() % 2 == 0) {
+        for (int i = 0; i < index.array.count(); i += 2)
+            subsections.append(qMakePair<qint64, qint64>(index.array[i].toInt(), index.array[i + 1].toInt()));
+    } else
+        subsections.append(qMakePair<qint64, qint64>(0, xrefStream.value("Size").toInt()));
+
+    int pos = 0;
+    for (const auto &subsection : const_cast<const QList<QPair<qint64, qint64> > &>(subsections)) {
+        for (qint64 i = 0; i < subsection.second; ++i) {
+            if (pos + entrySize > data.size()) return true; ///< tolerate truncated data
+            qint64 fields[3];
+            for (int f = 0; f < 3; ++f) {
+                if (widths[f] == 0)
+                    /// Missing type field defaults to 1, other fields to 0
+                    fields[f] = f == 0 ? 1 : 0;
+                else {
+                    fields[f] = 0;
+                    for (int b = 0; b < widths[f]; ++b)
+                        fields[f] = (fields[f] << 8) | static_cast<uchar>(data[pos++]);
+                }
+            }
+            const int objectNumber = static_cast<int>(subsection.first + i);
+            /// Entries of unknown types are to be ignored
+            if (fields[0] >= 0 && fields[0] <= 2 && !m_xref.contains(objectNumber))
+                m_xref.insert(objectNumber, XRefEntry(static_cast<int>(fields[0]), fields[1], fields[0] == 2 ? static_cast<int>(fields[2]) : 0));
+        }
+    }
+
+    return true;
+}
+
+bool PDFQuickParser::reconstructXRef() {
+    m_reconstructed = true;
+
+    /// Find all occurrences of 'N G obj', later definitions replace earlier ones
+    const int size = m_data.size();
+    for (int pos = m_data.indexOf("obj"); pos >= 0; pos = m_data.indexOf("obj", pos + 3)) {
+        if (pos + 3 < size && isRegular(m_data[pos + 3])) continue;
+        int p = pos - 1;
+        if (p < 0 || !isWhitespace(m_data[p])) continue;
+        while (p >= 0 && isWhitespace(m_data[p])) --p;
+        const int generationEnd = p;
+        while (p >= 0 && isDigit(m_data[p])) --p;
+        if (p == generationEnd || p < 0 || !isWhitespace(m_data[p])) continue;
+        while (p >= 0 && isWhitespace(m_data[p])) --p;
+        const int objectNumberEnd = p;
+        while (p >= 0 && isDigit(m_data[p])) --p;
+        if (p == objectNumberEnd || (p >= 0 && isRegular(m_data[p]))) continue;
+        bool ok = false;
+        const int objectNumber = m_data.mid(p + 1, objectNumberEnd - p).toInt(&ok);
+        if (ok)
+            m_xref.insert(objectNumber, XRefEntry(1, p + 1));
+    }
+
+    /// Register objects inside object streams and look for the document catalog
+    int catalogObjectNumber = -1;
+    Object xrefStreamDictionary;
+    const QList<int> objectNumbers = m_xref.keys();
+    for (const int objectNumber : objectNumbers) {
+        const Object o = object(objectNumber);
+        if (o.type == Object::Stream && o.value("Type").isName("ObjStm")) {
+            bool ok = false;
+            const QByteArray data = streamData(o, &ok);
+            const int count = resolve(o.value("N")).toInt();
+            int pos = 0;
+            for (int i = 0; ok && i < count; ++i) {
+                qint64 containedObjectNumber = 0, offset = 0;
+                if (!readInteger(data, pos, containedObjectNumber) || !readInteger(data, pos, offset)) break;
+                if (!m_xref.contains(static_cast<int>(containedObjectNumber)))
+                    m_xref.insert(static_cast<int>(containedObjectNumber), XRefEntry(2, objectNumber, i));
+            }
+        } else if (o.type == Object::Stream && o.value("Type").isName("XRef") && o.value("Root").type == Object::Reference)
+            xrefStreamDictionary = o;
+        else if (o.type == Object::Dictionary && o.value("Type").isName("Catalog"))
+            catalogObjectNumber = objectNumber;
+    }
+    if (catalogObjectNumber < 0) {
+        /// Document catalog may be located inside an object stream
+        for (QHash<int, XRefEntry>::ConstIterator it = m_xref.constBegin(); catalogObjectNumber < 0 && it != m_xref.constEnd(); ++it)
+            if (it.value().type == 2 && objectFromObjectStream(static_cast<int>(it.value().offset), it.key()).value("Type").isName("Catalog"))
+                catalogObjectNumber = it.key();
+    }
+
+    /// Use last trailer in file, or dictionary of a cross-reference stream
+    const int trailerPos = m_data.lastIndexOf("trailer");
+    if (trailerPos >= 0) {
+        int pos = trailerPos + 7;
+        if (!parseObject(m_data, pos, m_trailer) || m_trailer.type != Object::Dictionary)
+            m_trailer = Object();
+    }
+    if (m_trailer.isNull() && !xrefStreamDictionary.isNull()) {
+        m_trailer = Object(Object::Dictionary);
+        m_trailer.dictionary = xrefStreamDictionary.dictionary;
+    }
+    if (catalog().type != Object::Dictionary && catalogObjectNumber >= 0) {
+        if (m_trailer.type != Object::Dictionary)
+            m_trailer = Object(Object::Dictionary);
+        Object root(Object::Reference);
+        root.objectNumber = catalogObjectNumber;
+        m_trailer.dictionary.insert("Root", root);
+    }
+
+    return catalog().type == Object::Dictionary;
+}
+
+bool PDFQuickParser::parseIndirectObject(int &pos, int objectNumber, Object &result) {
+    qint64 foundObjectNumber = 0, generation = 0;
+    if (!readInteger(m_data, pos, foundObjectNumber) || !readInteger(m_data, pos, generation) || !readKeyword(m_data, pos, "obj"))
+        return false;
+    if (objectNumber >= 0 && foundObjectNumber != objectNumber) return false;
+    if (!parseObject(m_data, pos, result)) return false;
+
+    if (result.type == Object::Dictionary) {
+        int streamPos = pos;
+        if (readKeyword(m_data, streamPos, "stream")) {
+            /// Stream data starts after an end-of-line marker
+            if (streamPos < m_data.size() && m_data[streamPos] == '\r') ++streamPos;
+            if (streamPos < m_data.size() && m_data[streamPos] == '\n') ++streamPos;
+            result.type = Object::Stream;
+            result.streamOffset = streamPos;
+            pos = streamPos;
+        }
+    }
+
+    return true;
+}
+
+PDFQuickParser::Object PDFQuickParser::objectFromObjectStream(int objectStreamNumber, int objectNumber) {
+    if (!m_objectStreams.contains(objectStreamNumber)) {
+        ObjectStream objectStream;
+        const Object stream = object(objectStreamNumber);
+        bool ok = false;
+        const QByteArray data = stream.type == Object::Stream ? streamData(stream, &ok) : QByteArray();
+        if (ok) {
+            /// Stream starts with pairs of object number and offset relative to first object
+            const int count = resolve(stream.value("N")).toInt();
+            const int first = resolve(stream.value("First")).toInt();
+            int pos = 0;
+            for (int i = 0; i < count; ++i) {
+                qint64 containedObjectNumber = 0, offset = 0;
+                if (!readInteger(data, pos, containedObjectNumber) || !readInteger(data, pos, offset)) break;
+                if (!objectStream.offsets.contains(static_cast<int>(containedObjectNumber)))
+                    objectStream.offsets.insert(static_cast<int>(containedObjectNumber), first + static_cast<int>(offset));
+            }
+            objectStream.data = data;
+        }
+        /// Remember failures, too
+        m_objectStreams.insert(objectStreamNumber, objectStream);
+    }
+
+    const ObjectStream objectStream = m_objectStreams.value(objectStreamNumber);
+    int pos = objectStream.offsets.value(objectNumber, -1);
+    Object result;
+    if (pos < 0 || pos >= objectStream.data.size() || !parseObject(objectStream.data, pos, result))
+        return Object();
+    return result;
+}
+
+void PDFQuickParser::skipWhitespace(const QByteArray &buffer, int &pos) {
+    const int size = buffer.size();
+    while (pos < size) {
+        if (isWhitespace(buffer[pos]))
+            ++pos;
+        else if (buffer[pos] == '%') {
+            /// Comments last until end of line
+            while (pos < size && buffer[pos] != '\n' && buffer[pos] != '\r') ++pos;
+        } else
+            break;
+    }
+}
+
+bool PDFQuickParser::readInteger(const QByteArray &buffer, int &pos, qint64 &value) {
+    int p = pos;
+    skipWhitespace(buffer, p);
+    const int start = p;
+    if (p < buffer.size() && (buffer[p] == '+' || buffer[p] == '-')) ++p;
+    const int digitsStart = p;
+    while (p < buffer.size() && isDigit(buffer[p])) ++p;
+    if (p == digitsStart || (p < buffer.size() && isRegular(buffer[p]))) return false;
+
+    bool ok = false;
+    value = buffer.mid(start, p - start).toLongLong(&ok);
+    if (ok) pos = p;
+    return ok;
+}
+
+bool PDFQuickParser::readKeyword(const QByteArray &buffer, int &pos, const char *keyword) {
+    int p = pos;
+    skipWhitespace(buffer, p);
+    const int length = static_cast<int>(qstrlen(keyword));
+    if (p + length > buffer.size() || qstrncmp(buffer.constData() + p, keyword, static_cast<uint>(length)) != 0) return false;
+    /// Keyword must not be the beginning of a longer token
+    if (p + length < buffer.size() && isRegular(buffer[p + length])) return false;
+    pos = p + length;
+    return true;
+}
+
+bool PDFQuickParser::parseObject(const QByteArray &buffer, int &pos, Object &result, int depth) {
+    if (depth > maxNestingDepth) return false;
+    skipWhitespace(buffer, pos);
+    const int size = buffer.size();
+    if (pos >= size) return false;
+
+    const char c = buffer[pos];
+    if (c == '/') {
+        /// Name, may contain hex-encoded characters like '#20'
+        ++pos;
+        result = Object(Object::Name);
+        while (pos < size && isRegular(buffer[pos])) {
+            char nameChar = buffer[pos++];
+            if (nameChar == '#' && pos + 1 < size && hexValue(buffer[pos]) >= 0 && hexValue(buffer[pos + 1]) >= 0) {
+                nameChar = static_cast<char>(hexValue(buffer[pos]) * 16 + hexValue(buffer[pos + 1]));
+                pos += 2;
+            }
+            result.data.append(nameChar);
+        }
+        return true;
+    } else if (c == '<' && pos + 1 < size && buffer[pos + 1] == '<') {
+        /// Dictionary
+        pos += 2;
+        result = Object(Object::Dictionary);
+        forever {
+            skipWhitespace(buffer, pos);
+            if (pos + 1 >= size) return false;
+            if (buffer[pos] == '>' && buffer[pos + 1] == '>') {
+                pos += 2;
+                return true;
+            }
+            Object key, value;
+            if (!parseObject(buffer, pos, key, depth + 1) || key.type != Object::Name || !parseObject(buffer, pos, value, depth + 1))
+                return false;
+            result.dictionary.insert(key.data, value);
+        }
+    } else if (c == '<') {
+        /// Hexadecimal string
+        ++pos;
+        result = Object(Object::String);
+        int high = -1;
+        while (pos < size && buffer[pos] != '>') {
+            const int value = hexValue(buffer[pos++]);
+            if (value < 0) continue; ///< skip whitespace
+            if (high < 0)
+                high = value;
+            else {
+                result.data.append(static_cast<char>(high * 16 + value));
+                high = -1;
+            }
+        }
+        if (high >= 0) result.data.append(static_cast<char>(high * 16));
+        if (pos >= size) return false;
+        ++pos;
+        return true;
+    } else if (c == '(') {
+        /// Literal string, may contain balanced parentheses and escape sequences
+        ++pos;
+        result = Object(Object::String);
+        int nesting = 1;
+        while (pos < size) {
+            char stringChar = buffer[pos++];
+            if (stringChar == '\\') {
+                if (pos >= size) return false;
+                stringChar = buffer[pos++];
+                switch (stringChar) {
+                case 'n': result.data.append('\n'); break;
+                case 'r': result.data.append('\r'); break;
+                case 't': result.data.append('\t'); break;
+                case 'b': result.data.append('\b'); break;
+                case 'f': result.data.append('\f'); break;
+                case '\r':
+                    /// Line continuation
+                    if (pos < size && buffer[pos] == '\n') ++pos;
+                    break;
+                case '\n': break; ///< line continuation
+                default:
+                    if (stringChar >= '0' && stringChar <= '7') {
+                        int value = stringChar - '0';
+                        for (int i = 0; i < 2 && pos < size && buffer[pos] >= '0' && buffer[pos] <= '7'; ++i)
+                            value = value * 8 + buffer[pos++] - '0';
+                        result.data.append(static_cast<char>(value & 0xff));
+                    } else
+                        result.data.append(stringChar); ///< covers \( \) and \\ as well
+                }
+            } else if (stringChar == '(') {
+                ++nesting;
+                result.data.append(stringChar);
+            } else if (stringChar == ')') {
+                if (--nesting == 0) return true;
+                result.data.append(stringChar);
+            } else
+                result.data.append(stringChar);
+        }
+        return false;
+    } else if (c == '[') {
+        /// Array
+        ++pos;
+        result = Object(Object::Array);
+        forever {
+            skipWhitespace(buffer, pos);
+            if (pos >= size) return false;
+            if (buffer[pos] == ']') {
+                ++pos;
+                return true;
+            }
+            Object element;
+            if (!parseObject(buffer, pos, element, depth + 1)) return false;
+            result.array.append(element);
+        }
+    } else if (c == '+' || c == '-' || c == '.' || isDigit(c)) {
+        /// Number, or reference if an integer is followed by a generation number and 'R'
+        const int start = pos++;
+        bool isInteger = isDigit(c);
+        while (pos < size && (isDigit(buffer[pos]) || buffer[pos] == '.')) {
+            if (buffer[pos] == '.') isInteger = false;
+            ++pos;
+        }
+        bool ok = false;
+        const double number = buffer.mid(start, pos - start).toDouble(&ok);
+        result = Object(Object::Number);
+        result.number = ok ? number : 0.0;
+        int lookaheadPos = pos;
+        qint64 generation = 0;
+        const int objectNumber = result.toInt(-1);
+        if (isInteger && objectNumber >= 0 && readInteger(buffer, lookaheadPos, generation) && generation >= 0 && generation <= INT_MAX && readKeyword(buffer, lookaheadPos, "R")) {
+            result = Object(Object::Reference);
+            result.objectNumber = objectNumber;
+            result.generationNumber = static_cast<int>(generation);
+            pos = lookaheadPos;
+        }
+        return true;
+    } else if (isRegular(c)) {
+        /// Keywords
+        const int start = pos;
+        while (pos < size && isRegular(buffer[pos])) ++pos;
+        const QByteArray keyword = buffer.mid(start, pos - start);
+        if (keyword == "true" || keyword == "false") {
+            result = Object(Object::Boolean);
+            result.boolean = keyword == "true";
+            return true;
+        } else if (keyword == "null") {
+            result = Object(Object::Null);
+            return true;
+        }
+        /// Other keywords like 'endobj' where an object was expected
+        pos = start;
+        return false;
+    }
+
+    return false;
+}
+
+QByteArray PDFQuickParser::applyPredictor(const QByteArray &data, const Object &decodeParameters, bool &ok) {
+    ok = false;
+    const int predictor = decodeParameters.value("Predictor").toInt(1);
+    if (predictor <= 1) {
+        ok = true;
+        return data;
+    }
+
+    /// Decode parameters come from the file, so reject values no real image uses
+    const int colors = decodeParameters.value("Colors").toInt(1);
+    const int bitsPerComponent = decodeParameters.value("BitsPerComponent").toInt(8);
+    const int columns = decodeParameters.value("Columns").toInt(1);
+    if (colors < 1 || colors > 32) return QByteArray();
+    if (bitsPerComponent != 1 && bitsPerComponent != 2 && bitsPerComponent != 4 && bitsPerComponent != 8 && bitsPerComponent != 16) return QByteArray();
+    if (columns < 1 || columns > maxPredictorColumns) return QByteArray();
+    const int bytesPerPixel = qMax(1, (colors * bitsPerComponent + 7) / 8);
+    const qint64 rowLength64 = (static_cast<qint64>(colors) * bitsPerComponent * columns + 7) / 8;
+    /// A single row cannot be longer than all the data to decode
+    if (rowLength64 > data.size()) return QByteArray();
+    const int rowLength = static_cast<int>(rowLength64);
+
+    if (predictor == 2) {
+        /// TIFF predictor, supported for 8 bits per component only
+        if (bitsPerComponent != 8) return QByteArray();
+        QByteArray result(data);
+        for (int rowStart = 0; rowStart + rowLength <= result.size(); rowStart += rowLength)
+            for (int i = bytesPerPixel; i < rowLength; ++i)
+                result[rowStart + i] = static_cast<char>(static_cast<uchar>(result[rowStart + i]) + static_cast<uchar>(result[rowStart + i - bytesPerPixel]));
+        ok = true;
+        return result;
+    }
+
+    /// PNG predictors, each row is preceded by a byte selecting the row's filter type
+    QByteArray result;
+    result.reserve(data.size());
+    QByteArray previousRow(rowLength, '\0');
+    for (int pos = 0; pos + 1 + rowLength <= data.size(); pos += 1 + rowLength) {
+        const int filterType = static_cast<uchar>(data[pos]);
+        QByteArray row = data.mid(pos + 1, rowLength);
+        for (int i = 0; i < rowLength; ++i) {
+            const int left = i >= bytesPerPixel ? static_cast<uchar>(row[i - bytesPerPixel]) : 0;
+            const int up = static_cast<uchar>(previousRow[i]);
+            const int upperLeft = i >= bytesPerPixel ? static_cast<uchar>(previousRow[i - bytesPerPixel]) : 0;
+            int value = static_cast<uchar>(row[i]);
+            switch (filterType) {
+            case 0: break; ///< None
+            case 1: value += left; break; ///< Sub
+            case 2: value += up; break; ///< Up
+            case 3: value += (left + up) / 2; break; ///< Average
+            case 4: { ///< Paeth
+                const int estimate = left + up - upperLeft;
+                const int distanceLeft = qAbs(estimate - left), distanceUp = qAbs(estimate - up), distanceUpperLeft = qAbs(estimate - upperLeft);
+                value += distanceLeft <= distanceUp && distanceLeft <= distanceUpperLeft ? left : (distanceUp <= distanceUpperLeft ? up : upperLeft);
+                break;
+            }
+            default: return QByteArray();
+            }
+            row[i] = static_cast<char>(value & 0xff);
+        }
+        result.append(row);
+        previousRow = row;
+    }
+
+    ok = true;
+    return result;
+}
+
+QByteArray PDFQuickParser::flateDecode(const QByteArray &data, bool &ok) {
+    ok = false;
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    if (inflateInit(&stream) != Z_OK) return QByteArray();
+
+    QByteArray result;
+    char buffer[16384];
+    int status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status == Z_OK || status == Z_STREAM_END || status == Z_BUF_ERROR)
+            result.append(buffer, static_cast<int>(sizeof(buffer) - stream.avail_out));
+        if (result.size() > maxDecodedStreamSize) {
+            status = Z_MEM_ERROR;
+            break;
+        }
+    }
+    inflateEnd(&stream);
+
+    /// Streams lacking their last bytes are common, use what could be decompressed
+    ok = status == Z_STREAM_END || (status == Z_BUF_ERROR && !result.isEmpty());
+    return result;
+}
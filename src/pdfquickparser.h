@@ -0,0 +1,252 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef PDFQUICKPARSER_H
+#define PDFQUICKPARSER_H
+
+#include <climits>
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QList>
+#include <QSet>
+#include <QByteArray>
+#include <QDateTime>
+
+/**
+ * Lightweight, read-only parser for PDF files.
+ * Only the file's header, its cross-reference data (classic tables,
+ * cross-reference streams and hybrid files, following /Prev links),
+ * and the trailer get read upfront. Any other object gets parsed
+ * only when requested, e.g. the document information dictionary,
+ * the page tree's root, or the XMP metadata stream.
+ * The file is memory-mapped, no page content is ever touched.
+ *
+ * Encrypted documents can be opened, but strings and streams
+ * cannot be decrypted.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class PDFQuickParser
+{
+public:
+    /// A PDF object as parsed from the file
+    struct Object {
+        enum Type {Null = 0, Boolean, Number, String, Name, Array, Dictionary, Reference, Stream};
+
+        Type type;
+        bool boolean;
+        double number;
+        /// unescaped bytes of a string, or a name without its leading slash
+        QByteArray data;
+        int objectNumber, generationNumber;
+        QList<Object> array;
+        /// entries of a dictionary or of a stream's dictionary
+        QMap<QByteArray, Object> dictionary;
+        /// position of a stream's (still encoded) data in the file
+        qint64 streamOffset;
+
+        explicit Object(Type _type = Null)
+            : type(_type), boolean(false), number(0.0), objectNumber(0), generationNumber(0), streamOffset(-1) {
+            /// nothing
+        }
+
+        bool isNull() const {
+            return type == Null;
+        }
+
+        /// Value for a key in a dictionary or stream, null object if key does not exist
+        Object value(const QByteArray &key) const {
+            return dictionary.value(key);
+        }
+
+        bool isName(const QByteArray &name) const {
+            return type == Name && data == name;
+        }
+
+        /// Default value also if number is out of int's range, e.g. '1e20'
+        int toInt(int defaultValue = 0) const {
+            return type == Number && number >= INT_MIN && number <= INT_MAX ? static_cast<int>(number) : defaultValue;
+        }
+
+        /// Default value also if number is out of qint64's range
+        qint64 toInt64(qint64 defaultValue = 0) const {
+            /// 2^63 itself is not representable as qint64
+            static const double bound = 9223372036854775808.0;
+            return type == Number && number > -bound && number < bound ? static_cast<qint64>(number) : defaultValue;
+        }
+    };
+
+    explicit PDFQuickParser(const QString &filename);
+
+    /**
+     * Open the file, read its header, cross-reference data and trailer.
+     * If the cross-reference data is damaged, it will be reconstructed
+     * by scanning the file for objects.
+     *
+     * @return true if file could be opened and a trailer with a document catalog was found
+     */
+    bool parse();
+
+    QString errorMessage() const;
+
+    /// PDF version as stated in the file's header or, if newer, in the document catalog
+    int majorVersion() const;
+    int minorVersion() const;
+
+    bool isEncrypted() const;
+
+    /// true if cross-reference data was damaged and reconstructed by scanning the file
+    bool wasReconstructed() const;
+
+    /// true if the newest cross-reference data is a cross-reference stream rather than a table
+    bool hasXRefStream() const;
+
+    /// Number of pages as stated in the page tree's root, -1 on error
+    int numPages();
+
+    /**
+     * Entry of the document information dictionary, e.g. "Producer"
+     * or "Title", decoded from PDFDocEncoding or UTF-16.
+     */
+    QString info(const QByteArray &key);
+
+    /**
+     * Date entry of the document information dictionary,
+     * e.g. "CreationDate". Invalid if not set or malformed.
+     */
+    QDateTime date(const QByteArray &key);
+
+    /// Decoded XMP metadata stream referred to by the document catalog, empty if none
+    QByteArray metadata();
+
+    const Object &trailer() const;
+    Object catalog();
+
+    /// Object with the given number as found via the cross-reference data, null object if unknown
+    Object object(int objectNumber);
+
+    /// If object is a reference, return the referred object, otherwise return object itself
+    Object resolve(const Object &candidate);
+
+    /**
+     * Read and decode a stream's data. Supported filters are
+     * FlateDecode (including PNG and TIFF predictors) and ASCIIHexDecode.
+     *
+     * @param stream stream object
+     * @param ok set to false if data could not be read or decoded, may be nullptr
+     * @return decoded data
+     */
+    QByteArray streamData(const Object &stream, bool *ok = nullptr);
+
+    /**
+     * Read a stream's data as stored in the file, i.e. without
+     * applying any filters. Useful for data that is meaningful
+     * in its encoded form, such as JPEG or JPEG 2000 images.
+     *
+     * @param stream stream object
+     * @param ok set to false if data could not be located, may be nullptr
+     * @return encoded data
+     */
+    QByteArray rawStreamData(const Object &stream, bool *ok = nullptr);
+
+    /**
+     * Like @see rawStreamData, but without copying: the returned data
+     * refers to the memory-mapped file and is only valid as long as
+     * this parser exists.
+     */
+    QByteArray rawStreamDataView(const Object &stream, bool *ok = nullptr);
+
+    /// Position of the newest cross-reference data as given after 'startxref'
+    qint64 startXRef() const;
+
+    /// Largest object number known from the cross-reference data
+    int highestObjectNumber() const;
+
+    /// Decode a text string, either UTF-16BE or UTF-8 with byte order mark, or PDFDocEncoding
+    static QString textString(const QByteArray &pdfString);
+
+    /// Parse a date like 'D:20170514093045+02'00'
+    static QDateTime dateFromString(const QByteArray &pdfDate);
+
+    /**
+     * Write an object in PDF syntax, e.g. for incremental updates.
+     * Strings are written in hexadecimal form; for streams, only
+     * their dictionary gets written.
+     */
+    static QByteArray toPdfSyntax(const Object &object);
+
+private:
+    struct XRefEntry {
+        /// 0 for free objects, 1 for objects at a file offset, 2 for objects inside an object stream
+        int type;
+        /// file offset for type 1, number of object stream for type 2
+        qint64 offset;
+        /// index inside object stream for type 2
+        int index;
+
+        explicit XRefEntry(int _type = 0, qint64 _offset = 0, int _index = 0)
+            : type(_type), offset(_offset), index(_index) {
+            /// nothing
+        }
+    };
+
+    /// Decoded object stream with offsets of its objects relative to its data
+    struct ObjectStream {
+        QByteArray data;
+        QHash<int, int> offsets;
+    };
+
+    QFile m_file;
+    QByteArray m_data;
+    QString m_errorMessage;
+    int m_majorVersion, m_minorVersion;
+    qint64 m_startXRef;
+    bool m_reconstructed;
+    bool m_xrefStream;
+    QHash<int, XRefEntry> m_xref;
+    Object m_trailer;
+    QHash<int, ObjectStream> m_objectStreams;
+    /// objects currently being resolved, to detect circular references
+    QSet<int> m_resolving;
+
+    bool readHeader();
+    /// Read cross-reference sections starting at offset and following their /Prev links
+    bool readXRef(qint64 offset);
+    bool readXRefTable(int &pos, Object &trailerDictionary);
+    bool readXRefStream(const Object &xrefStream);
+    bool reconstructXRef();
+    /// Locate a stream's encoded data in the file
+    bool rawStreamRange(const Object &stream, int &start, int &length);
+    bool parseIndirectObject(int &pos, int objectNumber, Object &result);
+    Object objectFromObjectStream(int objectStreamNumber, int objectNumber);
+
+    static void skipWhitespace(const QByteArray &buffer, int &pos);
+    static bool readInteger(const QByteArray &buffer, int &pos, qint64 &value);
+    static bool readKeyword(const QByteArray &buffer, int &pos, const char *keyword);
+    static bool parseObject(const QByteArray &buffer, int &pos, Object &result, int depth = 0);
+    static QByteArray applyPredictor(const QByteArray &data, const Object &decodeParameters, bool &ok);
+    static QByteArray flateDecode(const QByteArray &data, bool &ok);
+};
+
+#endif // PDFQUICKPARSER_H
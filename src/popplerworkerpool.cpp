@@ -0,0 +1,221 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "popplerworkerpool.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+#include <new>
+#include <cstdio>
+
+#include <sys/resource.h>
+
+#include "fileanalyzerpdf.h"
+
+const char *PopplerWorkerPool::workerArgument = "--poppler-worker";
+
+/// Workers must not write anything but results to standard output
+static void workerMessageOutput(QtMsgType type, const QMessageLogContext &, const QString &msg)
+{
+    fprintf(stderr, "Poppler worker %s: %s\n", type == QtDebugMsg || type == QtInfoMsg ? "info" : "warning", msg.toLocal8Bit().constData());
+    if (type == QtFatalMsg) abort();
+}
+
+PopplerWorkerPool::PopplerWorkerPool(int numWorkers, int memoryLimitMiB, int timeoutSeconds, QObject *parent)
+    : QObject(parent), m_nextWorker(0), m_memoryLimitMiB(memoryLimitMiB), m_timeoutMilliseconds(timeoutSeconds * 1000)
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+
+    for (int i = 0; i < numWorkers; ++i)
+        m_workers.append(startWorker());
+}
+
+PopplerWorkerPool::~PopplerWorkerPool() {
+    for (QProcess *worker : const_cast<const QVector<QProcess *> &>(m_workers))
+        stopWorker(worker);
+}
+
+PopplerWorkerPool::Result PopplerWorkerPool::analyze(const QJsonObject &request) {
+    /// Pick next running worker, respawning workers that are gone
+    QProcess *worker = nullptr;
+    for (int i = 0; worker == nullptr && i < m_workers.count(); ++i) {
+        const int index = (m_nextWorker + i) % m_workers.count();
+        if (m_workers[index]->state() != QProcess::Running) {
+            stopWorker(m_workers[index]);
+            m_workers[index] = startWorker();
+        }
+        if (m_workers[index]->state() == QProcess::Running) {
+            worker = m_workers[index];
+            m_nextWorker = (index + 1) % m_workers.count();
+        }
+    }
+    if (worker == nullptr) return Result(Unavailable);
+
+    worker->write(QJsonDocument(request).toJson(QJsonDocument::Compact).append('\n'));
+    worker->waitForBytesWritten(m_timeoutMilliseconds);
+
+    /// Wait for the result's line of output, but not longer than the deadline.
+    /// Lines before the result announce temporary files written by the worker
+    QStringList temporaryFiles;
+    QJsonObject response;
+    QElapsedTimer timer;
+    timer.start();
+    while (response.isEmpty()) {
+        while (!worker->canReadLine() && worker->state() == QProcess::Running) {
+            const qint64 remainingMilliseconds = m_timeoutMilliseconds - timer.elapsed();
+            if (remainingMilliseconds <= 0) break;
+            worker->waitForReadyRead(static_cast<int>(qMin<qint64>(remainingMilliseconds, 1000)));
+        }
+        if (!worker->canReadLine()) break;
+
+        const QJsonObject message = QJsonDocument::fromJson(worker->readLine()).object();
+        if (message.contains(QStringLiteral("temporaryfile")))
+            temporaryFiles.append(message.value(QStringLiteral("temporaryfile")).toString());
+        else
+            response = message;
+    }
+
+    if (response.isEmpty()) {
+        const bool isTimeout = worker->state() == QProcess::Running;
+        qWarning() << "Poppler worker" << (isTimeout ? "timed out" : "crashed") << "on file" << request.value(QStringLiteral("filename")).toString();
+        if (isTimeout) worker->kill();
+        replaceWorker(worker);
+        /// Nobody else will pick up what the worker wrote so far
+        removeTemporaryFiles(temporaryFiles);
+        return Result(isTimeout ? Timeout : Crashed);
+    }
+
+    Result result(Failed);
+    if (response.value(QStringLiteral("memorylimit")).toBool()) {
+        /// Worker quits after running out of memory
+        replaceWorker(worker);
+        removeTemporaryFiles(temporaryFiles);
+        result.status = MemoryLimit;
+        return result;
+    }
+    result.status = response.value(QStringLiteral("ok")).toBool() ? Ok : Failed;
+    result.logText = response.value(QStringLiteral("logtext")).toString();
+    result.metaText = response.value(QStringLiteral("metatext")).toString();
+    result.record = response.value(QStringLiteral("record")).toObject();
+    const QJsonArray embeddedFiles = response.value(QStringLiteral("embeddedfiles")).toArray();
+    for (const QJsonValue &embeddedFile : embeddedFiles)
+        result.embeddedFiles.append(embeddedFile.toString());
+    return result;
+}
+
+int PopplerWorkerPool::runWorker(int memoryLimitMiB) {
+    qInstallMessageHandler(workerMessageOutput);
+
+    if (memoryLimitMiB > 0) {
+        struct rlimit limit;
+        limit.rlim_cur = limit.rlim_max = static_cast<rlim_t>(memoryLimitMiB) << 20;
+        if (setrlimit(RLIMIT_AS, &limit) != 0)
+            qWarning() << "Failed to limit address space to" << memoryLimitMiB << "MiB";
+    }
+
+    QFile input, output;
+    if (!input.open(stdin, QFile::ReadOnly) || !output.open(stdout, QFile::WriteOnly)) return 1;
+
+    FileAnalyzerPDF fileAnalyzerPDF;
+    QStringList embeddedFiles;
+    QObject::connect(&fileAnalyzerPDF, &FileAnalyzerAbstract::foundEmbeddedFile, [&embeddedFiles, &output](const QString &filename) {
+        embeddedFiles.append(filename);
+        /// Announce temporary file right away, in case this worker does not survive the file
+        QJsonObject message;
+        message.insert(QStringLiteral("temporaryfile"), filename);
+        output.write(QJsonDocument(message).toJson(QJsonDocument::Compact).append('\n'));
+        output.flush();
+    });
+
+    forever {
+        const QByteArray line = input.readLine();
+        if (line.isEmpty()) break; ///< standard input got closed by pool
+
+        const QJsonObject request = QJsonDocument::fromJson(line).object();
+        QJsonObject response;
+        try {
+            fileAnalyzerPDF.setTextExtraction(static_cast<FileAnalyzerAbstract::TextExtraction>(request.value(QStringLiteral("textextraction")).toInt()));
+            fileAnalyzerPDF.setTextExtractionLimits(request.value(QStringLiteral("textextractionmaxpages")).toInt(), request.value(QStringLiteral("textextractionmaxchars")).toInt());
+            fileAnalyzerPDF.setAnalyzeEmbeddedFiles(request.value(QStringLiteral("embeddedfiles")).toBool());
+            fileAnalyzerPDF.setParallelPageThreshold(request.value(QStringLiteral("parallelpagethreshold")).toInt());
+
+            QString logText, metaText;
+            QJsonObject record;
+            embeddedFiles.clear();
+            const bool ok = fileAnalyzerPDF.popplerAnalysis(request.value(QStringLiteral("filename")).toString(), logText, metaText, record);
+            response.insert(QStringLiteral("ok"), ok);
+            response.insert(QStringLiteral("logtext"), logText);
+            response.insert(QStringLiteral("metatext"), metaText);
+            response.insert(QStringLiteral("record"), record);
+            response.insert(QStringLiteral("embeddedfiles"), QJsonArray::fromStringList(embeddedFiles));
+        } catch (const std::bad_alloc &) {
+            /// Memory limit reached; after telling the pool, quit as state may be inconsistent
+            output.write("{\"memorylimit\":true}\n");
+            output.flush();
+            return 2;
+        }
+        output.write(QJsonDocument(response).toJson(QJsonDocument::Compact).append('\n'));
+        output.flush();
+    }
+
+    return 0;
+}
+
+QProcess *PopplerWorkerPool::startWorker() {
+    QProcess *worker = new QProcess(this);
+    /// Workers' warnings go to this process' standard error
+    worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    worker->start(QCoreApplication::applicationFilePath(), QStringList() << QLatin1String(workerArgument) << QString::number(m_memoryLimitMiB));
+    if (!worker->waitForStarted(10000))
+        qWarning() << "Failed to start Poppler worker" << worker->program() << worker->arguments().join(QLatin1Char(' '));
+    return worker;
+}
+
+void PopplerWorkerPool::replaceWorker(QProcess *worker) {
+    /// Replace worker right away, so that a fresh one is ready for the next file
+    const int index = m_workers.indexOf(worker);
+    stopWorker(worker);
+    m_workers[index] = startWorker();
+}
+
+void PopplerWorkerPool::removeTemporaryFiles(const QStringList &temporaryFiles) {
+    for (const QString &temporaryFile : temporaryFiles)
+        QFile::remove(temporaryFile);
+}
+
+void PopplerWorkerPool::stopWorker(QProcess *worker) {
+    if (worker->state() != QProcess::NotRunning) {
+        /// Closing standard input makes a worker quit, unless it is stuck
+        worker->closeWriteChannel();
+        if (!worker->waitForFinished(1000)) {
+            worker->kill();
+            worker->waitForFinished(1000);
+        }
+    }
+    worker->deleteLater();
+}
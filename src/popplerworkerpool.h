@@ -0,0 +1,108 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef POPPLERWORKERPOOL_H
+#define POPPLERWORKERPOOL_H
+
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+#include <QJsonObject>
+
+class QProcess;
+
+/**
+ * Pool of pre-started worker processes, each running the Poppler-based
+ * part of a PDF file's analysis in isolation. Every worker runs with
+ * a limit on its address space (via setrlimit) and has to answer
+ * within a deadline, otherwise it gets killed. Workers that crashed,
+ * hit their memory limit, or were killed get respawned automatically.
+ *
+ * Workers are instances of DocScan itself, started with the
+ * command line argument given in workerArgument. Requests and results
+ * are exchanged as single-line JSON objects via the workers' standard
+ * input and output. While analyzing a file, a worker announces each
+ * temporary file it writes, so that the pool can remove those files
+ * if the worker gets killed or crashes before delivering its result.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class PopplerWorkerPool : public QObject
+{
+    Q_OBJECT
+public:
+    enum Status {Ok = 0, Failed, Timeout, Crashed, MemoryLimit, Unavailable};
+
+    struct Result {
+        Status status;
+        QString logText, metaText;
+        QJsonObject record;
+        /// Temporary files of embedded files or images extracted by the worker
+        QStringList embeddedFiles;
+
+        explicit Result(Status _status = Unavailable)
+            : status(_status) {
+            /// nothing
+        }
+    };
+
+    static const char *workerArgument;
+
+    /**
+     * @param numWorkers number of worker processes to keep running
+     * @param memoryLimitMiB maximum address space of each worker in MiB, 0 for no limit
+     * @param timeoutSeconds maximum time a worker may spend on a single file
+     */
+    explicit PopplerWorkerPool(int numWorkers, int memoryLimitMiB, int timeoutSeconds, QObject *parent = nullptr);
+    ~PopplerWorkerPool();
+
+    /**
+     * Hand a request to the next available worker and wait for its result.
+     * A request contains the filename and the analyzer's settings.
+     *
+     * @param request JSON object as built by FileAnalyzerPDF
+     * @return result; if status is Unavailable, no worker could be started
+     */
+    Result analyze(const QJsonObject &request);
+
+    /**
+     * Main loop of a worker process: read requests from standard input
+     * until it gets closed, analyze each file, and write results to
+     * standard output.
+     *
+     * @param memoryLimitMiB maximum address space in MiB, 0 for no limit
+     * @return exit code for this process
+     */
+    static int runWorker(int memoryLimitMiB);
+
+private:
+    QVector<QProcess *> m_workers;
+    int m_nextWorker;
+    const int m_memoryLimitMiB, m_timeoutMilliseconds;
+
+    QProcess *startWorker();
+    void replaceWorker(QProcess *worker);
+    void stopWorker(QProcess *worker);
+    static void removeTemporaryFiles(const QStringList &temporaryFiles);
+};
+
+#endif // POPPLERWORKERPOOL_H
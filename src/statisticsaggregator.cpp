@@ -0,0 +1,194 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "statisticsaggregator.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QSet>
+#include <QStringList>
+
+#include <algorithm>
+
+#include "general.h"
+
+/**
+ * Format a table of counters as a sequence of XML tags, one per key,
+ * sorted by decreasing count.
+ */
+static QString countsToXML(const QString &tag, const QHash<QString, int> &counts) {
+    QList<QPair<int, QString> > sorted;
+    sorted.reserve(counts.size());
+    for (QHash<QString, int>::ConstIterator it = counts.constBegin(); it != counts.constEnd(); ++it)
+        sorted.append(qMakePair(it.value(), it.key()));
+    std::sort(sorted.begin(), sorted.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    QString result;
+    for (const auto &pair : const_cast<const QList<QPair<int, QString> > &>(sorted))
+        result.append(QString(QStringLiteral("<%1 count=\"%2\">%3</%1>\n")).arg(tag, QString::number(pair.first), DocScan::xmlify(pair.second)));
+    return result;
+}
+
+StatisticsAggregator::StatisticsAggregator(QObject *parent)
+    : QObject(parent), m_startTime(QDateTime::currentMSecsSinceEpoch()), m_finalReportDone(false)
+{
+    setObjectName(QString(QLatin1String(metaObject()->className())).toLower());
+    connect(&m_reportTimer, &QTimer::timeout, this, &StatisticsAggregator::intermediateReport);
+}
+
+void StatisticsAggregator::setReportInterval(int seconds) {
+    if (seconds > 0)
+        m_reportTimer.start(seconds * 1000);
+    else
+        m_reportTimer.stop();
+}
+
+void StatisticsAggregator::receiveRecord(const QString &, const QJsonObject &record)
+{
+    const bool ok = record.value(QStringLiteral("status")).toString() == QStringLiteral("ok");
+    const QString mimetype = record.value(QStringLiteral("mimetype")).toString(QStringLiteral("unknown"));
+    FileCount &fileCount = m_mimetypeCount[mimetype];
+    if (ok)
+        ++fileCount.ok;
+    else
+        ++fileCount.error;
+    /// Like the XSL files this aggregator replaces,
+    /// only successfully analyzed files get evaluated any further
+    if (!ok) return;
+
+    const QString producer = record.value(QStringLiteral("producer")).toString();
+    if (!producer.isEmpty()) ++m_producerCount[producer];
+    const QString creator = record.value(QStringLiteral("creator")).toString();
+    if (!creator.isEmpty()) ++m_creatorCount[creator];
+
+    if (mimetype == QStringLiteral("application/pdf")) {
+        const QString version = record.value(QStringLiteral("version")).toString();
+        if (!version.isEmpty()) ++m_pdfVersionCount[version];
+        ++m_xmpPDFConformanceCount[record.value(QStringLiteral("xmppdfconformance")).toString(QStringLiteral("none"))];
+    }
+
+    const QJsonArray fonts = record.value(QStringLiteral("fonts")).toArray();
+    if (!fonts.isEmpty()) {
+        QSet<QString> licenseTypes;
+        for (const QJsonValue &fontValue : fonts) {
+            const QJsonObject font = fontValue.toObject();
+            const QString name = font.value(QStringLiteral("name")).toString();
+            if (name.isEmpty()) continue;
+            FontCount &fontCount = m_fontCount[name];
+            ++fontCount.files;
+            if (font.value(QStringLiteral("embedded")).toBool()) ++fontCount.embedded;
+            if (font.value(QStringLiteral("oninnerpage")).toBool()) ++fontCount.onInnerPage;
+            const QString license = font.value(QStringLiteral("license")).toString(QStringLiteral("unknown"));
+            fontCount.license = license;
+            licenseTypes.insert(license);
+        }
+        /// Selection of license types like 'open' or 'open,proprietary'
+        /// as found among all fonts in this file, see 'font-license.xsl'
+        QStringList licenseSelection = licenseTypes.toList();
+        licenseSelection.sort();
+        ++m_fontLicenseSelectionCount[licenseSelection.join(QChar(','))];
+    }
+
+    const QJsonObject validators = record.value(QStringLiteral("validators")).toObject();
+    if (!validators.isEmpty()) {
+        int pdfa1bVotes = 0;
+        for (QJsonObject::ConstIterator it = validators.constBegin(); it != validators.constEnd(); ++it) {
+            const QJsonObject verdicts = it.value().toObject();
+            for (QJsonObject::ConstIterator vit = verdicts.constBegin(); vit != verdicts.constEnd(); ++vit) {
+                /// Only boolean PDF/A verdicts like 'pdfa1b' are of interest,
+                /// not exit codes or the flavor used for validation
+                if (!vit.key().startsWith(QStringLiteral("pdfa")) || !vit.value().isBool()) continue;
+                VerdictCount &verdictCount = m_validatorVerdictCount[it.key() + QChar('/') + vit.key()];
+                if (vit.value().toBool()) {
+                    ++verdictCount.yes;
+                    if (vit.key() == QStringLiteral("pdfa1b")) ++pdfa1bVotes;
+                } else
+                    ++verdictCount.no;
+            }
+        }
+        ++m_pdfa1bVoteCount[pdfa1bVotes];
+    }
+}
+
+void StatisticsAggregator::finalReport() {
+    if (m_finalReportDone) return;
+    m_finalReportDone = true;
+    m_reportTimer.stop();
+    emit report(objectName(), statisticsToXML(true));
+}
+
+void StatisticsAggregator::intermediateReport() {
+    emit report(objectName(), statisticsToXML(false));
+}
+
+QString StatisticsAggregator::statisticsToXML(bool final) const {
+    int totalOk = 0, totalError = 0;
+    QString mimetypeText;
+    for (QHash<QString, FileCount>::ConstIterator it = m_mimetypeCount.constBegin(); it != m_mimetypeCount.constEnd(); ++it) {
+        totalOk += it.value().ok;
+        totalError += it.value().error;
+        mimetypeText.append(QString(QStringLiteral("<mimetype ok=\"%2\" error=\"%3\">%1</mimetype>\n")).arg(DocScan::xmlify(it.key()), QString::number(it.value().ok), QString::number(it.value().error)));
+    }
+
+    QString result = QString(QStringLiteral("<statistics final=\"%1\" ok=\"%2\" error=\"%3\" time=\"%4\">\n")).arg(final ? QStringLiteral("yes") : QStringLiteral("no"), QString::number(totalOk), QString::number(totalError), QString::number(QDateTime::currentMSecsSinceEpoch() - m_startTime));
+    if (!mimetypeText.isEmpty())
+        result.append(QStringLiteral("<mimetypes>\n")).append(mimetypeText).append(QStringLiteral("</mimetypes>\n"));
+    if (!m_producerCount.isEmpty())
+        result.append(QStringLiteral("<producers>\n")).append(countsToXML(QStringLiteral("producer"), m_producerCount)).append(QStringLiteral("</producers>\n"));
+    if (!m_creatorCount.isEmpty())
+        result.append(QStringLiteral("<creators>\n")).append(countsToXML(QStringLiteral("creator"), m_creatorCount)).append(QStringLiteral("</creators>\n"));
+    if (!m_pdfVersionCount.isEmpty())
+        result.append(QStringLiteral("<pdfversions>\n")).append(countsToXML(QStringLiteral("pdfversion"), m_pdfVersionCount)).append(QStringLiteral("</pdfversions>\n"));
+    if (!m_xmpPDFConformanceCount.isEmpty())
+        result.append(QStringLiteral("<xmppdfconformances>\n")).append(countsToXML(QStringLiteral("xmppdfconformance"), m_xmpPDFConformanceCount)).append(QStringLiteral("</xmppdfconformances>\n"));
+
+    if (!m_fontCount.isEmpty()) {
+        result.append(QStringLiteral("<fonts>\n"));
+        for (QHash<QString, FontCount>::ConstIterator it = m_fontCount.constBegin(); it != m_fontCount.constEnd(); ++it)
+            result.append(QString(QStringLiteral("<font count=\"%2\" embedded=\"%3\" oninnerpage=\"%4\" license=\"%5\">%1</font>\n")).arg(DocScan::xmlify(it.key()), QString::number(it.value().files), QString::number(it.value().embedded), QString::number(it.value().onInnerPage), DocScan::xmlify(it.value().license)));
+        result.append(QStringLiteral("</fonts>\n"));
+    }
+    if (!m_fontLicenseSelectionCount.isEmpty())
+        result.append(QStringLiteral("<fontlicenses>\n")).append(countsToXML(QStringLiteral("fontlicense"), m_fontLicenseSelectionCount)).append(QStringLiteral("</fontlicenses>\n"));
+
+    if (!m_validatorVerdictCount.isEmpty()) {
+        result.append(QStringLiteral("<validators>\n"));
+        for (QHash<QString, VerdictCount>::ConstIterator it = m_validatorVerdictCount.constBegin(); it != m_validatorVerdictCount.constEnd(); ++it) {
+            const int p = it.key().indexOf(QChar('/'));
+            result.append(QString(QStringLiteral("<validator name=\"%1\" flavor=\"%2\" yes=\"%3\" no=\"%4\" />\n")).arg(it.key().left(p), it.key().mid(p + 1), QString::number(it.value().yes), QString::number(it.value().no)));
+        }
+        result.append(QStringLiteral("</validators>\n"));
+    }
+    if (!m_pdfa1bVoteCount.isEmpty()) {
+        result.append(QStringLiteral("<pdfa1bvotes>\n"));
+        QList<int> votes = m_pdfa1bVoteCount.keys();
+        std::sort(votes.begin(), votes.end());
+        for (const int vote : const_cast<const QList<int> &>(votes))
+            result.append(QString(QStringLiteral("<votes validators=\"%1\" count=\"%2\" />\n")).arg(QString::number(vote), QString::number(m_pdfa1bVoteCount[vote])));
+        result.append(QStringLiteral("</pdfa1bvotes>\n"));
+    }
+
+    result.append(QStringLiteral("</statistics>\n"));
+    return result;
+}
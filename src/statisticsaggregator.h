@@ -0,0 +1,125 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef STATISTICSAGGREGATOR_H
+#define STATISTICSAGGREGATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QTimer>
+
+/**
+ * Maintaining summary statistics over all analyzed files while
+ * the analysis is running, such as the number of files per PDF
+ * producer, font usage, or PDF/A verdicts per validator.
+ * Counters get updated incrementally from the structured records
+ * as sent by file analyzers, making it unnecessary to re-read
+ * the complete XML log after the run to compute those numbers.
+ * Summary tables are reported as XML both periodically and once
+ * the analysis is finished.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class StatisticsAggregator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StatisticsAggregator(QObject *parent = nullptr);
+
+    /**
+     * Set interval in which intermediate summaries get reported
+     * while analysis is running.
+     *
+     * @param seconds interval in seconds, 0 or less disables periodic reports
+     */
+    void setReportInterval(int seconds);
+
+signals:
+    void report(QString, QString);
+
+public slots:
+    /**
+     * Update counters with a structured record as received
+     * from a file analyzer's analysisRecord signal.
+     *
+     * @param origin name of the object that created the record
+     * @param record record describing one analyzed file
+     */
+    void receiveRecord(const QString &origin, const QJsonObject &record);
+
+    /**
+     * Report the final summary. To be invoked once analysis is finished,
+     * but before the log collector gets closed.
+     */
+    void finalReport();
+
+private slots:
+    void intermediateReport();
+
+private:
+    struct FileCount {
+        int ok, error;
+
+        explicit FileCount()
+            : ok(0), error(0) {
+            /// nothing
+        }
+    };
+
+    struct FontCount {
+        int files, embedded, onInnerPage;
+        QString license;
+
+        explicit FontCount()
+            : files(0), embedded(0), onInnerPage(0) {
+            /// nothing
+        }
+    };
+
+    struct VerdictCount {
+        int yes, no;
+
+        explicit VerdictCount()
+            : yes(0), no(0) {
+            /// nothing
+        }
+    };
+
+    QTimer m_reportTimer;
+    qint64 m_startTime;
+    bool m_finalReportDone;
+
+    QHash<QString, FileCount> m_mimetypeCount;
+    QHash<QString, int> m_producerCount, m_creatorCount;
+    QHash<QString, int> m_pdfVersionCount, m_xmpPDFConformanceCount;
+    QHash<QString, FontCount> m_fontCount;
+    QHash<QString, int> m_fontLicenseSelectionCount;
+    /// Key is validator's name and PDF/A flavor, separated by a slash, e.g. 'verapdf/pdfa1b'
+    QHash<QString, VerdictCount> m_validatorVerdictCount;
+    /// Number of files per number of validators claiming PDF/A-1b compliance
+    QHash<int, int> m_pdfa1bVoteCount;
+
+    QString statisticsToXML(bool final) const;
+};
+
+#endif // STATISTICSAGGREGATOR_H
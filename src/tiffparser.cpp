@@ -0,0 +1,442 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#include "tiffparser.h"
+
+#include <QSet>
+
+#include <algorithm>
+#include <climits>
+
+#include "general.h"
+
+/// Tags evaluated by this parser
+static const quint16 tagImageWidth = 256;
+static const quint16 tagImageLength = 257;
+static const quint16 tagBitsPerSample = 258;
+static const quint16 tagCompression = 259;
+static const quint16 tagPhotometricInterpretation = 262;
+static const quint16 tagStripOffsets = 273;
+static const quint16 tagSamplesPerPixel = 277;
+static const quint16 tagRowsPerStrip = 278;
+static const quint16 tagStripByteCounts = 279;
+static const quint16 tagPlanarConfiguration = 284;
+static const quint16 tagDateTime = 306;
+static const quint16 tagTileWidth = 322;
+static const quint16 tagTileLength = 323;
+static const quint16 tagTileOffsets = 324;
+static const quint16 tagTileByteCounts = 325;
+static const quint16 tagXMP = 700;
+static const quint16 tagExifIFD = 34665;
+static const quint16 tagDateTimeOriginal = 36867;
+
+/// Limits to protect against malformed or malicious files
+static const int maxPages = 1 << 16; ///< image file directories beyond this are not followed
+static const quint64 maxEntriesPerIFD = 4096;
+static const int maxSegmentsPerPage = 1 << 20; ///< strips or tiles beyond this are not checked
+static const int maxSegmentsTotal = 1 << 23; ///< no overlap check for more strips or tiles in the whole file
+static const int maxXMPSize = 16 << 20;
+static const int maxStructuralErrors = 64;
+
+/// Size in bytes of a single value of the given field type, 0 for unknown types
+static int typeSize(quint16 type) {
+    switch (type) {
+    case 1: ///< BYTE
+    case 2: ///< ASCII
+    case 6: ///< SBYTE
+    case 7: ///< UNDEFINED
+        return 1;
+    case 3: ///< SHORT
+    case 8: ///< SSHORT
+        return 2;
+    case 4: ///< LONG
+    case 9: ///< SLONG
+    case 11: ///< FLOAT
+    case 13: ///< IFD
+        return 4;
+    case 5: ///< RATIONAL
+    case 10: ///< SRATIONAL
+    case 12: ///< DOUBLE
+    case 16: ///< LONG8
+    case 17: ///< SLONG8
+    case 18: ///< IFD8
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+static inline quint64 ceilDivide(quint64 a, quint64 b) {
+    return b == 0 ? 0 : (a + b - 1) / b;
+}
+
+TIFFParser::TIFFParser(const QString &filename)
+    : m_file(filename), m_bigTIFF(false), m_bigEndian(false), m_fileSize(0), m_hasXMP(false)
+{
+    /// nothing
+}
+
+bool TIFFParser::parse() {
+    if (!m_file.open(QFile::ReadOnly)) {
+        m_errorMessage = QStringLiteral("Could not open file");
+        return false;
+    }
+    m_fileSize = m_file.size();
+
+    const QByteArray header = readData(0, 16);
+    if (header.size() < 8) {
+        m_errorMessage = QStringLiteral("File too small");
+        return false;
+    }
+    if (header.startsWith("II"))
+        m_bigEndian = false;
+    else if (header.startsWith("MM"))
+        m_bigEndian = true;
+    else {
+        m_errorMessage = QStringLiteral("No TIFF header found");
+        return false;
+    }
+
+    qint64 ifdOffset = 0;
+    const quint64 magic = toUnsigned(header, 2, 2);
+    if (magic == 42)
+        ifdOffset = static_cast<qint64>(toUnsigned(header, 4, 4));
+    else if (magic == 43 && header.size() >= 16 && toUnsigned(header, 4, 2) == 8 && toUnsigned(header, 6, 2) == 0) {
+        m_bigTIFF = true;
+        ifdOffset = static_cast<qint64>(toUnsigned(header, 8, 8));
+    } else {
+        m_errorMessage = QStringLiteral("No TIFF header found");
+        return false;
+    }
+
+    /// Follow chain of image file directories, one per page
+    QSet<qint64> visitedOffsets;
+    while (ifdOffset != 0) {
+        if (m_pages.count() >= maxPages) {
+            addStructuralError(QString(QStringLiteral("More than %1 pages, remaining pages not checked")).arg(maxPages));
+            break;
+        }
+        if (visitedOffsets.contains(ifdOffset)) {
+            addStructuralError(QString(QStringLiteral("Loop in chain of image file directories at offset %1")).arg(ifdOffset));
+            break;
+        }
+        visitedOffsets.insert(ifdOffset);
+
+        QHash<quint16, Entry> entries;
+        qint64 nextOffset = 0;
+        if (!readIFD(ifdOffset, entries, nextOffset))
+            break;
+        parsePage(ifdOffset, entries);
+
+        if (m_pages.count() == 1) {
+            /// Metadata is taken from the first page only
+            m_modificationDate = dateTime(entries, tagDateTime);
+            if (entries.contains(tagExifIFD)) {
+                QHash<quint16, Entry> exifEntries;
+                qint64 exifNextOffset = 0;
+                if (readIFD(static_cast<qint64>(value(entries, tagExifIFD, 0)), exifEntries, exifNextOffset))
+                    m_creationDate = dateTime(exifEntries, tagDateTimeOriginal);
+            }
+            if (entries.contains(tagXMP)) {
+                const QByteArray xmp = bytes(entries[tagXMP], maxXMPSize);
+                m_hasXMP = !xmp.isEmpty();
+                DocScan::xmpDates(xmp, m_creationDate, m_modificationDate);
+            }
+        }
+
+        ifdOffset = nextOffset;
+    }
+
+    if (m_pages.isEmpty()) {
+        m_errorMessage = m_structuralErrors.isEmpty() ? QStringLiteral("No image file directory found") : m_structuralErrors.first();
+        return false;
+    }
+
+    checkOverlappingSegments();
+    m_segments.clear();
+    m_segments.squeeze();
+
+    return true;
+}
+
+QString TIFFParser::errorMessage() const {
+    return m_errorMessage;
+}
+
+QStringList TIFFParser::structuralErrors() const {
+    return m_structuralErrors;
+}
+
+bool TIFFParser::isWellFormed() const {
+    return m_structuralErrors.isEmpty();
+}
+
+bool TIFFParser::isBigTIFF() const {
+    return m_bigTIFF;
+}
+
+bool TIFFParser::isBigEndian() const {
+    return m_bigEndian;
+}
+
+qint64 TIFFParser::fileSize() const {
+    return m_fileSize;
+}
+
+const QList<TIFFParser::Page> &TIFFParser::pages() const {
+    return m_pages;
+}
+
+QDateTime TIFFParser::creationDate() const {
+    return m_creationDate;
+}
+
+QDateTime TIFFParser::modificationDate() const {
+    return m_modificationDate;
+}
+
+bool TIFFParser::hasXMP() const {
+    return m_hasXMP;
+}
+
+QString TIFFParser::compressionToString(int compression) {
+    switch (compression) {
+    case 1: return QStringLiteral("none");
+    case 2: return QStringLiteral("ccittrle");
+    case 3: return QStringLiteral("ccittfax3");
+    case 4: return QStringLiteral("ccittfax4");
+    case 5: return QStringLiteral("lzw");
+    case 6: return QStringLiteral("ojpeg");
+    case 7: return QStringLiteral("jpeg");
+    case 8: return QStringLiteral("deflate");
+    case 32773: return QStringLiteral("packbits");
+    case 32946: return QStringLiteral("deflate");
+    case 34712: return QStringLiteral("jpeg2000");
+    case 34925: return QStringLiteral("lzma");
+    case 50000: return QStringLiteral("zstd");
+    case 50001: return QStringLiteral("webp");
+    default: return QString(QStringLiteral("unknown%1")).arg(compression);
+    }
+}
+
+QString TIFFParser::photometricInterpretationToString(int photometricInterpretation) {
+    switch (photometricInterpretation) {
+    case 0: return QStringLiteral("miniswhite");
+    case 1: return QStringLiteral("minisblack");
+    case 2: return QStringLiteral("rgb");
+    case 3: return QStringLiteral("palette");
+    case 4: return QStringLiteral("mask");
+    case 5: return QStringLiteral("separated");
+    case 6: return QStringLiteral("ycbcr");
+    case 8: return QStringLiteral("cielab");
+    case 9: return QStringLiteral("icclab");
+    case 10: return QStringLiteral("itulab");
+    case 32803: return QStringLiteral("cfa");
+    case 32844: return QStringLiteral("logl");
+    case 32845: return QStringLiteral("logluv");
+    case 34892: return QStringLiteral("linearraw");
+    case -1: return QStringLiteral("missing");
+    default: return QString(QStringLiteral("unknown%1")).arg(photometricInterpretation);
+    }
+}
+
+bool TIFFParser::readIFD(qint64 offset, QHash<quint16, Entry> &entries, qint64 &nextOffset) {
+    const int countSize = m_bigTIFF ? 8 : 2, entrySize = m_bigTIFF ? 20 : 12, offsetSize = m_bigTIFF ? 8 : 4;
+    if (offset < 8 || offset + countSize > m_fileSize) {
+        addStructuralError(QString(QStringLiteral("Image file directory offset %1 past end of file")).arg(offset));
+        return false;
+    }
+
+    const quint64 numEntries = toUnsigned(readData(offset, countSize), 0, countSize);
+    if (numEntries == 0 || numEntries > maxEntriesPerIFD) {
+        addStructuralError(QString(QStringLiteral("Image file directory at offset %1 has invalid number of entries: %2")).arg(offset).arg(numEntries));
+        return false;
+    }
+    /// Read all entries plus offset of next directory in one go
+    const QByteArray data = readData(offset + countSize, static_cast<qint64>(numEntries) * entrySize + offsetSize);
+    if (data.size() < static_cast<int>(numEntries) * entrySize + offsetSize) {
+        addStructuralError(QString(QStringLiteral("Image file directory at offset %1 truncated")).arg(offset));
+        return false;
+    }
+
+    for (int i = 0; i < static_cast<int>(numEntries); ++i) {
+        const int pos = i * entrySize;
+        const quint16 tag = static_cast<quint16>(toUnsigned(data, pos, 2));
+        Entry entry;
+        entry.type = static_cast<quint16>(toUnsigned(data, pos + 2, 2));
+        entry.count = toUnsigned(data, pos + 4, m_bigTIFF ? 8 : 4);
+        entry.valueField = data.mid(pos + (m_bigTIFF ? 12 : 8), offsetSize);
+
+        const int size = typeSize(entry.type);
+        if (size > 0 && entry.count > static_cast<quint64>(offsetSize / size)) {
+            /// Value does not fit into entry, check that it is located within file
+            const quint64 valueOffset = toUnsigned(entry.valueField, 0, offsetSize);
+            if (entry.count > static_cast<quint64>(m_fileSize) || valueOffset > static_cast<quint64>(m_fileSize) || entry.count * size > static_cast<quint64>(m_fileSize) - valueOffset)
+                addStructuralError(QString(QStringLiteral("Value of tag %1 in image file directory at offset %2 past end of file")).arg(tag).arg(offset));
+        }
+        entries.insert(tag, entry);
+    }
+
+    nextOffset = static_cast<qint64>(toUnsigned(data, static_cast<int>(numEntries) * entrySize, offsetSize));
+    return true;
+}
+
+void TIFFParser::parsePage(qint64 ifdOffset, const QHash<quint16, Entry> &entries) {
+    Page page;
+    page.ifdOffset = ifdOffset;
+    page.width = static_cast<int>(qMin<quint64>(value(entries, tagImageWidth, 0), INT_MAX));
+    page.height = static_cast<int>(qMin<quint64>(value(entries, tagImageLength, 0), INT_MAX));
+    page.compression = static_cast<int>(value(entries, tagCompression, 1));
+    page.photometricInterpretation = entries.contains(tagPhotometricInterpretation) ? static_cast<int>(value(entries, tagPhotometricInterpretation, 0)) : -1;
+    page.bitsPerSample = static_cast<int>(value(entries, tagBitsPerSample, 1));
+    page.samplesPerPixel = static_cast<int>(value(entries, tagSamplesPerPixel, 1));
+    page.tiled = entries.contains(tagTileOffsets);
+    if (page.tiled) {
+        page.tileWidth = static_cast<int>(qMin<quint64>(value(entries, tagTileWidth, 0), INT_MAX));
+        page.tileHeight = static_cast<int>(qMin<quint64>(value(entries, tagTileLength, 0), INT_MAX));
+    }
+    const quint16 offsetsTag = page.tiled ? tagTileOffsets : tagStripOffsets, byteCountsTag = page.tiled ? tagTileByteCounts : tagStripByteCounts;
+    if (entries.contains(offsetsTag))
+        page.numSegments = static_cast<int>(qMin<quint64>(entries[offsetsTag].count, INT_MAX));
+    m_pages.append(page);
+    const int pageNumber = m_pages.count();
+
+    if (page.width <= 0 || page.height <= 0)
+        addStructuralError(QString(QStringLiteral("Page %1 lacks image dimensions")).arg(pageNumber));
+
+    if (!entries.contains(offsetsTag)) {
+        addStructuralError(QString(QStringLiteral("Page %1 has neither strip nor tile offsets")).arg(pageNumber));
+        return;
+    }
+    if (!entries.contains(byteCountsTag)) {
+        addStructuralError(QString(QStringLiteral("Page %1 lacks strip or tile byte counts")).arg(pageNumber));
+        return;
+    }
+
+    const Entry offsetsEntry = entries[offsetsTag];
+    if (offsetsEntry.count != entries[byteCountsTag].count)
+        addStructuralError(QString(QStringLiteral("Page %1 has %2 strip or tile offsets, but %3 byte counts")).arg(pageNumber).arg(offsetsEntry.count).arg(entries[byteCountsTag].count));
+
+    /// Check number of strips or tiles against image dimensions
+    if (page.width > 0 && page.height > 0) {
+        const quint64 planes = value(entries, tagPlanarConfiguration, 1) == 2 ? static_cast<quint64>(qMax(page.samplesPerPixel, 1)) : 1;
+        quint64 expected = 0;
+        if (page.tiled) {
+            if (page.tileWidth <= 0 || page.tileHeight <= 0)
+                addStructuralError(QString(QStringLiteral("Page %1 lacks tile dimensions")).arg(pageNumber));
+            else
+                expected = ceilDivide(page.width, page.tileWidth) * ceilDivide(page.height, page.tileHeight) * planes;
+        } else {
+            const quint64 rowsPerStrip = qMin<quint64>(qMax<quint64>(value(entries, tagRowsPerStrip, 0xffffffffULL), 1), page.height);
+            expected = ceilDivide(page.height, rowsPerStrip) * planes;
+        }
+        if (expected > 0 && offsetsEntry.count < expected)
+            addStructuralError(QString(QStringLiteral("Page %1 has %2 strips or tiles, expected %3")).arg(pageNumber).arg(offsetsEntry.count).arg(expected));
+    }
+
+    /// Check location of image data, which itself is never read
+    const QVector<quint64> offsets = values(offsetsEntry, maxSegmentsPerPage);
+    const QVector<quint64> byteCounts = values(entries[byteCountsTag], maxSegmentsPerPage);
+    const int n = qMin(offsets.count(), byteCounts.count());
+    int numPastEndOfFile = 0;
+    for (int i = 0; i < n; ++i) {
+        if (offsets[i] > static_cast<quint64>(m_fileSize) || byteCounts[i] > static_cast<quint64>(m_fileSize) - offsets[i])
+            ++numPastEndOfFile;
+        else if (byteCounts[i] > 0 && m_segments.count() < maxSegmentsTotal)
+            m_segments.append(qMakePair(offsets[i], byteCounts[i]));
+    }
+    if (numPastEndOfFile > 0)
+        addStructuralError(QString(QStringLiteral("Page %1 has %2 strips or tiles past end of file")).arg(pageNumber).arg(numPastEndOfFile));
+}
+
+void TIFFParser::checkOverlappingSegments() {
+    if (m_segments.count() >= maxSegmentsTotal) return;
+
+    std::sort(m_segments.begin(), m_segments.end());
+    quint64 end = 0;
+    int numOverlaps = 0;
+    for (int i = 0; i < m_segments.count(); ++i) {
+        const QPair<quint64, quint64> &segment = m_segments[i];
+        /// Some writers let identical strips (e.g. blank ones) share data, which is harmless
+        if (i > 0 && segment == m_segments[i - 1]) continue;
+        if (segment.first < end)
+            ++numOverlaps;
+        end = qMax(end, segment.first + segment.second);
+    }
+    if (numOverlaps > 0)
+        addStructuralError(QString(QStringLiteral("%1 strips or tiles overlap with others")).arg(numOverlaps));
+}
+
+QVector<quint64> TIFFParser::values(const Entry &entry, int maxCount) {
+    QVector<quint64> result;
+    /// Only unsigned integer types are meaningful for offsets, counts and dimensions
+    if (entry.type != 1 && entry.type != 3 && entry.type != 4 && entry.type != 13 && entry.type != 16 && entry.type != 18) return result;
+    const int size = typeSize(entry.type);
+    const int n = static_cast<int>(qMin<quint64>(entry.count, static_cast<quint64>(maxCount)));
+    const QByteArray data = bytes(entry, n * size);
+    result.reserve(data.size() / size);
+    for (int pos = 0; pos + size <= data.size(); pos += size)
+        result.append(toUnsigned(data, pos, size));
+    return result;
+}
+
+QByteArray TIFFParser::bytes(const Entry &entry, int maxSize) {
+    const int size = typeSize(entry.type);
+    if (size == 0 || entry.count > static_cast<quint64>(m_fileSize)) return QByteArray();
+    const quint64 length = qMin<quint64>(entry.count * size, static_cast<quint64>(maxSize));
+    if (entry.count * size <= static_cast<quint64>(entry.valueField.size()))
+        return entry.valueField.left(static_cast<int>(length));
+    return readData(static_cast<qint64>(toUnsigned(entry.valueField, 0, entry.valueField.size())), static_cast<qint64>(length));
+}
+
+quint64 TIFFParser::value(const QHash<quint16, Entry> &entries, quint16 tag, quint64 defaultValue) {
+    if (!entries.contains(tag)) return defaultValue;
+    const QVector<quint64> v = values(entries[tag], 1);
+    return v.isEmpty() ? defaultValue : v.first();
+}
+
+QDateTime TIFFParser::dateTime(const QHash<quint16, Entry> &entries, quint16 tag) {
+    if (!entries.contains(tag) || entries[tag].type != 2) return QDateTime();
+    const QByteArray text = bytes(entries[tag], 19);
+    return QDateTime::fromString(QString::fromLatin1(text), QStringLiteral("yyyy:MM:dd HH:mm:ss"));
+}
+
+quint64 TIFFParser::toUnsigned(const QByteArray &data, int pos, int numBytes) const {
+    if (pos < 0 || pos + numBytes > data.size()) return 0;
+    quint64 result = 0;
+    for (int i = 0; i < numBytes; ++i) {
+        const int index = m_bigEndian ? pos + i : pos + numBytes - 1 - i;
+        result = (result << 8) | static_cast<uchar>(data[index]);
+    }
+    return result;
+}
+
+QByteArray TIFFParser::readData(qint64 offset, qint64 length) {
+    if (offset < 0 || length <= 0 || offset >= m_fileSize || !m_file.seek(offset)) return QByteArray();
+    return m_file.read(length);
+}
+
+void TIFFParser::addStructuralError(const QString &error) {
+    if (m_structuralErrors.count() < maxStructuralErrors)
+        m_structuralErrors.append(error);
+}
@@ -0,0 +1,128 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#ifndef TIFFPARSER_H
+#define TIFFPARSER_H
+
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+/**
+ * Lightweight, read-only parser for TIFF and BigTIFF files in either
+ * byte order. Follows the chain of image file directories (IFDs),
+ * one per page, and reads only directory entries and the arrays of
+ * strip or tile offsets needed to check the file's structure.
+ * Image data is never read.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class TIFFParser
+{
+public:
+    /// Properties of one page (image file directory)
+    struct Page {
+        qint64 ifdOffset;
+        int width, height;
+        int compression;
+        int photometricInterpretation;
+        int bitsPerSample, samplesPerPixel;
+        bool tiled;
+        int tileWidth, tileHeight;
+        /// number of strips or tiles
+        int numSegments;
+
+        explicit Page()
+            : ifdOffset(0), width(0), height(0), compression(1), photometricInterpretation(-1), bitsPerSample(1), samplesPerPixel(1), tiled(false), tileWidth(0), tileHeight(0), numSegments(0) {
+            /// nothing
+        }
+    };
+
+    explicit TIFFParser(const QString &filename);
+
+    /**
+     * Open the file, read its header and follow the chain of
+     * image file directories. Structural problems found on the
+     * way are recorded, see @see structuralErrors.
+     *
+     * @return true if file has a TIFF header and at least one readable page
+     */
+    bool parse();
+
+    QString errorMessage() const;
+
+    /// Problems such as offsets past the end of file or overlapping strips, empty if none
+    QStringList structuralErrors() const;
+    bool isWellFormed() const;
+
+    bool isBigTIFF() const;
+    bool isBigEndian() const;
+    qint64 fileSize() const;
+    const QList<Page> &pages() const;
+
+    /// Modification date from the DateTime tag and creation date from EXIF data, each falling back to XMP metadata
+    QDateTime creationDate() const;
+    QDateTime modificationDate() const;
+    bool hasXMP() const;
+
+    static QString compressionToString(int compression);
+    static QString photometricInterpretationToString(int photometricInterpretation);
+
+private:
+    /// Directory entry with its value still in raw form
+    struct Entry {
+        quint16 type;
+        quint64 count;
+        /// value itself if it fits, otherwise offset of value
+        QByteArray valueField;
+    };
+
+    QFile m_file;
+    QString m_errorMessage;
+    QStringList m_structuralErrors;
+    bool m_bigTIFF, m_bigEndian;
+    qint64 m_fileSize;
+    QList<Page> m_pages;
+    QDateTime m_creationDate, m_modificationDate;
+    bool m_hasXMP;
+
+    /// Offset and length of strips and tiles of all pages, to detect overlaps
+    QVector<QPair<quint64, quint64> > m_segments;
+
+    bool readIFD(qint64 offset, QHash<quint16, Entry> &entries, qint64 &nextOffset);
+    void parsePage(qint64 ifdOffset, const QHash<quint16, Entry> &entries);
+    void checkOverlappingSegments();
+    QVector<quint64> values(const Entry &entry, int maxCount);
+    QByteArray bytes(const Entry &entry, int maxSize);
+    quint64 value(const QHash<quint16, Entry> &entries, quint16 tag, quint64 defaultValue);
+    QDateTime dateTime(const QHash<quint16, Entry> &entries, quint16 tag);
+    quint64 toUnsigned(const QByteArray &data, int pos, int numBytes) const;
+    QByteArray readData(qint64 offset, qint64 length);
+    void addStructuralError(const QString &error);
+};
+
+#endif // TIFFPARSER_H
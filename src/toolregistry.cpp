@@ -0,0 +1,186 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#include "toolregistry.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <QDebug>
+
+/// How to make each known tool report its version
+static const struct Probe {
+    const char *name;
+    const char *argument;
+    QProcess::ProcessChannel channel;
+    int timeLimit; ///< milliseconds for both starting and finishing
+} probes[] = {
+    {"java", "-version", QProcess::StandardError, 10000},
+    {"exiftool", "-ver", QProcess::StandardOutput, 120000},
+    {"pdfinfo", "-v", QProcess::StandardError, 120000}
+};
+
+ToolRegistry::ToolRegistry()
+{
+    /// nothing
+}
+
+ToolRegistry &ToolRegistry::instance() {
+    static ToolRegistry toolRegistry;
+    return toolRegistry;
+}
+
+void ToolRegistry::setCacheFilename(const QString &filename) {
+    QMutexLocker locker(&m_mutex);
+    m_cacheFilename = filename;
+    load();
+}
+
+QHash<QString, ToolRegistry::Tool> ToolRegistry::probe(const QStringList &names) {
+    QStringList unknownNames;
+    m_mutex.lock();
+    for (const QString &name : names)
+        if (!m_tools.contains(name) && !unknownNames.contains(name))
+            unknownNames.append(name);
+    m_mutex.unlock();
+
+    if (!unknownNames.isEmpty()) {
+        /// Tools get run without holding the lock; should another thread
+        /// ask for the same tool meanwhile, it will be run twice at worst
+        QFuture<Tool> future = QtConcurrent::mapped(unknownNames, &ToolRegistry::runProbe);
+        future.waitForFinished();
+        QMutexLocker locker(&m_mutex);
+        for (const Tool &tool : future.results())
+            m_tools.insert(tool.name, tool);
+        if (!m_cacheFilename.isEmpty())
+            saveLocked();
+    }
+
+    QHash<QString, Tool> result;
+    QMutexLocker locker(&m_mutex);
+    for (const QString &name : names)
+        result.insert(name, m_tools.value(name));
+    return result;
+}
+
+ToolRegistry::Tool ToolRegistry::probe(const QString &name) {
+    return probe(QStringList() << name).value(name);
+}
+
+ToolRegistry::Tool ToolRegistry::runProbe(const QString &name) {
+    Tool tool;
+    tool.name = name;
+
+    const Probe *probe = nullptr;
+    for (const Probe &candidate : probes)
+        if (name == QLatin1String(candidate.name)) {
+            probe = &candidate;
+            break;
+        }
+    if (probe == nullptr) {
+        qWarning() << "Don't know how to probe tool" << name;
+        return tool;
+    }
+
+    tool.path = QStandardPaths::findExecutable(name);
+    if (!tool.path.isEmpty())
+        tool.modified = QFileInfo(tool.path).lastModified().toMSecsSinceEpoch();
+
+    QProcess process;
+    process.start(name, QStringList() << QLatin1String(probe->argument), QIODevice::ReadOnly);
+    if (process.waitForStarted(probe->timeLimit) && process.waitForFinished(probe->timeLimit))
+        tool.found = true;
+    else if (process.state() != QProcess::NotRunning) {
+        process.kill();
+        process.waitForFinished();
+    }
+    tool.exitCode = process.exitCode();
+    const QByteArray output = probe->channel == QProcess::StandardError ? process.readAllStandardError() : process.readAllStandardOutput();
+    tool.output = QString::fromLocal8Bit(output).trimmed();
+    return tool;
+}
+
+bool ToolRegistry::isCurrent(const Tool &tool) {
+    const QString path = QStandardPaths::findExecutable(tool.name);
+    if (path != tool.path) return false; ///< tool got installed, removed, or moved
+    return path.isEmpty() || QFileInfo(path).lastModified().toMSecsSinceEpoch() == tool.modified;
+}
+
+void ToolRegistry::saveLocked() {
+    QJsonObject toolsObject;
+    for (QHash<QString, Tool>::ConstIterator it = m_tools.constBegin(); it != m_tools.constEnd(); ++it) {
+        const Tool &tool = it.value();
+        QJsonObject toolObject;
+        toolObject.insert(QStringLiteral("found"), tool.found);
+        toolObject.insert(QStringLiteral("exitcode"), tool.exitCode);
+        toolObject.insert(QStringLiteral("output"), tool.output);
+        toolObject.insert(QStringLiteral("path"), tool.path);
+        toolObject.insert(QStringLiteral("modified"), static_cast<double>(tool.modified));
+        toolsObject.insert(it.key(), toolObject);
+    }
+    QJsonObject rootObject;
+    rootObject.insert(QStringLiteral("tools"), toolsObject);
+
+    QSaveFile cacheFile(m_cacheFilename);
+    if (!cacheFile.open(QSaveFile::WriteOnly)) {
+        qWarning() << "Could not write tool registry file" << m_cacheFilename;
+        return;
+    }
+    cacheFile.write(QJsonDocument(rootObject).toJson(QJsonDocument::Indented));
+    if (!cacheFile.commit())
+        qWarning() << "Could not write tool registry file" << m_cacheFilename;
+}
+
+void ToolRegistry::load() {
+    QFile cacheFile(m_cacheFilename);
+    if (!cacheFile.exists()) return; ///< nothing probed yet
+    if (!cacheFile.open(QFile::ReadOnly)) {
+        qWarning() << "Could not read tool registry file" << m_cacheFilename;
+        return;
+    }
+    const QJsonDocument document = QJsonDocument::fromJson(cacheFile.readAll());
+    const QJsonObject toolsObject = document.object().value(QStringLiteral("tools")).toObject();
+    int numLoaded = 0;
+    for (QJsonObject::ConstIterator it = toolsObject.constBegin(); it != toolsObject.constEnd(); ++it) {
+        if (m_tools.contains(it.key())) continue; ///< already probed in this run
+        const QJsonObject toolObject = it.value().toObject();
+        Tool tool;
+        tool.name = it.key();
+        tool.found = toolObject.value(QStringLiteral("found")).toBool();
+        tool.exitCode = toolObject.value(QStringLiteral("exitcode")).toInt(-1);
+        tool.output = toolObject.value(QStringLiteral("output")).toString();
+        tool.path = toolObject.value(QStringLiteral("path")).toString();
+        tool.modified = static_cast<qint64>(toolObject.value(QStringLiteral("modified")).toDouble());
+        if (isCurrent(tool)) {
+            m_tools.insert(tool.name, tool);
+            ++numLoaded;
+        }
+    }
+    qDebug() << "Loaded" << numLoaded << "tool probes from" << m_cacheFilename;
+}
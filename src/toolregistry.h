@@ -0,0 +1,92 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+#ifndef TOOLREGISTRY_H
+#define TOOLREGISTRY_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+/**
+ * Results of probing external tools like 'java -version', shared by
+ * all analyzers. Each tool is run only once per process, several tools
+ * in parallel, and results may be kept in a JSON file, so that later
+ * runs reuse them as long as the tool's executable remains unchanged.
+ * All methods are thread-safe.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class ToolRegistry
+{
+public:
+    struct Tool {
+        explicit Tool()
+            : found(false), exitCode(-1), modified(0) {
+            /// nothing
+        }
+
+        QString name;
+        bool found; ///< tool could be started and finished in time
+        int exitCode;
+        QString output; ///< trimmed output on the channel the tool reports its version
+        QString path; ///< location of the tool's executable
+        qint64 modified; ///< executable's modification time in milliseconds since epoch
+    };
+
+    static ToolRegistry &instance();
+
+    /**
+     * Load results from this JSON file and save new results there.
+     * By default, results are kept in memory only.
+     */
+    void setCacheFilename(const QString &filename);
+
+    /**
+     * Probe tools such as 'java', 'exiftool', or 'pdfinfo' unless
+     * already probed before; tools not probed yet run in parallel.
+     *
+     * @param names names of tools to probe
+     * @return results for all known tools among the names
+     */
+    QHash<QString, Tool> probe(const QStringList &names);
+
+    /// Convenience function for a single tool, @see probe
+    Tool probe(const QString &name);
+
+private:
+    explicit ToolRegistry();
+
+    static Tool runProbe(const QString &name);
+    /// Check if a cached result still applies to the tool's current executable
+    static bool isCurrent(const Tool &tool);
+
+    void load();
+    void saveLocked();
+
+    QMutex m_mutex;
+    QString m_cacheFilename;
+    QHash<QString, Tool> m_tools;
+};
+
+#endif // TOOLREGISTRY_H
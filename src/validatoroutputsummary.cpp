@@ -0,0 +1,267 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#include "validatoroutputsummary.h"
+
+#include <QRegularExpression>
+
+#include "general.h"
+
+const int ValidatorOutputSummary::maxRawHeadSize = 65536;
+const int ValidatorOutputSummary::maxTextLength = 4096;
+const int ValidatorOutputSummary::maxRules = 1024;
+
+ValidatorOutputSummary::ValidatorOutputSummary(Dialect dialect, int maxFailures)
+    : m_dialect(dialect), m_maxFailures(maxFailures), m_parseError(false), m_depth(0), m_complete(false), m_watchedPhraseSeen(false), m_complianceKnown(false), m_compliant(false), m_fileSize(0), m_failureCount(0), m_inFailedRule(false), m_inFailure(false)
+{
+    /// nothing
+}
+
+void ValidatorOutputSummary::setWatchedPhrase(const QByteArray &phrase) {
+    m_watchedPhrase = phrase;
+}
+
+void ValidatorOutputSummary::addData(const QByteArray &data) {
+    if (data.isEmpty()) return;
+
+    if (!m_watchedPhrase.isEmpty() && !m_watchedPhraseSeen) {
+        /// Keep end of previous chunk to find phrases spanning two chunks
+        const QByteArray haystack = m_phraseTail + data;
+        m_watchedPhraseSeen = haystack.contains(m_watchedPhrase);
+        m_phraseTail = haystack.right(m_watchedPhrase.length() - 1);
+    }
+
+    if (m_rawHead.length() < maxRawHeadSize)
+        m_rawHead.append(data.left(maxRawHeadSize - m_rawHead.length()));
+
+    if (m_parseError || m_complete) return;
+
+    m_reader.addData(data);
+    while (!m_reader.atEnd()) {
+        switch (m_reader.readNext()) {
+        case QXmlStreamReader::StartElement:
+            startElement();
+            break;
+        case QXmlStreamReader::EndElement:
+            endElement();
+            break;
+        case QXmlStreamReader::Characters:
+            if (!m_reader.isWhitespace() && m_text.length() < maxTextLength)
+                m_text.append(m_reader.text().left(maxTextLength - m_text.length()));
+            break;
+        default:
+            break;
+        }
+        if (m_complete) return; ///< ignore anything after the root element
+    }
+    /// A premature end of document just means that more data is to come
+    if (m_reader.hasError() && m_reader.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+        m_parseError = true;
+        m_parseErrorString = QString(QStringLiteral("%1 (line %2, column %3)")).arg(m_reader.errorString()).arg(m_reader.lineNumber()).arg(m_reader.columnNumber());
+        m_reader.clear();
+    }
+}
+
+void ValidatorOutputSummary::startElement() {
+    ++m_depth;
+    m_text.clear();
+    const QStringRef name = m_reader.name();
+    const QXmlStreamAttributes attributes = m_reader.attributes();
+
+    if (m_dialect == VeraPDF) {
+        if (name == QStringLiteral("item")) {
+            bool ok = false;
+            const qint64 size = attributes.value(QStringLiteral("size")).toLongLong(&ok);
+            if (ok) m_fileSize = size;
+        } else if (name == QStringLiteral("validationResult")) {
+            /// 'rawResults' format
+            m_flavour = attributes.value(QStringLiteral("flavour")).toString();
+            m_complianceKnown = attributes.hasAttribute(QStringLiteral("isCompliant"));
+            m_compliant = attributes.value(QStringLiteral("isCompliant")) == QStringLiteral("true");
+        } else if (name == QStringLiteral("validationReport")) {
+            /// Machine readable report format, where the flavour is only known from the profile's name
+            const QString profileName = attributes.value(QStringLiteral("profileName")).toString();
+            static const QRegularExpression reFlavour(QStringLiteral("PDF/A-([1-4])([ABU]?)"), QRegularExpression::CaseInsensitiveOption);
+            const QRegularExpressionMatch match = reFlavour.match(profileName);
+            if (match.hasMatch())
+                m_flavour = QStringLiteral("PDFA_") + match.captured(1) + (match.captured(2).isEmpty() ? QString() : QStringLiteral("_") + match.captured(2).toUpper());
+            m_complianceKnown = attributes.hasAttribute(QStringLiteral("isCompliant"));
+            m_compliant = attributes.value(QStringLiteral("isCompliant")) == QStringLiteral("true");
+        } else if (name == QStringLiteral("rule") && attributes.value(QStringLiteral("status")) == QStringLiteral("failed")) {
+            m_inFailedRule = true;
+            m_currentRule = attributes.value(QStringLiteral("specification")).toString() + QLatin1Char(' ') + attributes.value(QStringLiteral("clause")).toString() + QLatin1Char('-') + attributes.value(QStringLiteral("testNumber")).toString();
+            bool ok = false;
+            int failedChecks = attributes.value(QStringLiteral("failedChecks")).toInt(&ok);
+            if (!ok) failedChecks = 1;
+            m_failureCount += failedChecks;
+            countRuleViolations(m_currentRule, failedChecks);
+        } else if (name == QStringLiteral("check") && m_inFailedRule && attributes.value(QStringLiteral("status")) == QStringLiteral("failed")) {
+            m_inFailure = true;
+            m_currentFailure = Failure();
+            m_currentFailure.rule = m_currentRule;
+        } else if (name == QStringLiteral("assertion") && attributes.value(QStringLiteral("status")).compare(QStringLiteral("failed"), Qt::CaseInsensitive) == 0) {
+            /// 'rawResults' format lists each violation as an assertion
+            m_inFailure = true;
+            m_currentFailure = Failure();
+        } else if (name == QStringLiteral("ruleId") && m_inFailure) {
+            m_currentFailure.rule = attributes.value(QStringLiteral("specification")).toString() + QLatin1Char(' ') + attributes.value(QStringLiteral("clause")).toString() + QLatin1Char('-') + attributes.value(QStringLiteral("testNumber")).toString();
+            countRuleViolations(m_currentFailure.rule, 1);
+        }
+    } else if (m_dialect == PdfBox) {
+        if (name == QStringLiteral("error")) {
+            m_inFailure = true;
+            m_currentFailure = Failure();
+        } else if (name == QStringLiteral("isValid"))
+            m_flavour = attributes.value(QStringLiteral("type")).toString();
+    }
+}
+
+void ValidatorOutputSummary::endElement() {
+    const QStringRef name = m_reader.name();
+    const QString text = m_text.trimmed();
+    m_text.clear();
+
+    if (m_dialect == VeraPDF) {
+        if (name == QStringLiteral("description") && m_inFailedRule && !m_inFailure) {
+            if (m_rules.contains(m_currentRule) && m_rules[m_currentRule].description.isEmpty())
+                m_rules[m_currentRule].description = text;
+        } else if (name == QStringLiteral("context") && m_inFailure)
+            m_currentFailure.context = text;
+        else if ((name == QStringLiteral("message") || name == QStringLiteral("errorMessage")) && m_inFailure)
+            m_currentFailure.message = text;
+        else if ((name == QStringLiteral("check") || name == QStringLiteral("assertion")) && m_inFailure) {
+            m_inFailure = false;
+            if (name == QStringLiteral("assertion")) ++m_failureCount; ///< failed checks got counted with their rule
+            if (m_failures.count() < m_maxFailures)
+                m_failures.append(m_currentFailure);
+        } else if (name == QStringLiteral("rule"))
+            m_inFailedRule = false;
+    } else if (m_dialect == PdfBox) {
+        if (name == QStringLiteral("code") && m_inFailure) {
+            m_currentFailure.rule = text;
+            countRuleViolations(text, 1);
+            ++m_failureCount;
+        } else if (name == QStringLiteral("details") && m_inFailure)
+            m_currentFailure.message = text;
+        else if (name == QStringLiteral("page") && m_inFailure)
+            m_currentFailure.context = QStringLiteral("page ") + text;
+        else if (name == QStringLiteral("error") && m_inFailure) {
+            m_inFailure = false;
+            if (m_failures.count() < m_maxFailures)
+                m_failures.append(m_currentFailure);
+        } else if (name == QStringLiteral("isValid")) {
+            m_complianceKnown = true;
+            m_compliant = text == QStringLiteral("true");
+        }
+    }
+
+    if (--m_depth == 0)
+        m_complete = true;
+}
+
+void ValidatorOutputSummary::countRuleViolations(const QString &rule, int count) {
+    if (m_rules.contains(rule) || m_rules.count() < maxRules)
+        m_rules[rule].count += count;
+}
+
+bool ValidatorOutputSummary::isEmpty() const {
+    return m_rawHead.isEmpty();
+}
+
+bool ValidatorOutputSummary::isComplete() const {
+    return m_complete;
+}
+
+bool ValidatorOutputSummary::hasParseError() const {
+    return m_parseError;
+}
+
+bool ValidatorOutputSummary::watchedPhraseSeen() const {
+    return m_watchedPhraseSeen;
+}
+
+bool ValidatorOutputSummary::complianceKnown() const {
+    return m_complianceKnown;
+}
+
+bool ValidatorOutputSummary::isCompliant() const {
+    return m_compliant;
+}
+
+QString ValidatorOutputSummary::flavour() const {
+    return m_flavour;
+}
+
+qint64 ValidatorOutputSummary::fileSize() const {
+    return m_fileSize;
+}
+
+int ValidatorOutputSummary::failedRuleCount() const {
+    return m_rules.count();
+}
+
+int ValidatorOutputSummary::failureCount() const {
+    return m_failureCount;
+}
+
+QString ValidatorOutputSummary::toXml() const {
+    QString result = QString(QStringLiteral("<summary complete=\"%1\" failedrules=\"%2\" failures=\"%3\"")).arg(m_complete ? QStringLiteral("yes") : QStringLiteral("no")).arg(m_rules.count()).arg(m_failureCount);
+    if (m_complianceKnown)
+        result.append(QString(QStringLiteral(" compliant=\"%1\"")).arg(m_compliant ? QStringLiteral("yes") : QStringLiteral("no")));
+    if (!m_flavour.isEmpty())
+        result.append(QString(QStringLiteral(" flavour=\"%1\"")).arg(DocScan::xmlify(m_flavour)));
+    result.append(QStringLiteral(">\n"));
+
+    if (m_parseError) {
+        result.append(QString(QStringLiteral("<error>Output is not well-formed XML: %1</error>\n")).arg(DocScan::xmlify(m_parseErrorString)));
+        result.append(QString(QStringLiteral("<output>%1</output>\n")).arg(DocScan::xmlifyLines(QString::fromUtf8(DocScan::removeBinaryGarbage(m_rawHead).constData()))));
+    }
+
+    for (QMap<QString, Rule>::ConstIterator it = m_rules.constBegin(); it != m_rules.constEnd(); ++it) {
+        if (it.value().description.isEmpty())
+            result.append(QString(QStringLiteral("<rule id=\"%1\" count=\"%2\" />\n")).arg(DocScan::xmlify(it.key())).arg(it.value().count));
+        else
+            result.append(QString(QStringLiteral("<rule id=\"%1\" count=\"%2\">%3</rule>\n")).arg(DocScan::xmlify(it.key())).arg(it.value().count).arg(DocScan::xmlify(it.value().description)));
+    }
+
+    for (const Failure &failure : m_failures) {
+        result.append(QString(QStringLiteral("<failure rule=\"%1\">")).arg(DocScan::xmlify(failure.rule)));
+        if (!failure.message.isEmpty())
+            result.append(QString(QStringLiteral("<message>%1</message>")).arg(DocScan::xmlify(failure.message)));
+        if (!failure.context.isEmpty())
+            result.append(QString(QStringLiteral("<context>%1</context>")).arg(DocScan::xmlify(failure.context)));
+        result.append(QStringLiteral("</failure>\n"));
+    }
+    if (m_failureCount > m_failures.count())
+        result.append(QString(QStringLiteral("<!-- %1 more failures omitted -->\n")).arg(m_failureCount - m_failures.count()));
+
+    result.append(QStringLiteral("</summary>\n"));
+    return result;
+}
+
+QJsonObject ValidatorOutputSummary::rulesToJson() const {
+    QJsonObject result;
+    for (QMap<QString, Rule>::ConstIterator it = m_rules.constBegin(); it != m_rules.constEnd(); ++it)
+        result.insert(it.key(), it.value().count);
+    return result;
+}
@@ -0,0 +1,148 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#ifndef VALIDATOROUTPUTSUMMARY_H
+#define VALIDATOROUTPUTSUMMARY_H
+
+#include <QXmlStreamReader>
+#include <QMap>
+#include <QList>
+#include <QJsonObject>
+
+/**
+ * Incrementally parses a validator's XML output as it arrives and
+ * keeps only a summary of it: the validator's verdict, how often
+ * each rule was violated, and details on the first few violations.
+ * Memory consumption is bounded independent of the output's size.
+ * Understands output of veraPDF (both 'rawResults' and machine
+ * readable report format) and of PDFBox's Preflight validator.
+ * If the output is not well-formed XML, the beginning of the output
+ * is kept instead.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class ValidatorOutputSummary
+{
+public:
+    enum Dialect {VeraPDF, PdfBox};
+
+    /**
+     * @param dialect which validator's output to expect
+     * @param maxFailures number of violations to keep details for
+     */
+    explicit ValidatorOutputSummary(Dialect dialect, int maxFailures);
+
+    /**
+     * Watch for a phrase anywhere in the output, even if split
+     * across several chunks of data.
+     */
+    void setWatchedPhrase(const QByteArray &phrase);
+
+    /**
+     * Parse next chunk of output, e.g. as read from a process.
+     */
+    void addData(const QByteArray &data);
+
+    /// True if no output has been received at all
+    bool isEmpty() const;
+    /// True if the output's root element has been closed
+    bool isComplete() const;
+    /// True if the output turned out not to be well-formed XML
+    bool hasParseError() const;
+    bool watchedPhraseSeen() const;
+
+    /// True if the validator stated whether the file is compliant
+    bool complianceKnown() const;
+    bool isCompliant() const;
+    /// Validated flavour like 'PDFA_1_B', if known
+    QString flavour() const;
+    /// File size as reported by the validator, 0 if unknown
+    qint64 fileSize() const;
+
+    int failedRuleCount() const;
+    int failureCount() const;
+
+    /**
+     * Summary as XML, to be embedded in the validator's element in the report.
+     */
+    QString toXml() const;
+
+    /**
+     * Summary as JSON, mapping rule identifiers to number of violations.
+     */
+    QJsonObject rulesToJson() const;
+
+private:
+    struct Failure {
+        QString rule, message, context;
+    };
+
+    struct Rule {
+        int count;
+        QString description;
+
+        explicit Rule()
+            : count(0) {
+            /// nothing
+        }
+    };
+
+    /// Number of bytes kept from output that is not well-formed XML
+    static const int maxRawHeadSize;
+    /// Number of characters kept from any element's text
+    static const int maxTextLength;
+    /// Number of different rules to count violations for
+    static const int maxRules;
+
+    const Dialect m_dialect;
+    const int m_maxFailures;
+    QXmlStreamReader m_reader;
+    bool m_parseError;
+    QString m_parseErrorString;
+    int m_depth;
+    bool m_complete;
+    QByteArray m_rawHead;
+
+    QByteArray m_watchedPhrase, m_phraseTail;
+    bool m_watchedPhraseSeen;
+
+    bool m_complianceKnown, m_compliant;
+    QString m_flavour;
+    qint64 m_fileSize;
+
+    QMap<QString, Rule> m_rules;
+    int m_failureCount;
+    QList<Failure> m_failures;
+
+    /// State while inside a violation's elements
+    QString m_text;
+    QString m_currentRule;
+    bool m_inFailedRule, m_inFailure;
+    Failure m_currentFailure;
+
+    void startElement();
+    void endElement();
+    void countRuleViolations(const QString &rule, int count);
+};
+
+#endif // VALIDATOROUTPUTSUMMARY_H
@@ -0,0 +1,80 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#include "zipdirectoryindex.h"
+
+#include <quazipfileinfo.h>
+
+ZipDirectoryIndex::ZipDirectoryIndex(QuaZip &zipFile)
+    : m_zipFile(zipFile)
+{
+    for (bool more = m_zipFile.goToFirstFile(); more; more = m_zipFile.goToNextFile()) {
+        QuaZipFileInfo64 info;
+        Entry entry;
+        if (!m_zipFile.getCurrentFileInfo(&info) || unzGetFilePos64(m_zipFile.getUnzFile(), &entry.position) != UNZ_OK)
+            continue;
+        entry.name = info.name;
+        entry.compressedSize = info.compressedSize;
+        entry.uncompressedSize = info.uncompressedSize;
+        entry.method = info.method;
+
+        /// Like QuaZip::setCurrentFile, the first of several equally named members wins
+        const QString key = entry.name.toLower();
+        if (!m_lookup.contains(key))
+            m_lookup.insert(key, m_entries.count());
+        m_entries.append(entry);
+    }
+}
+
+int ZipDirectoryIndex::count() const {
+    return m_entries.count();
+}
+
+const QList<ZipDirectoryIndex::Entry> &ZipDirectoryIndex::entries() const {
+    return m_entries;
+}
+
+bool ZipDirectoryIndex::contains(const QString &name) const {
+    return m_lookup.contains(name.toLower());
+}
+
+bool ZipDirectoryIndex::setCurrentFile(const QString &name) {
+    const QHash<QString, int>::ConstIterator it = m_lookup.constFind(name.toLower());
+    if (it == m_lookup.constEnd()) return false;
+    return setCurrentFile(m_entries[it.value()]);
+}
+
+bool ZipDirectoryIndex::setCurrentFile(const Entry &entry) {
+    return goToEntry(m_zipFile, entry);
+}
+
+bool ZipDirectoryIndex::goToEntry(QuaZip &zipFile, const Entry &entry) {
+    /// QuaZip only lets QuaZipFile open a member if it believes to have
+    /// a current file, which it stops doing after iterating past the last
+    /// member. Going to the first file restores this state cheaply,
+    /// then the underlying unzip handle is positioned directly.
+    if (!zipFile.hasCurrentFile() && !zipFile.goToFirstFile())
+        return false;
+    unz64_file_pos position = entry.position;
+    return unzGoToFilePos64(zipFile.getUnzFile(), &position) == UNZ_OK;
+}
@@ -0,0 +1,82 @@
+/*
+    This file is part of DocScan.
+
+    DocScan is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    DocScan is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with DocScan.  If not, see <https://www.gnu.org/licenses/>.
+
+
+    Copyright (2017) Thomas Fischer <thomas.fischer@his.se>, senior
+    lecturer at University of Skövde, as part of the LIM-IT project.
+
+ */
+
+
+#ifndef ZIPDIRECTORYINDEX_H
+#define ZIPDIRECTORYINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <quazip.h>
+
+/**
+ * Index of a ZIP archive's central directory, built in a single
+ * pass when the archive is opened. Members are looked up
+ * case-insensitively by name in constant time and are then
+ * positioned directly, without QuaZip::setCurrentFile scanning
+ * the central directory over and over again.
+ *
+ * @author Thomas Fischer <thomas.fischer@his.se>
+ */
+class ZipDirectoryIndex
+{
+public:
+    struct Entry {
+        QString name;
+        quint64 compressedSize, uncompressedSize;
+        quint16 method;
+        /// position of this entry's record in the central directory
+        unz64_file_pos position;
+    };
+
+    explicit ZipDirectoryIndex(QuaZip &zipFile);
+
+    int count() const;
+    const QList<Entry> &entries() const;
+    bool contains(const QString &name) const;
+
+    /**
+     * Make the member with the given name the archive's current file,
+     * so that a QuaZipFile constructed on this archive will read it.
+     *
+     * @param name member's name, compared case-insensitively
+     * @return true if member exists and was made current
+     */
+    bool setCurrentFile(const QString &name);
+    bool setCurrentFile(const Entry &entry);
+
+    /**
+     * Position another handle opened on the same archive on the given
+     * entry, e.g. one used by a worker thread.
+     */
+    static bool goToEntry(QuaZip &zipFile, const Entry &entry);
+
+private:
+    QuaZip &m_zipFile;
+    QList<Entry> m_entries;
+    /// lower-case member name to index in m_entries
+    QHash<QString, int> m_lookup;
+};
+
+#endif // ZIPDIRECTORYINDEX_H